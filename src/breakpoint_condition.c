@@ -0,0 +1,388 @@
+// breakpoint_condition.c - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Conditions for breakpoints and watchpoints, compiled to a compact stack-based bytecode
+
+#include "breakpoint_condition.h"
+#include "cpu.h"
+#include "device.h"
+#include "signal_line.h"
+
+#include "crt.h"
+
+#include <ctype.h>
+#include <stb/stb_ds.h>
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// private types
+//
+
+#define CONDITION_MAX_STACK			16
+#define CONDITION_MAX_OPERANDS		256
+#define CONDITION_MAX_IDENTIFIER	64
+#define CONDITION_MAX_NESTING		32			/* parentheses, brackets and unary operators */
+
+typedef enum ConditionOpcode {
+	// push a value on the stack - followed by a one byte operand
+	COND_OP_CONSTANT = 0,
+	COND_OP_REGISTER,
+	COND_OP_SIGNAL,
+
+	// replace the address on top of the stack with the memory contents
+	COND_OP_MEMORY,
+
+	// unary operators
+	COND_OP_NOT,
+	COND_OP_INVERT,
+	COND_OP_NEGATE,
+
+	// binary operators
+	COND_OP_LOGICAL_OR,
+	COND_OP_LOGICAL_AND,
+	COND_OP_OR,
+	COND_OP_XOR,
+	COND_OP_AND,
+	COND_OP_EQUAL,
+	COND_OP_NOT_EQUAL,
+	COND_OP_LESS,
+	COND_OP_LESS_EQUAL,
+	COND_OP_GREATER,
+	COND_OP_GREATER_EQUAL,
+	COND_OP_ADD,
+	COND_OP_SUBTRACT,
+	COND_OP_MULTIPLY,
+	COND_OP_DIVIDE,
+	COND_OP_MODULO
+} ConditionOpcode;
+
+typedef struct ConditionBinaryOperator {
+	const char *	token;
+	int				precedence;
+	ConditionOpcode	opcode;
+} ConditionBinaryOperator;
+
+// longer tokens first, so '<=' isn't parsed as '<'
+static const ConditionBinaryOperator BINARY_OPERATORS[] = {
+	{"||", 1, COND_OP_LOGICAL_OR},
+	{"&&", 2, COND_OP_LOGICAL_AND},
+	{"==", 6, COND_OP_EQUAL},
+	{"!=", 6, COND_OP_NOT_EQUAL},
+	{"<=", 7, COND_OP_LESS_EQUAL},
+	{">=", 7, COND_OP_GREATER_EQUAL},
+	{"|",  3, COND_OP_OR},
+	{"^",  4, COND_OP_XOR},
+	{"&",  5, COND_OP_AND},
+	{"=",  6, COND_OP_EQUAL},
+	{"<",  7, COND_OP_LESS},
+	{">",  7, COND_OP_GREATER},
+	{"+",  8, COND_OP_ADD},
+	{"-",  8, COND_OP_SUBTRACT},
+	{"*",  9, COND_OP_MULTIPLY},
+	{"/",  9, COND_OP_DIVIDE},
+	{"%",  9, COND_OP_MODULO}
+};
+
+typedef struct ConditionParser {
+	const char *			src;
+	const char *			error;
+	BreakpointCondition *	cond;
+	struct Cpu *			cpu;
+	struct SignalPool *		pool;
+	uint32_t				depth;
+	uint32_t				nesting;
+} ConditionParser;
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// parser
+//
+
+static void parse_expression(ConditionParser *parser, int min_precedence);
+
+static inline void skip_whitespace(ConditionParser *parser) {
+	while (isspace((unsigned char) *parser->src)) {
+		++parser->src;
+	}
+}
+
+static inline void parse_error(ConditionParser *parser, const char *error) {
+	if (!parser->error) {
+		parser->error = error;
+	}
+}
+
+static void emit_push(ConditionParser *parser, ConditionOpcode opcode, size_t operand) {
+	if (operand >= CONDITION_MAX_OPERANDS) {
+		parse_error(parser, "expression too complex");
+		return;
+	}
+
+	arrpush(parser->cond->code, (uint8_t) opcode);
+	arrpush(parser->cond->code, (uint8_t) operand);
+
+	parser->depth += 1;
+	parser->cond->max_stack = MAX(parser->cond->max_stack, parser->depth);
+	if (parser->depth > CONDITION_MAX_STACK) {
+		parse_error(parser, "expression too complex");
+	}
+}
+
+static void emit_operator(ConditionParser *parser, ConditionOpcode opcode, uint32_t operands) {
+	arrpush(parser->cond->code, (uint8_t) opcode);
+	parser->depth -= operands - 1;
+}
+
+static bool parse_number(ConditionParser *parser, int64_t *value) {
+	int base = 10;
+
+	if (parser->src[0] == '$') {
+		base = 16;
+		parser->src += 1;
+	} else if (parser->src[0] == '0' && (parser->src[1] == 'x' || parser->src[1] == 'X')) {
+		base = 16;
+		parser->src += 2;
+	} else if (parser->src[0] == '%') {
+		base = 2;
+		parser->src += 1;
+	}
+
+	char *end = NULL;
+	*value = strtoll(parser->src, &end, base);
+	if (end == parser->src) {
+		return false;
+	}
+
+	parser->src = end;
+	return true;
+}
+
+static void parse_identifier(ConditionParser *parser) {
+	char name[CONDITION_MAX_IDENTIFIER];
+	size_t len = 0;
+
+	while (isalnum((unsigned char) *parser->src) || *parser->src == '_') {
+		if (len < CONDITION_MAX_IDENTIFIER - 1) {
+			name[len++] = *parser->src;
+		}
+		++parser->src;
+	}
+	name[len] = '\0';
+
+	// cpu registers take precedence over signals with the same name
+	if (parser->cpu && parser->cpu->register_index) {
+		int32_t reg = parser->cpu->register_index(parser->cpu, name);
+		if (reg >= 0) {
+			emit_push(parser, COND_OP_REGISTER, (size_t) reg);
+			return;
+		}
+	}
+
+	if (parser->pool) {
+		Signal signal = signal_by_name(parser->pool, name);
+		if (!signal_is_undefined(signal)) {
+			arrpush(parser->cond->signals, signal);
+			emit_push(parser, COND_OP_SIGNAL, arrlenu(parser->cond->signals) - 1);
+			return;
+		}
+	}
+
+	parse_error(parser, "unknown register or signal");
+}
+
+static void parse_primary(ConditionParser *parser) {
+	skip_whitespace(parser);
+
+	// the parser recurses for each level: limit the nesting to protect the stack
+	if (parser->nesting >= CONDITION_MAX_NESTING) {
+		parse_error(parser, "expression nested too deeply");
+		return;
+	}
+	parser->nesting += 1;
+
+	char c = *parser->src;
+
+	if (c == '(' || c == '[') {
+		parser->src += 1;
+		parse_expression(parser, 1);
+		skip_whitespace(parser);
+
+		if (*parser->src != ((c == '(') ? ')' : ']')) {
+			parse_error(parser, (c == '(') ? "expected ')'" : "expected ']'");
+		} else {
+			parser->src += 1;
+
+			if (c == '[') {
+				emit_operator(parser, COND_OP_MEMORY, 1);
+			}
+		}
+	} else if (c == '!' || c == '~' || c == '-') {
+		parser->src += 1;
+		parse_primary(parser);
+		emit_operator(parser, (c == '!') ? COND_OP_NOT : (c == '~') ? COND_OP_INVERT : COND_OP_NEGATE, 1);
+	} else if (isdigit((unsigned char) c) || c == '$' || c == '%') {
+		int64_t value;
+		if (!parse_number(parser, &value)) {
+			parse_error(parser, "invalid number");
+		} else {
+			arrpush(parser->cond->constants, value);
+			emit_push(parser, COND_OP_CONSTANT, arrlenu(parser->cond->constants) - 1);
+		}
+	} else if (isalpha((unsigned char) c) || c == '_') {
+		parse_identifier(parser);
+	} else {
+		parse_error(parser, (c == '\0') ? "missing operand" : "unexpected character");
+	}
+
+	parser->nesting -= 1;
+}
+
+static const ConditionBinaryOperator *peek_binary_operator(ConditionParser *parser) {
+	skip_whitespace(parser);
+
+	for (size_t i = 0; i < sizeof(BINARY_OPERATORS) / sizeof(BINARY_OPERATORS[0]); ++i) {
+		size_t len = dms_strlen(BINARY_OPERATORS[i].token);
+		if (dms_strncmp(parser->src, BINARY_OPERATORS[i].token, len) == 0) {
+			return &BINARY_OPERATORS[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void parse_expression(ConditionParser *parser, int min_precedence) {
+	parse_primary(parser);
+
+	while (!parser->error) {
+		const ConditionBinaryOperator *op = peek_binary_operator(parser);
+		if (!op || op->precedence < min_precedence) {
+			break;
+		}
+
+		parser->src += dms_strlen(op->token);
+		parse_expression(parser, op->precedence + 1);
+		emit_operator(parser, op->opcode, 2);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// interface
+//
+
+BreakpointCondition *breakpoint_condition_compile(const char *source, struct Cpu *cpu, struct SignalPool *pool, const char **error) {
+	assert(source);
+
+	BreakpointCondition *cond = (BreakpointCondition *) dms_calloc(1, sizeof(BreakpointCondition));
+
+	ConditionParser parser = {
+		.src = source,
+		.error = NULL,
+		.cond = cond,
+		.cpu = cpu,
+		.pool = pool,
+		.depth = 0,
+		.nesting = 0
+	};
+
+	parse_expression(&parser, 1);
+
+	skip_whitespace(&parser);
+	if (*parser.src != '\0') {
+		parse_error(&parser, "unexpected input after expression");
+	}
+
+	if (parser.error) {
+		if (error) {
+			*error = parser.error;
+		}
+		breakpoint_condition_destroy(cond);
+		return NULL;
+	}
+
+	cond->source = dms_strdup(source);
+	return cond;
+}
+
+void breakpoint_condition_destroy(BreakpointCondition *condition) {
+	assert(condition);
+
+	dms_free(condition->source);
+	arrfree(condition->code);
+	arrfree(condition->constants);
+	arrfree(condition->signals);
+	dms_free(condition);
+}
+
+bool breakpoint_condition_evaluate(BreakpointCondition *condition, struct Cpu *cpu, struct Device *device, struct SignalPool *pool) {
+	assert(condition);
+
+	int64_t stack[CONDITION_MAX_STACK];
+	int sp = -1;
+
+	#define BINARY_OP(expr)	\
+		--sp;				\
+		stack[sp] = (expr);	\
+		break;
+
+	// the operands come from user input: arithmetic wraps around (two's complement) instead of overflowing
+	#define WRAP(expr)		((int64_t) (expr))
+
+	const uint8_t *code = condition->code;
+	const uint8_t *code_end = code + arrlenu(condition->code);
+
+	while (code < code_end) {
+		int64_t lhs = (sp > 0) ? stack[sp - 1] : 0;
+		int64_t rhs = (sp >= 0) ? stack[sp] : 0;
+
+		switch ((ConditionOpcode) *code++) {
+			case COND_OP_CONSTANT:
+				stack[++sp] = condition->constants[*code++];
+				break;
+			case COND_OP_REGISTER:
+				stack[++sp] = cpu->register_value(cpu, *code++);
+				break;
+			case COND_OP_SIGNAL:
+				stack[++sp] = signal_read(pool, condition->signals[*code++]);
+				break;
+			case COND_OP_MEMORY: {
+				uint8_t value = 0;
+				if (device) {
+					device->read_memory(device, (size_t) (rhs & 0xffff), 1, &value);
+				}
+				stack[sp] = value;
+				break;
+			}
+			case COND_OP_NOT:
+				stack[sp] = !rhs;
+				break;
+			case COND_OP_INVERT:
+				stack[sp] = ~rhs;
+				break;
+			case COND_OP_NEGATE:
+				stack[sp] = WRAP(0 - (uint64_t) rhs);
+				break;
+			case COND_OP_LOGICAL_OR:	BINARY_OP(lhs || rhs)
+			case COND_OP_LOGICAL_AND:	BINARY_OP(lhs && rhs)
+			case COND_OP_OR:			BINARY_OP(lhs | rhs)
+			case COND_OP_XOR:			BINARY_OP(lhs ^ rhs)
+			case COND_OP_AND:			BINARY_OP(lhs & rhs)
+			case COND_OP_EQUAL:			BINARY_OP(lhs == rhs)
+			case COND_OP_NOT_EQUAL:		BINARY_OP(lhs != rhs)
+			case COND_OP_LESS:			BINARY_OP(lhs < rhs)
+			case COND_OP_LESS_EQUAL:	BINARY_OP(lhs <= rhs)
+			case COND_OP_GREATER:		BINARY_OP(lhs > rhs)
+			case COND_OP_GREATER_EQUAL:	BINARY_OP(lhs >= rhs)
+			case COND_OP_ADD:			BINARY_OP(WRAP((uint64_t) lhs + (uint64_t) rhs))
+			case COND_OP_SUBTRACT:		BINARY_OP(WRAP((uint64_t) lhs - (uint64_t) rhs))
+			case COND_OP_MULTIPLY:		BINARY_OP(WRAP((uint64_t) lhs * (uint64_t) rhs))
+			// INT64_MIN / -1 traps: dividing by -1 is a negation
+			case COND_OP_DIVIDE:		BINARY_OP((rhs == 0) ? 0 : (rhs == -1) ? WRAP(0 - (uint64_t) lhs) : lhs / rhs)
+			case COND_OP_MODULO:		BINARY_OP((rhs == 0 || rhs == -1) ? 0 : lhs % rhs)
+		}
+	}
+
+	#undef WRAP
+	#undef BINARY_OP
+
+	return sp >= 0 && stack[sp] != 0;
+}
@@ -0,0 +1,47 @@
+// breakpoint_condition.h - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Conditions for breakpoints and watchpoints, compiled to a compact stack-based bytecode
+
+/* Expression syntax (C-like precedence):
+	- numbers: decimal (13), hexadecimal ($0d or 0x0d) or binary (%1101)
+	- cpu registers (A, X, Y, SP, PC, ... - case insensitive) or signal names (RW, CLK1, ...)
+	- memory contents: [address-expression]
+	- operators: || && | ^ & == (or =) != < <= > >= + - * / % and the unary operators ! ~ -
+   Example: A == $0d && X > 3 && [$e0] != 0
+*/
+
+#ifndef DROMAIUS_BREAKPOINT_CONDITION_H
+#define DROMAIUS_BREAKPOINT_CONDITION_H
+
+#include "signal_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// forward declarations
+struct Cpu;
+struct Device;
+struct SignalPool;
+
+// types
+typedef struct BreakpointCondition {
+	char *			source;				// expression as entered by the user
+	uint8_t *		code;				// bytecode (dynamic array)
+	int64_t *		constants;			// dynamic array
+	Signal *		signals;			// dynamic array
+	uint32_t		max_stack;			// stack depth required to evaluate the expression
+} BreakpointCondition;
+
+// breakpoint_condition_compile: parse the expression and convert it to bytecode (returns NULL and sets error when the expression is invalid)
+BreakpointCondition *breakpoint_condition_compile(const char *source, struct Cpu *cpu, struct SignalPool *pool, const char **error);
+void breakpoint_condition_destroy(BreakpointCondition *condition);
+
+// breakpoint_condition_evaluate: returns true when the expression evaluates to a non-zero value
+bool breakpoint_condition_evaluate(BreakpointCondition *condition, struct Cpu *cpu, struct Device *device, struct SignalPool *pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DROMAIUS_BREAKPOINT_CONDITION_H
@@ -0,0 +1,117 @@
+// bus_watcher.c - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Passive bus snooper that checks the memory accesses of a cpu against a set of watchpoints
+
+#include "bus_watcher.h"
+#include "signal_line.h"
+
+#include "crt.h"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// helper functions
+//
+
+static inline bool watcher_read(const uint64_t *signals_value, Signal signal) {
+	return (signals_value[signal.block] >> signal.index) & 1ull;
+}
+
+static inline uint32_t watcher_read_bits(const uint64_t *signals_value, const Signal *signals, size_t count) {
+	uint32_t result = 0;
+
+	for (size_t i = 0; i < count; ++i) {
+		result |= (uint32_t) watcher_read(signals_value, signals[i]) << i;
+	}
+
+	return result;
+}
+
+static void watcher_copy_group(Signal *dst, size_t *count, size_t max_count, SignalGroup group) {
+	assert(signal_group_size(group) <= max_count);
+
+	*count = signal_group_size(group);
+	for (size_t i = 0; i < *count; ++i) {
+		dst[i] = *group[i];
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// interface
+//
+
+BusWatcher *bus_watcher_create(Signal strobe, Signal rw, Signal sync, SignalGroup address, SignalGroup data) {
+	BusWatcher *watcher = (BusWatcher *) dms_calloc(1, sizeof(BusWatcher));
+
+	watcher->strobe = strobe;
+	watcher->rw = rw;
+	watcher->sync = sync;
+	watcher_copy_group(watcher->address, &watcher->address_count, BUS_WATCHER_MAX_BITS, address);
+	watcher_copy_group(watcher->data, &watcher->data_count, 8, data);
+
+	watcher->instruction_pc = -1;
+	watcher->last_hit.address = -1;
+
+	return watcher;
+}
+
+void bus_watcher_destroy(BusWatcher *watcher) {
+	assert(watcher);
+	dms_free(watcher);
+}
+
+void bus_watcher_clear(BusWatcher *watcher) {
+	assert(watcher);
+
+	dms_zero(watcher->flags, sizeof(watcher->flags));
+	dms_zero(watcher->values, sizeof(watcher->values));
+	watcher->watch_count = 0;
+}
+
+void bus_watcher_set(BusWatcher *watcher, BusWatchpoint watchpoint) {
+	assert(watcher);
+	assert(watchpoint.address >= 0 && watchpoint.address < BUS_WATCHER_ADDRESS_SPACE);
+
+	uint8_t *flags = &watcher->flags[watchpoint.address];
+
+	if (*flags == 0 && watchpoint.flags != 0) {
+		watcher->watch_count += 1;
+	} else if (*flags != 0 && watchpoint.flags == 0) {
+		watcher->watch_count -= 1;
+	}
+
+	*flags = watchpoint.flags;
+	watcher->values[watchpoint.address] = watchpoint.value;
+}
+
+bool bus_watcher_process(BusWatcher *watcher, int64_t tick, const uint64_t *signals_value) {
+	assert(watcher);
+
+	uint32_t address = watcher_read_bits(signals_value, watcher->address, watcher->address_count);
+	bool write = !watcher_read(signals_value, watcher->rw);
+
+	if (watcher_read(signals_value, watcher->sync)) {
+		watcher->instruction_pc = address;
+	}
+
+	// fast path: a single lookup for an unwatched address
+	uint8_t flags = watcher->flags[address];
+	if ((flags & ((write) ? BUS_WATCH_WRITE : BUS_WATCH_READ)) == 0) {
+		return false;
+	}
+
+	uint8_t value = (uint8_t) watcher_read_bits(signals_value, watcher->data, watcher->data_count);
+	if ((flags & BUS_WATCH_VALUE) && value != watcher->values[address]) {
+		return false;
+	}
+
+	watcher->last_hit = (BusWatchHit) {
+		.tick = tick,
+		.address = address,
+		.pc = watcher->instruction_pc,
+		.value = value,
+		.write = write
+	};
+
+	return true;
+}
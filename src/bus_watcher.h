@@ -0,0 +1,73 @@
+// bus_watcher.h - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Passive bus snooper that checks the memory accesses of a cpu against a set of watchpoints
+
+#ifndef DROMAIUS_BUS_WATCHER_H
+#define DROMAIUS_BUS_WATCHER_H
+
+#include "signal_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// types
+#define BUS_WATCHER_ADDRESS_SPACE	65536
+#define BUS_WATCHER_MAX_BITS		16
+
+typedef enum BusWatchFlags {
+	BUS_WATCH_READ	= 0b00000001,			// break when the address is read
+	BUS_WATCH_WRITE	= 0b00000010,			// break when the address is written
+	BUS_WATCH_VALUE	= 0b00000100,			// only break when the data on the bus matches the value of the watchpoint
+} BusWatchFlags;
+
+typedef struct BusWatchpoint {
+	int64_t		address;
+	uint8_t		flags;
+	uint8_t		value;
+} BusWatchpoint;
+
+typedef struct BusWatchHit {
+	int64_t		tick;						// simulator tick of the end of the bus cycle
+	int64_t		address;
+	int64_t		pc;							// address of the opcode of the instruction that accessed the memory
+	uint8_t		value;
+	bool		write;
+} BusWatchHit;
+
+typedef struct BusWatcher {
+	// bus signals (rw is high for a read cycle, a bus cycle ends on the negative edge of the strobe)
+	Signal		strobe;
+	Signal		rw;
+	Signal		sync;
+	Signal		address[BUS_WATCHER_MAX_BITS];
+	Signal		data[8];
+	size_t		address_count;
+	size_t		data_count;
+
+	// watched addresses
+	uint8_t		flags[BUS_WATCHER_ADDRESS_SPACE];		// BusWatchFlags for each address
+	uint8_t		values[BUS_WATCHER_ADDRESS_SPACE];		// value to match when BUS_WATCH_VALUE is set
+	uint32_t	watch_count;
+
+	// state
+	int64_t		instruction_pc;
+	BusWatchHit	last_hit;
+} BusWatcher;
+
+// construction
+BusWatcher *bus_watcher_create(Signal strobe, Signal rw, Signal sync, SignalGroup address, SignalGroup data);
+void bus_watcher_destroy(BusWatcher *watcher);
+
+// configuration
+void bus_watcher_clear(BusWatcher *watcher);
+void bus_watcher_set(BusWatcher *watcher, BusWatchpoint watchpoint);
+
+// bus_watcher_process: call on each negative edge of the strobe - returns true when a watchpoint was hit (details in last_hit)
+bool bus_watcher_process(BusWatcher *watcher, int64_t tick, const uint64_t *signals_value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DROMAIUS_BUS_WATCHER_H
@@ -39,15 +39,11 @@ static uint8_t Chip8x4116DRam_PinTypes[CHIP_4116_PIN_COUNT] = {
 	[CHIP_4116_DO5   ] = CHIP_PIN_OUTPUT,
 	[CHIP_4116_DO6   ] = CHIP_PIN_OUTPUT,
 	[CHIP_4116_DO7   ] = CHIP_PIN_OUTPUT,
-	[CHIP_4116_WE_B  ] = CHIP_PIN_INPUT | CHIP_PIN_TRIGGER,
+	[CHIP_4116_WE_B  ] = CHIP_PIN_INPUT,					// dependency is added while CAS is asserted
 	[CHIP_4116_RAS_B ] = CHIP_PIN_INPUT | CHIP_PIN_TRIGGER,
 	[CHIP_4116_CAS_B ] = CHIP_PIN_INPUT | CHIP_PIN_TRIGGER,
 };
 
-#define CHIP_8x4116_IDLE 0
-#define CHIP_8x4116_OUTPUT_BEGIN 1
-#define CHIP_8x4116_OUTPUT 2
-
 void chip_8x4116_dram_destroy(Chip8x4116DRam *chip);
 void chip_8x4116_dram_process(Chip8x4116DRam *chip);
 
@@ -58,7 +54,7 @@ Chip8x4116DRam *chip_8x4116_dram_create(Simulator *sim, Chip8x4116DRamSignals si
 	CHIP_SET_VARIABLES(chip, sim, chip->signals, Chip8x4116DRam_PinTypes, CHIP_4116_PIN_COUNT);
 
 	chip->signal_pool = sim->signal_pool;
-	chip->access_time = simulator_interval_to_tick_count(sim, NS_TO_PS(100));
+	chip->row_data = chip->data_array;
 
 	dms_memcpy(chip->signals, signals, sizeof(Chip8x4116DRamSignals));
 
@@ -97,45 +93,57 @@ void chip_8x4116_dram_process(Chip8x4116DRam *chip) {
 	assert(chip);
 
 	bool ras_b = SIGNAL_READ(RAS_B);
-	bool cas_b = SIGNAL_READ(CAS_B);
 
-	// negative edge on ras_b: latch row address
+	// negative edge on ras_b: latch row address (a refresh cycle doesn't do anything else)
 	if (!ras_b && SIGNAL_CHANGED(RAS_B)) {
 		chip->row = SIGNAL_GROUP_READ_U8(address);
+		chip->row_data = chip->data_array + (chip->row * 128);
 		return;
 	}
 
-	// negative adge on cas_b: latch col address
-	if (!ras_b && !cas_b && SIGNAL_CHANGED(CAS_B)) {
-		chip->col = SIGNAL_GROUP_READ_U8(address);
-
-		// if write-enable is already asserted: perform early write
-		if (ACTLO_ASSERTED(SIGNAL_READ(WE_B))) {
-			chip->data_array[chip->row * 128 + chip->col] = SIGNAL_GROUP_READ_U8(din);
+	if (SIGNAL_CHANGED(CAS_B)) {
+		if (!SIGNAL_READ(CAS_B)) {
+			if (ras_b) {
+				return;
+			}
+
+			// negative edge on cas_b: latch col address
+			chip->col = SIGNAL_GROUP_READ_U8(address);
+			SIGNAL_DEPENDENCY(WE_B);
+
+			// if write-enable is already asserted: perform early write (data-out stays high-impedance)
+			if (ACTLO_ASSERTED(SIGNAL_READ(WE_B))) {
+				chip->row_data[chip->col] = SIGNAL_GROUP_READ_U8(din);
+			} else {
+				SIGNAL_GROUP_WRITE(dout, chip->row_data[chip->col]);
+				chip->output = true;
+			}
 		} else {
-			chip->schedule_timestamp = chip->simulator->current_tick + chip->access_time;
-			chip->next_state_transition = chip->schedule_timestamp;
-			chip->state = CHIP_8x4116_OUTPUT_BEGIN;
-		}
-		return;
-	}
+			// positive edge on cas_b: end of the cycle
+			SIGNAL_NO_DEPENDENCY(WE_B);
 
-	// negative edge on write while ras_b and cas_b are asserted
-	if (!ras_b && !cas_b && !SIGNAL_READ(WE_B) && SIGNAL_CHANGED(WE_B)) {
-		chip->data_array[chip->row * 128 + chip->col] = SIGNAL_GROUP_READ_U8(din);
+			if (chip->output) {
+				SIGNAL_GROUP_NO_WRITE(dout);
+				chip->output = false;
+			}
+		}
 		return;
 	}
 
-	if (chip->state == CHIP_8x4116_OUTPUT_BEGIN && chip->next_state_transition >= chip->simulator->current_tick) {
-		chip->do_latch = chip->data_array[chip->row * 128 + chip->col];
-		SIGNAL_GROUP_WRITE(dout, chip->do_latch);
-		chip->state = CHIP_8x4116_OUTPUT;
-	}
-
-	if (chip->state == CHIP_8x4116_OUTPUT && cas_b) {
-		SIGNAL_GROUP_NO_WRITE(dout);
-		chip->state = CHIP_8x4116_IDLE;
+	// negative edge on write while ras_b and cas_b are asserted (late write / read-modify-write)
+	if (!ras_b && !SIGNAL_READ(CAS_B) && ACTLO_ASSERTED(SIGNAL_READ(WE_B)) && SIGNAL_CHANGED(WE_B)) {
+		chip->row_data[chip->col] = SIGNAL_GROUP_READ_U8(din);
 	}
 }
 
+void chip_8x4116_dram_load(Chip8x4116DRam *chip, const uint8_t *data) {
+	assert(chip);
+	assert(data);
+	dms_memcpy(chip->data_array, data, CHIP_4116_DATA_SIZE);
+}
 
+void chip_8x4116_dram_save(Chip8x4116DRam *chip, uint8_t *data) {
+	assert(chip);
+	assert(data);
+	dms_memcpy(data, chip->data_array, CHIP_4116_DATA_SIZE);
+}
@@ -14,8 +14,10 @@ extern "C" {
 
 // types - 8x MK 4116 (16K x 1 Bit Dynamic Ram)
 //	- 8 parallel chips in one type because I don't want to waste 8x the memory
-//	- does not emulate refresh cycle (or lack thereof)
+//	- does not emulate refresh cycle (or lack thereof): RAS-only cycles just latch the row address
 //  - does not follow real pin-assignments because it aggregates 8 chips
+//	- the access time isn't emulated: the data is output on the negative edge of CAS
+//	- write-enable is only watched while CAS is asserted
 
 enum Chip8x4116DRamSignalAssignment {
 	// 7-bit address
@@ -67,22 +69,22 @@ typedef struct Chip8x4116DRam {
 	SignalGroup			sg_din;
 	SignalGroup			sg_dout;
 
-	// config
-	int64_t		access_time;
-
 	// data
 	uint8_t		row;
 	uint8_t		col;
-	uint8_t		do_latch;
-	uint8_t		data_array[128 * 128];
-
-	int			state;
-	int64_t		next_state_transition;
+	uint8_t *	row_data;				// start of the selected row in data_array
+	bool		output;					// driving the data-out lines
+	uint8_t		data_array[128 * 128];	// indexed by (row * 128) + column
 } Chip8x4116DRam;
 
 // functions - 8x MK 4116
 Chip8x4116DRam *chip_8x4116_dram_create(struct Simulator *simulator, Chip8x4116DRamSignals signals);
 
+// bulk access to the entire bank (CHIP_4116_DATA_SIZE bytes in the order of data_array)
+#define CHIP_4116_DATA_SIZE		(128 * 128)
+void chip_8x4116_dram_load(Chip8x4116DRam *chip, const uint8_t *data);
+void chip_8x4116_dram_save(Chip8x4116DRam *chip, uint8_t *data);
+
 #ifdef __cplusplus
 }
 #endif
@@ -26,10 +26,10 @@ static uint8_t Chip6114SRam_PinTypes[CHIP_6114_PIN_COUNT] = {
 	[CHIP_6114_A7  ] = CHIP_PIN_INPUT | CHIP_PIN_TRIGGER,
 	[CHIP_6114_A8  ] = CHIP_PIN_INPUT | CHIP_PIN_TRIGGER,
 	[CHIP_6114_A9  ] = CHIP_PIN_INPUT | CHIP_PIN_TRIGGER,
-	[CHIP_6114_IO0 ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT | CHIP_PIN_TRIGGER,
-	[CHIP_6114_IO1 ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT | CHIP_PIN_TRIGGER,
-	[CHIP_6114_IO2 ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT | CHIP_PIN_TRIGGER,
-	[CHIP_6114_IO3 ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT | CHIP_PIN_TRIGGER,
+	[CHIP_6114_IO0 ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT,
+	[CHIP_6114_IO1 ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT,
+	[CHIP_6114_IO2 ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT,
+	[CHIP_6114_IO3 ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT,
 	[CHIP_6114_CE_B] = CHIP_PIN_INPUT | CHIP_PIN_TRIGGER,
 	[CHIP_6114_RW  ] = CHIP_PIN_INPUT | CHIP_PIN_TRIGGER,
 };
@@ -44,6 +44,8 @@ Chip6114SRam *chip_6114_sram_create(Simulator *sim, Chip6114SRamSignals signals)
 	CHIP_SET_VARIABLES(chip, sim, chip->signals, Chip6114SRam_PinTypes, CHIP_6114_PIN_COUNT);
 
 	chip->signal_pool = sim->signal_pool;
+	chip->address = -1;
+	chip->last_data = -1;
 	dms_memcpy(chip->signals, signals, sizeof(Chip6114SRamSignals));
 
 	SIGNAL_DEFINE_GROUP(A0, address);
@@ -75,21 +77,82 @@ static void chip_6114_sram_destroy(Chip6114SRam *chip) {
 	dms_free(chip);
 }
 
+static inline void chip_6114_sram_watch_signal(Chip6114SRam *chip, Signal signal, bool watch) {
+	// the chip-enable line is always watched (take care when it's also connected to another pin)
+	if (signal_equal(signal, SIGNAL(CE_B))) {
+		return;
+	} else if (watch) {
+		signal_add_dependency(chip->signal_pool, signal, chip->id);
+	} else {
+		signal_remove_dependency(chip->signal_pool, signal, chip->id);
+	}
+}
+
+static void chip_6114_sram_watch_bus(Chip6114SRam *chip, bool watch) {
+	// stop being woken up by the address and R/W lines while the chip isn't selected
+	for (size_t i = 0, n = arrlenu(chip->sg_address); i < n; ++i) {
+		chip_6114_sram_watch_signal(chip, *chip->sg_address[i], watch);
+	}
+
+	chip_6114_sram_watch_signal(chip, SIGNAL(RW), watch);
+	chip->deselected = !watch;
+}
+
+static void chip_6114_sram_watch_io(Chip6114SRam *chip, bool watch) {
+	for (size_t i = 0, n = arrlenu(chip->sg_io); i < n; ++i) {
+		chip_6114_sram_watch_signal(chip, *chip->sg_io[i], watch);
+	}
+	chip->watch_io = watch;
+}
+
 static void chip_6114_sram_process(Chip6114SRam *chip) {
 
 	if (!ACTLO_ASSERTED(SIGNAL_READ(CE_B))) {
-		SIGNAL_GROUP_NO_WRITE(io);
+		if (!chip->deselected) {
+			SIGNAL_GROUP_NO_WRITE(io);
+			chip->last_data = -1;
+			chip->address = -1;
+			chip_6114_sram_watch_bus(chip, false);
+		}
+		if (chip->watch_io) {
+			chip_6114_sram_watch_io(chip, false);
+		}
 		return;
 	}
 
-	int addr = SIGNAL_GROUP_READ_U32(address);
+	if (chip->deselected) {
+		chip_6114_sram_watch_bus(chip, true);
+	}
 
-	if (SIGNAL_READ(RW)) {
-		SIGNAL_GROUP_WRITE(io, chip->data_array[addr]);
+	// decode the address: each change of an address line wakes up the chip while it's selected,
+	//	flipping the bits of the lines that changed keeps the address up-to-date
+	if (chip->address < 0) {
+		chip->address = SIGNAL_GROUP_READ_U32(address);
 	} else {
-		chip->data_array[addr] = SIGNAL_GROUP_READ_U8(io);
-		SIGNAL_GROUP_NO_WRITE(io);
+		for (size_t i = 0, n = arrlenu(chip->sg_address); i < n; ++i) {
+			chip->address ^= signal_changed(chip->signal_pool, *chip->sg_address[i]) << i;
+		}
+	}
+
+	if (SIGNAL_READ(RW)) {
+		if (chip->watch_io) {
+			chip_6114_sram_watch_io(chip, false);
+		}
+		if (chip->data_array[chip->address] != chip->last_data) {
+			SIGNAL_GROUP_WRITE(io, chip->data_array[chip->address]);
+			chip->last_data = chip->data_array[chip->address];
+		}
+		return;
 	}
-}
 
+	// write: the memory follows the io lines as long as R/W is low
+	if (chip->last_data != -1) {
+		SIGNAL_GROUP_NO_WRITE(io);
+		chip->last_data = -1;
+	}
+	if (!chip->watch_io) {
+		chip_6114_sram_watch_io(chip, true);
+	}
 
+	chip->data_array[chip->address] = SIGNAL_GROUP_READ_U8(io);
+}
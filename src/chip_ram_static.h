@@ -51,7 +51,10 @@ typedef struct Chip6114SRam {
 	SignalGroup			sg_io;
 
 	// data
+	int32_t		address;				// decoded address (-1 == read all address lines at the next activation)
 	int			last_data;
+	bool		deselected;				// the address and R/W lines aren't watched while the chip isn't selected
+	bool		watch_io;				// the io lines are only watched during a write
 	uint8_t		data_array[1024];
 } Chip6114SRam;
 
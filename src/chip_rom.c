@@ -3,12 +3,127 @@
 // Emulation of read-only memory modules
 
 #include "chip_rom.h"
+#include "rom_image.h"
 #include "simulator.h"
 
 #include "crt.h"
 
 #define SIGNAL_OWNER		chip
 
+//////////////////////////////////////////////////////////////////////////////
+//
+// common functionality
+//
+
+static void chip_63xx_rom_watch_address(Chip63xxRom *chip, bool watch, const uint32_t *cs_pins, size_t num_cs_pins) {
+	// stop being woken up by changes of the address lines while the chip isn't selected
+	//	(take care not to drop a chip-select signal that's also connected to an address line)
+	for (size_t i = 0, n = arrlenu(chip->sg_address); i < n; ++i) {
+		bool is_cs = false;
+		for (size_t cs = 0; cs < num_cs_pins; ++cs) {
+			is_cs = is_cs || signal_equal(*chip->sg_address[i], chip->signals[cs_pins[cs]]);
+		}
+
+		if (is_cs) {
+			continue;
+		} else if (watch) {
+			signal_add_dependency(chip->signal_pool, *chip->sg_address[i], chip->id);
+		} else {
+			signal_remove_dependency(chip->signal_pool, *chip->sg_address[i], chip->id);
+		}
+	}
+
+	chip->deselected = !watch;
+}
+
+static inline void chip_63xx_rom_process(Chip63xxRom *chip, bool selected, bool cs_changed,
+										 const uint32_t *cs_pins, size_t num_cs_pins) {
+	if (!selected) {
+		if (chip->last_data != -1) {
+			SIGNAL_GROUP_NO_WRITE(data);
+			chip->last_data = -1;
+		}
+		if (!chip->deselected) {
+			chip_63xx_rom_watch_address(chip, false, cs_pins, num_cs_pins);
+		}
+		return;
+	}
+
+	if (chip->deselected) {
+		chip_63xx_rom_watch_address(chip, true, cs_pins, num_cs_pins);
+	}
+
+	int address = SIGNAL_GROUP_READ_U32(address);
+
+	if (!chip->zero_latency && (cs_changed || address != chip->last_address)) {
+		chip->last_address = address;
+		chip->schedule_timestamp = chip->simulator->current_tick + chip->output_delay;
+		return;
+	}
+
+	chip->last_address = address;
+
+	uint8_t data = chip->data_array[address];
+	if (chip->last_data != data) {
+		SIGNAL_GROUP_WRITE(data, data);
+		chip->last_data = data;
+	}
+}
+
+void chip_63xx_rom_zero_latency(Chip63xxRom *chip, bool zero_latency) {
+	assert(chip);
+	chip->zero_latency = zero_latency;
+}
+
+void chip_63xx_rom_use_image(Chip63xxRom *chip, const RomImage *image) {
+	assert(chip);
+	assert(image);
+
+	if (image->size < chip->data_size) {
+		chip_63xx_rom_private_copy(chip);
+		dms_zero(chip->data_array, chip->data_size);
+		dms_memcpy(chip->data_array, image->data, image->size);
+		rom_image_release(image);
+		return;
+	}
+
+	if (chip->image) {
+		rom_image_release(chip->image);
+	} else {
+		dms_free(chip->data_array);
+	}
+
+	chip->image = image;
+	chip->data_array = (uint8_t *) image->data;
+}
+
+void chip_63xx_rom_private_copy(Chip63xxRom *chip) {
+	assert(chip);
+
+	if (!chip->image) {
+		return;
+	}
+
+	chip->data_array = (uint8_t *) dms_malloc(chip->data_size);
+	dms_memcpy(chip->data_array, chip->image->data, chip->data_size);
+	rom_image_release(chip->image);
+	chip->image = NULL;
+}
+
+static void chip_63xx_rom_destroy(Chip63xxRom *chip) {
+	assert(chip);
+	signal_group_destroy(chip->sg_address);
+	signal_group_destroy(chip->sg_data);
+
+	if (chip->image) {
+		rom_image_release(chip->image);
+	} else {
+		dms_free(chip->data_array);
+	}
+
+	dms_free(chip);
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // 6316 - 2k x 8-bit ROM
@@ -41,17 +156,19 @@ static uint8_t Chip6316Rom_PinTypes[CHIP_63XX_PIN_COUNT] = {
 	[CHIP_6316_D7   ] = CHIP_PIN_OUTPUT,
 };
 
-static void chip_63xx_rom_destroy(Chip63xxRom *chip);
+static const uint32_t Chip6316Rom_CsPins[] = {CHIP_6316_CS1_B, CHIP_6316_CS2_B, CHIP_6316_CS3};
+
 static void chip_6316_rom_process(Chip63xxRom *chip);
 
 Chip63xxRom *chip_6316_rom_create(Simulator *sim, Chip63xxSignals signals) {
 
-	Chip63xxRom *chip = (Chip63xxRom *) dms_calloc(1, sizeof(Chip63xxRom) + ROM_6316_DATA_SIZE);
+	Chip63xxRom *chip = (Chip63xxRom *) dms_calloc(1, sizeof(Chip63xxRom));
 
 	CHIP_SET_FUNCTIONS(chip, chip_6316_rom_process, chip_63xx_rom_destroy);
 	CHIP_SET_VARIABLES(chip, sim, chip->signals, Chip6316Rom_PinTypes, CHIP_63XX_PIN_COUNT);
 	chip->signal_pool = sim->signal_pool;
 	chip->data_size = ROM_6316_DATA_SIZE;
+	chip->data_array = (uint8_t *) dms_calloc(1, ROM_6316_DATA_SIZE);
 	chip->output_delay = simulator_interval_to_tick_count(chip->simulator, NS_TO_PS(60));
 	chip->last_address = -1;
 	chip->last_data = -1;
@@ -88,38 +205,13 @@ Chip63xxRom *chip_6316_rom_create(Simulator *sim, Chip63xxSignals signals) {
 	return chip;
 }
 
-static void chip_63xx_rom_destroy(Chip63xxRom *chip) {
-	assert(chip);
-	signal_group_destroy(chip->sg_address);
-	signal_group_destroy(chip->sg_data);
-	dms_free(chip);
-}
-
 static void chip_6316_rom_process(Chip63xxRom *chip) {
 	assert(chip);
 
-	if (!(ACTLO_ASSERTED(SIGNAL_READ(CS1_B)) && ACTLO_ASSERTED(SIGNAL_READ(CS2_B)) && ACTHI_ASSERTED(SIGNAL_READ(CS3)))) {
-		if (chip->last_data != -1) {
-			SIGNAL_GROUP_NO_WRITE(data);
-			chip->last_data = -1;
-		}
-		return;
-	}
-
-	int address = SIGNAL_GROUP_READ_U32(address);
-
-	if (SIGNAL_CHANGED(CS1_B) || SIGNAL_CHANGED(CS2_B) || SIGNAL_CHANGED(CS3) ||
-		address != chip->last_address) {
-		chip->last_address = address;
-		chip->schedule_timestamp = chip->simulator->current_tick + chip->output_delay;
-		return;
-	}
-
-	uint8_t data = chip->data_array[address];
-	if (chip->last_data != data) {
-		SIGNAL_GROUP_WRITE(data, data);
-		chip->last_data = data;
-	}
+	chip_63xx_rom_process(chip,
+						  ACTLO_ASSERTED(SIGNAL_READ(CS1_B)) && ACTLO_ASSERTED(SIGNAL_READ(CS2_B)) && ACTHI_ASSERTED(SIGNAL_READ(CS3)),
+						  SIGNAL_CHANGED(CS1_B) || SIGNAL_CHANGED(CS2_B) || SIGNAL_CHANGED(CS3),
+						  Chip6316Rom_CsPins, sizeof(Chip6316Rom_CsPins) / sizeof(Chip6316Rom_CsPins[0]));
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -155,17 +247,20 @@ static uint8_t Chip6332Rom_PinTypes[CHIP_63XX_PIN_COUNT] = {
 	[CHIP_6332_D7   ] = CHIP_PIN_OUTPUT,
 };
 
+static const uint32_t Chip6332Rom_CsPins[] = {CHIP_6332_CS1_B, CHIP_6332_CS3};
+
 static void chip_6332_rom_process(Chip63xxRom *chip);
 
 Chip63xxRom *chip_6332_rom_create(Simulator *sim, Chip63xxSignals signals) {
 
-	Chip63xxRom *chip = (Chip63xxRom *) dms_calloc(1, sizeof(Chip63xxRom) + ROM_6332_DATA_SIZE);
+	Chip63xxRom *chip = (Chip63xxRom *) dms_calloc(1, sizeof(Chip63xxRom));
 
 	CHIP_SET_FUNCTIONS(chip, chip_6332_rom_process, chip_63xx_rom_destroy);
 	CHIP_SET_VARIABLES(chip, sim, chip->signals, Chip6332Rom_PinTypes, CHIP_63XX_PIN_COUNT);
 
 	chip->signal_pool = sim->signal_pool;
 	chip->data_size = ROM_6332_DATA_SIZE;
+	chip->data_array = (uint8_t *) dms_calloc(1, ROM_6332_DATA_SIZE);
 	chip->output_delay = simulator_interval_to_tick_count(chip->simulator, NS_TO_PS(60));
 	chip->last_address = -1;
 	chip->last_data = -1;
@@ -205,27 +300,8 @@ Chip63xxRom *chip_6332_rom_create(Simulator *sim, Chip63xxSignals signals) {
 static void chip_6332_rom_process(Chip63xxRom *chip) {
 	assert(chip);
 
-	if (!(ACTLO_ASSERTED(SIGNAL_READ(CS1_B)) && ACTHI_ASSERTED(SIGNAL_READ(CS3)))) {
-		if (chip->last_data != -1) {
-			SIGNAL_GROUP_NO_WRITE(data);
-			chip->last_data = -1;
-		}
-		return;
-	}
-
-	int address = SIGNAL_GROUP_READ_U32(address);
-
-	if (SIGNAL_CHANGED(CS1_B) || SIGNAL_CHANGED(CS3) ||
-		address != chip->last_address) {
-		chip->last_address = address;
-		chip->schedule_timestamp = chip->simulator->current_tick + chip->output_delay;
-		return;
-	}
-
-	uint8_t data = chip->data_array[address];
-	if (chip->last_data != data) {
-		SIGNAL_GROUP_WRITE(data, data);
-		chip->last_data = data;
-	}
+	chip_63xx_rom_process(chip,
+						  ACTLO_ASSERTED(SIGNAL_READ(CS1_B)) && ACTHI_ASSERTED(SIGNAL_READ(CS3)),
+						  SIGNAL_CHANGED(CS1_B) || SIGNAL_CHANGED(CS3),
+						  Chip6332Rom_CsPins, sizeof(Chip6332Rom_CsPins) / sizeof(Chip6332Rom_CsPins[0]));
 }
-
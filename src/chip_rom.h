@@ -92,15 +92,31 @@ typedef struct Chip63xxRom {
 	int64_t		output_delay;
 	int			last_address;
 	int			last_data;
+	bool		zero_latency;			// output the data in the same timestep as the address change
+	bool		deselected;				// the address lines aren't watched while the chip isn't selected
 
 	size_t		data_size;
-	uint8_t		data_array[];
+	uint8_t *	data_array;				// contents: the chip's own copy or a shared image (read-only!)
+	const struct RomImage *image;		// shared image (NULL == data_array is owned by the chip)
 } Chip63xxRom;
 
 // functions
 Chip63xxRom *chip_6316_rom_create(struct Simulator *sim, Chip63xxSignals signals);
 Chip63xxRom *chip_6332_rom_create(struct Simulator *sim, Chip63xxSignals signals);
 
+// chip_63xx_rom_zero_latency: respond to an address change immediately instead of after the access time of the chip
+//	(for devices that don't depend on the exact timing of the data bus)
+void chip_63xx_rom_zero_latency(Chip63xxRom *chip, bool zero_latency);
+
+// chip_63xx_rom_use_image: read the contents of the rom from a shared image instead of the chip's own copy
+//	- the chip takes over the reference to the image and releases it when it's destroyed
+//	- an image that's smaller than the rom is copied instead (the rest of the rom reads zero)
+void chip_63xx_rom_use_image(Chip63xxRom *chip, const struct RomImage *image);
+
+// chip_63xx_rom_private_copy: give the chip its own, writable copy of the contents of its shared image (e.g. to patch it)
+//	- data_array changes
+void chip_63xx_rom_private_copy(Chip63xxRom *chip);
+
 #ifdef __cplusplus
 }
 #endif
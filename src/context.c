@@ -3,62 +3,188 @@
 // main external interface for others to control a Dromaius instance
 // define DMS_NO_THREADING to disable multithreading
 
+/* The user-side (UI thread) and the context-side (simulation thread) don't share any mutable configuration:
+	- every change made by the user is sent to the simulation thread as a message on a single-producer/single-consumer queue
+	- the simulation thread publishes its state, current tick and program counter in a status block protected by a seqlock
+	- breakpoint hit counts are sent back to the user-side on a second queue
+	- external inputs (keys, tapes, disks, reset) are messages too: the simulation thread applies them and stamps them with
+	  the current tick, a recording of these events can be replayed to reproduce a session exactly
+   Neither side ever blocks waiting for the other; the simulation thread only sleeps on a condition variable when it is paused.
+*/
+
 #include "context.h"
 
+#include "sys/atomics.h"
 #include "sys/threads.h"
 #include "crt.h"
 #include "utils.h"
 #include <stb/stb_ds.h>
 
+#include "breakpoint_condition.h"
+#include "bus_watcher.h"
 #include "cpu.h"
 #include "device.h"
+#include "input_event.h"
 #include "stopwatch.h"
 #include "simulator.h"
 
-#define SYNC_MIN_DIFF_PS		MS_TO_PS(20)	/* required skew betweem sim & real-time before sleep */
+#define SYNC_SLICE_INITIAL_PS	US_TO_PS(500)	/* simulated time between two synchronisation points with real-time */
+#define SYNC_SLICE_MIN_PS		US_TO_PS(100)
+#define SYNC_SLICE_MAX_PS		MS_TO_PS(1)
+#define SYNC_JITTER_TARGET_PS	MS_TO_PS(1)		/* frame-to-frame jitter the pacing tries to stay below */
+#define SYNC_MAX_LAG_PS			MS_TO_PS(100)	/* restart the timeline instead of catching up when falling this far behind */
+#define PACING_WINDOW_PS		MS_TO_PS(250)	/* interval at which the pacing statistics are updated */
+#define PC_BREAKPOINT_WORDS		(65536 / 64)	/* one bit for each address in the 16-bit address space */
+#define MESSAGE_QUEUE_SIZE		256				/* number of entries in each message queue (power of two) */
 
 ///////////////////////////////////////////////////////////////////////////////
 //
 // internal types
 //
 
+typedef struct BreakpointOptions {
+	DMS_BREAKPOINT_KIND		kind;
+	int64_t					address;
+	BreakpointCondition *	condition;			// NULL for an unconditional breakpoint
+	int64_t					ignore_until;		// don't pause the simulation until the hit count exceeds this value
+	int64_t					hit_count;			// number of times the breakpoint (and its condition) matched (user-side copy lags behind)
+} BreakpointOptions;
+
+// snapshot of the user-side breakpoint configuration, owned by the simulation thread once it has been sent
+typedef struct BreakpointSet {
+	SignalBreakpoint *		signal_breakpoints;	// dynamic arrays
+	BusWatchpoint *			watchpoints;
+	BreakpointOptions *		bp_options;
+	BreakpointCondition **	bp_retired;			// conditions that are no longer referenced by the user-side (freed by the context)
+	uint64_t				pc_breakpoints[PC_BREAKPOINT_WORDS];
+	uint32_t				pc_breakpoint_count;
+} BreakpointSet;
+
 struct Config {
 	DMS_STATE		state;
 
 	int64_t			target_sim_real_ratio;		// (4 decimal places)
+	bool			auto_warp;					// stop synchronizing with real-time when a peripheral requests it
 
 	SignalBreakpoint	step_signal;			// signal to use for the step-signal feature (normally a clock signal)
-	SignalBreakpoint *	signal_breakpoints;		// dynamic array of signal breakpoints
-	int64_t *			pc_breakpoints;			// dynamic array of program counter breakpoints
-	bool				bp_updated;
+	SignalBreakpoint *	signal_breakpoints;		// dynamic array of signal breakpoints (user-side only)
+	uint64_t			bp_pos_edge[SIGNAL_BLOCKS];		// signal breakpoints compiled into masks (context-side only)
+	uint64_t			bp_neg_edge[SIGNAL_BLOCKS];
+	uint64_t			bp_watch_pos[SIGNAL_BLOCKS];	// bp_pos_edge + start of instruction signal when pc breakpoints are set
+	uint64_t			bp_watch_neg[SIGNAL_BLOCKS];	// bp_neg_edge + bus strobe when memory watchpoints are set
+	int					bp_blocks[SIGNAL_BLOCKS];		// signal blocks that have to be checked
+	int					bp_block_count;
+
+	uint64_t			pc_breakpoints[PC_BREAKPOINT_WORDS];	// bitmap of program counter breakpoints
+	uint32_t			pc_breakpoint_count;
+
+	BusWatchpoint *		watchpoints;			// dynamic array of memory watchpoints (user-side only)
+
+	BreakpointOptions *	bp_options;				// dynamic array with an entry for each pc breakpoint and watchpoint
+	BreakpointCondition **bp_retired;			// conditions no longer in use by the user-side (sent along with the next BreakpointSet)
 };
 
+typedef enum ContextMessageType {
+	// user -> context
+	MSG_CHANGE_STATE = 0,
+	MSG_STEP_SIGNAL,
+	MSG_SIMULATION_SPEED,
+	MSG_AUTO_WARP,
+	MSG_BREAKPOINTS,
+	MSG_INPUT,
+	MSG_INPUT_RECORD,
+	MSG_INPUT_REPLAY,
+
+	// context -> user
+	MSG_BREAKPOINT_HIT
+} ContextMessageType;
+
+typedef struct ContextMessage {
+	ContextMessageType	type;
+	union {
+		DMS_STATE			state;
+		SignalBreakpoint	step_signal;
+		int64_t				target_sim_real_ratio;
+		bool				auto_warp;
+		BreakpointSet *		breakpoints;
+		InputEvent *		input;					// single event, owned by the message
+		InputRecorder *		recorder;				// NULL to stop recording
+		InputEvent *		replay;					// dynamic array of events sorted by tick
+		struct {
+			DMS_BREAKPOINT_KIND	kind;
+			int64_t				address;
+			int64_t				hit_count;
+		} hit;
+	};
+} ContextMessage;
+
+// lock-free ring buffer with exactly one producer and one consumer thread
+typedef struct MessageQueue {
+	ContextMessage	entries[MESSAGE_QUEUE_SIZE];
+	atomic_uint32_t	next_in;					// only written by the producer
+	atomic_uint32_t	first_out;					// only written by the consumer
+} MessageQueue;
+
+typedef struct ContextPacing {
+	int64_t			sleep_granularity_ps;		// measured sleep granularity of the host (-1 = not measured yet)
+	int64_t			slice_ps;					// current simulated time between synchronisation points
+	int64_t			prev_lateness_ps;			// how far real-time was ahead of the simulation at the previous sync point
+	int64_t			window_start_ps;			// host timestamp at the start of the statistics window
+	int64_t			window_start_tick;
+	int64_t			max_jitter_ps;				// worst values in the current window
+	int64_t			max_overshoot_ps;
+	int64_t			sleep_count;				// number of sync points in the window where the simulation was ahead
+} ContextPacing;
+
+typedef struct ContextStatus {
+	DmsStatus		public;
+	DmsPacingStats	pacing;
+	BusWatchHit		watch_hit;					// last memory access that triggered a watchpoint
+	uint32_t		messages_done;				// number of user messages processed by the context
+} ContextStatus;
+
 typedef struct DmsContext {
 	Simulator *		simulator;					// non-owning pointer to the simulator executing the device
 	Device *		device;						// non-owning pointer to the device being simulator
 
 	struct Config	config_usr;					// configuration that is set/changed by the user
 	struct Config	config;						// configuration that is in use by the context
-	bool			config_changed;				// ui-config was changed, context should update config
+
+	MessageQueue	to_context;
+	MessageQueue	to_user;
+
+	// status published by the context: protected by a seqlock (odd while the context is writing)
+	atomic_uint32_t	status_seq;
+	ContextStatus	status;
 
 	// context-side variables
 	Stopwatch *		stopwatch;
 	int64_t			tick_start_run;
 	int64_t			sync_tick_interval;			// sync sim & real-time at this interval
+	ContextPacing	pacing;
+	DmsPacingStats	pacing_stats;
+	Cpu *			cpu;
+	Signal			cpu_sync;					// signal that goes high when the cpu starts a new instruction
+	BusWatcher *	bus_watcher;				// non-owning pointer to the bus watcher of the device (optional)
+	BusWatchHit		watch_hit;
+	uint32_t		messages_done;
+	InputRecorder *	input_recorder;				// records the applied input events (optional)
+	InputEvent *	input_replay;				// dynamic array of recorded events that are being replayed
+	size_t			input_replay_next;
+	int64_t			input_next_tick;			// tick of the next event to replay (INT64_MAX when not replaying)
 
 #ifndef DMS_NO_THREADING
 	thread_t		thread;
-	mutex_t			mtx_wait;
+	mutex_t			mtx_wait;					// only used to sleep/wake the paused context, never held while simulating
 	cond_t			cnd_wait;
-
-	mutex_t			mtx_config;
 #endif // DMS_NO_THREADING
 
 	// user-side variables
 	bool			usr_break_irq;
-
-	// feedback variables (context -> user): protect with config-mutex
-	int64_t			actual_sim_real_ratio;		// (4 decimal places)
+	bool			usr_thread_running;			// false: the user-side thread executes the simulation itself
+	uint32_t		usr_messages_sent;
+	uint32_t		usr_state_msg;				// sequence number of the last state change that was sent
+	DMS_STATE		usr_state;					// state that was requested by the last state change
 
 } DmsContext;
 
@@ -70,23 +196,58 @@ typedef struct DmsContext {
 #ifndef DMS_NO_THREADING
 	#define MUTEX_LOCK(dms)				mutex_lock(&(dms)->mtx_wait)
 	#define MUTEX_UNLOCK(dms)			mutex_unlock(&(dms)->mtx_wait)
-	#define MUTEX_CONFIG_LOCK(dms)		mutex_lock(&(dms)->mtx_config)
-	#define MUTEX_CONFIG_UNLOCK(dms)	mutex_unlock(&(dms)->mtx_config)
 #else
 	#define MUTEX_LOCK(dms)
 	#define MUTEX_UNLOCK(dms)
-	#define MUTEX_CONFIG_LOCK(dms)
-	#define MUTEX_CONFIG_UNLOCK(dms)
 #endif
 
-static inline int breakpoint_index(DmsContext *dms, int64_t addr) {
-	for (int i = 0; i < arrlen(dms->config.pc_breakpoints); ++i) {
-		if (dms->config.pc_breakpoints[i] == addr) {
-			return i;
-		}
+static inline bool message_queue_push(MessageQueue *queue, ContextMessage *msg) {
+	// only called by the producer thread
+	uint32_t next_in = atomic_load_uint32_relaxed(&queue->next_in);
+	uint32_t next = (next_in + 1) & (MESSAGE_QUEUE_SIZE - 1);
+
+	// don't let next_in 'catch up' with first_out
+	if (next == atomic_load_uint32(&queue->first_out)) {
+		return false;
 	}
 
-	return -1;
+	queue->entries[next_in] = *msg;
+	atomic_exchange_uint32(&queue->next_in, next);
+	return true;
+}
+
+static inline bool message_queue_pop(MessageQueue *queue, ContextMessage *msg) {
+	// only called by the consumer thread
+	uint32_t first_out = atomic_load_uint32_relaxed(&queue->first_out);
+
+	if (first_out == atomic_load_uint32(&queue->next_in)) {
+		return false;
+	}
+
+	*msg = queue->entries[first_out];
+	atomic_exchange_uint32(&queue->first_out, (first_out + 1) & (MESSAGE_QUEUE_SIZE - 1));
+	return true;
+}
+
+static inline bool message_queue_empty(MessageQueue *queue) {
+	return atomic_load_uint32(&queue->first_out) == atomic_load_uint32(&queue->next_in);
+}
+
+static void breakpoint_set_destroy(BreakpointSet *set) {
+	// the conditions of the options are owned by the user-side, only the retired conditions belong to the set
+	for (size_t i = 0; i < arrlenu(set->bp_retired); ++i) {
+		breakpoint_condition_destroy(set->bp_retired[i]);
+	}
+
+	arrfree(set->signal_breakpoints);
+	arrfree(set->watchpoints);
+	arrfree(set->bp_options);
+	arrfree(set->bp_retired);
+	dms_free(set);
+}
+
+static inline bool pc_breakpoint_is_set(struct Config *config, int64_t addr) {
+	return (config->pc_breakpoints[(addr >> 6) & (PC_BREAKPOINT_WORDS - 1)] >> (addr & 63)) & 1;
 }
 
 static inline int signal_breakpoint_index(DmsContext *dms, Signal signal) {
@@ -109,86 +270,370 @@ static inline bool signal_breakpoint_check(DmsContext *dms, SignalBreakpoint *bp
 	return ((!value && bp->neg_edge) || (value && bp->pos_edge));
 }
 
-static inline bool signal_breakpoint_triggered(DmsContext *dms) {
-	for (int i = 0; i < arrlen(dms->config.signal_breakpoints); ++i) {
-		if (signal_breakpoint_check(dms, &dms->config.signal_breakpoints[i])) {
+static inline int breakpoint_options_index(BreakpointOptions *options, DMS_BREAKPOINT_KIND kind, int64_t addr) {
+	for (int i = 0; i < arrlen(options); ++i) {
+		if (options[i].kind == kind && options[i].address == addr) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// context-side functions
+//
+
+static void context_publish_status(DmsContext *dms) {
+	uint32_t seq = atomic_load_uint32_relaxed(&dms->status_seq);
+
+	atomic_store_uint32_relaxed(&dms->status_seq, seq + 1);
+	atomic_fence_release();
+
+	dms->status = (ContextStatus) {
+		.public = {
+			.state = dms->config.state,
+			.current_tick = (dms->simulator) ? dms->simulator->current_tick : 0,
+			.program_counter = (dms->cpu) ? dms->cpu->program_counter(dms->cpu) : 0,
+			.warp = (dms->simulator) ? dms->simulator->warp_active : false
+		},
+		.pacing = dms->pacing_stats,
+		.watch_hit = dms->watch_hit,
+		.messages_done = dms->messages_done
+	};
+
+	atomic_fence_release();
+	atomic_store_uint32_relaxed(&dms->status_seq, seq + 2);
+}
+
+static bool breakpoint_options_triggered(DmsContext *dms, Cpu *cpu, DMS_BREAKPOINT_KIND kind, int64_t addr) {
+	// the base breakpoint matched: evaluate the condition and the ignore count
+	int idx = breakpoint_options_index(dms->config.bp_options, kind, addr);
+	if (idx < 0) {
+		return true;
+	}
+
+	BreakpointOptions *opt = &dms->config.bp_options[idx];
+	if (opt->condition && !breakpoint_condition_evaluate(opt->condition, cpu, dms->device, dms->simulator->signal_pool)) {
+		return false;
+	}
+
+	opt->hit_count += 1;
+
+	// report the new hit count to the user-side, dropped when the user-side isn't keeping up (the next hit corrects it)
+	ContextMessage msg = {.type = MSG_BREAKPOINT_HIT, .hit = {kind, addr, opt->hit_count}};
+	message_queue_push(&dms->to_user, &msg);
+
+	return opt->hit_count > opt->ignore_until;
+}
+
+static bool breakpoint_hit(DmsContext *dms, Cpu *cpu, int blk, uint64_t hit) {
+	// a signal in a watched block changed: determine if it was caused by a signal breakpoint, the start of a new instruction or the end of a bus cycle
+	uint64_t *signals_value = dms->simulator->signal_pool->signals_value;
+	uint64_t value = signals_value[blk];
+
+	if (hit & ((value & dms->config.bp_pos_edge[blk]) | (~value & dms->config.bp_neg_edge[blk]))) {
+		return true;
+	}
+
+	if (blk == dms->cpu_sync.block && (hit & (1ull << dms->cpu_sync.index))) {
+		int64_t pc = cpu->program_counter(cpu);
+		if (pc_breakpoint_is_set(&dms->config, pc) && breakpoint_options_triggered(dms, cpu, DMS_BREAKPOINT_PC, pc)) {
 			return true;
 		}
 	}
 
+	if (dms->bus_watcher && blk == dms->bus_watcher->strobe.block && (hit & (1ull << dms->bus_watcher->strobe.index)) &&
+		bus_watcher_process(dms->bus_watcher, dms->simulator->current_tick, signals_value) &&
+		breakpoint_options_triggered(dms, cpu, DMS_BREAKPOINT_WATCH, dms->bus_watcher->last_hit.address)) {
+		dms->watch_hit = dms->bus_watcher->last_hit;
+		return true;
+	}
+
 	return false;
 }
 
+static inline void compile_breakpoints(DmsContext *dms, SignalBreakpoint *breakpoints) {
+	struct Config *config = &dms->config;
+
+	dms_zero(config->bp_pos_edge, sizeof(config->bp_pos_edge));
+	dms_zero(config->bp_neg_edge, sizeof(config->bp_neg_edge));
+
+	for (size_t i = 0; i < arrlenu(breakpoints); ++i) {
+		uint64_t mask = 1ull << breakpoints[i].signal.index;
+		FLAG_SET_CLEAR_U64(config->bp_pos_edge[breakpoints[i].signal.block], mask, breakpoints[i].pos_edge);
+		FLAG_SET_CLEAR_U64(config->bp_neg_edge[breakpoints[i].signal.block], mask, breakpoints[i].neg_edge);
+	}
+
+	// the program counter only has to be checked when the cpu starts a new instruction
+	dms_memcpy(config->bp_watch_pos, config->bp_pos_edge, sizeof(config->bp_pos_edge));
+	if (config->pc_breakpoint_count > 0) {
+		config->bp_watch_pos[dms->cpu_sync.block] |= 1ull << dms->cpu_sync.index;
+	}
+
+	// memory accesses only have to be checked at the end of a bus cycle
+	dms_memcpy(config->bp_watch_neg, config->bp_neg_edge, sizeof(config->bp_neg_edge));
+	if (dms->bus_watcher && dms->bus_watcher->watch_count > 0) {
+		config->bp_watch_neg[dms->bus_watcher->strobe.block] |= 1ull << dms->bus_watcher->strobe.index;
+	}
+
+	config->bp_block_count = 0;
+	for (int blk = 0; blk < SIGNAL_BLOCKS; ++blk) {
+		if (config->bp_watch_pos[blk] | config->bp_watch_neg[blk]) {
+			config->bp_blocks[config->bp_block_count++] = blk;
+		}
+	}
+}
+
+static inline void update_breakpoint_options(DmsContext *dms, BreakpointSet *set) {
+	// take over the user-side options but keep the hit counts
+	BreakpointOptions *old_options = dms->config.bp_options;
+	dms->config.bp_options = set->bp_options;
+	set->bp_options = NULL;
+
+	for (size_t i = 0; i < arrlenu(dms->config.bp_options); ++i) {
+		BreakpointOptions *opt = &dms->config.bp_options[i];
+		int old_idx = breakpoint_options_index(old_options, opt->kind, opt->address);
+		opt->hit_count = (old_idx >= 0) ? old_options[old_idx].hit_count : 0;
+	}
+
+	arrfree(old_options);
+}
+
+static inline void context_install_breakpoints(DmsContext *dms, BreakpointSet *set) {
+	dms_memcpy(dms->config.pc_breakpoints, set->pc_breakpoints, sizeof(dms->config.pc_breakpoints));
+	dms->config.pc_breakpoint_count = set->pc_breakpoint_count;
+
+	if (dms->bus_watcher) {
+		bus_watcher_clear(dms->bus_watcher);
+		for (size_t i = 0; i < arrlenu(set->watchpoints); ++i) {
+			bus_watcher_set(dms->bus_watcher, set->watchpoints[i]);
+		}
+	}
+
+	compile_breakpoints(dms, set->signal_breakpoints);
+	update_breakpoint_options(dms, set);
+
+	// the context doesn't reference the retired conditions anymore
+	breakpoint_set_destroy(set);
+}
+
+static inline void pacing_restart(DmsContext *dms) {
+	// start a new timeline at the current tick
+	stopwatch_stop(dms->stopwatch);
+	stopwatch_start(dms->stopwatch);
+	dms->tick_start_run = dms->simulator->current_tick;
+
+	dms->pacing.prev_lateness_ps = 0;
+	dms->pacing.window_start_ps = stopwatch_timestamp_ps();
+	dms->pacing.window_start_tick = dms->simulator->current_tick;
+	dms->pacing.max_jitter_ps = 0;
+	dms->pacing.max_overshoot_ps = 0;
+	dms->pacing.sleep_count = 0;
+}
+
+static inline void pacing_set_slice(DmsContext *dms, int64_t slice_ps) {
+	dms->pacing.slice_ps = slice_ps;
+	dms->sync_tick_interval = simulator_interval_to_tick_count(dms->simulator, slice_ps);
+	dms->pacing_stats.slice_ps = slice_ps;
+}
+
+static inline void pacing_end_window(DmsContext *dms, int64_t now_ps) {
+	ContextPacing *pacing = &dms->pacing;
+
+	int64_t sim_ps = (dms->simulator->current_tick - pacing->window_start_tick) * dms->simulator->tick_duration_ps;
+	dms->pacing_stats.speed_ratio = (double) sim_ps / (double) (now_ps - pacing->window_start_ps);
+	dms->pacing_stats.jitter_ps = pacing->max_jitter_ps;
+	dms->pacing_stats.overshoot_ps = pacing->max_overshoot_ps;
+
+	// shorter slices when the jitter is too high, longer slices (less synchronisation overhead) when there's room to spare
+	// or when the simulation can't keep up with real-time anyway
+	if (pacing->sleep_count == 0) {
+		pacing_set_slice(dms, MIN(pacing->slice_ps * 5 / 4, SYNC_SLICE_MAX_PS));
+	} else if (pacing->max_jitter_ps > SYNC_JITTER_TARGET_PS / 2) {
+		pacing_set_slice(dms, MAX(pacing->slice_ps * 3 / 4, SYNC_SLICE_MIN_PS));
+	} else if (pacing->max_jitter_ps < SYNC_JITTER_TARGET_PS / 4) {
+		pacing_set_slice(dms, MIN(pacing->slice_ps * 5 / 4, SYNC_SLICE_MAX_PS));
+	}
+
+	pacing->window_start_ps = now_ps;
+	pacing->window_start_tick = dms->simulator->current_tick;
+	pacing->max_jitter_ps = 0;
+	pacing->max_overshoot_ps = 0;
+	pacing->sleep_count = 0;
+}
+
 static inline void sync_simulation_with_real_time(DmsContext *dms) {
 	// sync simulation time with realtime
 	if (dms->config.state != DS_RUN) {
 		return;
 	}
 
-	int64_t real_ps = stopwatch_time_elapsed_ps(dms->stopwatch);
+	ContextPacing *pacing = &dms->pacing;
+
+	if (pacing->sleep_granularity_ps < 0) {
+		pacing->sleep_granularity_ps = stopwatch_sleep_granularity_ps();
+		dms->pacing_stats.sleep_granularity_ps = pacing->sleep_granularity_ps;
+	}
+
+	// peripherals request warp mode while transferring data: run as fast as possible
+	bool warp = dms->config.auto_warp && dms->simulator->warp_requests != 0;
+	if (warp != dms->simulator->warp_active) {
+		// start a new timeline, the simulation shouldn't slow down afterwards to make up for the time spent in warp mode
+		dms->simulator->warp_active = warp;
+		pacing_restart(dms);
+		context_publish_status(dms);
+	}
+
+	// real-time at which the simulation should reach the current tick
 	int64_t sim_ps  = (dms->simulator->current_tick - dms->tick_start_run) * dms->simulator->tick_duration_ps;
+	int64_t deadline_ps = (sim_ps * 10000) / dms->config.target_sim_real_ratio;
+	int64_t real_ps = stopwatch_time_elapsed_ps(dms->stopwatch);
+	int64_t lateness_ps = 0;
+
+	if (!warp) {
+		// sleep to within the granularity of the host and spin the rest of the way
+		//	- spinning for more than half a slice would keep the thread busy most of the time: hosts with a coarser
+		//	  granularity only sleep and rely on the pacing to absorb the overshoot
+		if (deadline_ps > real_ps) {
+			int64_t slice_real_ps = (pacing->slice_ps * 10000) / dms->config.target_sim_real_ratio;
+			if (pacing->sleep_granularity_ps <= slice_real_ps / 2) {
+				stopwatch_sleep_precise(deadline_ps - real_ps, pacing->sleep_granularity_ps);
+			} else {
+				stopwatch_sleep(deadline_ps - real_ps);
+			}
+			real_ps = stopwatch_time_elapsed_ps(dms->stopwatch);
+			pacing->max_overshoot_ps = MAX(pacing->max_overshoot_ps, real_ps - deadline_ps);
+			pacing->sleep_count += 1;
+		}
 
-	MUTEX_CONFIG_LOCK(dms);
-	dms->actual_sim_real_ratio = (sim_ps * 10000) / real_ps;
-	MUTEX_CONFIG_UNLOCK(dms);
+		lateness_ps = real_ps - deadline_ps;
+		int64_t jitter_ps = lateness_ps - pacing->prev_lateness_ps;
+		pacing->max_jitter_ps = MAX(pacing->max_jitter_ps, (jitter_ps >= 0) ? jitter_ps : -jitter_ps);
+		pacing->prev_lateness_ps = lateness_ps;
+	}
 
-	int64_t delta = ((sim_ps * 10000) / dms->config.target_sim_real_ratio) - real_ps;
+	int64_t now_ps = stopwatch_timestamp_ps();
+	if (now_ps - pacing->window_start_ps >= PACING_WINDOW_PS) {
+		pacing_end_window(dms, now_ps);
+		context_publish_status(dms);
+	}
 
-	if (delta > SYNC_MIN_DIFF_PS) {
-		stopwatch_sleep(delta);
+	// don't run at full speed to catch up when the simulation can't keep up
+	if (lateness_ps > SYNC_MAX_LAG_PS) {
+		pacing_restart(dms);
 	}
 }
 
-static inline void context_change_state(DmsContext *dms, DMS_STATE new_state) {
-	MUTEX_CONFIG_LOCK(dms);
-	dms->config.state = new_state;
-	dms->config_usr.state = new_state;
-	MUTEX_CONFIG_UNLOCK(dms);
+static void context_apply_input(DmsContext *dms, InputEvent *event) {
+	event->tick = dms->simulator->current_tick;
+	input_event_apply(event, dms->device);
+
+	if (dms->input_recorder) {
+		input_recorder_write(dms->input_recorder, event);
+	}
 }
 
-static inline void context_update_config(DmsContext *dms) {
-	bool reset_stopwatch = false;
+static void context_replay_input(DmsContext *dms) {
+	// apply the recorded events that are due
+	size_t count = arrlenu(dms->input_replay);
 
-	MUTEX_CONFIG_LOCK(dms);
-	if (dms->config_changed) {
-		reset_stopwatch = dms->config.target_sim_real_ratio != dms->config_usr.target_sim_real_ratio;
+	while (dms->input_replay_next < count && dms->input_replay[dms->input_replay_next].tick <= dms->simulator->current_tick) {
+		context_apply_input(dms, &dms->input_replay[dms->input_replay_next++]);
+	}
 
-		dms->config.state = dms->config_usr.state;
-		dms->config.target_sim_real_ratio = dms->config_usr.target_sim_real_ratio;
-		dms->config.step_signal = dms->config_usr.step_signal;
+	if (dms->input_replay_next < count) {
+		dms->input_next_tick = dms->input_replay[dms->input_replay_next].tick;
+	} else {
+		input_recording_release(dms->input_replay);
+		dms->input_replay = NULL;
+		dms->input_replay_next = 0;
+		dms->input_next_tick = INT64_MAX;
+	}
+}
 
-		if (dms->config_usr.bp_updated) {
-			size_t len = arrlenu(dms->config_usr.signal_breakpoints);
-			arrsetlen(dms->config.signal_breakpoints, len);
-			dms_memcpy(dms->config.signal_breakpoints, dms->config_usr.signal_breakpoints, sizeof(SignalBreakpoint) * len);
+static inline void context_input_due(DmsContext *dms) {
+	// checked before each simulation step: replayed events take effect at the same point as during the recording
+	if (dms->simulator->current_tick >= dms->input_next_tick) {
+		context_replay_input(dms);
+	}
+}
+
+static inline void context_change_state(DmsContext *dms, DMS_STATE new_state) {
+	dms->config.state = new_state;
+	context_publish_status(dms);
+}
 
-			len = arrlenu(dms->config_usr.pc_breakpoints);
-			arrsetlen(dms->config.pc_breakpoints, len);
-			dms_memcpy(dms->config.pc_breakpoints, dms->config_usr.pc_breakpoints, sizeof(int64_t) * len);
+static void context_process_messages(DmsContext *dms) {
+	ContextMessage msg;
+	bool processed = false;
 
-			dms->config_usr.bp_updated = false;
+	while (message_queue_pop(&dms->to_context, &msg)) {
+		switch (msg.type) {
+			case MSG_CHANGE_STATE:
+				dms->config.state = msg.state;
+				break;
+			case MSG_STEP_SIGNAL:
+				dms->config.step_signal = msg.step_signal;
+				dms->config.state = DS_STEP_SIGNAL;
+				break;
+			case MSG_SIMULATION_SPEED:
+				if (msg.target_sim_real_ratio != dms->config.target_sim_real_ratio && dms->stopwatch->running) {
+					pacing_restart(dms);
+				}
+				dms->config.target_sim_real_ratio = msg.target_sim_real_ratio;
+				break;
+			case MSG_AUTO_WARP:
+				dms->config.auto_warp = msg.auto_warp;
+				break;
+			case MSG_BREAKPOINTS:
+				context_install_breakpoints(dms, msg.breakpoints);
+				break;
+			case MSG_INPUT:
+				context_apply_input(dms, msg.input);
+				input_event_release(msg.input);
+				dms_free(msg.input);
+				break;
+			case MSG_INPUT_RECORD:
+				if (dms->input_recorder) {
+					input_recorder_close(dms->input_recorder);
+				}
+				dms->input_recorder = msg.recorder;
+				break;
+			case MSG_INPUT_REPLAY:
+				input_recording_release(dms->input_replay);
+				dms->input_replay = msg.replay;
+				dms->input_replay_next = 0;
+				context_replay_input(dms);
+				break;
+			case MSG_BREAKPOINT_HIT:
+				assert(false);
+				break;
 		}
 
-		dms->config_changed = false;
+		dms->messages_done += 1;
+		processed = true;
 	}
-	MUTEX_CONFIG_UNLOCK(dms);
 
-	if (reset_stopwatch && dms->stopwatch->running) {
-		stopwatch_stop(dms->stopwatch);
-		stopwatch_start(dms->stopwatch);
-		dms->tick_start_run = dms->simulator->current_tick;
+	if (processed) {
+		context_publish_status(dms);
 	}
 }
 
 static inline bool context_check_breakpoints(DmsContext *dms, Cpu *cpu) {
 
-	if (signal_breakpoint_triggered(dms)) {
-		return true;
-	}
+	// check all breakpoints in one pass over the changed signals
+	SignalPool *pool = dms->simulator->signal_pool;
 
-	if (breakpoint_index(dms, cpu->program_counter(cpu)) >= 0 &&
-		cpu->is_at_start_of_instruction(cpu)) {
-		return true;
+	for (int i = 0; i < dms->config.bp_block_count; ++i) {
+		int blk = dms->config.bp_blocks[i];
+		uint64_t value = pool->signals_value[blk];
+		uint64_t hit = pool->signals_changed[blk] & ((value & dms->config.bp_watch_pos[blk]) | (~value & dms->config.bp_watch_neg[blk]));
+
+		if (hit && breakpoint_hit(dms, cpu, blk, hit)) {
+			return true;
+		}
 	}
 
 	return false;
@@ -196,18 +641,18 @@ static inline bool context_check_breakpoints(DmsContext *dms, Cpu *cpu) {
 
 static bool context_execute(DmsContext *dms) {
 
-	Cpu *cpu = dms->device->get_cpu(dms->device);
+	Cpu *cpu = dms->cpu;
 	int64_t tick_max = dms->simulator->current_tick + dms->sync_tick_interval;
 
 	while (dms->config.state != DS_WAIT && dms->simulator->current_tick < tick_max) {
 
 		// start stopwatch if not already activated
 		if (dms->config.state == DS_RUN && !dms->stopwatch->running) {
-			stopwatch_start(dms->stopwatch);
-			dms->tick_start_run = dms->simulator->current_tick;
+			pacing_restart(dms);
 		}
 
 		// process the device
+		context_input_due(dms);
 		dms->device->process(dms->device);
 
 		switch (dms->config.state) {
@@ -234,9 +679,12 @@ static bool context_execute(DmsContext *dms) {
 
 	if (dms->config.state == DS_WAIT) {
 		stopwatch_stop(dms->stopwatch);
-		dms->actual_sim_real_ratio = 0;
+		dms->pacing_stats.speed_ratio = 0.0;
+		dms->simulator->warp_active = false;
 	}
 
+	context_publish_status(dms);
+
 	return true;
 }
 
@@ -248,19 +696,21 @@ static int context_background_thread(DmsContext *dms) {
 
 	while (keep_running) {
 
-		mutex_lock(&dms->mtx_wait);
-
 		// wait until execution is requested
-		context_update_config(dms);
+		context_process_messages(dms);
+
 		while (dms->config.state == DS_WAIT) {
-			cond_wait(&dms->cnd_wait, &dms->mtx_wait);
-			context_update_config(dms);
+			mutex_lock(&dms->mtx_wait);
+			while (message_queue_empty(&dms->to_context)) {
+				cond_wait(&dms->cnd_wait, &dms->mtx_wait);
+			}
+			mutex_unlock(&dms->mtx_wait);
+
+			context_process_messages(dms);
 		}
 
 		keep_running = context_execute(dms);
 
-		mutex_unlock(&dms->mtx_wait);
-
 		sync_simulation_with_real_time(dms);
 	}
 
@@ -269,17 +719,95 @@ static int context_background_thread(DmsContext *dms) {
 
 #endif // DMS_NO_THREADING
 
-static inline void change_state(DmsContext *context, DMS_STATE new_state) {
+///////////////////////////////////////////////////////////////////////////////
+//
+// user-side functions
+//
+
+static ContextStatus context_read_status(DmsContext *dms) {
+	ContextStatus result;
+	uint32_t seq;
+
+	do {
+		// the context only holds the sequence odd while copying the status block
+		while ((seq = atomic_load_uint32_relaxed(&dms->status_seq)) & 1);
+		atomic_fence_acquire();
+
+		result = dms->status;
+
+		atomic_fence_acquire();
+	} while (atomic_load_uint32_relaxed(&dms->status_seq) != seq);
+
+	return result;
+}
+
+static void context_send_message(DmsContext *dms, ContextMessage msg) {
+
+	while (!message_queue_push(&dms->to_context, &msg)) {
+		if (!dms->usr_thread_running) {
+			// the simulation runs on this thread: apply the pending messages now
+			context_process_messages(dms);
+		}
+	}
+
+	dms->usr_messages_sent += 1;
+
+	if (!dms->usr_thread_running) {
+		context_process_messages(dms);
+	}
 
-	MUTEX_CONFIG_LOCK(context);
-	context->config_usr.state = new_state;
-	context->config_changed = true;
-	MUTEX_CONFIG_UNLOCK(context);
 	#ifndef DMS_NO_THREADING
-		cond_signal(&context->cnd_wait);
+		// wake the context if it's paused
+		MUTEX_LOCK(dms);
+		cond_signal(&dms->cnd_wait);
+		MUTEX_UNLOCK(dms);
 	#endif // DMS_NO_THREADING
 }
 
+static inline void change_state(DmsContext *dms, ContextMessage msg) {
+	context_send_message(dms, msg);
+
+	dms->usr_state = (msg.type == MSG_STEP_SIGNAL) ? DS_STEP_SIGNAL : msg.state;
+	dms->usr_state_msg = dms->usr_messages_sent;
+}
+
+static void context_process_notifications(DmsContext *dms) {
+	ContextMessage msg;
+
+	while (message_queue_pop(&dms->to_user, &msg)) {
+		assert(msg.type == MSG_BREAKPOINT_HIT);
+
+		int idx = breakpoint_options_index(dms->config_usr.bp_options, msg.hit.kind, msg.hit.address);
+		if (idx >= 0) {
+			dms->config_usr.bp_options[idx].hit_count = msg.hit.hit_count;
+		}
+	}
+}
+
+static void context_send_breakpoints(DmsContext *dms) {
+	// send a copy of the breakpoint configuration to the context
+	struct Config *usr = &dms->config_usr;
+	BreakpointSet *set = (BreakpointSet *) dms_calloc(1, sizeof(BreakpointSet));
+
+	dms_memcpy(set->pc_breakpoints, usr->pc_breakpoints, sizeof(set->pc_breakpoints));
+	set->pc_breakpoint_count = usr->pc_breakpoint_count;
+
+	for (size_t i = 0; i < arrlenu(usr->signal_breakpoints); ++i) {
+		arrpush(set->signal_breakpoints, usr->signal_breakpoints[i]);
+	}
+	for (size_t i = 0; i < arrlenu(usr->watchpoints); ++i) {
+		arrpush(set->watchpoints, usr->watchpoints[i]);
+	}
+	for (size_t i = 0; i < arrlenu(usr->bp_options); ++i) {
+		arrpush(set->bp_options, usr->bp_options[i]);
+	}
+
+	set->bp_retired = usr->bp_retired;
+	usr->bp_retired = NULL;
+
+	context_send_message(dms, (ContextMessage) {.type = MSG_BREAKPOINTS, .breakpoints = set});
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // interface functions
@@ -290,18 +818,24 @@ DmsContext *dms_create_context() {
 	ctx->simulator = NULL;
 	ctx->device = NULL;
 	ctx->usr_break_irq = false;
+	ctx->usr_thread_running = false;
 	ctx->stopwatch = stopwatch_create();
+	ctx->pacing.sleep_granularity_ps = -1;
 
 	ctx->config.state = DS_WAIT;
 	ctx->config.target_sim_real_ratio = 10000;
-	ctx->config.pc_breakpoints = NULL;
+	ctx->config.auto_warp = true;
 	ctx->config.signal_breakpoints = NULL;
-	ctx->config.bp_updated = false;
+	ctx->config.watchpoints = NULL;
+	ctx->watch_hit.address = -1;
+	ctx->input_next_tick = INT64_MAX;
 	dms_memcpy(&ctx->config_usr, &ctx->config, sizeof(ctx->config));
 
+	ctx->usr_state = DS_WAIT;
+	context_publish_status(ctx);
+
 #ifndef DMS_NO_THREADING
 	mutex_init_plain(&ctx->mtx_wait);
-	mutex_init_plain(&ctx->mtx_config);
 	cond_init(&ctx->cnd_wait);
 #endif
 
@@ -311,6 +845,42 @@ DmsContext *dms_create_context() {
 void dms_release_context(DmsContext *dms) {
 	assert(dms);
 	stopwatch_destroy(dms->stopwatch);
+
+	// messages that never reached the context
+	ContextMessage msg;
+	while (message_queue_pop(&dms->to_context, &msg)) {
+		if (msg.type == MSG_BREAKPOINTS) {
+			breakpoint_set_destroy(msg.breakpoints);
+		} else if (msg.type == MSG_INPUT) {
+			input_event_release(msg.input);
+			dms_free(msg.input);
+		} else if (msg.type == MSG_INPUT_RECORD && msg.recorder) {
+			input_recorder_close(msg.recorder);
+		} else if (msg.type == MSG_INPUT_REPLAY) {
+			input_recording_release(msg.replay);
+		}
+	}
+
+	if (dms->input_recorder) {
+		input_recorder_close(dms->input_recorder);
+	}
+	input_recording_release(dms->input_replay);
+
+	arrfree(dms->config_usr.signal_breakpoints);
+	arrfree(dms->config_usr.watchpoints);
+
+	for (size_t i = 0; i < arrlenu(dms->config_usr.bp_options); ++i) {
+		if (dms->config_usr.bp_options[i].condition) {
+			breakpoint_condition_destroy(dms->config_usr.bp_options[i].condition);
+		}
+	}
+	for (size_t i = 0; i < arrlenu(dms->config_usr.bp_retired); ++i) {
+		breakpoint_condition_destroy(dms->config_usr.bp_retired[i]);
+	}
+	arrfree(dms->config_usr.bp_options);
+	arrfree(dms->config_usr.bp_retired);
+	arrfree(dms->config.bp_options);
+
 	dms_free(dms);
 }
 
@@ -319,7 +889,14 @@ void dms_set_device(DmsContext *dms, Device *device) {
 	dms->device = device;
 	dms->simulator = device->simulator;
 
-	dms->sync_tick_interval = simulator_interval_to_tick_count(dms->simulator, US_TO_PS(500));
+	dms->cpu = device->get_cpu(device);
+	dms->cpu_sync = dms->cpu->instruction_start_signal(dms->cpu);
+	dms->bus_watcher = device->bus_watcher;
+
+	pacing_set_slice(dms, SYNC_SLICE_INITIAL_PS);
+
+	// recompile the breakpoints for the new cpu
+	context_send_breakpoints(dms);
 }
 
 struct Device *dms_get_device(struct DmsContext *dms) {
@@ -328,10 +905,24 @@ struct Device *dms_get_device(struct DmsContext *dms) {
 }
 
 DMS_STATE dms_get_state(DmsContext *dms) {
-	MUTEX_CONFIG_LOCK(dms);
-		DMS_STATE result = dms->config_usr.state;
-	MUTEX_CONFIG_UNLOCK(dms);
-	return result;
+	assert(dms);
+
+	context_process_notifications(dms);
+	ContextStatus status = context_read_status(dms);
+
+	// report the requested state until the context has processed the request
+	if ((int32_t) (status.messages_done - dms->usr_state_msg) < 0) {
+		return dms->usr_state;
+	}
+
+	return status.public.state;
+}
+
+DmsStatus dms_get_status(DmsContext *dms) {
+	assert(dms);
+
+	ContextStatus status = context_read_status(dms);
+	return status.public;
 }
 
 #ifndef DMS_NO_THREADING
@@ -341,24 +932,29 @@ void dms_start_execution(DmsContext *dms) {
 	assert(dms->device);
 
 	// initialize context configuration
+	context_process_messages(dms);
 	dms->config.state = DS_WAIT;
-	dms_memcpy(&dms->config_usr, &dms->config, sizeof(dms->config));
+	dms->usr_state = DS_WAIT;
+	context_publish_status(dms);
 
+	dms->usr_thread_running = true;
 	thread_create_joinable(&dms->thread, (thread_func_t) context_background_thread, dms);
 }
 
 void dms_stop_execution(DmsContext *dms) {
 	assert(dms);
 
-	change_state(dms, DS_EXIT);
+	change_state(dms, (ContextMessage) {.type = MSG_CHANGE_STATE, .state = DS_EXIT});
 
 	int thread_res;
 	thread_join(dms->thread, &thread_res);
+	dms->usr_thread_running = false;
 }
 
 #else
 
 void dms_execute(DmsContext *dms) {
+	context_process_messages(dms);
 	context_execute(dms);
 	sync_simulation_with_real_time(dms);
 }
@@ -366,29 +962,144 @@ void dms_execute(DmsContext *dms) {
 #endif // DMS_NO_THREADING
 
 void dms_execute_no_sync(DmsContext *dms) {
+	assert(!dms->usr_thread_running);
+
+	context_process_messages(dms);
 	dms->config.state = DS_RUN;
-	dms->config_usr.state = DS_RUN;
+	dms->usr_state = DS_RUN;
 	context_execute(dms);
 }
 
+static inline bool context_run_prepare(DmsContext *dms, int64_t max_ticks, int64_t *tick_end) {
+	// the synchronous run functions execute the simulation on the calling thread
+	if (dms->usr_thread_running) {
+		return false;
+	}
+
+	context_process_messages(dms);
+
+	*tick_end = (max_ticks > 0) ? dms->simulator->current_tick + max_ticks : INT64_MAX;
+	return true;
+}
+
+static inline DMS_STOP_REASON context_run_finish(DmsContext *dms, DMS_STOP_REASON reason) {
+	context_publish_status(dms);
+	return reason;
+}
+
+DMS_STOP_REASON dms_run_for_ticks(DmsContext *dms, int64_t ticks) {
+	assert(dms);
+
+	int64_t tick_end;
+	if (!context_run_prepare(dms, ticks, &tick_end)) {
+		return DMS_STOP_BUSY;
+	}
+
+	Simulator *sim = dms->simulator;
+	Device *device = dms->device;
+
+	while (sim->current_tick < tick_end) {
+		context_input_due(dms);
+		device->process(device);
+	}
+
+	return context_run_finish(dms, DMS_STOP_REACHED);
+}
+
+DMS_STOP_REASON dms_run_for_instructions(DmsContext *dms, int64_t count, int64_t max_ticks) {
+	assert(dms);
+
+	int64_t tick_end;
+	if (!context_run_prepare(dms, max_ticks, &tick_end)) {
+		return DMS_STOP_BUSY;
+	}
+
+	Simulator *sim = dms->simulator;
+	Device *device = dms->device;
+	const uint64_t *sync_value = &sim->signal_pool->signals_value[dms->cpu_sync.block];
+	const uint64_t *sync_changed = &sim->signal_pool->signals_changed[dms->cpu_sync.block];
+	uint64_t sync_mask = 1ull << dms->cpu_sync.index;
+
+	while (count > 0 && sim->current_tick < tick_end) {
+		context_input_due(dms);
+		device->process(device);
+		count -= (*sync_changed & *sync_value & sync_mask) != 0;
+	}
+
+	return context_run_finish(dms, (count > 0) ? DMS_STOP_TICK_LIMIT : DMS_STOP_REACHED);
+}
+
+DMS_STOP_REASON dms_run_until_pc(DmsContext *dms, int64_t addr, int64_t max_ticks) {
+	assert(dms);
+
+	int64_t tick_end;
+	if (!context_run_prepare(dms, max_ticks, &tick_end)) {
+		return DMS_STOP_BUSY;
+	}
+
+	Simulator *sim = dms->simulator;
+	Device *device = dms->device;
+	Cpu *cpu = dms->cpu;
+	const uint64_t *sync_value = &sim->signal_pool->signals_value[dms->cpu_sync.block];
+	const uint64_t *sync_changed = &sim->signal_pool->signals_changed[dms->cpu_sync.block];
+	uint64_t sync_mask = 1ull << dms->cpu_sync.index;
+
+	// only look at the program counter when the cpu starts a new instruction
+	while (sim->current_tick < tick_end) {
+		context_input_due(dms);
+		device->process(device);
+		if ((*sync_changed & *sync_value & sync_mask) && cpu->program_counter(cpu) == addr) {
+			return context_run_finish(dms, DMS_STOP_REACHED);
+		}
+	}
+
+	return context_run_finish(dms, DMS_STOP_TICK_LIMIT);
+}
+
+DMS_STOP_REASON dms_run_until_signal(DmsContext *dms, Signal signal, bool pos_edge, bool neg_edge, int64_t max_ticks) {
+	assert(dms);
+
+	int64_t tick_end;
+	if (!context_run_prepare(dms, max_ticks, &tick_end)) {
+		return DMS_STOP_BUSY;
+	}
+
+	Simulator *sim = dms->simulator;
+	Device *device = dms->device;
+	const uint64_t *value = &sim->signal_pool->signals_value[signal.block];
+	const uint64_t *changed = &sim->signal_pool->signals_changed[signal.block];
+	uint64_t pos_mask = (pos_edge) ? 1ull << signal.index : 0;
+	uint64_t neg_mask = (neg_edge) ? 1ull << signal.index : 0;
+
+	while (sim->current_tick < tick_end) {
+		context_input_due(dms);
+		device->process(device);
+		if (*changed & ((*value & pos_mask) | (~*value & neg_mask))) {
+			return context_run_finish(dms, DMS_STOP_REACHED);
+		}
+	}
+
+	return context_run_finish(dms, DMS_STOP_TICK_LIMIT);
+}
+
 void dms_single_step(DmsContext *dms) {
 	assert(dms);
 
-	if (dms->config_usr.state == DS_WAIT) {
-		change_state(dms, DS_SINGLE_STEP);
+	if (dms_get_state(dms) == DS_WAIT) {
+		change_state(dms, (ContextMessage) {.type = MSG_CHANGE_STATE, .state = DS_SINGLE_STEP});
 	}
 }
 
 void dms_step_signal(struct DmsContext *dms, Signal signal, bool pos_edge, bool neg_edge) {
 	assert(dms);
 
-	if (dms->config_usr.state == DS_WAIT) {
+	if (dms_get_state(dms) == DS_WAIT) {
 		dms->config_usr.step_signal = (SignalBreakpoint) {
 			.signal = signal,
 			.pos_edge = pos_edge,
 			.neg_edge = neg_edge
 		};
-		change_state(dms, DS_STEP_SIGNAL);
+		change_state(dms, (ContextMessage) {.type = MSG_STEP_SIGNAL, .step_signal = dms->config_usr.step_signal});
 	}
 }
 
@@ -396,65 +1107,205 @@ void dms_step_signal(struct DmsContext *dms, Signal signal, bool pos_edge, bool
 void dms_run(DmsContext *dms) {
 	assert(dms);
 
-	if (dms->config_usr.state == DS_WAIT) {
-		change_state(dms, DS_RUN);
+	if (dms_get_state(dms) == DS_WAIT) {
+		change_state(dms, (ContextMessage) {.type = MSG_CHANGE_STATE, .state = DS_RUN});
 	}
 }
 
 void dms_pause(DmsContext *dms) {
 	assert(dms);
 
-	if (dms->config_usr.state == DS_RUN) {
-		change_state(dms, DS_WAIT);
+	if (dms_get_state(dms) == DS_RUN) {
+		change_state(dms, (ContextMessage) {.type = MSG_CHANGE_STATE, .state = DS_WAIT});
 	}
 }
 
 bool dms_is_paused(DmsContext *dms) {
-	return dms->config_usr.state == DS_WAIT;
+	return dms_get_state(dms) == DS_WAIT;
 }
 
 void dms_change_simulation_speed_ratio(DmsContext *dms, double ratio) {
 	assert(dms);
 
-	MUTEX_CONFIG_LOCK(dms);
+	dms->config_usr.target_sim_real_ratio = (int64_t) (ratio * 10000);
+	context_send_message(dms, (ContextMessage) {.type = MSG_SIMULATION_SPEED, .target_sim_real_ratio = dms->config_usr.target_sim_real_ratio});
+}
+
+double dms_simulation_speed_ratio(DmsContext *dms) {
+	assert(dms);
+
+	ContextStatus status = context_read_status(dms);
+	return status.pacing.speed_ratio;
+}
 
-		dms->config_usr.target_sim_real_ratio = (int64_t) (ratio * 10000);
-		dms->config_changed = true;
+void dms_auto_warp_set(DmsContext *dms, bool enabled) {
+	assert(dms);
 
-	MUTEX_CONFIG_UNLOCK(dms);
+	dms->config_usr.auto_warp = enabled;
+	context_send_message(dms, (ContextMessage) {.type = MSG_AUTO_WARP, .auto_warp = enabled});
+}
 
+bool dms_auto_warp(DmsContext *dms) {
+	assert(dms);
+	return dms->config_usr.auto_warp;
 }
 
-double dms_simulation_speed_ratio(DmsContext *dms) {
+DmsPacingStats dms_pacing_stats(DmsContext *dms) {
 	assert(dms);
 
-	MUTEX_CONFIG_LOCK(dms);
-	int64_t ratio = dms->actual_sim_real_ratio;
-	MUTEX_CONFIG_UNLOCK(dms);
+	ContextStatus status = context_read_status(dms);
+	return status.pacing;
+}
 
-	return (double) ratio / 10000.0;
+static void context_send_input(DmsContext *dms, InputEvent event) {
+	InputEvent *msg_event = (InputEvent *) dms_malloc(sizeof(InputEvent));
+	*msg_event = event;
+	context_send_message(dms, (ContextMessage) {.type = MSG_INPUT, .input = msg_event});
+}
+
+void dms_input_key_pressed(DmsContext *dms, struct InputKeypad *keypad, size_t row, size_t col) {
+	assert(dms);
+	assert(keypad);
+
+	context_send_input(dms, (InputEvent) {
+		.type = INPUT_EVENT_KEY_PRESSED,
+		.chip = (Chip *) keypad,
+		.param = {(int32_t) row, (int32_t) col}
+	});
+}
+
+void dms_input_key_dwell_time(DmsContext *dms, struct InputKeypad *keypad, int32_t dwell_ms) {
+	assert(dms);
+	assert(keypad);
+
+	context_send_input(dms, (InputEvent) {
+		.type = INPUT_EVENT_KEY_DWELL,
+		.chip = (Chip *) keypad,
+		.param = {dwell_ms, 0}
+	});
+}
+
+void dms_input_datassette_key(DmsContext *dms, struct PerifDatassette *datassette, int32_t key) {
+	assert(dms);
+	assert(datassette);
+
+	context_send_input(dms, (InputEvent) {
+		.type = INPUT_EVENT_DATASSETTE_KEY,
+		.chip = (Chip *) datassette,
+		.param = {key, 0}
+	});
+}
+
+static inline void context_send_input_data(DmsContext *dms, INPUT_EVENT_TYPE type, Chip *chip, const int8_t *data, size_t data_len) {
+	InputEvent event = {.type = type, .chip = chip};
+
+	arrsetlen(event.data, data_len);
+	dms_memcpy(event.data, data, data_len);
+
+	context_send_input(dms, event);
+}
+
+void dms_input_tape_load(DmsContext *dms, struct PerifDatassette *datassette, const int8_t *data, size_t data_len) {
+	assert(dms);
+	assert(datassette);
+	assert(data);
+
+	context_send_input_data(dms, INPUT_EVENT_TAPE_LOAD, (Chip *) datassette, data, data_len);
+}
+
+void dms_input_disk_load(DmsContext *dms, struct PerifDisk2031 *disk, const int8_t *data, size_t data_len) {
+	assert(dms);
+	assert(disk);
+	assert(data);
+
+	context_send_input_data(dms, INPUT_EVENT_DISK_LOAD, (Chip *) disk, data, data_len);
+}
+
+void dms_input_reset(DmsContext *dms) {
+	assert(dms);
+
+	context_send_input(dms, (InputEvent) {.type = INPUT_EVENT_RESET});
+}
+
+bool dms_input_record_start(DmsContext *dms, const char *filename) {
+	assert(dms);
+	assert(filename);
+
+	InputRecorder *recorder = input_recorder_open(filename);
+	if (!recorder) {
+		return false;
+	}
+
+	context_send_message(dms, (ContextMessage) {.type = MSG_INPUT_RECORD, .recorder = recorder});
+	return true;
+}
+
+void dms_input_record_stop(DmsContext *dms) {
+	assert(dms);
+
+	context_send_message(dms, (ContextMessage) {.type = MSG_INPUT_RECORD, .recorder = NULL});
+}
+
+bool dms_input_replay(DmsContext *dms, const char *filename) {
+	assert(dms);
+	assert(dms->simulator);
+	assert(filename);
+
+	InputEvent *events = NULL;
+	if (!input_recording_load(filename, dms->simulator, &events)) {
+		return false;
+	}
+
+	context_send_message(dms, (ContextMessage) {.type = MSG_INPUT_REPLAY, .replay = events});
+	return true;
+}
+
+static inline void breakpoint_options_add(DmsContext *dms, DMS_BREAKPOINT_KIND kind, int64_t addr) {
+	if (breakpoint_options_index(dms->config_usr.bp_options, kind, addr) < 0) {
+		arrpush(dms->config_usr.bp_options, ((BreakpointOptions) {.kind = kind, .address = addr}));
+	}
+}
+
+static inline void breakpoint_options_remove(DmsContext *dms, DMS_BREAKPOINT_KIND kind, int64_t addr) {
+	int idx = breakpoint_options_index(dms->config_usr.bp_options, kind, addr);
+	if (idx >= 0) {
+		if (dms->config_usr.bp_options[idx].condition) {
+			arrpush(dms->config_usr.bp_retired, dms->config_usr.bp_options[idx].condition);
+		}
+		arrdelswap(dms->config_usr.bp_options, idx);
+	}
 }
 
 bool dms_toggle_breakpoint(DmsContext *dms, int64_t addr) {
 	bool result;
 
-	MUTEX_CONFIG_LOCK(dms);
-		int idx = breakpoint_index(dms, addr);
+	if (addr < 0 || addr > 0xffff) {
+		return false;
+	}
 
-		if (idx < 0) {
-			arrpush(dms->config_usr.pc_breakpoints, addr);
-			result = true;
-		} else {
-			arrdelswap(dms->config.pc_breakpoints, idx);
-			result = false;
-		}
-		dms->config_usr.bp_updated = true;
-		dms->config_changed = true;
-	MUTEX_CONFIG_UNLOCK(dms);
+	result = !pc_breakpoint_is_set(&dms->config_usr, addr);
+	FLAG_SET_CLEAR_U64(dms->config_usr.pc_breakpoints[addr >> 6], 1ull << (addr & 63), result);
+	dms->config_usr.pc_breakpoint_count = (result) ? dms->config_usr.pc_breakpoint_count + 1 : dms->config_usr.pc_breakpoint_count - 1;
+	if (result) {
+		breakpoint_options_add(dms, DMS_BREAKPOINT_PC, addr);
+	} else {
+		breakpoint_options_remove(dms, DMS_BREAKPOINT_PC, addr);
+	}
+	context_send_breakpoints(dms);
 
 	return result;
 }
 
+bool dms_breakpoint_is_set(DmsContext *dms, int64_t addr) {
+	assert(dms);
+
+	if (addr < 0 || addr > 0xffff) {
+		return false;
+	}
+
+	return pc_breakpoint_is_set(&dms->config_usr, addr);
+}
+
 SignalBreakpoint *dms_breakpoint_signal_list(DmsContext *dms) {
 	assert(dms);
 	return dms->config_usr.signal_breakpoints;
@@ -463,26 +1314,20 @@ SignalBreakpoint *dms_breakpoint_signal_list(DmsContext *dms) {
 void dms_breakpoint_signal_set(DmsContext *dms, Signal signal, bool pos_edge, bool neg_edge) {
 	assert(dms);
 
-	MUTEX_CONFIG_LOCK(dms);
-		if (signal_breakpoint_index(dms, signal) < 0) {
-			arrpush(dms->config_usr.signal_breakpoints, ((SignalBreakpoint) {signal, pos_edge, neg_edge}));
-			dms->config_usr.bp_updated = true;
-			dms->config_changed = true;
-		}
-	MUTEX_CONFIG_UNLOCK(dms);
+	if (signal_breakpoint_index(dms, signal) < 0) {
+		arrpush(dms->config_usr.signal_breakpoints, ((SignalBreakpoint) {signal, pos_edge, neg_edge}));
+		context_send_breakpoints(dms);
+	}
 }
 
 void dms_breakpoint_signal_clear(DmsContext *dms, Signal signal) {
 	assert(dms);
 
-	MUTEX_CONFIG_LOCK(dms);
-		int idx = signal_breakpoint_index(dms, signal);
-		if (idx	>= 0) {
-			arrdelswap(dms->config_usr.signal_breakpoints, idx);
-			dms->config_usr.bp_updated = true;
-			dms->config_changed = true;
-		}
-	MUTEX_CONFIG_UNLOCK(dms);
+	int idx = signal_breakpoint_index(dms, signal);
+	if (idx	>= 0) {
+		arrdelswap(dms->config_usr.signal_breakpoints, idx);
+		context_send_breakpoints(dms);
+	}
 }
 
 bool dms_breakpoint_signal_is_set(struct DmsContext *dms, Signal signal) {
@@ -493,22 +1338,146 @@ bool dms_breakpoint_signal_is_set(struct DmsContext *dms, Signal signal) {
 bool dms_toggle_signal_breakpoint(DmsContext *dms, Signal signal) {
 	bool result;
 
-	MUTEX_CONFIG_LOCK(dms);
-		int idx = signal_breakpoint_index(dms, signal);
-		if (idx < 0) {
-			arrpush(dms->config_usr.signal_breakpoints, ((SignalBreakpoint) {signal, true, true}));
-			result = true;
-		} else {
-			arrdelswap(dms->config_usr.signal_breakpoints, idx);
-			result = false;
-		}
+	int idx = signal_breakpoint_index(dms, signal);
+	if (idx < 0) {
+		arrpush(dms->config_usr.signal_breakpoints, ((SignalBreakpoint) {signal, true, true}));
+		result = true;
+	} else {
+		arrdelswap(dms->config_usr.signal_breakpoints, idx);
+		result = false;
+	}
 
-		dms->config_usr.bp_updated = true;
-		dms->config_changed = true;
-	MUTEX_CONFIG_UNLOCK(dms);
+	context_send_breakpoints(dms);
 	return result;
 }
 
+static inline int watchpoint_index(DmsContext *dms, int64_t addr) {
+	for (int i = 0; i < arrlen(dms->config_usr.watchpoints); ++i) {
+		if (dms->config_usr.watchpoints[i].address == addr) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+BusWatchpoint *dms_watchpoint_list(DmsContext *dms) {
+	assert(dms);
+	return dms->config_usr.watchpoints;
+}
+
+void dms_watchpoint_set(DmsContext *dms, int64_t addr, uint8_t flags, uint8_t value) {
+	assert(dms);
+
+	if (addr < 0 || addr >= BUS_WATCHER_ADDRESS_SPACE) {
+		return;
+	}
+
+	if (flags == 0) {
+		dms_watchpoint_clear(dms, addr);
+		return;
+	}
+
+	int idx = watchpoint_index(dms, addr);
+	if (idx < 0) {
+		arrpush(dms->config_usr.watchpoints, ((BusWatchpoint) {addr, flags, value}));
+		breakpoint_options_add(dms, DMS_BREAKPOINT_WATCH, addr);
+	} else {
+		dms->config_usr.watchpoints[idx] = (BusWatchpoint) {addr, flags, value};
+	}
+	context_send_breakpoints(dms);
+}
+
+void dms_watchpoint_clear(DmsContext *dms, int64_t addr) {
+	assert(dms);
+
+	int idx = watchpoint_index(dms, addr);
+	if (idx >= 0) {
+		arrdelswap(dms->config_usr.watchpoints, idx);
+		breakpoint_options_remove(dms, DMS_BREAKPOINT_WATCH, addr);
+		context_send_breakpoints(dms);
+	}
+}
+
+uint8_t dms_watchpoint_flags(DmsContext *dms, int64_t addr) {
+	assert(dms);
+
+	int idx = watchpoint_index(dms, addr);
+	return (idx >= 0) ? dms->config_usr.watchpoints[idx].flags : 0;
+}
+
+BusWatchHit dms_watchpoint_last_hit(DmsContext *dms) {
+	assert(dms);
+
+	ContextStatus status = context_read_status(dms);
+	return status.watch_hit;
+}
+
+bool dms_breakpoint_condition_set(DmsContext *dms, DMS_BREAKPOINT_KIND kind, int64_t addr, const char *condition, const char **error) {
+	assert(dms);
+
+	int idx = breakpoint_options_index(dms->config_usr.bp_options, kind, addr);
+	if (idx < 0) {
+		if (error) {
+			*error = (kind == DMS_BREAKPOINT_PC) ? "no breakpoint at this address" : "no watchpoint at this address";
+		}
+		return false;
+	}
+
+	// an empty condition removes the current condition
+	BreakpointCondition *compiled = NULL;
+
+	if (condition && condition[0] != '\0') {
+		compiled = breakpoint_condition_compile(condition, dms->cpu, (dms->simulator) ? dms->simulator->signal_pool : NULL, error);
+		if (!compiled) {
+			return false;
+		}
+	}
+
+	BreakpointOptions *opt = &dms->config_usr.bp_options[idx];
+	if (opt->condition) {
+		arrpush(dms->config_usr.bp_retired, opt->condition);
+	}
+	opt->condition = compiled;
+	context_send_breakpoints(dms);
+
+	return true;
+}
+
+const char *dms_breakpoint_condition(DmsContext *dms, DMS_BREAKPOINT_KIND kind, int64_t addr) {
+	assert(dms);
+
+	int idx = breakpoint_options_index(dms->config_usr.bp_options, kind, addr);
+	if (idx < 0 || !dms->config_usr.bp_options[idx].condition) {
+		return NULL;
+	}
+
+	return dms->config_usr.bp_options[idx].condition->source;
+}
+
+void dms_breakpoint_ignore_count_set(DmsContext *dms, DMS_BREAKPOINT_KIND kind, int64_t addr, int64_t count) {
+	assert(dms);
+
+	context_process_notifications(dms);
+
+	int idx = breakpoint_options_index(dms->config_usr.bp_options, kind, addr);
+	if (idx >= 0) {
+		// ignore the next 'count' hits
+		BreakpointOptions *opt = &dms->config_usr.bp_options[idx];
+		opt->ignore_until = opt->hit_count + MAX(count, 0);
+		context_send_breakpoints(dms);
+	}
+}
+
+int64_t dms_breakpoint_hit_count(DmsContext *dms, DMS_BREAKPOINT_KIND kind, int64_t addr) {
+	assert(dms);
+
+	context_process_notifications(dms);
+
+	int idx = breakpoint_options_index(dms->config_usr.bp_options, kind, addr);
+	return (idx >= 0) ? dms->config_usr.bp_options[idx].hit_count : 0;
+}
+
 void dms_break_on_irq_set(struct DmsContext *dms) {
 	assert(dms);
 
@@ -531,6 +1500,81 @@ void dms_break_on_irq_clear(struct DmsContext *dms) {
 	}
 }
 
+static bool monitor_parse_address(const char *args, int64_t *addr, const char **rest) {
+	char *end = NULL;
+	*addr = strtoll(args, &end, 16);
+	if (end == args || *addr < 0 || *addr > 0xffff) {
+		return false;
+	}
+
+	while (*end == ' ') {
+		++end;
+	}
+	*rest = end;
+	return true;
+}
+
+static void monitor_breakpoint_options(DmsContext *dms, DMS_BREAKPOINT_KIND kind, const char *cmd, char **reply) {
+	static const char *disp_kind[] = {"breakpoint", "watchpoint"};
+
+	int64_t addr;
+	const char *rest;
+
+	if (!monitor_parse_address(cmd + 2, &addr, &rest)) {
+		arr_printf(*reply, "NOK: invalid address specified");
+		return;
+	}
+
+	// a condition on an address without a breakpoint creates the breakpoint (but not when the condition is invalid)
+	bool created = kind == DMS_BREAKPOINT_PC && cmd[1] == 'c' && !pc_breakpoint_is_set(&dms->config_usr, addr);
+	if (created) {
+		dms_toggle_breakpoint(dms, addr);
+	}
+
+	if (cmd[1] == 'c') {		// condition
+		const char *error = NULL;
+		if (dms_breakpoint_condition_set(dms, kind, addr, rest, &error)) {
+			arr_printf(*reply, "OK: %s at 0x%lx %s %s", disp_kind[kind], addr, (*rest) ? "breaks when" : "is unconditional", rest);
+		} else {
+			if (created) {
+				dms_toggle_breakpoint(dms, addr);
+			}
+			arr_printf(*reply, "NOK: %s", error);
+		}
+	} else {					// ignore count
+		int64_t count = strtoll(rest, NULL, 10);
+		if (breakpoint_options_index(dms->config_usr.bp_options, kind, addr) >= 0) {
+			dms_breakpoint_ignore_count_set(dms, kind, addr, count);
+			arr_printf(*reply, "OK: ignoring the next %ld hits of the %s at 0x%lx", count, disp_kind[kind], addr);
+		} else {
+			arr_printf(*reply, "NOK: no %s at this address", disp_kind[kind]);
+		}
+	}
+}
+
+static void monitor_breakpoint_list(DmsContext *dms, char **reply) {
+	static const char *disp_kind[] = {"break", "watch"};
+
+	context_process_notifications(dms);
+	BreakpointOptions *options = dms->config_usr.bp_options;
+
+	for (size_t i = 0; i < arrlenu(options); ++i) {
+		int64_t hits = options[i].hit_count;
+		arr_printf(*reply, "%s 0x%.4lx hits %ld", disp_kind[options[i].kind], options[i].address, hits);
+		if (options[i].ignore_until > hits) {
+			arr_printf(*reply, " (ignoring %ld)", options[i].ignore_until - hits);
+		}
+		if (options[i].condition) {
+			arr_printf(*reply, " if %s", options[i].condition->source);
+		}
+		arr_printf(*reply, "\n");
+	}
+
+	if (arrlenu(options) == 0) {
+		arr_printf(*reply, "OK: no breakpoints or watchpoints");
+	}
+}
+
 void dms_monitor_cmd(struct DmsContext *dms, const char *cmd, char **reply) {
 	assert(dms);
 	assert(cmd);
@@ -577,6 +1621,22 @@ void dms_monitor_cmd(struct DmsContext *dms, const char *cmd, char **reply) {
 		} else {
 			arr_printf(*reply, "NOK: signal '%s' is not known", cmd + 3);
 		}
+	} else if ((cmd[0] == 'b' || cmd[0] == 'w') && (cmd[1] == 'c' || cmd[1] == 'n') && cmd[2] == ' ') {		// "c"ondition or ig"n"ore count
+		monitor_breakpoint_options(dms, (cmd[0] == 'b') ? DMS_BREAKPOINT_PC : DMS_BREAKPOINT_WATCH, cmd, reply);
+	} else if (cmd[0] == 'b' && cmd[1] == 'l') {		// "b"reakpoint "l"ist
+		monitor_breakpoint_list(dms, reply);
+	} else if (cmd[0] == 'w' && (cmd[1] == 'r' || cmd[1] == 'w')) {		// toggle "w"atchpoint on "r"ead or "w"rite
+		int64_t addr;
+		if (string_to_hexint(cmd + 2, &addr) && addr >= 0 && addr < BUS_WATCHER_ADDRESS_SPACE) {
+			static const char *disp_access[] = {"read", "write"};
+			static const char *disp_watch[] = {"unset", "set"};
+			uint8_t flag = (cmd[1] == 'r') ? BUS_WATCH_READ : BUS_WATCH_WRITE;
+			uint8_t flags = dms_watchpoint_flags(dms, addr) ^ flag;
+			dms_watchpoint_set(dms, addr, flags, 0);
+			arr_printf(*reply, "OK: %s watchpoint at 0x%lx %s", disp_access[cmd[1] == 'w'], addr, disp_watch[(flags & flag) != 0]);
+		} else {
+			arr_printf(*reply, "NOK: invalid address specified");
+		}
 	} else if (cmd[0] == 'b') {		// toggle "b"reak-point
 		int64_t addr;
 		if (string_to_hexint(cmd + 1, &addr)) {
@@ -591,6 +1651,13 @@ void dms_monitor_cmd(struct DmsContext *dms, const char *cmd, char **reply) {
 		arr_printf(*reply, "bi          : set/clear breakpoint on IRQ assertion.\n");
 		arr_printf(*reply, "bs <signal> : set/clear breakpoint on signal modification.\n");
 		arr_printf(*reply, "b <address> : set/clear breakpoint on program counter.\n");
+		arr_printf(*reply, "wr <address>: set/clear watchpoint on memory read.\n");
+		arr_printf(*reply, "ww <address>: set/clear watchpoint on memory write.\n");
+		arr_printf(*reply, "bc <address> <condition> : only break when the condition is true (e.g. A == $0d && X > 3).\n");
+		arr_printf(*reply, "wc <address> <condition> : only break on the watchpoint when the condition is true.\n");
+		arr_printf(*reply, "bn <address> <count>     : ignore the next <count> hits of the breakpoint.\n");
+		arr_printf(*reply, "wn <address> <count>     : ignore the next <count> hits of the watchpoint.\n");
+		arr_printf(*reply, "bl          : list breakpoints and watchpoints.\n");
 	} else {
 		arr_printf(*reply, "NOK: invalid command");
 	}
@@ -5,6 +5,7 @@
 
 #include "types.h"
 #include "signal_line.h"
+#include "bus_watcher.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -20,8 +21,38 @@ typedef enum DMS_STATE {
 	DS_EXIT = 99
 } DMS_STATE;
 
+typedef enum DMS_BREAKPOINT_KIND {
+	DMS_BREAKPOINT_PC = 0,			// program counter breakpoint
+	DMS_BREAKPOINT_WATCH = 1		// memory watchpoint
+} DMS_BREAKPOINT_KIND;
+
+typedef enum DMS_STOP_REASON {
+	DMS_STOP_REACHED = 0,			// the requested number of ticks/instructions was executed or the condition was met
+	DMS_STOP_TICK_LIMIT = 1,		// gave up after the maximum number of ticks
+	DMS_STOP_BUSY = 2				// the background thread is executing the simulation
+} DMS_STOP_REASON;
+
+typedef struct DmsStatus {
+	DMS_STATE	state;
+	int64_t		current_tick;
+	int64_t		program_counter;
+	bool		warp;						// running as fast as possible on request of a peripheral
+} DmsStatus;
+
+typedef struct DmsPacingStats {
+	double		speed_ratio;				// achieved simulation speed relative to real-time
+	int64_t		jitter_ps;					// largest change in lag behind real-time between two sync points (last window)
+	int64_t		overshoot_ps;				// largest amount a sleep overshot its deadline (last window)
+	int64_t		slice_ps;					// simulated time between two sync points
+	int64_t		sleep_granularity_ps;		// measured sleep overshoot of the host, sleeps are cut short by this margin
+											//	(unless it's more than half a slice: then the simulation only sleeps)
+} DmsPacingStats;
+
 struct DmsContext;
 struct Device;
+struct InputKeypad;
+struct PerifDatassette;
+struct PerifDisk2031;
 
 // functions
 struct DmsContext *dms_create_context(void);
@@ -30,7 +61,10 @@ void dms_release_context(struct DmsContext *dms);
 void dms_set_device(struct DmsContext *dms, struct Device *device);
 struct Device *dms_get_device(struct DmsContext *dms);
 
+// dms_get_state: state of the simulation (a requested state change is reported before the simulation has processed it)
 DMS_STATE dms_get_state(struct DmsContext *dms);
+// dms_get_status: the last status published by the simulation, never waits for the simulation thread
+DmsStatus dms_get_status(struct DmsContext *dms);
 
 #ifndef DMS_NO_THREADING
 void dms_start_execution(struct DmsContext *dms);
@@ -41,6 +75,14 @@ void dms_execute(struct DmsContext *dms);
 
 void dms_execute_no_sync(struct DmsContext *dms);
 
+// synchronous execution on the calling thread, without checking breakpoints (not allowed while the background thread is running)
+//	- max_ticks: give up after this many ticks (0 = no limit)
+//	- the simulation can advance a few ticks past the requested count when the simulator skips idle ticks
+DMS_STOP_REASON dms_run_for_ticks(struct DmsContext *dms, int64_t ticks);
+DMS_STOP_REASON dms_run_for_instructions(struct DmsContext *dms, int64_t count, int64_t max_ticks);
+DMS_STOP_REASON dms_run_until_pc(struct DmsContext *dms, int64_t addr, int64_t max_ticks);
+DMS_STOP_REASON dms_run_until_signal(struct DmsContext *dms, Signal signal, bool pos_edge, bool neg_edge, int64_t max_ticks);
+
 void dms_single_step(struct DmsContext *dms);
 void dms_step_signal(struct DmsContext *dms, Signal signal, bool pos_edge, bool neg_edge);
 void dms_run(struct DmsContext *dms);
@@ -50,6 +92,28 @@ bool dms_is_paused(struct DmsContext *dms);
 
 void dms_change_simulation_speed_ratio(struct DmsContext *dms, double ratio);
 double dms_simulation_speed_ratio(struct DmsContext *dms);
+DmsPacingStats dms_pacing_stats(struct DmsContext *dms);
+
+// automatic warp mode: don't synchronize with real-time while a peripheral is transferring data (enabled by default)
+void dms_auto_warp_set(struct DmsContext *dms, bool enabled);
+bool dms_auto_warp(struct DmsContext *dms);
+
+// external inputs: applied by the simulation at the tick it processes the request (recorded when a recording is active)
+void dms_input_key_pressed(struct DmsContext *dms, struct InputKeypad *keypad, size_t row, size_t col);
+void dms_input_key_dwell_time(struct DmsContext *dms, struct InputKeypad *keypad, int32_t dwell_ms);
+void dms_input_datassette_key(struct DmsContext *dms, struct PerifDatassette *datassette, int32_t key);
+void dms_input_tape_load(struct DmsContext *dms, struct PerifDatassette *datassette, const int8_t *data, size_t data_len);
+void dms_input_disk_load(struct DmsContext *dms, struct PerifDisk2031 *disk, const int8_t *data, size_t data_len);
+void dms_input_reset(struct DmsContext *dms);
+
+// record the external inputs to a file, replaying the file on a freshly created device reproduces the session exactly
+bool dms_input_record_start(struct DmsContext *dms, const char *filename);
+void dms_input_record_stop(struct DmsContext *dms);
+// dms_input_replay: the events are applied when the simulation reaches their tick (returns false if the file is invalid)
+bool dms_input_replay(struct DmsContext *dms, const char *filename);
+
+bool dms_toggle_breakpoint(struct DmsContext *dms, int64_t addr);
+bool dms_breakpoint_is_set(struct DmsContext *dms, int64_t addr);
 
 SignalBreakpoint *dms_breakpoint_signal_list(struct DmsContext *dms);
 void dms_breakpoint_signal_set(struct DmsContext *dms, Signal signal, bool pos_edge, bool neg_edge);
@@ -57,6 +121,18 @@ void dms_breakpoint_signal_clear(struct DmsContext *dms, Signal signal);
 bool dms_breakpoint_signal_is_set(struct DmsContext *dms, Signal signal);
 bool dms_toggle_signal_breakpoint(struct DmsContext *dms, Signal signal);
 
+BusWatchpoint *dms_watchpoint_list(struct DmsContext *dms);
+void dms_watchpoint_set(struct DmsContext *dms, int64_t addr, uint8_t flags, uint8_t value);
+void dms_watchpoint_clear(struct DmsContext *dms, int64_t addr);
+uint8_t dms_watchpoint_flags(struct DmsContext *dms, int64_t addr);
+BusWatchHit dms_watchpoint_last_hit(struct DmsContext *dms);
+
+// conditions and ignore counts apply to an existing pc breakpoint or watchpoint
+bool dms_breakpoint_condition_set(struct DmsContext *dms, DMS_BREAKPOINT_KIND kind, int64_t addr, const char *condition, const char **error);
+const char *dms_breakpoint_condition(struct DmsContext *dms, DMS_BREAKPOINT_KIND kind, int64_t addr);
+void dms_breakpoint_ignore_count_set(struct DmsContext *dms, DMS_BREAKPOINT_KIND kind, int64_t addr, int64_t count);
+int64_t dms_breakpoint_hit_count(struct DmsContext *dms, DMS_BREAKPOINT_KIND kind, int64_t addr);
+
 void dms_break_on_irq_set(struct DmsContext *dms);
 void dms_break_on_irq_clear(struct DmsContext *dms);
 
@@ -11,13 +11,19 @@ typedef void (*CPU_OVERRIDE_NEXT_INSTRUCTION_ADDRESS)(void *cpu, uint16_t addr);
 typedef bool (*CPU_IS_AT_START_OF_INSTRUCTION)(void *cpu);
 typedef bool (*CPU_IRQ_IS_ASSERTED)(void *cpu);
 typedef int64_t  (*CPU_PROGRAM_COUNTER)(void *cpu);
+typedef Signal (*CPU_INSTRUCTION_START_SIGNAL)(void *cpu);
+typedef int32_t (*CPU_REGISTER_INDEX)(void *cpu, const char *name);
+typedef int64_t (*CPU_REGISTER_VALUE)(void *cpu, int32_t index);
 
 #define CPU_DECLARE_FUNCTIONS		\
 	CHIP_DECLARE_BASE														\
 	CPU_OVERRIDE_NEXT_INSTRUCTION_ADDRESS override_next_instruction_address;	\
 	CPU_IS_AT_START_OF_INSTRUCTION is_at_start_of_instruction;					\
 	CPU_IRQ_IS_ASSERTED irq_is_asserted;										\
-	CPU_PROGRAM_COUNTER program_counter;
+	CPU_PROGRAM_COUNTER program_counter;										\
+	CPU_INSTRUCTION_START_SIGNAL instruction_start_signal;					\
+	CPU_REGISTER_INDEX register_index;											\
+	CPU_REGISTER_VALUE register_value;
 
 typedef struct Cpu {
 	CPU_DECLARE_FUNCTIONS
@@ -3,10 +3,16 @@
 // Emulation of the MOS 6502
 
 #include "cpu_6502.h"
+#include "bus_watcher.h"
+#include "cpu_6502_coverage.h"
 #include "cpu_6502_opcodes.h"
+#include "cpu_6502_profile.h"
+#include "cpu_6502_trace.h"
 #include "simulator.h"
 #include "crt.h"
 
+#include <ctype.h>
+
 #define SIGNAL_OWNER		cpu
 #define SIGNAL_PREFIX		PIN_6502_
 
@@ -168,6 +174,18 @@ typedef struct Cpu6502_private {
 	bool			delayed_cycle;
 
 	uint16_t		last_out_address;
+
+	Cpu6502Trace *			trace;			// optional instruction trace
+	Cpu6502TraceRecord *	trace_current;	// record of the instruction being executed (NULL == none)
+	uint8_t					trace_fetched;	// bitmask of the instruction bytes already stored in trace_current
+
+	Cpu6502Profile *		profile;		// optional execution profile
+	Cpu6502Coverage *		coverage;		// optional code and data coverage
+
+	Cpu6502MemoryMap *		memory_map;		// optional direct access to memory (fast bus mode)
+	bool					fast_cycle;		// current cycle accesses memory through the map, the bus stays idle
+	bool					fast_begun;		// first cycle after the idle cycles was already started
+	int8_t					fast_idle;		// number of cycles that were executed ahead of the clock
 } Cpu6502_private;
 
 //////////////////////////////////////////////////////////////////////////////
@@ -189,6 +207,17 @@ static void process_end(Cpu6502 *cpu) {
 	output_t *output = &PRIVATE(cpu)->output;
 	output_t *last_output = &PRIVATE(cpu)->last_output;
 
+	// fast bus: the bus stays idle during accesses through the memory map. Park it on a mapped address first so
+	//	the device accessed last doesn't keep seeing a read (or a write) of the same location.
+	output_t idle;
+	if (PRIVATE(cpu)->fast_cycle) {
+		idle = (output_t) {.address = last_output->address, .rw = RW_READ, .drv_data = false};
+		if (!PRIVATE(cpu)->memory_map->read[HI_BYTE(idle.address)]) {
+			idle.address = output->address;
+		}
+		output = &idle;
+	}
+
 	// address bus
 	if (output->address != last_output->address) {
 		SIGNAL_GROUP_WRITE(address, output->address);
@@ -333,1798 +362,965 @@ static void execute_init(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
 	interrupt_sequence(cpu, phase, INTR_RESET);
 }
 
-static inline void fetch_memory(Cpu6502 *cpu, uint16_t addr, uint8_t *dst, CPU_6502_CYCLE phase) {
+static inline void fetch_pc_memory(Cpu6502 *cpu, uint8_t *dst, CPU_6502_CYCLE phase) {
 	assert(cpu);
 	assert(dst);
 
 	switch (phase) {
 		case CYCLE_BEGIN :
-			PRIVATE(cpu)->output.address = addr;
+			PRIVATE(cpu)->output.address = cpu->reg_pc;
 			break;
 		case CYCLE_MIDDLE:
 			break;
 		case CYCLE_END :
 			*dst = PRIVATE(cpu)->in_data;
+			++cpu->reg_pc;
 			break;
 	}
 }
 
-static inline void store_memory(Cpu6502 *cpu, uint16_t addr, uint8_t value, CPU_6502_CYCLE phase) {
-	assert(cpu);
-
-	switch (phase) {
-		case CYCLE_BEGIN :
-			PRIVATE(cpu)->output.address = addr;
-			PRIVATE(cpu)->output.rw = RW_WRITE;
-			break;
-		case CYCLE_MIDDLE:
-			OUTPUT_DATA(value);
-			break;
-		case CYCLE_END :
-			PRIVATE(cpu)->output.rw = RW_READ;
-			break;
-	}
-}
+//////////////////////////////////////////////////////////////////////////////
+//
+// micro-programs
+//
 
-static inline void fetch_zp_discard_add(Cpu6502 *cpu, uint8_t index, CPU_6502_CYCLE phase) {
-// utility function for indexed zero-page memory accesses
-//	- according to programming manual: cpu fetches data at base adress and discards it
-//  - there is no page crossing in indexed zero page, a wrap-around occurs
+/* After the opcode fetch each instruction is executed by a micro-program: a list of micro-operations, one for each
+   cycle of the instruction. A micro-operation determines what the cpu puts on the bus at the start of the cycle,
+   the data it drives halfway the cycle (writes only) and the internal work that is done at the end of the cycle.
+   The 'op' of the micro-program selects the operation performed on the operand (or the register that is stored, or
+   the condition of a branch). Instructions that take fewer cycles when no page boundary is crossed (or when a branch
+   isn't taken) end early from the micro-operation that checks for it.
+*/
 
-	assert(cpu);
+typedef enum MICRO_OP_6502 {
+	MOP_JAM = 0,				// undefined opcode: the cpu stops executing instructions
+
+	// address calculation
+	MOP_FETCH_ADL,				// fetch the low byte of the address (zero page: the complete address)
+	MOP_FETCH_ADH,				// fetch the high byte of the address
+	MOP_FETCH_ADH_X,			// fetch the high byte of the address, add X to the low byte
+	MOP_FETCH_ADH_Y,			// fetch the high byte of the address, add Y to the low byte
+	MOP_ZP_INDEX_X,				// dummy read of the zero page address, add X (no page crossing in zero page)
+	MOP_ZP_INDEX_Y,				// dummy read of the zero page address, add Y
+	MOP_FETCH_ZP_PTR,			// fetch the zero page address of the pointer
+	MOP_PTR_INDEX_X,			// dummy read of the pointer, add X to the pointer
+	MOP_PTR_ADL,				// read the low byte of the address from the pointer
+	MOP_PTR_ADH,				// read the high byte of the address from the pointer
+	MOP_PTR_ADH_Y,				// read the high byte of the address from the pointer, add Y to the low byte
+	MOP_PAGE_CROSS_FIX,			// dummy read of the indexed address, add the carry to the high byte
+
+	// operand access
+	MOP_READ,					// read the operand
+	MOP_READ_EXEC,				// read the operand and execute the operation
+	MOP_READ_IMM_EXEC,			// read the operand following the opcode and execute the operation
+	MOP_READ_PAGE_CROSS_EXEC,	// read the operand and execute the operation if no page boundary was crossed
+	MOP_IMPLIED_EXEC,			// dummy read of the next opcode and execute the operation
+	MOP_WRITE,					// write the selected register
+	MOP_RMW_MODIFY,				// write back the unmodified operand (rw only), execute the operation on the operand
+	MOP_RMW_WRITE,				// write the modified operand
+
+	// jumps & subroutines
+	MOP_READ_PC_DISCARD,		// dummy read of the next opcode
+	MOP_FETCH_PC_DISCARD,		// dummy read of the byte following the opcode (increments the program counter)
+	MOP_FETCH_PC_END,			// dummy read at the new program counter (increments the program counter)
+	MOP_FETCH_IAL,				// fetch the low byte of the indirect address
+	MOP_FETCH_IAH,				// fetch the high byte of the indirect address
+	MOP_IND_ADL,				// read the low byte of the jump address
+	MOP_IND_ADH_JMP,			// read the high byte of the jump address and jump
+	MOP_JMP_ADH,				// fetch the high byte of the address and jump
+
+	// stack
+	MOP_STACK_PEEK,				// put the stack pointer on the address bus
+	MOP_PUSH_PCH,				// push the high byte of the program counter
+	MOP_PUSH_PCL,				// push the low byte of the program counter
+	MOP_PUSH_END,				// push the selected register
+	MOP_POP_A_END,				// pop the accumulator
+	MOP_POP_P_END,				// pop the status register (PLP)
+	MOP_POP_P_RTI,				// pop the status register (RTI)
+	MOP_POP_PCL,				// pop the low byte of the program counter
+	MOP_POP_PCH,				// pop the high byte of the program counter
+	MOP_POP_PCH_END,			// pop the high byte of the program counter and end the instruction
+
+	// branches
+	MOP_BRANCH_OFFSET,			// fetch the offset, stop if the branch isn't taken
+	MOP_BRANCH_ADD,				// add the offset to the program counter, stop if no page boundary was crossed
+	MOP_BRANCH_FIX,				// the high byte of the program counter was fixed
+
+	// BRK
+	MOP_BRK						// interrupt sequence
+} MICRO_OP_6502;
+
+typedef enum MICRO_OPERATION_6502 {
+	OPER_NONE = 0,
+
+	// operations on the operand / registers
+	OPER_ADC, OPER_AND, OPER_BIT, OPER_CMP, OPER_CPX, OPER_CPY, OPER_EOR, OPER_LDA, OPER_LDX, OPER_LDY, OPER_ORA, OPER_SBC,
+	OPER_ASL_A, OPER_LSR_A, OPER_ROL_A, OPER_ROR_A,
+	OPER_CLC, OPER_CLD, OPER_CLI, OPER_CLV, OPER_SEC, OPER_SED, OPER_SEI,
+	OPER_DEX, OPER_DEY, OPER_INX, OPER_INY,
+	OPER_TAX, OPER_TAY, OPER_TSX, OPER_TXA, OPER_TXS, OPER_TYA,
+
+	// read-modify-write operations
+	OPER_ASL, OPER_LSR, OPER_ROL, OPER_ROR, OPER_INC, OPER_DEC,
+
+	// register written to memory or pushed on the stack
+	OPER_STA, OPER_STX, OPER_STY, OPER_PHA, OPER_PHP,
+
+	// branch conditions
+	OPER_BCC, OPER_BCS, OPER_BEQ, OPER_BMI, OPER_BNE, OPER_BPL, OPER_BVC, OPER_BVS
+} MICRO_OPERATION_6502;
+
+typedef struct MicroProgram6502 {
+	uint8_t		op;					// MICRO_OPERATION_6502
+	uint8_t		cycles[7];			// MICRO_OP_6502 for the decode cycles following the opcode fetch
+} MicroProgram6502;
+
+#define MP_IMPLIED(o)	{o, {MOP_IMPLIED_EXEC}}
+#define MP_READ_IMM(o)	{o, {MOP_READ_IMM_EXEC}}
+#define MP_READ_ZP(o)	{o, {MOP_FETCH_ADL, MOP_READ_EXEC}}
+#define MP_READ_ZPX(o)	{o, {MOP_FETCH_ADL, MOP_ZP_INDEX_X, MOP_READ_EXEC}}
+#define MP_READ_ZPY(o)	{o, {MOP_FETCH_ADL, MOP_ZP_INDEX_Y, MOP_READ_EXEC}}
+#define MP_READ_ABS(o)	{o, {MOP_FETCH_ADL, MOP_FETCH_ADH, MOP_READ_EXEC}}
+#define MP_READ_ABSX(o)	{o, {MOP_FETCH_ADL, MOP_FETCH_ADH_X, MOP_READ_PAGE_CROSS_EXEC, MOP_READ_EXEC}}
+#define MP_READ_ABSY(o)	{o, {MOP_FETCH_ADL, MOP_FETCH_ADH_Y, MOP_READ_PAGE_CROSS_EXEC, MOP_READ_EXEC}}
+#define MP_READ_INDX(o)	{o, {MOP_FETCH_ZP_PTR, MOP_PTR_INDEX_X, MOP_PTR_ADL, MOP_PTR_ADH, MOP_READ_EXEC}}
+#define MP_READ_INDY(o)	{o, {MOP_FETCH_ZP_PTR, MOP_PTR_ADL, MOP_PTR_ADH_Y, MOP_READ_PAGE_CROSS_EXEC, MOP_READ_EXEC}}
+
+#define MP_WRITE_ZP(o)		{o, {MOP_FETCH_ADL, MOP_WRITE}}
+#define MP_WRITE_ZPX(o)		{o, {MOP_FETCH_ADL, MOP_ZP_INDEX_X, MOP_WRITE}}
+#define MP_WRITE_ZPY(o)		{o, {MOP_FETCH_ADL, MOP_ZP_INDEX_Y, MOP_WRITE}}
+#define MP_WRITE_ABS(o)		{o, {MOP_FETCH_ADL, MOP_FETCH_ADH, MOP_WRITE}}
+#define MP_WRITE_ABSX(o)	{o, {MOP_FETCH_ADL, MOP_FETCH_ADH_X, MOP_PAGE_CROSS_FIX, MOP_WRITE}}
+#define MP_WRITE_ABSY(o)	{o, {MOP_FETCH_ADL, MOP_FETCH_ADH_Y, MOP_PAGE_CROSS_FIX, MOP_WRITE}}
+#define MP_WRITE_INDX(o)	{o, {MOP_FETCH_ZP_PTR, MOP_PTR_INDEX_X, MOP_PTR_ADL, MOP_PTR_ADH, MOP_WRITE}}
+#define MP_WRITE_INDY(o)	{o, {MOP_FETCH_ZP_PTR, MOP_PTR_ADL, MOP_PTR_ADH_Y, MOP_PAGE_CROSS_FIX, MOP_WRITE}}
+
+#define MP_RMW_ZP(o)	{o, {MOP_FETCH_ADL, MOP_READ, MOP_RMW_MODIFY, MOP_RMW_WRITE}}
+#define MP_RMW_ZPX(o)	{o, {MOP_FETCH_ADL, MOP_ZP_INDEX_X, MOP_READ, MOP_RMW_MODIFY, MOP_RMW_WRITE}}
+#define MP_RMW_ABS(o)	{o, {MOP_FETCH_ADL, MOP_FETCH_ADH, MOP_READ, MOP_RMW_MODIFY, MOP_RMW_WRITE}}
+#define MP_RMW_ABSX(o)	{o, {MOP_FETCH_ADL, MOP_FETCH_ADH_X, MOP_PAGE_CROSS_FIX, MOP_READ, MOP_RMW_MODIFY, MOP_RMW_WRITE}}
+
+#define MP_BRANCH(o)	{o, {MOP_BRANCH_OFFSET, MOP_BRANCH_ADD, MOP_BRANCH_FIX}}
+
+#define MP_GROUP1(name, o)										\
+	[OP_6502_##name##_IMM]	= MP_READ_IMM(o),					\
+	[OP_6502_##name##_ZP]	= MP_READ_ZP(o),					\
+	[OP_6502_##name##_ZPX]	= MP_READ_ZPX(o),					\
+	[OP_6502_##name##_ABS]	= MP_READ_ABS(o),					\
+	[OP_6502_##name##_ABSX]	= MP_READ_ABSX(o),					\
+	[OP_6502_##name##_ABSY]	= MP_READ_ABSY(o),					\
+	[OP_6502_##name##_INDX]	= MP_READ_INDX(o),					\
+	[OP_6502_##name##_INDY]	= MP_READ_INDY(o)
+
+#define MP_SHIFT(name, o)										\
+	[OP_6502_##name##_ACC]	= MP_IMPLIED(o##_A),				\
+	[OP_6502_##name##_ZP]	= MP_RMW_ZP(o),						\
+	[OP_6502_##name##_ZPX]	= MP_RMW_ZPX(o),					\
+	[OP_6502_##name##_ABS]	= MP_RMW_ABS(o),					\
+	[OP_6502_##name##_ABSX]	= MP_RMW_ABSX(o)
+
+// opcodes without an entry are undefined (MOP_JAM)
+static const MicroProgram6502 MICRO_PROGRAMS[256] = {
+	MP_GROUP1(ADC, OPER_ADC),
+	MP_GROUP1(AND, OPER_AND),
+	MP_GROUP1(CMP, OPER_CMP),
+	MP_GROUP1(EOR, OPER_EOR),
+	MP_GROUP1(LDA, OPER_LDA),
+	MP_GROUP1(ORA, OPER_ORA),
+	MP_GROUP1(SBC, OPER_SBC),
+
+	MP_SHIFT(ASL, OPER_ASL),
+	MP_SHIFT(LSR, OPER_LSR),
+	MP_SHIFT(ROL, OPER_ROL),
+	MP_SHIFT(ROR, OPER_ROR),
+
+	[OP_6502_BIT_ZP]	= MP_READ_ZP(OPER_BIT),
+	[OP_6502_BIT_ABS]	= MP_READ_ABS(OPER_BIT),
+
+	[OP_6502_CPX_IMM]	= MP_READ_IMM(OPER_CPX),
+	[OP_6502_CPX_ZP]	= MP_READ_ZP(OPER_CPX),
+	[OP_6502_CPX_ABS]	= MP_READ_ABS(OPER_CPX),
+	[OP_6502_CPY_IMM]	= MP_READ_IMM(OPER_CPY),
+	[OP_6502_CPY_ZP]	= MP_READ_ZP(OPER_CPY),
+	[OP_6502_CPY_ABS]	= MP_READ_ABS(OPER_CPY),
+
+	[OP_6502_LDX_IMM]	= MP_READ_IMM(OPER_LDX),
+	[OP_6502_LDX_ZP]	= MP_READ_ZP(OPER_LDX),
+	[OP_6502_LDX_ZPY]	= MP_READ_ZPY(OPER_LDX),
+	[OP_6502_LDX_ABS]	= MP_READ_ABS(OPER_LDX),
+	[OP_6502_LDX_ABSY]	= MP_READ_ABSY(OPER_LDX),
+	[OP_6502_LDY_IMM]	= MP_READ_IMM(OPER_LDY),
+	[OP_6502_LDY_ZP]	= MP_READ_ZP(OPER_LDY),
+	[OP_6502_LDY_ZPX]	= MP_READ_ZPX(OPER_LDY),
+	[OP_6502_LDY_ABS]	= MP_READ_ABS(OPER_LDY),
+	[OP_6502_LDY_ABSX]	= MP_READ_ABSX(OPER_LDY),
+
+	[OP_6502_DEC_ZP]	= MP_RMW_ZP(OPER_DEC),
+	[OP_6502_DEC_ZPX]	= MP_RMW_ZPX(OPER_DEC),
+	[OP_6502_DEC_ABS]	= MP_RMW_ABS(OPER_DEC),
+	[OP_6502_DEC_ABSX]	= MP_RMW_ABSX(OPER_DEC),
+	[OP_6502_INC_ZP]	= MP_RMW_ZP(OPER_INC),
+	[OP_6502_INC_ZPX]	= MP_RMW_ZPX(OPER_INC),
+	[OP_6502_INC_ABS]	= MP_RMW_ABS(OPER_INC),
+	[OP_6502_INC_ABSX]	= MP_RMW_ABSX(OPER_INC),
+
+	[OP_6502_STA_ZP]	= MP_WRITE_ZP(OPER_STA),
+	[OP_6502_STA_ZPX]	= MP_WRITE_ZPX(OPER_STA),
+	[OP_6502_STA_ABS]	= MP_WRITE_ABS(OPER_STA),
+	[OP_6502_STA_ABSX]	= MP_WRITE_ABSX(OPER_STA),
+	[OP_6502_STA_ABSY]	= MP_WRITE_ABSY(OPER_STA),
+	[OP_6502_STA_INDX]	= MP_WRITE_INDX(OPER_STA),
+	[OP_6502_STA_INDY]	= MP_WRITE_INDY(OPER_STA),
+	[OP_6502_STX_ZP]	= MP_WRITE_ZP(OPER_STX),
+	[OP_6502_STX_ZPY]	= MP_WRITE_ZPY(OPER_STX),
+	[OP_6502_STX_ABS]	= MP_WRITE_ABS(OPER_STX),
+	[OP_6502_STY_ZP]	= MP_WRITE_ZP(OPER_STY),
+	[OP_6502_STY_ZPX]	= MP_WRITE_ZPX(OPER_STY),
+	[OP_6502_STY_ABS]	= MP_WRITE_ABS(OPER_STY),
+
+	[OP_6502_BCC]		= MP_BRANCH(OPER_BCC),
+	[OP_6502_BCS]		= MP_BRANCH(OPER_BCS),
+	[OP_6502_BEQ]		= MP_BRANCH(OPER_BEQ),
+	[OP_6502_BMI]		= MP_BRANCH(OPER_BMI),
+	[OP_6502_BNE]		= MP_BRANCH(OPER_BNE),
+	[OP_6502_BPL]		= MP_BRANCH(OPER_BPL),
+	[OP_6502_BVC]		= MP_BRANCH(OPER_BVC),
+	[OP_6502_BVS]		= MP_BRANCH(OPER_BVS),
+
+	[OP_6502_CLC]		= MP_IMPLIED(OPER_CLC),
+	[OP_6502_CLD]		= MP_IMPLIED(OPER_CLD),
+	[OP_6502_CLI]		= MP_IMPLIED(OPER_CLI),
+	[OP_6502_CLV]		= MP_IMPLIED(OPER_CLV),
+	[OP_6502_SEC]		= MP_IMPLIED(OPER_SEC),
+	[OP_6502_SED]		= MP_IMPLIED(OPER_SED),
+	[OP_6502_SEI]		= MP_IMPLIED(OPER_SEI),
+	[OP_6502_DEX]		= MP_IMPLIED(OPER_DEX),
+	[OP_6502_DEY]		= MP_IMPLIED(OPER_DEY),
+	[OP_6502_INX]		= MP_IMPLIED(OPER_INX),
+	[OP_6502_INY]		= MP_IMPLIED(OPER_INY),
+	[OP_6502_TAX]		= MP_IMPLIED(OPER_TAX),
+	[OP_6502_TAY]		= MP_IMPLIED(OPER_TAY),
+	[OP_6502_TSX]		= MP_IMPLIED(OPER_TSX),
+	[OP_6502_TXA]		= MP_IMPLIED(OPER_TXA),
+	[OP_6502_TXS]		= MP_IMPLIED(OPER_TXS),
+	[OP_6502_TYA]		= MP_IMPLIED(OPER_TYA),
+	[OP_6502_NOP]		= MP_IMPLIED(OPER_NONE),
+
+	[OP_6502_JMP_ABS]	= {OPER_NONE, {MOP_FETCH_ADL, MOP_JMP_ADH}},
+	[OP_6502_JMP_IND]	= {OPER_NONE, {MOP_FETCH_IAL, MOP_FETCH_IAH, MOP_IND_ADL, MOP_IND_ADH_JMP}},
+	[OP_6502_JSR]		= {OPER_NONE, {MOP_FETCH_ADL, MOP_STACK_PEEK, MOP_PUSH_PCH, MOP_PUSH_PCL, MOP_JMP_ADH}},
+	[OP_6502_RTS]		= {OPER_NONE, {MOP_FETCH_PC_DISCARD, MOP_STACK_PEEK, MOP_POP_PCL, MOP_POP_PCH, MOP_FETCH_PC_END}},
+	[OP_6502_RTI]		= {OPER_NONE, {MOP_FETCH_PC_DISCARD, MOP_STACK_PEEK, MOP_POP_P_RTI, MOP_POP_PCL, MOP_POP_PCH_END}},
+	[OP_6502_BRK]		= {OPER_NONE, {MOP_BRK, MOP_BRK, MOP_BRK, MOP_BRK, MOP_BRK, MOP_BRK}},
+
+	[OP_6502_PHA]		= {OPER_PHA, {MOP_READ_PC_DISCARD, MOP_PUSH_END}},
+	[OP_6502_PHP]		= {OPER_PHP, {MOP_READ_PC_DISCARD, MOP_PUSH_END}},
+	[OP_6502_PLA]		= {OPER_NONE, {MOP_READ_PC_DISCARD, MOP_STACK_PEEK, MOP_POP_A_END}},
+	[OP_6502_PLP]		= {OPER_NONE, {MOP_READ_PC_DISCARD, MOP_STACK_PEEK, MOP_POP_P_END}},
+};
 
-	switch (phase) {
-		case CYCLE_BEGIN:
-			PRIVATE(cpu)->addr.hi_byte = 0;
-			PRIVATE(cpu)->output.address = PRIVATE(cpu)->addr.full;
-			break;
-		case CYCLE_MIDDLE:
-			break;
-		case CYCLE_END:
-			PRIVATE(cpu)->addr.lo_byte = (uint8_t) (PRIVATE(cpu)->addr.lo_byte + index);
-			break;
-	};
+static inline void set_flags_zn(Cpu6502 *cpu, uint8_t value) {
+	CPU_CHANGE_FLAG(Z, value == 0);
+	CPU_CHANGE_FLAG(N, BIT_IS_SET(value, 7));
 }
 
-static inline void fetch_high_byte_address_indexed(Cpu6502 *cpu, uint8_t index, CPU_6502_CYCLE phase) {
-// utility function for indexed absolute addressed memory accesses
-// fetch high byte of address while adding the offset to the low byte
-
-	assert(cpu);
-
-	switch (phase) {
-		case CYCLE_BEGIN:
-			PRIVATE(cpu)->addr.hi_byte = 0;
-			PRIVATE(cpu)->output.address = cpu->reg_pc;
-			break;
-		case CYCLE_MIDDLE:
-			PRIVATE(cpu)->addr.full = (uint16_t) (PRIVATE(cpu)->addr.full + index);
-			PRIVATE(cpu)->page_crossed = PRIVATE(cpu)->addr.hi_byte > 0;
-			break;
-		case CYCLE_END:
-			PRIVATE(cpu)->addr.hi_byte = PRIVATE(cpu)->in_data;
-			++cpu->reg_pc;
-			break;
-	};
+static inline void compare(Cpu6502 *cpu, uint8_t reg) {
+	int8_t result = (int8_t) (reg - PRIVATE(cpu)->operand);
+	CPU_CHANGE_FLAG(Z, result == 0);
+	CPU_CHANGE_FLAG(N, BIT_IS_SET(result, 7));
+	CPU_CHANGE_FLAG(C, reg >= PRIVATE(cpu)->operand);
 }
 
-static inline bool fetch_memory_page_crossed(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	assert(cpu);
+static inline void calculate_adc_decimal(Cpu6502 *cpu) {
+/* ADC (and SBC) effect the C/N/V/Z-flags, even in decimal mode. On a 6502 only the carry is supported and valid.
+   But the other flags are still affected, we do are best to emulate this behaviour.
+   Many thanks go to Bruce Clark, for his excellent explanation of the decimal mode of the 6502 (see: http://www.6502.org/tutorials/decimal_mode.html)
+   and the accompanying test program.
+*/
+	int carry = FLAG_IS_SET(cpu->reg_p, FLAG_6502_CARRY);
+	int bin_result = cpu->reg_a + PRIVATE(cpu)->operand + carry;
 
-	switch (phase) {
-		case CYCLE_BEGIN:
-			PRIVATE(cpu)->output.address = PRIVATE(cpu)->addr.full;
-			return false;
-		case CYCLE_MIDDLE:
-			PRIVATE(cpu)->addr.hi_byte = (uint8_t) (PRIVATE(cpu)->addr.hi_byte + PRIVATE(cpu)->page_crossed);
-			return false;
-		case CYCLE_END:
-			PRIVATE(cpu)->operand = PRIVATE(cpu)->in_data;
-			return !PRIVATE(cpu)->page_crossed;
-	};
+	int al = (cpu->reg_a & 0x0f) + (PRIVATE(cpu)->operand & 0x0f) + carry;
+	if (al >= 0x0a) {
+		al = ((al + 0x06) & 0x0f) + 0x10;
+	}
+	int a_seq1 = (cpu->reg_a & 0xf0) + (PRIVATE(cpu)->operand & 0xf0) + al;
+	if (a_seq1 >= 0xa0) {
+		a_seq1 += 0x60;
+	}
 
-	return false;
-}
+	int a_seq2 = (int8_t) (cpu->reg_a & 0xf0) + (int8_t) (PRIVATE(cpu)->operand & 0xf0) + al;
 
-static inline void fetch_pc_memory(Cpu6502 *cpu, uint8_t *dst, CPU_6502_CYCLE phase) {
-	assert(cpu);
-	assert(dst);
+	cpu->reg_a = (uint8_t) (a_seq1 & 0x00ff);
+	CPU_CHANGE_FLAG(C, a_seq1 >= 0x0100);
+	CPU_CHANGE_FLAG(V, (a_seq2 < -128) || (a_seq2 > 127));
+	CPU_CHANGE_FLAG(Z, (bin_result & 0xff) == 0x00);
+	CPU_CHANGE_FLAG(N, BIT_IS_SET(a_seq2, 7));
+}
 
-	switch (phase) {
-		case CYCLE_BEGIN :
-			PRIVATE(cpu)->output.address = cpu->reg_pc;
-			break;
-		case CYCLE_MIDDLE:
-			break;
-		case CYCLE_END :
-			*dst = PRIVATE(cpu)->in_data;
-			++cpu->reg_pc;
-			break;
+static inline void calculate_adc(Cpu6502 *cpu) {
+	if (!FLAG_IS_SET(cpu->reg_p, FLAG_6502_DECIMAL_MODE)) {
+		int carry = FLAG_IS_SET(cpu->reg_p, FLAG_6502_CARRY);
+		int s_result = (int8_t) cpu->reg_a + (int8_t) PRIVATE(cpu)->operand + carry;
+		int u_result = cpu->reg_a + PRIVATE(cpu)->operand + carry;
+		cpu->reg_a = (uint8_t) (u_result & 0x00ff);
+		CPU_CHANGE_FLAG(C, BIT_IS_SET(u_result, 8));
+		CPU_CHANGE_FLAG(V, (s_result < -128) || (s_result > 127));
+		CPU_CHANGE_FLAG(Z, cpu->reg_a == 0);
+		CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_a, 7));
+	} else {
+		calculate_adc_decimal(cpu);
 	}
 }
 
-static inline int fetch_address_immediate(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	assert(cpu);
+static inline void calculate_sbc(Cpu6502 *cpu) {
+	// on a 6502 the C/N/V/Z-flags are set using the binary mode computation.
+	int carry = FLAG_IS_SET(cpu->reg_p, FLAG_6502_CARRY);
+	int u_result = cpu->reg_a + (uint8_t) ~PRIVATE(cpu)->operand + carry;
+	int s_result = (int8_t) cpu->reg_a - (int8_t) PRIVATE(cpu)->operand - !carry;
 
-	if (PRIVATE(cpu)->decode_cycle == 1) {
-		switch (phase) {
-			case CYCLE_BEGIN :
-				PRIVATE(cpu)->addr.full = cpu->reg_pc;
-				break;
-			case CYCLE_MIDDLE:
-				break;
-			case CYCLE_END :
-				++cpu->reg_pc;
-				break;
+	if (!FLAG_IS_SET(cpu->reg_p, FLAG_6502_DECIMAL_MODE)) {
+		cpu->reg_a = (uint8_t) (u_result & 0x00ff);
+	} else {
+		int al = (cpu->reg_a & 0x0f) - (PRIVATE(cpu)->operand & 0x0f) + carry - 1;
+		if (al < 0) {
+			al = ((al - 0x06) & 0x0f) - 0x10;
+		}
+		int a_seq3 = (cpu->reg_a & 0xf0) - (PRIVATE(cpu)->operand & 0xf0) + al;
+		if (a_seq3 < 0) {
+			a_seq3 -= 0x60;
 		}
+		cpu->reg_a = (uint8_t) (a_seq3 & 0x00ff);
 	}
 
-	return 1;
+	CPU_CHANGE_FLAG(C, BIT_IS_SET(u_result, 8));
+	CPU_CHANGE_FLAG(V, (s_result < -128) || (s_result > 127));
+	CPU_CHANGE_FLAG(Z, (u_result & 0x00ff) == 0);
+	CPU_CHANGE_FLAG(N, BIT_IS_SET(u_result, 7));
 }
 
-static inline int fetch_address_zeropage(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1 :		// fetch address - low byte
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->addr.lo_byte, phase);
-			PRIVATE(cpu)->addr.hi_byte = 0;
-			break;
-	};
+static inline uint8_t shift_left(Cpu6502 *cpu, uint8_t value, int carry_in) {
+	CPU_CHANGE_FLAG(C, BIT_IS_SET(value, 7));
+	return (uint8_t) ((value << 1) | carry_in);
+}
 
-	return 2;
+static inline uint8_t shift_right(Cpu6502 *cpu, uint8_t value, int carry_in) {
+	CPU_CHANGE_FLAG(C, BIT_IS_SET(value, 0));
+	return (uint8_t) ((value >> 1) | (carry_in << 7));
 }
 
-static inline int fetch_address_zeropage_indexed(Cpu6502 *cpu, CPU_6502_CYCLE phase, uint8_t index) {
+static inline void execute_operation(Cpu6502 *cpu, uint8_t op) {
+	Cpu6502_private *priv = PRIVATE(cpu);
+	int carry = FLAG_IS_SET(cpu->reg_p, FLAG_6502_CARRY);
 
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1 :		// fetch address - low byte
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->addr.lo_byte, phase);
+	switch (op) {
+		case OPER_ADC:
+			calculate_adc(cpu);
 			break;
-		case 2 :		// fetch discarded data & add addr.lo_byte + offset
-			fetch_zp_discard_add(cpu, index, phase);
+		case OPER_AND:
+			cpu->reg_a = cpu->reg_a & priv->operand;
+			set_flags_zn(cpu, cpu->reg_a);
 			break;
-	};
-
-	return 3;
-}
-
-static inline int fetch_address_absolute(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1 :		// fetch address - low byte
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->addr.lo_byte, phase);
+		case OPER_BIT:
+			CPU_CHANGE_FLAG(N, BIT_IS_SET(priv->operand, 7));
+			CPU_CHANGE_FLAG(V, BIT_IS_SET(priv->operand, 6));
+			CPU_CHANGE_FLAG(Z, (priv->operand & cpu->reg_a) == 0);
 			break;
-		case 2 :		// fetch address - high byte
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->addr.hi_byte, phase);
+		case OPER_CMP:
+			compare(cpu, cpu->reg_a);
 			break;
-	};
-
-	return 3;
-}
-
-static inline int fetch_address_absolute_indexed_shortcut(Cpu6502 *cpu, CPU_6502_CYCLE phase, uint8_t index) {
-// cycle count depends on the value of the base adress and the index:
-//	- if a page boundary is crossed (low-byte of address + index > 0xff) then it takes 5 cycles
-//	- if no page boundary is crossed only 4 cycles are required
-
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1 :		// fetch address - low byte
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->addr.lo_byte, phase);
+		case OPER_CPX:
+			compare(cpu, cpu->reg_x);
 			break;
-		case 2 :		// fetch address - high byte & add addr.lo_byte + index
-			fetch_high_byte_address_indexed(cpu, index, phase);
+		case OPER_CPY:
+			compare(cpu, cpu->reg_y);
 			break;
-		case 3:			// fetch operand + add BAH + carry
-			fetch_memory_page_crossed(cpu, phase);
+		case OPER_EOR:
+			cpu->reg_a = cpu->reg_a ^ priv->operand;
+			set_flags_zn(cpu, cpu->reg_a);
 			break;
-	};
-
-	return 3 + PRIVATE(cpu)->page_crossed;
-}
-
-static inline int fetch_address_absolute_indexed(Cpu6502 *cpu, CPU_6502_CYCLE phase, uint8_t index) {
-// no lookup-ahead (or shortcut) when the indexing does not case page crossing
-//	used for operations that write to memory
-
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1 :		// fetch address - low byte
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->addr.lo_byte, phase);
+		case OPER_LDA:
+			cpu->reg_a = priv->operand;
+			set_flags_zn(cpu, cpu->reg_a);
 			break;
-		case 2 :		// fetch address - high byte & add addr.lo_byte + index
-			fetch_high_byte_address_indexed(cpu, index, phase);
+		case OPER_LDX:
+			cpu->reg_x = priv->operand;
+			set_flags_zn(cpu, cpu->reg_x);
 			break;
-		case 3:			// fetch operand + add BAH + carry
-			fetch_memory_page_crossed(cpu, phase);
+		case OPER_LDY:
+			cpu->reg_y = priv->operand;
+			set_flags_zn(cpu, cpu->reg_y);
+			break;
+		case OPER_ORA:
+			cpu->reg_a = cpu->reg_a | priv->operand;
+			set_flags_zn(cpu, cpu->reg_a);
+			break;
+		case OPER_SBC:
+			calculate_sbc(cpu);
 			break;
-	};
-
-	return 4;
-}
-
-
-static inline int fetch_address_indirect(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
 
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1 :		// fetch indirect address - low byte
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->i_addr.lo_byte, phase);
+		case OPER_ASL_A:
+			cpu->reg_a = shift_left(cpu, cpu->reg_a, 0);
+			set_flags_zn(cpu, cpu->reg_a);
 			break;
-		case 2 :		// fetch indirect address - high byte
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->i_addr.hi_byte, phase);
+		case OPER_LSR_A:
+			cpu->reg_a = shift_right(cpu, cpu->reg_a, 0);
+			set_flags_zn(cpu, cpu->reg_a);
 			break;
-		case 3 :		// fetch jump address - low byte
-			fetch_memory(cpu, PRIVATE(cpu)->i_addr.full, &PRIVATE(cpu)->addr.lo_byte, phase);
-			INC_UINT16(PRIVATE(cpu)->i_addr.full, (phase == CYCLE_END));
+		case OPER_ROL_A:
+			cpu->reg_a = shift_left(cpu, cpu->reg_a, carry);
+			set_flags_zn(cpu, cpu->reg_a);
 			break;
-		case 4 :		// fetch jump address - high byte
-			fetch_memory(cpu, PRIVATE(cpu)->i_addr.full, &PRIVATE(cpu)->addr.hi_byte, phase);
+		case OPER_ROR_A:
+			cpu->reg_a = shift_right(cpu, cpu->reg_a, carry);
+			set_flags_zn(cpu, cpu->reg_a);
 			break;
-	}
-
-	return 5;
-}
-
-static inline int fetch_address_indexed_indirect(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
 
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1 :		// fetch zero page address
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->operand, phase);
+		case OPER_CLC:
+			CPU_CHANGE_FLAG(C, false);
 			break;
-		case 2 :		// fetch discard memory & add zp + index-x
-			fetch_memory(cpu, PRIVATE(cpu)->operand, &PRIVATE(cpu)->addr.lo_byte, phase);
-			if (phase == CYCLE_END) {
-				INC_UINT8(PRIVATE(cpu)->operand, cpu->reg_x);
-			}
+		case OPER_CLD:
+			CPU_CHANGE_FLAG(D, false);
 			break;
-		case 3:			// fetch address - low byte & increment zp + index-x
-			fetch_memory(cpu, PRIVATE(cpu)->operand, &PRIVATE(cpu)->addr.lo_byte, phase);
-			if (phase == CYCLE_END) {
-				PRIVATE(cpu)->operand++;
-			}
+		case OPER_CLI:
+			CPU_CHANGE_FLAG(I, false);
 			break;
-		case 4:			// fetch address - high byte
-			fetch_memory(cpu, PRIVATE(cpu)->operand, &PRIVATE(cpu)->addr.hi_byte, phase);
+		case OPER_CLV:
+			CPU_CHANGE_FLAG(V, false);
+			break;
+		case OPER_SEC:
+			CPU_CHANGE_FLAG(C, true);
+			break;
+		case OPER_SED:
+			CPU_CHANGE_FLAG(D, true);
+			break;
+		case OPER_SEI:
+			CPU_CHANGE_FLAG(I, true);
 			break;
-	}
-
-	return 5;
-}
-
-static inline int fetch_address_indirect_indexed_shortcut(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
 
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1 :		// fetch zero page address
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->operand, phase);
+		case OPER_DEX:
+			cpu->reg_x--;
+			set_flags_zn(cpu, cpu->reg_x);
 			break;
-		case 2 :		// fetch address - low byte & increment zp
-			fetch_memory(cpu, PRIVATE(cpu)->operand, &PRIVATE(cpu)->addr.lo_byte, phase);
-			if (phase == CYCLE_END) {
-				PRIVATE(cpu)->operand++;
-			}
+		case OPER_DEY:
+			cpu->reg_y--;
+			set_flags_zn(cpu, cpu->reg_y);
 			break;
-		case 3 :		// fetch address - high byte & add addr.lo_byte + y
-			fetch_memory(cpu, PRIVATE(cpu)->operand, &PRIVATE(cpu)->addr.hi_byte, phase);
-			if (phase == CYCLE_END) {
-				PRIVATE(cpu)->page_crossed = PRIVATE(cpu)->addr.lo_byte + cpu->reg_y > 255;
-				INC_UINT8(PRIVATE(cpu)->addr.lo_byte, cpu->reg_y);
-			}
+		case OPER_INX:
+			cpu->reg_x++;
+			set_flags_zn(cpu, cpu->reg_x);
 			break;
-		case 4 :
-			fetch_memory(cpu, PRIVATE(cpu)->addr.full, &PRIVATE(cpu)->operand, phase);
-			if (phase == CYCLE_END) {
-				INC_UINT8(PRIVATE(cpu)->addr.hi_byte, PRIVATE(cpu)->page_crossed);
-			}
+		case OPER_INY:
+			cpu->reg_y++;
+			set_flags_zn(cpu, cpu->reg_y);
 			break;
-	}
-
-	return 4 + PRIVATE(cpu)->page_crossed;
-}
 
-static inline int fetch_address_indirect_indexed(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
+		case OPER_TAX:
+			cpu->reg_x = cpu->reg_a;
+			set_flags_zn(cpu, cpu->reg_x);
+			break;
+		case OPER_TAY:
+			cpu->reg_y = cpu->reg_a;
+			set_flags_zn(cpu, cpu->reg_y);
+			break;
+		case OPER_TSX:
+			cpu->reg_x = cpu->reg_sp;
+			set_flags_zn(cpu, cpu->reg_x);
+			break;
+		case OPER_TXA:
+			cpu->reg_a = cpu->reg_x;
+			set_flags_zn(cpu, cpu->reg_a);
+			break;
+		case OPER_TXS:
+			cpu->reg_sp = cpu->reg_x;
+			break;
+		case OPER_TYA:
+			cpu->reg_a = cpu->reg_y;
+			set_flags_zn(cpu, cpu->reg_a);
+			break;
 
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1 :		// fetch zero page address
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->operand, phase);
+		// read-modify-write: the flags Z/N are set when the result is written
+		case OPER_ASL:
+			priv->operand = shift_left(cpu, priv->operand, 0);
 			break;
-		case 2 :		// fetch address - low byte & increment zp
-			fetch_memory(cpu, PRIVATE(cpu)->operand, &PRIVATE(cpu)->addr.lo_byte, phase);
-			if (phase == CYCLE_END) {
-				PRIVATE(cpu)->operand++;
-			}
+		case OPER_LSR:
+			priv->operand = shift_right(cpu, priv->operand, 0);
 			break;
-		case 3 :		// fetch address - high byte & add addr.lo_byte + y
-			fetch_memory(cpu, PRIVATE(cpu)->operand, &PRIVATE(cpu)->addr.hi_byte, phase);
-			if (phase == CYCLE_END) {
-				PRIVATE(cpu)->page_crossed = PRIVATE(cpu)->addr.lo_byte + cpu->reg_y > 255;
-				INC_UINT8(PRIVATE(cpu)->addr.lo_byte, cpu->reg_y);
-			}
+		case OPER_ROL:
+			priv->operand = shift_left(cpu, priv->operand, carry);
 			break;
-		case 4 :
-			fetch_memory(cpu, PRIVATE(cpu)->addr.full, &PRIVATE(cpu)->operand, phase);
-			if (phase == CYCLE_END) {
-				INC_UINT8(PRIVATE(cpu)->addr.hi_byte, PRIVATE(cpu)->page_crossed);
-			}
+		case OPER_ROR:
+			priv->operand = shift_right(cpu, priv->operand, carry);
+			break;
+		case OPER_INC:
+			priv->operand++;
+			break;
+		case OPER_DEC:
+			priv->operand--;
 			break;
 	}
-
-	return 5;
-}
-
-static inline int fetch_address_shortcut(Cpu6502 *cpu, ADDRESSING_MODE_6502 mode, CPU_6502_CYCLE phase) {
-
-	switch (mode) {
-		case AM_6502_IMMEDIATE:
-			return fetch_address_immediate(cpu, phase);
-		case AM_6502_ZEROPAGE:
-			return fetch_address_zeropage(cpu, phase);
-		case AM_6502_ZEROPAGE_X:
-			return fetch_address_zeropage_indexed(cpu, phase, cpu->reg_x);
-		case AM_6502_ZEROPAGE_Y:
-			return fetch_address_zeropage_indexed(cpu, phase, cpu->reg_y);
-		case AM_6502_ABSOLUTE:
-			return fetch_address_absolute(cpu, phase);
-		case AM_6502_ABSOLUTE_X:
-			return fetch_address_absolute_indexed_shortcut(cpu, phase, cpu->reg_x);
-		case AM_6502_ABSOLUTE_Y:
-			return fetch_address_absolute_indexed_shortcut(cpu, phase, cpu->reg_y);
-		case AM_6502_INDIRECT:
-			return fetch_address_indirect(cpu, phase);
-		case AM_6502_INDIRECT_X:
-			return fetch_address_indexed_indirect(cpu, phase);
-		case AM_6502_INDIRECT_Y:
-			return fetch_address_indirect_indexed_shortcut(cpu, phase);
-		default:
-			return 0;
-	};
 }
 
-static inline int fetch_address(Cpu6502 *cpu, ADDRESSING_MODE_6502 mode, CPU_6502_CYCLE phase) {
-
-	switch (mode) {
-		case AM_6502_IMMEDIATE:
-			return fetch_address_immediate(cpu, phase);
-		case AM_6502_ZEROPAGE:
-			return fetch_address_zeropage(cpu, phase);
-		case AM_6502_ZEROPAGE_X:
-			return fetch_address_zeropage_indexed(cpu, phase, cpu->reg_x);
-		case AM_6502_ZEROPAGE_Y:
-			return fetch_address_zeropage_indexed(cpu, phase, cpu->reg_y);
-		case AM_6502_ABSOLUTE:
-			return fetch_address_absolute(cpu, phase);
-		case AM_6502_ABSOLUTE_X:
-			return fetch_address_absolute_indexed(cpu, phase, cpu->reg_x);
-		case AM_6502_ABSOLUTE_Y:
-			return fetch_address_absolute_indexed(cpu, phase, cpu->reg_y);
-		case AM_6502_INDIRECT:
-			return fetch_address_indirect(cpu, phase);
-		case AM_6502_INDIRECT_X:
-			return fetch_address_indexed_indirect(cpu, phase);
-		case AM_6502_INDIRECT_Y:
-			return fetch_address_indirect_indexed(cpu, phase);
+static inline uint8_t operation_register(Cpu6502 *cpu, uint8_t op) {
+	switch (op) {
+		case OPER_STA:
+		case OPER_PHA:
+			return cpu->reg_a;
+		case OPER_STX:
+			return cpu->reg_x;
+		case OPER_STY:
+			return cpu->reg_y;
+		case OPER_PHP:
+			// apparently the break bit is also set by PHP
+			// (I didn't see that mentioned in the programming manual, or I missed it, but several online resources mention this.)
+			return cpu->reg_p | FLAG_6502_BREAK_COMMAND;
 		default:
 			return 0;
-	};
-}
-
-static inline bool fetch_operand(Cpu6502 *cpu, ADDRESSING_MODE_6502 mode, CPU_6502_CYCLE phase) {
-
-	bool result = false;
-
-	int memop_cycle = fetch_address_shortcut(cpu, mode, phase);
-
-	if (memop_cycle == PRIVATE(cpu)->decode_cycle) {
-		fetch_memory(cpu, PRIVATE(cpu)->addr.full, &PRIVATE(cpu)->operand, phase);
-		result = phase == CYCLE_END;
 	}
-
-	return result;
-}
-
-static inline bool fetch_operand_g1(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	return fetch_operand(cpu, (cpu->reg_ir & ADDR_6502_MASK) >> 2, phase);
 }
 
-static inline bool store_to_memory(Cpu6502 *cpu, uint8_t value, ADDRESSING_MODE_6502 mode, CPU_6502_CYCLE phase) {
-
-	bool result = false;
-
-	int memop_cycle = fetch_address(cpu, mode, phase);
-
-	if (memop_cycle == PRIVATE(cpu)->decode_cycle) {
-		store_memory(cpu, PRIVATE(cpu)->addr.full, value, phase);
-		result = phase == CYCLE_END;
+static inline bool branch_taken(Cpu6502 *cpu, uint8_t op) {
+	switch (op) {
+		case OPER_BCC:	return !FLAG_IS_SET(cpu->reg_p, FLAG_6502_CARRY);
+		case OPER_BCS:	return FLAG_IS_SET(cpu->reg_p, FLAG_6502_CARRY);
+		case OPER_BEQ:	return FLAG_IS_SET(cpu->reg_p, FLAG_6502_ZERO_RESULT);
+		case OPER_BMI:	return FLAG_IS_SET(cpu->reg_p, FLAG_6502_NEGATIVE_RESULT);
+		case OPER_BNE:	return !FLAG_IS_SET(cpu->reg_p, FLAG_6502_ZERO_RESULT);
+		case OPER_BPL:	return !FLAG_IS_SET(cpu->reg_p, FLAG_6502_NEGATIVE_RESULT);
+		case OPER_BVC:	return !FLAG_IS_SET(cpu->reg_p, FLAG_6502_OVERFLOW);
+		case OPER_BVS:	return FLAG_IS_SET(cpu->reg_p, FLAG_6502_OVERFLOW);
+		default:		return false;
+	}
+}
+
+static inline void index_address(Cpu6502_private *priv, uint8_t index) {
+	priv->page_crossed = priv->addr.lo_byte + index > 0xff;
+	INC_UINT8(priv->addr.lo_byte, index);
+}
+
+static inline void micro_op_begin(Cpu6502 *cpu, uint8_t mop) {
+	Cpu6502_private *priv = PRIVATE(cpu);
+
+	switch (mop) {
+		case MOP_FETCH_ADL:
+		case MOP_FETCH_ADH:
+		case MOP_FETCH_ADH_X:
+		case MOP_FETCH_ADH_Y:
+		case MOP_FETCH_ZP_PTR:
+		case MOP_IMPLIED_EXEC:
+		case MOP_READ_PC_DISCARD:
+		case MOP_FETCH_PC_DISCARD:
+		case MOP_FETCH_PC_END:
+		case MOP_FETCH_IAL:
+		case MOP_FETCH_IAH:
+		case MOP_JMP_ADH:
+		case MOP_BRANCH_OFFSET:
+			priv->output.address = cpu->reg_pc;
+			break;
+		case MOP_READ_IMM_EXEC:
+			priv->addr.full = cpu->reg_pc;
+			priv->output.address = cpu->reg_pc;
+			break;
+		case MOP_ZP_INDEX_X:
+		case MOP_ZP_INDEX_Y:
+			priv->addr.hi_byte = 0;
+			priv->output.address = priv->addr.full;
+			break;
+		case MOP_PTR_INDEX_X:
+		case MOP_PTR_ADL:
+		case MOP_PTR_ADH:
+		case MOP_PTR_ADH_Y:
+			priv->output.address = priv->operand;
+			break;
+		case MOP_PAGE_CROSS_FIX:
+		case MOP_READ:
+		case MOP_READ_EXEC:
+		case MOP_READ_PAGE_CROSS_EXEC:
+			priv->output.address = priv->addr.full;
+			break;
+		case MOP_WRITE:
+			priv->output.address = priv->addr.full;
+			priv->output.rw = RW_WRITE;
+			break;
+		case MOP_IND_ADL:
+		case MOP_IND_ADH_JMP:
+			priv->output.address = priv->i_addr.full;
+			break;
+		case MOP_STACK_PEEK:
+			priv->output.address = MAKE_WORD(0x01, cpu->reg_sp);
+			break;
+		case MOP_PUSH_PCH:
+		case MOP_PUSH_PCL:
+		case MOP_PUSH_END:
+			priv->output.address = MAKE_WORD(0x01, cpu->reg_sp);
+			priv->output.rw = RW_WRITE;
+			break;
+		case MOP_POP_A_END:
+		case MOP_POP_P_END:
+		case MOP_POP_P_RTI:
+		case MOP_POP_PCL:
+		case MOP_POP_PCH:
+		case MOP_POP_PCH_END:
+			cpu->reg_sp++;
+			priv->output.address = MAKE_WORD(0x01, cpu->reg_sp);
+			break;
+		case MOP_BRANCH_ADD:
+			priv->output.address = cpu->reg_pc;
+			priv->i_addr.hi_byte = HI_BYTE(cpu->reg_pc);
+			INC_UINT16(cpu->reg_pc, (int8_t) priv->i_addr.lo_byte);
+			priv->page_crossed = priv->i_addr.hi_byte != HI_BYTE(cpu->reg_pc);
+			break;
+		case MOP_BRANCH_FIX:
+			priv->i_addr.lo_byte = LO_BYTE(cpu->reg_pc);
+			priv->output.address = priv->i_addr.full;
+			break;
+		case MOP_BRK:
+			if (priv->decode_cycle == 1) {
+				CPU_CHANGE_FLAG(B, true);
+			}
+			interrupt_sequence(cpu, CYCLE_BEGIN, INTR_BRK);
+			break;
+		case MOP_JAM:
+			// keep repeating the first cycle of the instruction
+			priv->decode_cycle = 1;
+			break;
 	}
-
-	return result;
 }
 
-static inline bool store_to_memory_g1(Cpu6502 *cpu, uint8_t value, CPU_6502_CYCLE phase) {
-	return store_to_memory(cpu, value, (cpu->reg_ir & ADDR_6502_MASK) >> 2, phase);
-}
+static inline void micro_op_middle(Cpu6502 *cpu, uint8_t mop, uint8_t op) {
 
-static inline void stack_push(Cpu6502 *cpu, uint8_t value, CPU_6502_CYCLE phase) {
-	switch (phase) {
-		case CYCLE_BEGIN:
-			PRIVATE(cpu)->output.address = MAKE_WORD(0x01, cpu->reg_sp);
+	switch (mop) {
+		case MOP_WRITE:
+		case MOP_PUSH_END:
+			OUTPUT_DATA(operation_register(cpu, op));
+			break;
+		case MOP_RMW_MODIFY:
 			PRIVATE(cpu)->output.rw = RW_WRITE;
 			break;
-		case CYCLE_MIDDLE:
-			OUTPUT_DATA(value);
+		case MOP_RMW_WRITE:
+			OUTPUT_DATA(PRIVATE(cpu)->operand);
 			break;
-		case CYCLE_END:
-			cpu->reg_sp--;
-			PRIVATE(cpu)->output.rw = RW_READ;
+		case MOP_PUSH_PCH:
+			OUTPUT_DATA(HI_BYTE(cpu->reg_pc));
+			break;
+		case MOP_PUSH_PCL:
+			OUTPUT_DATA(LO_BYTE(cpu->reg_pc));
+			break;
+		case MOP_BRK:
+			interrupt_sequence(cpu, CYCLE_MIDDLE, INTR_BRK);
 			break;
 	}
 }
 
-static inline uint8_t stack_pop(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	uint8_t result = 0;
+static inline void micro_op_end(Cpu6502 *cpu, uint8_t mop, uint8_t op) {
+	Cpu6502_private *priv = PRIVATE(cpu);
+	uint8_t data = priv->in_data;
 
-	switch (phase) {
-		case CYCLE_BEGIN:
-			cpu->reg_sp++;
-			PRIVATE(cpu)->output.address = MAKE_WORD(0x01, cpu->reg_sp);
+	switch (mop) {
+		// address calculation
+		case MOP_FETCH_ADL:
+			priv->addr.full = data;
+			++cpu->reg_pc;
 			break;
-		case CYCLE_MIDDLE:
+		case MOP_FETCH_ADH:
+			priv->addr.hi_byte = data;
+			++cpu->reg_pc;
 			break;
-		case CYCLE_END:
-			result = PRIVATE(cpu)->in_data;
+		case MOP_FETCH_ADH_X:
+			index_address(priv, cpu->reg_x);
+			priv->addr.hi_byte = data;
+			++cpu->reg_pc;
 			break;
-	}
-
-	return result;
-}
-
-static inline void decode_branch_instruction(Cpu6502 *cpu, uint8_t bit, uint8_t value, CPU_6502_CYCLE phase) {
-// the branching instructions follow the 6502's philosophy of doing the least amount of work possible
-// -> 2 cycles are always needed to fetch the opcode (before this function) and to fetch the offset (relative addressing)
-// -> if the branch isn't taken, the work ends there and the program continues with the next instruction (reg_pc)
-// -> if the branch is taken: the offset is added in the 3th cycle
-// -> only if a page boundary is crossed a 4th cycle is required
-
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1:		// fetch offset
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->i_addr.lo_byte, phase);
-			if (phase == CYCLE_END && BIT_IS_SET(cpu->reg_p, bit) != value) {
-				// check flags + stop if branch not taken
-				PRIVATE(cpu)->decode_cycle = -1;
-			}
+		case MOP_FETCH_ADH_Y:
+			index_address(priv, cpu->reg_y);
+			priv->addr.hi_byte = data;
+			++cpu->reg_pc;
 			break;
-		case 2:		// add relative address + check for page crossing
-			switch (phase) {
-				case CYCLE_BEGIN:
-					PRIVATE(cpu)->output.address = cpu->reg_pc;
-					PRIVATE(cpu)->i_addr.hi_byte = HI_BYTE(cpu->reg_pc);
-					INC_UINT16(cpu->reg_pc, (int8_t) PRIVATE(cpu)->i_addr.lo_byte);
-					break;
-				case CYCLE_MIDDLE:
-					PRIVATE(cpu)->page_crossed = PRIVATE(cpu)->i_addr.hi_byte != HI_BYTE(cpu->reg_pc);
-					break;
-				case CYCLE_END:
-					if (!PRIVATE(cpu)->page_crossed) {
-						PRIVATE(cpu)->decode_cycle = -1;
-					}
-					break;
-			}
+		case MOP_ZP_INDEX_X:
+			INC_UINT8(priv->addr.lo_byte, cpu->reg_x);
 			break;
-		case 3:		// extra cycle when page crossed to add carry to high address
-			switch (phase) {
-				case CYCLE_BEGIN:
-					PRIVATE(cpu)->i_addr.lo_byte = LO_BYTE(cpu->reg_pc);
-					PRIVATE(cpu)->output.address = PRIVATE(cpu)->i_addr.full;
-					break;
-				case CYCLE_MIDDLE:
-					break;
-				case CYCLE_END:
-					PRIVATE(cpu)->decode_cycle = -1;
-					break;
-			}
+		case MOP_ZP_INDEX_Y:
+			INC_UINT8(priv->addr.lo_byte, cpu->reg_y);
 			break;
-	}
-}
-
-static inline void calculate_adc_decimal(Cpu6502 *cpu) {
-/* ADC (and SBC) effect the C/N/V/Z-flags, even in decimal mode. On a 6502 only the carry is supported and valid.
-   But the other flags are still affected, we do are best to emulate this behaviour.
-   Many thanks go to Bruce Clark, for his excellent explanation of the decimal mode of the 6502 (see: http://www.6502.org/tutorials/decimal_mode.html)
-   and the accompanying test program.
-*/
-	int carry = FLAG_IS_SET(cpu->reg_p, FLAG_6502_CARRY);
-	int bin_result = cpu->reg_a + PRIVATE(cpu)->operand + carry;
-
-	int al = (cpu->reg_a & 0x0f) + (PRIVATE(cpu)->operand & 0x0f) + carry;
-	if (al >= 0x0a) {
-		al = ((al + 0x06) & 0x0f) + 0x10;
-	}
-	int a_seq1 = (cpu->reg_a & 0xf0) + (PRIVATE(cpu)->operand & 0xf0) + al;
-	if (a_seq1 >= 0xa0) {
-		a_seq1 += 0x60;
-	}
-
-	int a_seq2 = (int8_t) (cpu->reg_a & 0xf0) + (int8_t) (PRIVATE(cpu)->operand & 0xf0) + al;
-
-	cpu->reg_a = (uint8_t) (a_seq1 & 0x00ff);
-	CPU_CHANGE_FLAG(C, a_seq1 >= 0x0100);
-	CPU_CHANGE_FLAG(V, (a_seq2 < -128) || (a_seq2 > 127));
-	CPU_CHANGE_FLAG(Z, (bin_result & 0xff) == 0x00);
-	CPU_CHANGE_FLAG(N, BIT_IS_SET(a_seq2, 7));
-}
-
-static inline void decode_adc(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	if (!fetch_operand_g1(cpu, phase)) {
-		return;
-	}
-
-	if (!FLAG_IS_SET(cpu->reg_p, FLAG_6502_DECIMAL_MODE)) {
-		int carry = FLAG_IS_SET(cpu->reg_p, FLAG_6502_CARRY);
-		int s_result = (int8_t) cpu->reg_a + (int8_t) PRIVATE(cpu)->operand + carry;
-		int u_result = cpu->reg_a + PRIVATE(cpu)->operand + carry;
-		cpu->reg_a = (uint8_t) (u_result & 0x00ff);
-		CPU_CHANGE_FLAG(C, BIT_IS_SET(u_result, 8));
-		CPU_CHANGE_FLAG(V, (s_result < -128) || (s_result > 127));
-		CPU_CHANGE_FLAG(Z, cpu->reg_a == 0);
-		CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_a, 7));
-	} else {
-		calculate_adc_decimal(cpu);
-	}
-
-	PRIVATE(cpu)->decode_cycle = -1;
-}
-
-static inline void decode_and(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	if (fetch_operand_g1(cpu, phase)) {
-		cpu->reg_a	= cpu->reg_a & PRIVATE(cpu)->operand;
-		CPU_CHANGE_FLAG(Z, cpu->reg_a == 0);
-		CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_a, 7));
-		PRIVATE(cpu)->decode_cycle = -1;
-	}
-}
-
-static inline void decode_asl(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	if (cpu->reg_ir == OP_6502_ASL_ACC) {
-		switch (phase) {
-			case CYCLE_BEGIN:
-				PRIVATE(cpu)->output.address = cpu->reg_pc;
-				break;
-			case CYCLE_MIDDLE:
-				break;
-			case CYCLE_END:
-				CPU_CHANGE_FLAG(C, BIT_IS_SET(cpu->reg_a, 7));
-				cpu->reg_a = (uint8_t) (cpu->reg_a << 1);
-				CPU_CHANGE_FLAG(Z, cpu->reg_a == 0);
-				CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_a, 7));
-				PRIVATE(cpu)->decode_cycle = -1;
-				break;
-		}
-		return;
-	}
-
-	static const uint8_t AM_LUT[] = {
-		AM_6502_UNDEFINED,		// 0
-		AM_6502_ZEROPAGE,		// 1
-		AM_6502_UNDEFINED,		// 2
-		AM_6502_ABSOLUTE,		// 3
-		AM_6502_UNDEFINED,		// 4
-		AM_6502_ZEROPAGE_X,		// 5
-		AM_6502_UNDEFINED,		// 6
-		AM_6502_ABSOLUTE_X		// 7
-	};
-
-	int memop_cycle = fetch_address(cpu, AM_LUT[EXTRACT_6502_ADRESSING_MODE(cpu->reg_ir)], phase);
-
-	switch (PRIVATE(cpu)->decode_cycle - memop_cycle) {
-		case 0:		// fetch operand
-			fetch_memory(cpu, PRIVATE(cpu)->addr.full, &PRIVATE(cpu)->operand, phase);
-			break;
-		case 1:		// perform rotate / turn on write
-			switch (phase) {
-				case CYCLE_BEGIN:
-					break;
-				case CYCLE_MIDDLE:
-					PRIVATE(cpu)->output.rw = RW_WRITE;
-					break;
-				case CYCLE_END:
-					CPU_CHANGE_FLAG(C, BIT_IS_SET(PRIVATE(cpu)->operand, 7));
-					PRIVATE(cpu)->operand = (uint8_t) (PRIVATE(cpu)->operand << 1);
-					break;
-			}
-			break;
-		case 2:		// store result + set flags
-			switch (phase) {
-				case CYCLE_BEGIN:
-					break;
-				case CYCLE_MIDDLE:
-					OUTPUT_DATA(PRIVATE(cpu)->operand);
-					break;
-				case CYCLE_END:
-					PRIVATE(cpu)->output.rw = RW_READ;
-					CPU_CHANGE_FLAG(Z, PRIVATE(cpu)->operand == 0);
-					CPU_CHANGE_FLAG(N, BIT_IS_SET(PRIVATE(cpu)->operand, 7));
-					PRIVATE(cpu)->decode_cycle = -1;
-					break;
-			}
-			break;
-	}
-}
-
-static inline void decode_bcc(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	decode_branch_instruction(cpu, 0, false, phase);
-}
-
-static inline void decode_bcs(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	decode_branch_instruction(cpu, 0, true, phase);
-}
-
-static inline void decode_beq(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	decode_branch_instruction(cpu, 1, true, phase);
-}
-
-static inline void decode_bit(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	static const uint8_t AM_LUT[] = {
-		AM_6502_UNDEFINED,		// 0
-		AM_6502_ZEROPAGE,		// 1
-		AM_6502_UNDEFINED,		// 2
-		AM_6502_ABSOLUTE,		// 3
-		AM_6502_UNDEFINED,		// 4
-		AM_6502_UNDEFINED,		// 5
-		AM_6502_UNDEFINED,		// 6
-		AM_6502_UNDEFINED		// 7
-	};
-
-	if (fetch_operand(cpu, AM_LUT[EXTRACT_6502_ADRESSING_MODE(cpu->reg_ir)], phase)) {
-		CPU_CHANGE_FLAG(N, BIT_IS_SET(PRIVATE(cpu)->operand, 7));
-		CPU_CHANGE_FLAG(V, BIT_IS_SET(PRIVATE(cpu)->operand, 6));
-		CPU_CHANGE_FLAG(Z, (PRIVATE(cpu)->operand & cpu->reg_a) == 0);
-		PRIVATE(cpu)->decode_cycle = -1;
-	}
-}
-
-static inline void decode_bmi(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	decode_branch_instruction(cpu, 7, true, phase);
-}
-
-static inline void decode_bne(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	decode_branch_instruction(cpu, 1, false, phase);
-}
-
-static inline void decode_bpl(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	decode_branch_instruction(cpu, 7, false, phase);
-}
-
-static inline void decode_brk(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	if (PRIVATE(cpu)->decode_cycle == 1 && phase == CYCLE_BEGIN) {
-		CPU_CHANGE_FLAG(B, true);
-	}
-
-	interrupt_sequence(cpu, phase, INTR_BRK);
-}
-
-static inline void decode_bvc(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	decode_branch_instruction(cpu, 6, false, phase);
-}
-
-static inline void decode_bvs(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	decode_branch_instruction(cpu, 6, true, phase);
-}
-
-static inline void decode_clc(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	switch (phase) {
-		case CYCLE_BEGIN:
-			PRIVATE(cpu)->output.address = cpu->reg_pc;
-			break;
-		case CYCLE_MIDDLE:
-			break;
-		case CYCLE_END :
-			CPU_CHANGE_FLAG(CARRY, false);
-			PRIVATE(cpu)->decode_cycle = -1;
-			break;
-	}
-}
-
-static inline void decode_cld(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	switch (phase) {
-		case CYCLE_BEGIN:
-			PRIVATE(cpu)->output.address = cpu->reg_pc;
-			break;
-		case CYCLE_MIDDLE:
-			break;
-		case CYCLE_END :
-			CPU_CHANGE_FLAG(DECIMAL_MODE, false);
-			PRIVATE(cpu)->decode_cycle = -1;
-			break;
-	}
-}
-
-static inline void decode_cli(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	switch (phase) {
-		case CYCLE_BEGIN:
-			PRIVATE(cpu)->output.address = cpu->reg_pc;
-			break;
-		case CYCLE_MIDDLE:
-			break;
-		case CYCLE_END :
-			CPU_CHANGE_FLAG(INTERRUPT_DISABLE, false);
-			PRIVATE(cpu)->decode_cycle = -1;
-			break;
-	}
-}
-
-static inline void decode_clv(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	switch (phase) {
-		case CYCLE_BEGIN:
-			PRIVATE(cpu)->output.address = cpu->reg_pc;
-			break;
-		case CYCLE_MIDDLE:
-			break;
-		case CYCLE_END :
-			CPU_CHANGE_FLAG(OVERFLOW, false);
-			PRIVATE(cpu)->decode_cycle = -1;
-			break;
-	}
-}
-
-static inline void decode_cmp(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	if (fetch_operand_g1(cpu, phase)) {
-		int8_t result = (int8_t) (cpu->reg_a - PRIVATE(cpu)->operand);
-		CPU_CHANGE_FLAG(Z, result == 0);
-		CPU_CHANGE_FLAG(N, BIT_IS_SET(result, 7));
-		CPU_CHANGE_FLAG(C, cpu->reg_a >= PRIVATE(cpu)->operand);
-		PRIVATE(cpu)->decode_cycle = -1;
-	}
-}
-
-static inline void decode_cpx_cpy(Cpu6502 *cpu, CPU_6502_CYCLE phase, uint8_t reg) {
-
-	static const uint8_t AM_LUT[] = {
-		AM_6502_IMMEDIATE,		// 0
-		AM_6502_ZEROPAGE,		// 1
-		AM_6502_UNDEFINED,		// 2
-		AM_6502_ABSOLUTE,		// 3
-		AM_6502_UNDEFINED,		// 4
-		AM_6502_UNDEFINED,		// 5
-		AM_6502_UNDEFINED,		// 6
-		AM_6502_UNDEFINED		// 7
-	};
-
-	if (fetch_operand(cpu, AM_LUT[EXTRACT_6502_ADRESSING_MODE(cpu->reg_ir)], phase)) {
-		int8_t result = (int8_t) (reg - PRIVATE(cpu)->operand);
-		CPU_CHANGE_FLAG(Z, result == 0);
-		CPU_CHANGE_FLAG(N, BIT_IS_SET(result, 7));
-		CPU_CHANGE_FLAG(C, reg >= PRIVATE(cpu)->operand);
-		PRIVATE(cpu)->decode_cycle = -1;
-	}
-}
-
-static inline void decode_dec(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	static const uint8_t AM_LUT[] = {
-		AM_6502_UNDEFINED,		// 0
-		AM_6502_ZEROPAGE,		// 1
-		AM_6502_UNDEFINED,		// 2
-		AM_6502_ABSOLUTE,		// 3
-		AM_6502_UNDEFINED,		// 4
-		AM_6502_ZEROPAGE_X,		// 5
-		AM_6502_UNDEFINED,		// 6
-		AM_6502_ABSOLUTE_X		// 7
-	};
-
-	int memop_cycle = fetch_address(cpu, AM_LUT[EXTRACT_6502_ADRESSING_MODE(cpu->reg_ir)], phase);
-
-	switch (PRIVATE(cpu)->decode_cycle - memop_cycle) {
-		case 0:		// fetch operand
-			fetch_memory(cpu, PRIVATE(cpu)->addr.full, &PRIVATE(cpu)->operand, phase);
-			break;
-		case 1:		// perform decrement / turn on write
-			switch (phase) {
-				case CYCLE_BEGIN:
-					break;
-				case CYCLE_MIDDLE:
-					PRIVATE(cpu)->output.rw = RW_WRITE;
-					break;
-				case CYCLE_END:
-					PRIVATE(cpu)->operand--;
-					break;
-			}
-			break;
-		case 2:		// store result + set flags
-			switch (phase) {
-				case CYCLE_BEGIN:
-					break;
-				case CYCLE_MIDDLE:
-					OUTPUT_DATA(PRIVATE(cpu)->operand);
-					break;
-				case CYCLE_END:
-					PRIVATE(cpu)->output.rw = RW_READ;
-					CPU_CHANGE_FLAG(Z, PRIVATE(cpu)->operand == 0);
-					CPU_CHANGE_FLAG(N, BIT_IS_SET(PRIVATE(cpu)->operand, 7));
-					PRIVATE(cpu)->decode_cycle = -1;
-					break;
-			}
-			break;
-	}
-}
-
-static inline void decode_dex(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	switch (phase) {
-		case CYCLE_BEGIN:
-			PRIVATE(cpu)->output.address = cpu->reg_pc;
-			break;
-		case CYCLE_MIDDLE:
-			break;
-		case CYCLE_END :
-			cpu->reg_x--;
-			CPU_CHANGE_FLAG(Z, cpu->reg_x == 0);
-			CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_x, 7));
-			PRIVATE(cpu)->decode_cycle = -1;
-			break;
-	}
-}
-
-static inline void decode_dey(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	switch (phase) {
-		case CYCLE_BEGIN:
-			PRIVATE(cpu)->output.address = cpu->reg_pc;
-			break;
-		case CYCLE_MIDDLE:
-			break;
-		case CYCLE_END :
-			cpu->reg_y--;
-			CPU_CHANGE_FLAG(Z, cpu->reg_y == 0);
-			CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_y, 7));
-			PRIVATE(cpu)->decode_cycle = -1;
-			break;
-	}
-}
-
-static inline void decode_eor(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	if (fetch_operand_g1(cpu, phase)) {
-		cpu->reg_a	= cpu->reg_a ^ PRIVATE(cpu)->operand;
-		CPU_CHANGE_FLAG(Z, cpu->reg_a == 0);
-		CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_a, 7));
-		PRIVATE(cpu)->decode_cycle = -1;
-	}
-}
-
-static inline void decode_inc(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	static const uint8_t AM_LUT[] = {
-		AM_6502_UNDEFINED,						// 0
-		AM_6502_ZEROPAGE,		// 1
-		AM_6502_UNDEFINED,						// 2
-		AM_6502_ABSOLUTE,		// 3
-		AM_6502_UNDEFINED,						// 4
-		AM_6502_ZEROPAGE_X,		// 5
-		AM_6502_UNDEFINED,						// 6
-		AM_6502_ABSOLUTE_X		// 7
-	};
-
-	int memop_cycle = fetch_address(cpu, AM_LUT[EXTRACT_6502_ADRESSING_MODE(cpu->reg_ir)], phase);
-
-	switch (PRIVATE(cpu)->decode_cycle - memop_cycle) {
-		case 0:		// fetch operand
-			fetch_memory(cpu, PRIVATE(cpu)->addr.full, &PRIVATE(cpu)->operand, phase);
-			break;
-		case 1:		// perform increment / turn on write
-			switch (phase) {
-				case CYCLE_BEGIN:
-					break;
-				case CYCLE_MIDDLE:
-					PRIVATE(cpu)->output.rw = RW_WRITE;
-					break;
-				case CYCLE_END:
-					PRIVATE(cpu)->operand++;
-					break;
-			}
-			break;
-		case 2:		// store result + set flags
-			switch (phase) {
-				case CYCLE_BEGIN:
-					break;
-				case CYCLE_MIDDLE:
-					OUTPUT_DATA(PRIVATE(cpu)->operand);
-					break;
-				case CYCLE_END:
-					PRIVATE(cpu)->output.rw = RW_READ;
-					CPU_CHANGE_FLAG(Z, PRIVATE(cpu)->operand == 0);
-					CPU_CHANGE_FLAG(N, BIT_IS_SET(PRIVATE(cpu)->operand, 7));
-					PRIVATE(cpu)->decode_cycle = -1;
-					break;
-			}
-			break;
-	}
-}
-
-static inline void decode_inx(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	switch (phase) {
-		case CYCLE_BEGIN:
-			PRIVATE(cpu)->output.address = cpu->reg_pc;
-			break;
-		case CYCLE_MIDDLE:
-			break;
-		case CYCLE_END :
-			cpu->reg_x++;
-			CPU_CHANGE_FLAG(Z, cpu->reg_x == 0);
-			CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_x, 7));
-			PRIVATE(cpu)->decode_cycle = -1;
-			break;
-	}
-}
-
-static inline void decode_iny(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	switch (phase) {
-		case CYCLE_BEGIN:
-			PRIVATE(cpu)->output.address = cpu->reg_pc;
-			break;
-		case CYCLE_MIDDLE:
-			break;
-		case CYCLE_END :
-			cpu->reg_y++;
-			CPU_CHANGE_FLAG(Z, cpu->reg_y == 0);
-			CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_y, 7));
-			PRIVATE(cpu)->decode_cycle = -1;
-			break;
-	}
-}
-
-static inline void decode_jmp(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	int memop_cycle = 0;
-
-	if (cpu->reg_ir == OP_6502_JMP_ABS) {
-		memop_cycle = fetch_address_absolute(cpu, phase);
-	} else {
-		memop_cycle = fetch_address_indirect(cpu, phase);
-	}
-
-	if (PRIVATE(cpu)->decode_cycle == memop_cycle - 1 && phase == CYCLE_END) {
-		cpu->reg_pc = PRIVATE(cpu)->addr.full;
-		PRIVATE(cpu)->decode_cycle = -1;
-	}
-}
-
-static inline void decode_jsr(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1 :		// fetch address low byte (adl)
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->addr.lo_byte, phase);
-			break;
-		case 2 :		// store adl in cpu, put stack pointer on address bus
-			if (phase == CYCLE_BEGIN) {
-				PRIVATE(cpu)->output.address = MAKE_WORD(0x01, cpu->reg_sp);
-			}
-			break;
-		case 3 :		// push program_counter - high byte
-			stack_push(cpu, HI_BYTE(cpu->reg_pc), phase);
-			break;
-		case 4 :		// push program_counter - low byte
-			stack_push(cpu, LO_BYTE(cpu->reg_pc), phase);
-			break;
-		case 5 :		// fetch address high byte (adh)
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->addr.hi_byte, phase);
-			if (phase == CYCLE_END) {
-				cpu->reg_pc = PRIVATE(cpu)->addr.full;
-				PRIVATE(cpu)->decode_cycle = -1;
-			}
-			break;
-	}
-}
-
-static inline void decode_lda(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	if (fetch_operand_g1(cpu, phase)) {
-		cpu->reg_a	= PRIVATE(cpu)->operand;
-		CPU_CHANGE_FLAG(Z, cpu->reg_a == 0);
-		CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_a, 7));
-		PRIVATE(cpu)->decode_cycle = -1;
-	}
-}
-
-static inline void decode_ldx(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	static const uint8_t AM_LUT[] = {
-		AM_6502_IMMEDIATE,		// 0
-		AM_6502_ZEROPAGE,		// 1
-		AM_6502_UNDEFINED,		// 2
-		AM_6502_ABSOLUTE,		// 3
-		AM_6502_UNDEFINED,		// 4
-		AM_6502_ZEROPAGE_Y,		// 5
-		AM_6502_UNDEFINED,		// 6
-		AM_6502_ABSOLUTE_Y		// 7
-	};
-
-	if (fetch_operand(cpu, AM_LUT[EXTRACT_6502_ADRESSING_MODE(cpu->reg_ir)], phase)) {
-		cpu->reg_x = PRIVATE(cpu)->operand;
-		CPU_CHANGE_FLAG(Z, cpu->reg_x == 0);
-		CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_x, 7));
-		PRIVATE(cpu)->decode_cycle = -1;
-	}
-}
-
-static inline void decode_ldy(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	static const uint8_t AM_LUT[] = {
-		AM_6502_IMMEDIATE,		// 0
-		AM_6502_ZEROPAGE,		// 1
-		AM_6502_UNDEFINED,		// 2
-		AM_6502_ABSOLUTE,		// 3
-		AM_6502_UNDEFINED,		// 4
-		AM_6502_ZEROPAGE_X,		// 5
-		AM_6502_UNDEFINED,		// 6
-		AM_6502_ABSOLUTE_X		// 7
-	};
-
-	if (fetch_operand(cpu, AM_LUT[EXTRACT_6502_ADRESSING_MODE(cpu->reg_ir)], phase)) {
-		cpu->reg_y = PRIVATE(cpu)->operand;
-		CPU_CHANGE_FLAG(Z, cpu->reg_y == 0);
-		CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_y, 7));
-		PRIVATE(cpu)->decode_cycle = -1;
-	}
-}
-
-static inline void decode_lsr(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	if (cpu->reg_ir == OP_6502_LSR_ACC) {
-		switch (phase) {
-			case CYCLE_BEGIN:
-				PRIVATE(cpu)->output.address = cpu->reg_pc;
-				break;
-			case CYCLE_MIDDLE:
-				break;
-			case CYCLE_END:
-				CPU_CHANGE_FLAG(C, BIT_IS_SET(cpu->reg_a, 0));
-				cpu->reg_a >>= 1;
-				CPU_CHANGE_FLAG(Z, cpu->reg_a == 0);
-				CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_a, 7));
-				PRIVATE(cpu)->decode_cycle = -1;
-				break;
-		}
-		return;
-	}
-
-	static const uint8_t AM_LUT[] = {
-		AM_6502_UNDEFINED,		// 0
-		AM_6502_ZEROPAGE,		// 1
-		AM_6502_UNDEFINED,		// 2
-		AM_6502_ABSOLUTE,		// 3
-		AM_6502_UNDEFINED,		// 4
-		AM_6502_ZEROPAGE_X,		// 5
-		AM_6502_UNDEFINED,		// 6
-		AM_6502_ABSOLUTE_X		// 7
-	};
-
-	int memop_cycle = fetch_address(cpu, AM_LUT[EXTRACT_6502_ADRESSING_MODE(cpu->reg_ir)], phase);
-
-	switch (PRIVATE(cpu)->decode_cycle - memop_cycle) {
-		case 0:		// fetch operand
-			fetch_memory(cpu, PRIVATE(cpu)->addr.full, &PRIVATE(cpu)->operand, phase);
-			break;
-		case 1:		// perform rotate / turn on write
-			switch (phase) {
-				case CYCLE_BEGIN:
-					break;
-				case CYCLE_MIDDLE:
-					PRIVATE(cpu)->output.rw = RW_WRITE;
-					break;
-				case CYCLE_END:
-					CPU_CHANGE_FLAG(C, BIT_IS_SET(PRIVATE(cpu)->operand, 0));
-					PRIVATE(cpu)->operand >>= 1;
-					break;
-			}
-			break;
-		case 2:		// store result + set flags
-			switch (phase) {
-				case CYCLE_BEGIN:
-					break;
-				case CYCLE_MIDDLE:
-					OUTPUT_DATA(PRIVATE(cpu)->operand);
-					break;
-				case CYCLE_END:
-					PRIVATE(cpu)->output.rw = RW_READ;
-					CPU_CHANGE_FLAG(Z, PRIVATE(cpu)->operand == 0);
-					CPU_CHANGE_FLAG(N, BIT_IS_SET(PRIVATE(cpu)->operand, 7));
-					PRIVATE(cpu)->decode_cycle = -1;
-					break;
-			}
-			break;
-	}
-}
-
-static inline void decode_nop(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	switch (phase) {
-		case CYCLE_BEGIN:
-			PRIVATE(cpu)->output.address = cpu->reg_pc;
-			break;
-		case CYCLE_MIDDLE:
+		case MOP_FETCH_ZP_PTR:
+			priv->operand = data;
+			++cpu->reg_pc;
 			break;
-		case CYCLE_END :
-			PRIVATE(cpu)->decode_cycle = -1;
+		case MOP_PTR_INDEX_X:
+			priv->addr.lo_byte = data;
+			INC_UINT8(priv->operand, cpu->reg_x);
 			break;
-	}
-}
-
-static inline void decode_pha(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1 :		// fetch discard data & decode pha
-			fetch_memory(cpu, cpu->reg_pc, &PRIVATE(cpu)->addr.lo_byte, phase);
+		case MOP_PTR_ADL:
+			priv->addr.lo_byte = data;
+			priv->operand++;
 			break;
-		case 2 :
-			stack_push(cpu, cpu->reg_a, phase);
-			if (phase == CYCLE_END) {
-				PRIVATE(cpu)->decode_cycle = -1;
-			}
+		case MOP_PTR_ADH:
+			priv->addr.hi_byte = data;
 			break;
-	}
-}
-
-static inline void decode_php(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1 :		// fetch discard data & decode php
-			fetch_memory(cpu, cpu->reg_pc, &PRIVATE(cpu)->addr.lo_byte, phase);
+		case MOP_PTR_ADH_Y:
+			priv->addr.hi_byte = data;
+			index_address(priv, cpu->reg_y);
 			break;
-		case 2 :
-			// apparently the break bit is also set by PHP
-			// (I didn't see that mentioned in the programming manual, or I missed it, but several online resources mention this.)
-			stack_push(cpu, cpu->reg_p | 0b00010000, phase);
-			if (phase == CYCLE_END) {
-				PRIVATE(cpu)->decode_cycle = -1;
-			}
+		case MOP_PAGE_CROSS_FIX:
+			priv->operand = data;
+			INC_UINT8(priv->addr.hi_byte, priv->page_crossed);
 			break;
-	}
-}
 
-static inline void decode_pla(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1 :		// fetch discard data & decode pla
-			fetch_memory(cpu, cpu->reg_pc, &PRIVATE(cpu)->addr.lo_byte, phase);
-			break;
-		case 2 :		// read stack,
-			if (phase == CYCLE_BEGIN) {
-				PRIVATE(cpu)->output.address = MAKE_WORD(0x01, cpu->reg_sp);
-			}
+		// operand access
+		case MOP_READ:
+			priv->operand = data;
 			break;
-		case 3 :		// pop value from stack
-			cpu->reg_a = stack_pop(cpu, phase);
-			if (phase == CYCLE_END) {
-				CPU_CHANGE_FLAG(Z, cpu->reg_a == 0);
-				CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_a, 7));
-				PRIVATE(cpu)->decode_cycle = -1;
-			}
+		case MOP_READ_IMM_EXEC:
+			++cpu->reg_pc;
+			priv->operand = data;
+			execute_operation(cpu, op);
+			priv->decode_cycle = -1;
 			break;
-	}
-}
-
-static inline void decode_plp(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1 :		// fetch discard data & decode plp
-			fetch_memory(cpu, cpu->reg_pc, &PRIVATE(cpu)->addr.lo_byte, phase);
+		case MOP_READ_EXEC:
+			priv->operand = data;
+			execute_operation(cpu, op);
+			priv->decode_cycle = -1;
 			break;
-		case 2 :		// read stack
-			if (phase == CYCLE_BEGIN) {
-				PRIVATE(cpu)->output.address = MAKE_WORD(0x01, cpu->reg_sp);
+		case MOP_READ_PAGE_CROSS_EXEC:
+			priv->operand = data;
+			if (priv->page_crossed) {
+				priv->addr.hi_byte++;
+			} else {
+				execute_operation(cpu, op);
+				priv->decode_cycle = -1;
 			}
 			break;
-		case 3 :		// pop value from stack
-			cpu->reg_p = stack_pop(cpu, phase) | FLAG_6502_EXPANSION;	// reserved bit is always set
-			FLAG_CLEAR_U8(cpu->reg_p, FLAG_6502_BREAK_COMMAND);			// ignore the 'B'-flag (it gets set by the PHP-instruction)
-			if (phase == CYCLE_END) {
-				PRIVATE(cpu)->decode_cycle = -1;
-			}
+		case MOP_IMPLIED_EXEC:
+			execute_operation(cpu, op);
+			priv->decode_cycle = -1;
 			break;
-	}
-}
-
-
-static inline void decode_ora(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	if (fetch_operand_g1(cpu, phase)) {
-		cpu->reg_a	= cpu->reg_a | PRIVATE(cpu)->operand;
-		CPU_CHANGE_FLAG(Z, cpu->reg_a == 0);
-		CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_a, 7));
-		PRIVATE(cpu)->decode_cycle = -1;
-	}
-}
-
-static inline void decode_rol(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	if (cpu->reg_ir == OP_6502_ROL_ACC) {
-		switch (phase) {
-			case CYCLE_BEGIN:
-				PRIVATE(cpu)->output.address = cpu->reg_pc;
-				break;
-			case CYCLE_MIDDLE:
-				break;
-			case CYCLE_END: {
-				int carry = FLAG_IS_SET(cpu->reg_p, FLAG_6502_CARRY);
-				CPU_CHANGE_FLAG(C, BIT_IS_SET(cpu->reg_a, 7));
-				cpu->reg_a = (uint8_t) ((cpu->reg_a << 1) | carry);
-				CPU_CHANGE_FLAG(Z, cpu->reg_a == 0);
-				CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_a, 7));
-				PRIVATE(cpu)->decode_cycle = -1;
-				break;
-			}
-		}
-		return;
-	}
-
-	static const uint8_t AM_LUT[] = {
-		AM_6502_UNDEFINED,		// 0
-		AM_6502_ZEROPAGE,		// 1
-		AM_6502_UNDEFINED,		// 2
-		AM_6502_ABSOLUTE,		// 3
-		AM_6502_UNDEFINED,		// 4
-		AM_6502_ZEROPAGE_X,		// 5
-		AM_6502_UNDEFINED,		// 6
-		AM_6502_ABSOLUTE_X		// 7
-	};
-
-	int memop_cycle = fetch_address(cpu, AM_LUT[EXTRACT_6502_ADRESSING_MODE(cpu->reg_ir)], phase);
-
-	switch (PRIVATE(cpu)->decode_cycle - memop_cycle) {
-		case 0:		// fetch operand
-			fetch_memory(cpu, PRIVATE(cpu)->addr.full, &PRIVATE(cpu)->operand, phase);
+		case MOP_WRITE:
+			priv->output.rw = RW_READ;
+			priv->decode_cycle = -1;
 			break;
-		case 1:		// perform rotate / turn on write
-			switch (phase) {
-				case CYCLE_BEGIN:
-					break;
-				case CYCLE_MIDDLE:
-					PRIVATE(cpu)->output.rw = RW_WRITE;
-					break;
-				case CYCLE_END: {
-					int carry = FLAG_IS_SET(cpu->reg_p, FLAG_6502_CARRY);
-					CPU_CHANGE_FLAG(C, BIT_IS_SET(PRIVATE(cpu)->operand, 7));
-					PRIVATE(cpu)->operand = (uint8_t) ((PRIVATE(cpu)->operand << 1) | carry);
-					break;
-				}
-			}
+		case MOP_RMW_MODIFY:
+			execute_operation(cpu, op);
 			break;
-		case 2:		// store result + set flags
-			switch (phase) {
-				case CYCLE_BEGIN:
-					break;
-				case CYCLE_MIDDLE:
-					OUTPUT_DATA(PRIVATE(cpu)->operand);
-					break;
-				case CYCLE_END:
-					PRIVATE(cpu)->output.rw = RW_READ;
-					CPU_CHANGE_FLAG(Z, PRIVATE(cpu)->operand == 0);
-					CPU_CHANGE_FLAG(N, BIT_IS_SET(PRIVATE(cpu)->operand, 7));
-					PRIVATE(cpu)->decode_cycle = -1;
-					break;
-			}
+		case MOP_RMW_WRITE:
+			priv->output.rw = RW_READ;
+			set_flags_zn(cpu, priv->operand);
+			priv->decode_cycle = -1;
 			break;
-	}
-}
-
-
-static inline void decode_ror(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	if (cpu->reg_ir == OP_6502_ROR_ACC) {
-		switch (phase) {
-			case CYCLE_BEGIN:
-				PRIVATE(cpu)->output.address = cpu->reg_pc;
-				break;
-			case CYCLE_MIDDLE:
-				break;
-			case CYCLE_END: {
-				int carry = FLAG_IS_SET(cpu->reg_p, FLAG_6502_CARRY);
-				CPU_CHANGE_FLAG(C, BIT_IS_SET(cpu->reg_a, 0));
-				cpu->reg_a = (cpu->reg_a >> 1) | (uint8_t) (carry << 7);
-				CPU_CHANGE_FLAG(Z, cpu->reg_a == 0);
-				CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_a, 7));
-				PRIVATE(cpu)->decode_cycle = -1;
-				break;
-			}
-		}
-		return;
-	}
-
-	static const uint8_t AM_LUT[] = {
-		AM_6502_UNDEFINED,		// 0
-		AM_6502_ZEROPAGE,		// 1
-		AM_6502_UNDEFINED,		// 2
-		AM_6502_ABSOLUTE,		// 3
-		AM_6502_UNDEFINED,		// 4
-		AM_6502_ZEROPAGE_X,		// 5
-		AM_6502_UNDEFINED,		// 6
-		AM_6502_ABSOLUTE_X		// 7
-	};
-
-	int memop_cycle = fetch_address(cpu, AM_LUT[EXTRACT_6502_ADRESSING_MODE(cpu->reg_ir)], phase);
 
-	switch (PRIVATE(cpu)->decode_cycle - memop_cycle) {
-		case 0:		// fetch operand
-			fetch_memory(cpu, PRIVATE(cpu)->addr.full, &PRIVATE(cpu)->operand, phase);
+		// jumps & subroutines
+		case MOP_READ_PC_DISCARD:
+			priv->addr.lo_byte = data;
 			break;
-		case 1:		// perform rotate / turn on write
-			switch (phase) {
-				case CYCLE_BEGIN:
-					break;
-				case CYCLE_MIDDLE:
-					PRIVATE(cpu)->output.rw = RW_WRITE;
-					break;
-				case CYCLE_END: {
-					int carry = FLAG_IS_SET(cpu->reg_p, FLAG_6502_CARRY);
-					CPU_CHANGE_FLAG(C, BIT_IS_SET(PRIVATE(cpu)->operand, 0));
-					PRIVATE(cpu)->operand = (PRIVATE(cpu)->operand >> 1) | (uint8_t) (carry << 7);
-					break;
-				}
-			}
-			break;
-		case 2:		// store result + set flags
-			switch (phase) {
-				case CYCLE_BEGIN:
-					break;
-				case CYCLE_MIDDLE:
-					OUTPUT_DATA(PRIVATE(cpu)->operand);
-					break;
-				case CYCLE_END:
-					PRIVATE(cpu)->output.rw = RW_READ;
-					CPU_CHANGE_FLAG(Z, PRIVATE(cpu)->operand == 0);
-					CPU_CHANGE_FLAG(N, BIT_IS_SET(PRIVATE(cpu)->operand, 7));
-					PRIVATE(cpu)->decode_cycle = -1;
-					break;
-			}
+		case MOP_FETCH_PC_DISCARD:
+			priv->addr.lo_byte = data;
+			++cpu->reg_pc;
 			break;
-	}
-}
-
-static inline void decode_rts(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1 :		// fetch discard data & decode rts
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->addr.lo_byte, phase);
+		case MOP_FETCH_PC_END:
+			priv->operand = data;
+			++cpu->reg_pc;
+			priv->decode_cycle = -1;
 			break;
-		case 2 :		// "increment stack pointer
-			if (phase == CYCLE_BEGIN) {
-				PRIVATE(cpu)->output.address = MAKE_WORD(0x01, cpu->reg_sp);
-			}
+		case MOP_FETCH_IAL:
+			priv->i_addr.lo_byte = data;
+			++cpu->reg_pc;
 			break;
-		case 3 :		// pop program_counter - low byte
-			cpu->reg_pc = SET_LO_BYTE(cpu->reg_pc, stack_pop(cpu, phase));
+		case MOP_FETCH_IAH:
+			priv->i_addr.hi_byte = data;
+			++cpu->reg_pc;
 			break;
-		case 4 :		// pop program_counter - low byte
-			cpu->reg_pc = SET_HI_BYTE(cpu->reg_pc, stack_pop(cpu, phase));
+		case MOP_IND_ADL:
+			priv->addr.lo_byte = data;
+			priv->i_addr.full++;
 			break;
-		case 5 :		// increment program counter
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->operand, phase);
-			if (phase == CYCLE_END) {
-				PRIVATE(cpu)->decode_cycle = -1;
-			}
+		case MOP_IND_ADH_JMP:
+		case MOP_JMP_ADH:
+			priv->addr.hi_byte = data;
+			cpu->reg_pc = priv->addr.full;
+			priv->decode_cycle = -1;
 			break;
-	}
-}
-
-static inline void decode_rti(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
 
-	switch (PRIVATE(cpu)->decode_cycle) {
-		case 1 :		// decode RTI
-			fetch_pc_memory(cpu, &PRIVATE(cpu)->addr.lo_byte, phase);
+		// stack
+		case MOP_PUSH_PCH:
+		case MOP_PUSH_PCL:
+			cpu->reg_sp--;
+			priv->output.rw = RW_READ;
 			break;
-		case 2 :		// "increment" stack pointer
-			if (phase == CYCLE_BEGIN) {
-				PRIVATE(cpu)->output.address = MAKE_WORD(0x01, cpu->reg_sp);
-			}
+		case MOP_PUSH_END:
+			cpu->reg_sp--;
+			priv->output.rw = RW_READ;
+			priv->decode_cycle = -1;
 			break;
-		case 3 :		// pop status register
-			cpu->reg_p = stack_pop(cpu, phase);
-			if (phase == CYCLE_END) {
-				CPU_CHANGE_FLAG(B, false);
-			}
+		case MOP_POP_A_END:
+			cpu->reg_a = data;
+			set_flags_zn(cpu, cpu->reg_a);
+			priv->decode_cycle = -1;
 			break;
-		case 4 :		// pop program_counter - low byte
-			cpu->reg_pc = SET_LO_BYTE(cpu->reg_pc, stack_pop(cpu, phase));
+		case MOP_POP_P_END:
+			// reserved bit is always set, ignore the 'B'-flag (it gets set by the PHP-instruction)
+			cpu->reg_p = (data | FLAG_6502_EXPANSION) & (uint8_t) ~FLAG_6502_BREAK_COMMAND;
+			priv->decode_cycle = -1;
 			break;
-		case 5 :		// pop program_counter - low byte
-			cpu->reg_pc = SET_HI_BYTE(cpu->reg_pc, stack_pop(cpu, phase));
-			if (phase == CYCLE_END) {
-				PRIVATE(cpu)->decode_cycle = -1;
-			}
+		case MOP_POP_P_RTI:
+			cpu->reg_p = data & (uint8_t) ~FLAG_6502_BREAK_COMMAND;
 			break;
-	}
-}
-
-static inline void decode_sbc(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	if (!fetch_operand_g1(cpu, phase)) {
-		return;
-	}
-
-	// on a 6502 the C/N/V/Z-flags are set using the binary mode computation.
-	int carry = FLAG_IS_SET(cpu->reg_p, FLAG_6502_CARRY);
-	int u_result = cpu->reg_a + (uint8_t) ~PRIVATE(cpu)->operand + carry;
-	int s_result = (int8_t) cpu->reg_a - (int8_t) PRIVATE(cpu)->operand - !carry;
-
-	if (!FLAG_IS_SET(cpu->reg_p, FLAG_6502_DECIMAL_MODE)) {
-		cpu->reg_a = (uint8_t) (u_result & 0x00ff);
-	} else {
-		int al = (cpu->reg_a & 0x0f) - (PRIVATE(cpu)->operand & 0x0f) + carry - 1;
-		if (al < 0) {
-			al = ((al - 0x06) & 0x0f) - 0x10;
-		}
-		int a_seq3 = (cpu->reg_a & 0xf0) - (PRIVATE(cpu)->operand & 0xf0) + al;
-		if (a_seq3 < 0) {
-			a_seq3 -= 0x60;
-		}
-		cpu->reg_a = (uint8_t) (a_seq3 & 0x00ff);
-	}
-
-	CPU_CHANGE_FLAG(C, BIT_IS_SET(u_result, 8));
-	CPU_CHANGE_FLAG(V, (s_result < -128) || (s_result > 127));
-	CPU_CHANGE_FLAG(Z, (u_result & 0x00ff) == 0);
-	CPU_CHANGE_FLAG(N, BIT_IS_SET(u_result, 7));
-
-	PRIVATE(cpu)->decode_cycle = -1;
-}
-
-static inline void decode_sec(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	switch (phase) {
-		case CYCLE_BEGIN:
-			PRIVATE(cpu)->output.address = cpu->reg_pc;
+		case MOP_POP_PCL:
+			cpu->reg_pc = SET_LO_BYTE(cpu->reg_pc, data);
 			break;
-		case CYCLE_MIDDLE:
+		case MOP_POP_PCH:
+			cpu->reg_pc = SET_HI_BYTE(cpu->reg_pc, data);
 			break;
-		case CYCLE_END:
-			CPU_CHANGE_FLAG(C, true);
-			PRIVATE(cpu)->decode_cycle = -1;
+		case MOP_POP_PCH_END:
+			cpu->reg_pc = SET_HI_BYTE(cpu->reg_pc, data);
+			priv->decode_cycle = -1;
 			break;
-	}
-}
 
-static inline void decode_sed(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	switch (phase) {
-		case CYCLE_BEGIN:
-			PRIVATE(cpu)->output.address = cpu->reg_pc;
+		// branches
+		case MOP_BRANCH_OFFSET:
+			priv->i_addr.lo_byte = data;
+			++cpu->reg_pc;
+			if (!branch_taken(cpu, op)) {
+				priv->decode_cycle = -1;
+			}
 			break;
-		case CYCLE_MIDDLE:
+		case MOP_BRANCH_ADD:
+			if (!priv->page_crossed) {
+				priv->decode_cycle = -1;
+			}
 			break;
-		case CYCLE_END:
-			CPU_CHANGE_FLAG(D, true);
-			PRIVATE(cpu)->decode_cycle = -1;
+		case MOP_BRANCH_FIX:
+			priv->decode_cycle = -1;
+			break;
+
+		case MOP_BRK:
+			interrupt_sequence(cpu, CYCLE_END, INTR_BRK);
 			break;
 	}
 }
 
-static inline void decode_sei(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
+static inline void execute_micro_op(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
+	const MicroProgram6502 *program = &MICRO_PROGRAMS[cpu->reg_ir];
+	uint8_t mop = program->cycles[PRIVATE(cpu)->decode_cycle - 1];
+
 	switch (phase) {
 		case CYCLE_BEGIN:
-			PRIVATE(cpu)->output.address = cpu->reg_pc;
+			micro_op_begin(cpu, mop);
 			break;
 		case CYCLE_MIDDLE:
+			micro_op_middle(cpu, mop, program->op);
 			break;
 		case CYCLE_END:
-			CPU_CHANGE_FLAG(I, true);
-			PRIVATE(cpu)->decode_cycle = -1;
+			micro_op_end(cpu, mop, program->op);
 			break;
 	}
 }
 
-static inline void decode_sta(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	if (store_to_memory_g1(cpu, cpu->reg_a, phase)) {
-		PRIVATE(cpu)->decode_cycle = -1;
-	}
-}
-
-static inline void decode_stx(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	bool op_ready = false;
-
-	switch (cpu->reg_ir) {
-		case OP_6502_STX_ZP :
-			op_ready = store_to_memory(cpu, cpu->reg_x, AM_6502_ZEROPAGE, phase);
-			break;
-		case OP_6502_STX_ZPY :
-			op_ready = store_to_memory(cpu, cpu->reg_x, AM_6502_ZEROPAGE_Y, phase);
-			break;
-		case OP_6502_STX_ABS :
-			op_ready = store_to_memory(cpu, cpu->reg_x, AM_6502_ABSOLUTE, phase);
-			break;
-	}
-
-	if (op_ready) {
-		PRIVATE(cpu)->decode_cycle = -1;
-	}
+static inline void trace_end_instruction(Cpu6502 *cpu) {
+	PRIVATE(cpu)->trace_current->address = PRIVATE(cpu)->addr.full;
+	PRIVATE(cpu)->trace_current = NULL;
 }
 
-static inline void decode_sty(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-
-	bool op_ready = false;
-
-	switch (cpu->reg_ir) {
-		case OP_6502_STY_ZP :
-			op_ready = store_to_memory(cpu, cpu->reg_y, AM_6502_ZEROPAGE, phase);
-			break;
-		case OP_6502_STY_ZPX :
-			op_ready = store_to_memory(cpu, cpu->reg_y, AM_6502_ZEROPAGE_X, phase);
-			break;
-		case OP_6502_STY_ABS :
-			op_ready = store_to_memory(cpu, cpu->reg_y, AM_6502_ABSOLUTE, phase);
-			break;
-	}
+static inline void trace_begin_instruction(Cpu6502 *cpu) {
+	Cpu6502Trace *trace = PRIVATE(cpu)->trace;
+	int64_t tick = cpu->simulator->current_tick;
+	int64_t delta = (trace->count > 0) ? tick - trace->last_tick : 0;
 
-	if (op_ready) {
-		PRIVATE(cpu)->decode_cycle = -1;
-	}
-}
+	Cpu6502TraceRecord *record = &trace->records[trace->count++ & trace->mask];
+	record->tick_delta = (uint32_t) MIN(delta, (int64_t) UINT32_MAX);
+	record->pc = cpu->reg_pc;
+	record->reg_a = cpu->reg_a;
+	record->reg_x = cpu->reg_x;
+	record->reg_y = cpu->reg_y;
+	record->reg_sp = cpu->reg_sp;
+	record->reg_p = cpu->reg_p;
+	trace->last_tick = tick;
 
-static inline void decode_tax(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	if (phase == CYCLE_BEGIN) {
-		PRIVATE(cpu)->output.address = cpu->reg_pc;
-	}
-	if (phase == CYCLE_END) {
-		cpu->reg_x = cpu->reg_a;
-		CPU_CHANGE_FLAG(Z, cpu->reg_x == 0);
-		CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_x, 7));
-		PRIVATE(cpu)->decode_cycle = -1;
-	}
+	PRIVATE(cpu)->trace_current = record;
+	PRIVATE(cpu)->trace_fetched = 0;
 }
 
-static inline void decode_tay(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	if (phase == CYCLE_BEGIN) {
-		PRIVATE(cpu)->output.address = cpu->reg_pc;
-	}
-	if (phase == CYCLE_END) {
-		cpu->reg_y = cpu->reg_a;
-		CPU_CHANGE_FLAG(Z, cpu->reg_y == 0);
-		CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_y, 7));
-		PRIVATE(cpu)->decode_cycle = -1;
-	}
-}
+static inline void trace_fetch(Cpu6502 *cpu) {
+	// the first read of each byte at pc, pc+1 and pc+2 is the opcode and its operands
+	uint16_t offset = (uint16_t) (PRIVATE(cpu)->output.address - PRIVATE(cpu)->trace_current->pc);
 
-static inline void decode_tsx(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	if (phase == CYCLE_BEGIN) {
-		PRIVATE(cpu)->output.address = cpu->reg_pc;
-	}
-	if (phase == CYCLE_END) {
-		cpu->reg_x = cpu->reg_sp;
-		CPU_CHANGE_FLAG(Z, cpu->reg_x == 0);
-		CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_x, 7));
-		PRIVATE(cpu)->decode_cycle = -1;
+	if (offset < 3 && PRIVATE(cpu)->output.rw == RW_READ && !(PRIVATE(cpu)->trace_fetched & (1 << offset))) {
+		PRIVATE(cpu)->trace_current->bytes[offset] = PRIVATE(cpu)->in_data;
+		PRIVATE(cpu)->trace_fetched |= (uint8_t) (1 << offset);
 	}
 }
 
-static inline void decode_txa(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	if (phase == CYCLE_BEGIN) {
-		PRIVATE(cpu)->output.address = cpu->reg_pc;
-	}
-	if (phase == CYCLE_END) {
-		cpu->reg_a = cpu->reg_x;
-		CPU_CHANGE_FLAG(Z, cpu->reg_a == 0);
-		CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_a, 7));
-		PRIVATE(cpu)->decode_cycle = -1;
-	}
-}
+static inline void coverage_access(Cpu6502 *cpu) {
+	Cpu6502_private *priv = PRIVATE(cpu);
+	uint8_t *flags = &priv->coverage->flags[priv->output.address];
 
-static inline void decode_txs(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	if (phase == CYCLE_BEGIN) {
-		PRIVATE(cpu)->output.address = cpu->reg_pc;
-	}
-	if (phase == CYCLE_END) {
-		cpu->reg_sp = cpu->reg_x;
-		PRIVATE(cpu)->decode_cycle = -1;
+	if (priv->output.rw == RW_WRITE) {
+		*flags |= COVERAGE_6502_WRITE;
+		return;
 	}
-}
 
-static inline void decode_tya(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
-	if (phase == CYCLE_BEGIN) {
-		PRIVATE(cpu)->output.address = cpu->reg_pc;
-	}
-	if (phase == CYCLE_END) {
-		cpu->reg_a = cpu->reg_y;
-		CPU_CHANGE_FLAG(Z, cpu->reg_a == 0);
-		CPU_CHANGE_FLAG(N, BIT_IS_SET(cpu->reg_a, 7));
-		PRIVATE(cpu)->decode_cycle = -1;
+	if (priv->state == CS_RUNNING && priv->decode_cycle == 0) {
+		*flags |= COVERAGE_6502_OPCODE;
+		return;
 	}
-}
-
-static inline void decode_instruction(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
 
-	/* some instruction are grouped by addressing mode and can easily be tested at once */
-	switch (cpu->reg_ir & AC_6502_MASK) {
-		case AC_6502_ADC :
-			decode_adc(cpu, phase);
-			return;
-		case AC_6502_AND :
-			decode_and(cpu, phase);
-			return;
-		case AC_6502_ASL :
-			decode_asl(cpu, phase);
-			return;
-		case AC_6502_CMP :
-			decode_cmp(cpu, phase);
-			return;
-		case AC_6502_DEC :
-			if (cpu->reg_ir != OP_6502_DEX) {
-				decode_dec(cpu, phase);
-			}
-			break;
-		case AC_6502_EOR :
-			decode_eor(cpu, phase);
-			return;
-		case AC_6502_INC :
-			if (cpu->reg_ir != OP_6502_NOP) {
-				decode_inc(cpu, phase);
+	// interrupt sequences (and BRK) only read the vector in their last two cycles
+	uint8_t mop = (priv->state == CS_RUNNING) ? MICRO_PROGRAMS[cpu->reg_ir].cycles[priv->decode_cycle - 1] : MOP_BRK;
+
+	switch (mop) {
+		case MOP_FETCH_ADL:
+		case MOP_FETCH_ADH:
+		case MOP_FETCH_ADH_X:
+		case MOP_FETCH_ADH_Y:
+		case MOP_FETCH_ZP_PTR:
+		case MOP_READ_IMM_EXEC:
+		case MOP_FETCH_IAL:
+		case MOP_FETCH_IAH:
+		case MOP_JMP_ADH:
+		case MOP_BRANCH_OFFSET:
+			*flags |= COVERAGE_6502_OPERAND;
+			break;
+		case MOP_READ_PAGE_CROSS_EXEC:
+			if (!priv->page_crossed) {
+				*flags |= COVERAGE_6502_READ;
 			}
 			break;
-		case AC_6502_LDA :
-			decode_lda(cpu, phase);
-			return;
-		case AC_6502_LDX :
-			if (cpu->reg_ir != OP_6502_TAX && cpu->reg_ir != OP_6502_TSX) {
-				decode_ldx(cpu, phase);
-				return;
+		case MOP_PTR_ADL:
+		case MOP_PTR_ADH:
+		case MOP_PTR_ADH_Y:
+		case MOP_READ:
+		case MOP_READ_EXEC:
+		case MOP_IND_ADL:
+		case MOP_IND_ADH_JMP:
+		case MOP_POP_A_END:
+		case MOP_POP_P_END:
+		case MOP_POP_P_RTI:
+		case MOP_POP_PCL:
+		case MOP_POP_PCH:
+		case MOP_POP_PCH_END:
+			*flags |= COVERAGE_6502_READ;
+			break;
+		case MOP_BRK:
+			if (priv->decode_cycle >= 5) {
+				*flags |= COVERAGE_6502_READ;
 			}
 			break;
-		case AC_6502_LDY :
-			if (cpu->reg_ir != OP_6502_BCS && cpu->reg_ir != OP_6502_CLV && cpu->reg_ir != OP_6502_TAY) {
-				decode_ldy(cpu, phase);
-				return;
-			};
-			break;
-		case AC_6502_LSR :
-			decode_lsr(cpu, phase);
-			return;
-		case AC_6502_ORA :
-			decode_ora(cpu, phase);
-			return;
-		case AC_6502_ROL :
-			decode_rol(cpu, phase);
-			return;
-		case AC_6502_ROR :
-			decode_ror(cpu, phase);
-			return;
-		case AC_6502_SBC :
-			decode_sbc(cpu, phase);
-			return;
-		case AC_6502_STA :
-			decode_sta(cpu, phase);
-			return;
-	};
-
-	switch (cpu->reg_ir) {
-		case OP_6502_BCC :
-			decode_bcc(cpu, phase);
-			break;
-		case OP_6502_BCS :
-			decode_bcs(cpu, phase);
-			break;
-		case OP_6502_BIT_ZP :
-		case OP_6502_BIT_ABS:
-			decode_bit(cpu, phase);
-			break;
-		case OP_6502_BEQ :
-			decode_beq(cpu, phase);
-			break;
-		case OP_6502_BMI :
-			decode_bmi(cpu, phase);
-			break;
-		case OP_6502_BNE :
-			decode_bne(cpu, phase);
-			break;
-		case OP_6502_BPL :
-			decode_bpl(cpu, phase);
-			break;
-		case OP_6502_BRK :
-			decode_brk(cpu, phase);
-			break;
-		case OP_6502_BVC :
-			decode_bvc(cpu, phase);
-			break;
-		case OP_6502_BVS :
-			decode_bvs(cpu, phase);
-			break;
-		case OP_6502_CLC :
-			decode_clc(cpu, phase);
-			break;
-		case OP_6502_CLD :
-			decode_cld(cpu, phase);
-			break;
-		case OP_6502_CLI :
-			decode_cli(cpu, phase);
-			break;
-		case OP_6502_CLV :
-			decode_clv(cpu, phase);
-			break;
-		case OP_6502_CPX_IMM:
-		case OP_6502_CPX_ZP:
-		case OP_6502_CPX_ABS:
-			decode_cpx_cpy(cpu, phase, cpu->reg_x);
-			break;
-		case OP_6502_CPY_IMM:
-		case OP_6502_CPY_ZP:
-		case OP_6502_CPY_ABS:
-			decode_cpx_cpy(cpu, phase, cpu->reg_y);
-			break;
-		case OP_6502_DEX:
-			decode_dex(cpu, phase);
-			break;
-		case OP_6502_DEY:
-			decode_dey(cpu, phase);
-			break;
-		case OP_6502_INX:
-			decode_inx(cpu, phase);
-			break;
-		case OP_6502_INY:
-			decode_iny(cpu, phase);
-			break;
-		case OP_6502_JMP_ABS:
-		case OP_6502_JMP_IND:
-			decode_jmp(cpu, phase);
-			break;
-		case OP_6502_JSR:
-			decode_jsr(cpu, phase);
-			break;
-		case OP_6502_NOP:
-			decode_nop(cpu, phase);
-			break;
-		case OP_6502_PHA:
-			decode_pha(cpu, phase);
-			break;
-		case OP_6502_PHP:
-			decode_php(cpu, phase);
-			break;
-		case OP_6502_PLA:
-			decode_pla(cpu, phase);
-			break;
-		case OP_6502_PLP:
-			decode_plp(cpu, phase);
-			break;
-		case OP_6502_RTI:
-			decode_rti(cpu, phase);
-			break;
-		case OP_6502_RTS:
-			decode_rts(cpu, phase);
-			break;
-		case OP_6502_SEC :
-			decode_sec(cpu, phase);
-			break;
-		case OP_6502_SED :
-			decode_sed(cpu, phase);
-			break;
-		case OP_6502_SEI :
-			decode_sei(cpu, phase);
-			break;
-		case OP_6502_STX_ZP :
-		case OP_6502_STX_ZPY :
-		case OP_6502_STX_ABS :
-			decode_stx(cpu, phase);
-			break;
-		case OP_6502_STY_ZP :
-		case OP_6502_STY_ZPX :
-		case OP_6502_STY_ABS :
-			decode_sty(cpu, phase);
-			break;
-		case OP_6502_TAX :
-			decode_tax(cpu, phase);
-			break;
-		case OP_6502_TAY :
-			decode_tay(cpu, phase);
-			break;
-		case OP_6502_TSX :
-			decode_tsx(cpu, phase);
-			break;
-		case OP_6502_TXA :
-			decode_txa(cpu, phase);
-			break;
-		case OP_6502_TXS:
-			decode_txs(cpu, phase);
-			break;
-		case OP_6502_TYA :
-			decode_tya(cpu, phase);
+		default:
+			// dummy reads
 			break;
-	};
+	}
 }
 
 static inline void cpu_6502_execute_phase(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
 
-	// data-bus
+	// data-bus: the cpu only latches incoming data at the end of a cycle (in_data is filled in by the caller)
 	PRIVATE(cpu)->output.drv_data = false;
-	PRIVATE(cpu)->in_data = SIGNAL_GROUP_READ_U8(data);
+
+	if (phase == CYCLE_END && PRIVATE(cpu)->trace_current) {
+		trace_fetch(cpu);
+	}
+
+	if (phase == CYCLE_END && PRIVATE(cpu)->coverage) {
+		coverage_access(cpu);
+	}
 
 	// initialization is treated seperately
 	if (PRIVATE(cpu)->state == CS_INIT) {
@@ -2132,6 +1328,10 @@ static inline void cpu_6502_execute_phase(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
 		return;
 	}
 
+	if (PRIVATE(cpu)->profile && phase == CYCLE_BEGIN) {
+		++PRIVATE(cpu)->profile->cycle_count;
+	}
+
 	// check for interrupts between instructions
 	if (PRIVATE(cpu)->decode_cycle == 0 && phase == CYCLE_BEGIN) {
 		if (PRIVATE(cpu)->nmi_triggered) {
@@ -2145,6 +1345,20 @@ static inline void cpu_6502_execute_phase(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
 			cpu->reg_pc = PRIVATE(cpu)->override_pc;
 			PRIVATE(cpu)->override_pc = 0;
 		}
+
+		if (PRIVATE(cpu)->trace) {
+			if (PRIVATE(cpu)->trace_current) {
+				trace_end_instruction(cpu);
+			}
+			if (PRIVATE(cpu)->state == CS_RUNNING) {
+				trace_begin_instruction(cpu);
+			}
+		}
+
+		if (PRIVATE(cpu)->profile) {
+			cpu_6502_profile_next_instruction(PRIVATE(cpu)->profile, cpu->reg_ir, cpu->reg_pc, cpu->reg_sp,
+											  PRIVATE(cpu)->state == CS_RUNNING);
+		}
 	}
 
 	// irq starting sequence is handled seperately
@@ -2162,9 +1376,63 @@ static inline void cpu_6502_execute_phase(Cpu6502 *cpu, CPU_6502_CYCLE phase) {
 	if (PRIVATE(cpu)->decode_cycle == 0) {
 		fetch_pc_memory(cpu, &cpu->reg_ir, phase);
 	} else {
-		decode_instruction(cpu, phase);
+		execute_micro_op(cpu, phase);
+	}
+
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// fast bus
+//
+
+/* With a memory map attached, a cycle that accesses a mapped page doesn't drive the bus. At the end of such a cycle
+   the cpu keeps executing the instruction directly against the memory map, until it finishes or until it needs a
+   page that isn't mapped. The cycles that were executed ahead are then skipped while the clock catches up: an access
+   over the bus (e.g. to an I/O device) still happens at the time it would without the memory map and the next
+   instruction always starts in sync with the clock, when the interrupt lines are checked.
+*/
+
+#define FAST_BUS_MAX_AHEAD	8		// bound the cycles executed ahead (a jammed cpu never finishes its instruction)
+
+static inline bool fast_bus_mapped(Cpu6502_private *priv, uint16_t address) {
+	return priv->memory_map && priv->memory_map->read[HI_BYTE(address)] &&
+		   (!priv->memory_map->bus_watcher || priv->memory_map->bus_watcher->watch_count == 0);
+}
+
+static inline void fast_bus_access(Cpu6502_private *priv) {
+	uint8_t page = HI_BYTE(priv->output.address);
+
+	if (priv->output.rw == RW_READ) {
+		priv->in_data = priv->memory_map->read[page][LO_BYTE(priv->output.address)];
+	} else if (priv->output.drv_data && priv->memory_map->write[page]) {
+		priv->memory_map->write[page][LO_BYTE(priv->output.address)] = priv->output.data;
 	}
+}
+
+static void fast_bus_execute(Cpu6502 *cpu) {
+	Cpu6502_private *priv = PRIVATE(cpu);
+
+	while (true) {
+		fast_bus_access(priv);
+		cpu_6502_execute_phase(cpu, CYCLE_END);
+
+		if (priv->decode_cycle < 0 || priv->fast_idle == FAST_BUS_MAX_AHEAD) {
+			return;
+		}
+
+		++priv->decode_cycle;
+		cpu_6502_execute_phase(cpu, CYCLE_BEGIN);
+
+		if (!fast_bus_mapped(priv, priv->output.address)) {
+			// access over the bus: put it on the bus when the clock has caught up
+			priv->fast_begun = true;
+			return;
+		}
 
+		cpu_6502_execute_phase(cpu, CYCLE_MIDDLE);
+		++priv->fast_idle;
+	}
 }
 
 void cpu_6502_override_next_instruction_address(Cpu6502 *cpu, uint16_t pc) {
@@ -2182,11 +1450,78 @@ bool cpu_6502_irq_is_asserted(Cpu6502 *cpu) {
 	return ACTLO_ASSERTED(SIGNAL_READ_NEXT(IRQ_B));
 }
 
+void cpu_6502_set_trace(Cpu6502 *cpu, Cpu6502Trace *trace) {
+	assert(cpu);
+	PRIVATE(cpu)->trace = trace;
+	PRIVATE(cpu)->trace_current = NULL;
+}
+
+void cpu_6502_set_profile(Cpu6502 *cpu, Cpu6502Profile *profile) {
+	assert(cpu);
+	PRIVATE(cpu)->profile = profile;
+	if (profile) {
+		cpu_6502_profile_interrupted(profile);
+	}
+}
+
+void cpu_6502_set_coverage(Cpu6502 *cpu, Cpu6502Coverage *coverage) {
+	assert(cpu);
+	PRIVATE(cpu)->coverage = coverage;
+}
+
+void cpu_6502_set_memory_map(Cpu6502 *cpu, Cpu6502MemoryMap *map) {
+	assert(cpu);
+	PRIVATE(cpu)->memory_map = map;
+	PRIVATE(cpu)->fast_cycle = false;
+}
+
 int64_t cpu_6502_program_counter(Cpu6502 *cpu) {
 	assert(cpu);
 	return cpu->reg_pc;
 }
 
+Signal cpu_6502_instruction_start_signal(Cpu6502 *cpu) {
+	assert(cpu);
+	return SIGNAL(SYNC);
+}
+
+static const char *CPU_6502_REGISTER_NAMES[] = {"A", "X", "Y", "SP", "IR", "PC", "P"};
+
+int32_t cpu_6502_register_index(Cpu6502 *cpu, const char *name) {
+	assert(cpu);
+	assert(name);
+
+	for (int32_t idx = 0; idx < (int32_t) (sizeof(CPU_6502_REGISTER_NAMES) / sizeof(CPU_6502_REGISTER_NAMES[0])); ++idx) {
+		const char *reg = CPU_6502_REGISTER_NAMES[idx];
+		size_t i = 0;
+
+		while (reg[i] != '\0' && toupper((unsigned char) name[i]) == reg[i]) {
+			++i;
+		}
+
+		if (reg[i] == '\0' && name[i] == '\0') {
+			return idx;
+		}
+	}
+
+	return -1;
+}
+
+int64_t cpu_6502_register_value(Cpu6502 *cpu, int32_t index) {
+	assert(cpu);
+
+	switch (index) {
+		case 0: return cpu->reg_a;
+		case 1: return cpu->reg_x;
+		case 2: return cpu->reg_y;
+		case 3: return cpu->reg_sp;
+		case 4: return cpu->reg_ir;
+		case 5: return cpu->reg_pc;
+		case 6: return cpu->reg_p;
+		default: return 0;
+	}
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // interface functions
@@ -2208,6 +1543,9 @@ Cpu6502 *cpu_6502_create(Simulator *sim, Cpu6502Signals signals) {
 	cpu->is_at_start_of_instruction = (CPU_IS_AT_START_OF_INSTRUCTION) cpu_6502_at_start_of_instruction;
 	cpu->irq_is_asserted = (CPU_IRQ_IS_ASSERTED) cpu_6502_irq_is_asserted;
 	cpu->program_counter = (CPU_PROGRAM_COUNTER) cpu_6502_program_counter;
+	cpu->instruction_start_signal = (CPU_INSTRUCTION_START_SIGNAL) cpu_6502_instruction_start_signal;
+	cpu->register_index = (CPU_REGISTER_INDEX) cpu_6502_register_index;
+	cpu->register_value = (CPU_REGISTER_VALUE) cpu_6502_register_value;
 
 	dms_memcpy(cpu->signals, signals, sizeof(Cpu6502Signals));
 
@@ -2278,11 +1616,19 @@ static void cpu_6502_process(Cpu6502 *cpu) {
 			// reset was just asserted
 			priv->output.address = 0;
 			priv->output.rw = RW_READ;
+			priv->fast_cycle = false;
 		} else {
 			// reset was just deasserted - start initialization sequence
 			priv->state = CS_INIT;
 			priv->decode_cycle = -1;
 			priv->delayed_cycle = false;
+			priv->fast_cycle = false;
+			priv->fast_begun = false;
+			priv->fast_idle = 0;
+			priv->trace_current = NULL;
+			if (priv->profile) {
+				cpu_6502_profile_interrupted(priv->profile);
+			}
 		}
 	}
 
@@ -2305,18 +1651,33 @@ static void cpu_6502_process(Cpu6502 *cpu) {
 
 	if (priv->delayed_cycle) {
 		priv->delayed_cycle = false;
-		++priv->decode_cycle;
-		cpu_6502_execute_phase(cpu, CYCLE_BEGIN);
+		if (!priv->fast_begun) {
+			++priv->decode_cycle;
+			cpu_6502_execute_phase(cpu, CYCLE_BEGIN);
+		}
+		priv->fast_begun = false;
+		priv->fast_cycle = fast_bus_mapped(priv, priv->output.address);
 	} else if (clock && clock_changed) {
-		// a positive going clock marks the halfway point of the cycle
-		cpu_6502_execute_phase(cpu, CYCLE_MIDDLE);
+		// a positive going clock marks the halfway point of the cycle (unless it was already executed)
+		if (priv->fast_idle == 0) {
+			cpu_6502_execute_phase(cpu, CYCLE_MIDDLE);
+		}
 	} else if (!clock && clock_changed) {
 		// a negative going clock ends the previous cycle and starts a new cycle
-		cpu_6502_execute_phase(cpu, CYCLE_END);
+		if (priv->fast_idle > 0) {
+			--priv->fast_idle;
+		} else if (priv->fast_cycle) {
+			fast_bus_execute(cpu);
+		} else {
+			priv->in_data = SIGNAL_GROUP_READ_U8(data);
+			cpu_6502_execute_phase(cpu, CYCLE_END);
+		}
 
 		// ask to be woken up next timestep to process the delayed part of the negative edge
-		priv->delayed_cycle = true;
-		cpu->schedule_timestamp = cpu->simulator->current_tick + 1;
+		if (priv->fast_idle == 0) {
+			priv->delayed_cycle = true;
+			cpu->schedule_timestamp = cpu->simulator->current_tick + 1;
+		}
 	}
 
 	process_end(cpu);
@@ -95,9 +95,41 @@ typedef struct Cpu6502 {
 	uint8_t		reg_p;				// processor status register
 } Cpu6502;
 
+struct BusWatcher;
+
+typedef struct Cpu6502MemoryMap {
+	uint8_t *	read[256];			// memory of each page (NULL == the page is accessed through the signal bus)
+	uint8_t *	write[256];			// memory written to for each page with direct reads (NULL == writes are ignored)
+	const struct BusWatcher *bus_watcher;	// optional: every access uses the signal bus while it has watchpoints
+} Cpu6502MemoryMap;
+
 // functions
 Cpu6502 *cpu_6502_create(struct Simulator *sim, Cpu6502Signals signals);
 
+// cpu_6502_set_trace: record each instruction that starts executing into the trace (NULL == stop tracing)
+//	- the trace isn't owned by the cpu
+struct Cpu6502Trace;
+void cpu_6502_set_trace(Cpu6502 *cpu, struct Cpu6502Trace *trace);
+
+// cpu_6502_set_profile: count the instructions and cycles executed into the profile (NULL == stop profiling)
+//	- the profile isn't owned by the cpu, counting continues where it left off when it's attached again
+struct Cpu6502Profile;
+void cpu_6502_set_profile(Cpu6502 *cpu, struct Cpu6502Profile *profile);
+
+// cpu_6502_set_coverage: flag the addresses the cpu executes, reads and writes in the coverage map (NULL == stop)
+//	- the coverage isn't owned by the cpu
+struct Cpu6502Coverage;
+void cpu_6502_set_coverage(Cpu6502 *cpu, struct Cpu6502Coverage *coverage);
+
+// cpu_6502_set_memory_map: 'fast bus' mode, accesses to the pages in the map bypass the signal bus (NULL == disable)
+//	- at the end of the first cycle of an instruction that only touches mapped pages, the rest of the instruction is
+//	  executed at once, the cpu then idles until the clock catches up. Pages that aren't mapped (e.g. I/O) are still
+//	  accessed with regular bus cycles, at the right time. Interrupts are checked at the start of each instruction.
+//	- the bus isn't driven for mapped accesses: chips don't see these. Set the bus_watcher of the map to fall back to
+//	  regular bus cycles while it has watchpoints, or they won't trigger on mapped pages.
+//	- the map isn't owned by the cpu
+void cpu_6502_set_memory_map(Cpu6502 *cpu, Cpu6502MemoryMap *map);
+
 #ifdef __cplusplus
 }
 #endif
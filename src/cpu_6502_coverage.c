@@ -0,0 +1,290 @@
+// cpu_6502_coverage.c - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Code and data coverage of the 6502: flags for each address that was executed, read or written
+
+#include "cpu_6502_coverage.h"
+#include "cpu_6502_profile.h"
+#include "crt.h"
+#include "utils.h"
+
+#include <stb/stb_ds.h>
+#include <ctype.h>
+#include <stdio.h>
+
+#define COVERAGE_MAGIC		"DMSCOVER"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// helper functions
+//
+
+static uint32_t line_map_file_index(Cpu6502LineMap *map, const char *name, size_t len) {
+	// the lines of a file are usually consecutive: search from the back
+	for (size_t i = arrlenu(map->files); i > 0; --i) {
+		if (strlen(map->files[i - 1]) == len && strncmp(map->files[i - 1], name, len) == 0) {
+			return (uint32_t) (i - 1);
+		}
+	}
+
+	char *file = (char *) dms_calloc(len + 1, 1);
+	dms_memcpy(file, name, len);
+	arrpush(map->files, file);
+	return (uint32_t) (arrlenu(map->files) - 1);
+}
+
+static bool parse_line(Cpu6502LineMap *map, char *text, Cpu6502SourceLine *result) {
+	// <address> <file>:<line>
+	char *c = text;
+	while (isspace((unsigned char) *c)) {
+		++c;
+	}
+	if (*c == '\0' || *c == ';' || *c == '#') {
+		return false;
+	}
+
+	char *address = c;
+	while (*c != '\0' && !isspace((unsigned char) *c)) {
+		++c;
+	}
+	char *address_end = c;
+
+	while (isspace((unsigned char) *c)) {
+		++c;
+	}
+	char *location = c;
+	while (*c != '\0' && !isspace((unsigned char) *c)) {
+		++c;
+	}
+	*address_end = '\0';			// terminate the address token for the symbol file parser
+
+	// the file name may contain a colon (e.g. a drive letter): the line number follows the last one
+	char *colon = NULL;
+	for (char *p = location; p < c; ++p) {
+		if (*p == ':') {
+			colon = p;
+		}
+	}
+	if (!colon || colon == location) {
+		return false;
+	}
+
+	char *line_end = NULL;
+	long line = strtol(colon + 1, &line_end, 10);
+	if (line_end != c || line <= 0 || !cpu_6502_symbol_parse_address(address, &result->address)) {
+		return false;
+	}
+
+	result->line = (uint32_t) line;
+	result->file = line_map_file_index(map, location, (size_t) (colon - location));
+	return true;
+}
+
+static int compare_lines(const void *a, const void *b) {
+	const Cpu6502SourceLine *line_a = (const Cpu6502SourceLine *) a;
+	const Cpu6502SourceLine *line_b = (const Cpu6502SourceLine *) b;
+
+	if (line_a->file != line_b->file) {
+		return (line_a->file < line_b->file) ? -1 : 1;
+	}
+	if (line_a->line != line_b->line) {
+		return (line_a->line < line_b->line) ? -1 : 1;
+	}
+	return (int) line_a->address - (int) line_b->address;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// interface functions
+//
+
+Cpu6502Coverage *cpu_6502_coverage_create(void) {
+	return (Cpu6502Coverage *) dms_calloc(1, sizeof(Cpu6502Coverage));
+}
+
+void cpu_6502_coverage_destroy(Cpu6502Coverage *coverage) {
+	assert(coverage);
+	dms_free(coverage);
+}
+
+void cpu_6502_coverage_clear(Cpu6502Coverage *coverage) {
+	assert(coverage);
+	dms_zero(coverage, sizeof(Cpu6502Coverage));
+}
+
+void cpu_6502_coverage_merge(Cpu6502Coverage *dst, const Cpu6502Coverage *src) {
+	assert(dst);
+	assert(src);
+
+	for (size_t i = 0; i < sizeof(dst->flags); ++i) {
+		dst->flags[i] |= src->flags[i];
+	}
+}
+
+size_t cpu_6502_coverage_count(const Cpu6502Coverage *coverage, uint8_t flags) {
+	assert(coverage);
+
+	size_t count = 0;
+	for (size_t i = 0; i < sizeof(coverage->flags); ++i) {
+		count += (coverage->flags[i] & flags) != 0;
+	}
+	return count;
+}
+
+bool cpu_6502_coverage_save(const Cpu6502Coverage *coverage, const char *filename) {
+	assert(coverage);
+	assert(filename);
+
+	FILE *fp = NULL;
+	if (dms_fopen(fp, filename, "wb")) {
+		return false;
+	}
+
+	uint8_t version[4] = {CPU_6502_COVERAGE_VERSION & 0xff, 0, 0, 0};
+	dms_fwrite(COVERAGE_MAGIC, 1, 8, fp);
+	dms_fwrite(version, 1, sizeof(version), fp);
+	dms_fwrite(coverage->flags, 1, sizeof(coverage->flags), fp);
+
+	bool ok = !ferror(fp);
+	dms_fclose(fp);
+	return ok;
+}
+
+Cpu6502Coverage *cpu_6502_coverage_load(const char *filename) {
+	assert(filename);
+
+	FILE *fp = NULL;
+	if (dms_fopen(fp, filename, "rb")) {
+		return NULL;
+	}
+
+	char magic[8];
+	uint8_t version[4];
+	bool ok = dms_fread(magic, 1, 8, fp) == 8 && dms_memcmp(magic, COVERAGE_MAGIC, 8) == 0 &&
+			  dms_fread(version, 1, 4, fp) == 4 && version[0] == CPU_6502_COVERAGE_VERSION &&
+			  version[1] == 0 && version[2] == 0 && version[3] == 0;
+
+	Cpu6502Coverage *coverage = (ok) ? cpu_6502_coverage_create() : NULL;
+
+	if (coverage && dms_fread(coverage->flags, 1, sizeof(coverage->flags), fp) != sizeof(coverage->flags)) {
+		cpu_6502_coverage_destroy(coverage);
+		coverage = NULL;
+	}
+
+	dms_fclose(fp);
+	return coverage;
+}
+
+Cpu6502LineMap *cpu_6502_line_map_load(const char *filename) {
+	assert(filename);
+
+	FILE *fp = NULL;
+	if (dms_fopen(fp, filename, "r")) {
+		return NULL;
+	}
+
+	Cpu6502LineMap *map = (Cpu6502LineMap *) dms_calloc(1, sizeof(Cpu6502LineMap));
+	char text[1024];
+
+	while (fgets(text, sizeof(text), fp)) {
+		Cpu6502SourceLine line;
+		if (parse_line(map, text, &line)) {
+			arrpush(map->lines, line);
+		}
+	}
+
+	dms_fclose(fp);
+
+	if (!map->lines) {
+		cpu_6502_line_map_release(map);
+		return NULL;
+	}
+
+	qsort(map->lines, arrlenu(map->lines), sizeof(Cpu6502SourceLine), compare_lines);
+	return map;
+}
+
+void cpu_6502_line_map_release(Cpu6502LineMap *map) {
+	if (!map) {
+		return;
+	}
+
+	for (size_t i = 0; i < arrlenu(map->files); ++i) {
+		dms_free(map->files[i]);
+	}
+	arrfree(map->files);
+	arrfree(map->lines);
+	dms_free(map);
+}
+
+char *cpu_6502_coverage_lcov(const Cpu6502Coverage *coverage, const Cpu6502LineMap *map,
+							 Cpu6502Symbol *symbols, const char *test_name) {
+	assert(coverage);
+	assert(map);
+
+	char *report = NULL;
+	size_t num_lines = arrlenu(map->lines);
+
+	if (test_name) {
+		arr_printf(report, "TN:%s\n", test_name);
+	}
+
+	for (size_t first = 0; first < num_lines; ) {
+		uint32_t file = map->lines[first].file;
+		size_t last = first;
+		while (last < num_lines && map->lines[last].file == file) {
+			++last;
+		}
+
+		arr_printf(report, "SF:%s\n", map->files[file]);
+
+		// functions: symbols at the address of a line of this file
+		size_t fn_found = 0;
+		size_t fn_hit = 0;
+
+		for (int pass = 0; pass < 2; ++pass) {
+			for (size_t s = 0; s < arrlenu(symbols); ++s) {
+				for (size_t i = first; i < last; ++i) {
+					if (map->lines[i].address != symbols[s].address) {
+						continue;
+					}
+
+					bool hit = (coverage->flags[symbols[s].address] & COVERAGE_6502_OPCODE) != 0;
+					if (pass == 0) {
+						arr_printf(report, "FN:%u,%s\n", map->lines[i].line, symbols[s].name);
+						fn_found += 1;
+						fn_hit += hit;
+					} else {
+						arr_printf(report, "FNDA:%d,%s\n", hit, symbols[s].name);
+					}
+					break;
+				}
+			}
+		}
+
+		if (fn_found > 0) {
+			arr_printf(report, "FNF:%zu\nFNH:%zu\n", fn_found, fn_hit);
+		}
+
+		// lines: hit when any address on the line was executed as an opcode
+		size_t lines_found = 0;
+		size_t lines_hit = 0;
+
+		for (size_t i = first; i < last; ) {
+			uint32_t line = map->lines[i].line;
+			bool hit = false;
+
+			for (; i < last && map->lines[i].line == line; ++i) {
+				hit = hit || (coverage->flags[map->lines[i].address] & COVERAGE_6502_OPCODE);
+			}
+
+			arr_printf(report, "DA:%u,%d\n", line, hit);
+			lines_found += 1;
+			lines_hit += hit;
+		}
+
+		arr_printf(report, "LF:%zu\nLH:%zu\nend_of_record\n", lines_found, lines_hit);
+		first = last;
+	}
+
+	return report;
+}
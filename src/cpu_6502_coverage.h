@@ -0,0 +1,74 @@
+// cpu_6502_coverage.h - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Code and data coverage of the 6502: flags for each address that was executed, read or written
+
+#ifndef DROMAIUS_CPU_6502_COVERAGE_H
+#define DROMAIUS_CPU_6502_COVERAGE_H
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// types
+#define CPU_6502_COVERAGE_VERSION	1
+
+typedef enum Cpu6502CoverageFlags {
+	COVERAGE_6502_OPCODE	= 0b00000001,		// fetched as the opcode of an instruction
+	COVERAGE_6502_OPERAND	= 0b00000010,		// fetched as an operand of an instruction
+	COVERAGE_6502_READ		= 0b00000100,		// read as data (dummy reads excluded)
+	COVERAGE_6502_WRITE		= 0b00001000,		// written
+
+	COVERAGE_6502_EXECUTED	= COVERAGE_6502_OPCODE | COVERAGE_6502_OPERAND
+} Cpu6502CoverageFlags;
+
+typedef struct Cpu6502Coverage {
+	uint8_t			flags[65536];			// Cpu6502CoverageFlags (indexed by address)
+} Cpu6502Coverage;
+
+typedef struct Cpu6502SourceLine {
+	uint16_t		address;
+	uint32_t		file;					// index in the files of the line map
+	uint32_t		line;
+} Cpu6502SourceLine;
+
+typedef struct Cpu6502LineMap {
+	char **				files;				// dynamic array with the names of the source files
+	Cpu6502SourceLine *	lines;				// dynamic array, sorted by file and line
+} Cpu6502LineMap;
+
+struct Cpu6502Symbol;
+
+// functions
+Cpu6502Coverage *cpu_6502_coverage_create(void);
+void cpu_6502_coverage_destroy(Cpu6502Coverage *coverage);
+void cpu_6502_coverage_clear(Cpu6502Coverage *coverage);
+
+// cpu_6502_coverage_merge: add the addresses covered in src to dst
+void cpu_6502_coverage_merge(Cpu6502Coverage *dst, const Cpu6502Coverage *src);
+
+// cpu_6502_coverage_count: number of addresses with at least one of the flags set
+size_t cpu_6502_coverage_count(const Cpu6502Coverage *coverage, uint8_t flags);
+
+// binary coverage map: header ("DMSCOVER", uint32_t version (little-endian)) followed by the flags of each address
+bool cpu_6502_coverage_save(const Cpu6502Coverage *coverage, const char *filename);
+Cpu6502Coverage *cpu_6502_coverage_load(const char *filename);
+
+// cpu_6502_line_map_load: read the source line of each address (one "<address> <file>:<line>" per line)
+//	- the address is decimal or hexadecimal with the '$' or '0x' prefix, lines starting with ';' or '#' are ignored
+//	- returns NULL if the file can't be read or maps no addresses
+Cpu6502LineMap *cpu_6502_line_map_load(const char *filename);
+void cpu_6502_line_map_release(Cpu6502LineMap *map);
+
+// cpu_6502_coverage_lcov: lcov tracefile (dynamic array) for the source lines in the map
+//	- a line is hit when the opcode of an instruction on the line was executed
+//	- symbols (optional) that start on a mapped line are reported as functions
+char *cpu_6502_coverage_lcov(const Cpu6502Coverage *coverage, const Cpu6502LineMap *map,
+							 struct Cpu6502Symbol *symbols, const char *test_name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DROMAIUS_CPU_6502_COVERAGE_H
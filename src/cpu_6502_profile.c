@@ -0,0 +1,372 @@
+// cpu_6502_profile.c - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Execution profiler for the 6502: counts instructions and cycles per address and cycles spent in subroutines
+
+#include "cpu_6502_profile.h"
+#include "cpu_6502_opcodes.h"
+#include "crt.h"
+#include "utils.h"
+
+#include <stb/stb_ds.h>
+#include <ctype.h>
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// internal types
+//
+
+typedef struct ProfileRange {
+	uint64_t	cycles;
+	uint64_t	instructions;
+	uint16_t	first;					// lowest executed address in the range
+	uint16_t	last;					// highest executed address in the range
+	int32_t		label;					// index of the symbol (< 0: page of memory)
+} ProfileRange;
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// helper functions
+//
+
+static inline void call_stack_pop(Cpu6502Profile *profile, uint64_t now) {
+	Cpu6502ProfileCall *call = &profile->call_stack[--profile->call_depth];
+	profile->inclusive_cycles[call->target] += now - call->start_cycle;
+}
+
+static void call_stack_return(Cpu6502Profile *profile, uint8_t sp, uint64_t now) {
+	// calls whose return address was already removed from the stack (e.g. by resetting the stack pointer) are finished
+	while (profile->call_depth > 0 && profile->call_stack[profile->call_depth - 1].sp - 2 < sp) {
+		call_stack_pop(profile, now);
+	}
+
+	// a RTS with more on the stack is used as a computed jump, not as the end of a subroutine
+	if (profile->call_depth > 0 && profile->call_stack[profile->call_depth - 1].sp - 2 == sp) {
+		call_stack_pop(profile, now);
+	}
+}
+
+static int compare_symbols(const void *a, const void *b) {
+	const Cpu6502Symbol *sym_a = (const Cpu6502Symbol *) a;
+	const Cpu6502Symbol *sym_b = (const Cpu6502Symbol *) b;
+
+	if (sym_a->address != sym_b->address) {
+		return (sym_a->address < sym_b->address) ? -1 : 1;
+	}
+	return dms_strcmp(sym_a->name, sym_b->name);
+}
+
+static int compare_ranges(const void *a, const void *b) {
+	const ProfileRange *range_a = (const ProfileRange *) a;
+	const ProfileRange *range_b = (const ProfileRange *) b;
+
+	if (range_a->cycles != range_b->cycles) {
+		return (range_a->cycles > range_b->cycles) ? -1 : 1;
+	}
+	return (range_a->first < range_b->first) ? -1 : 1;
+}
+
+static bool parse_symbol_line(char *line, Cpu6502Symbol *symbol) {
+	// split the line into (at most 3) whitespace separated tokens
+	char *tokens[3] = {NULL, NULL, NULL};
+	size_t count = 0;
+
+	for (char *c = line; *c != '\0' && count < 3; ) {
+		while (isspace((unsigned char) *c)) {
+			++c;
+		}
+		if (*c == '\0' || *c == ';') {
+			break;
+		}
+		tokens[count++] = c;
+		while (*c != '\0' && !isspace((unsigned char) *c)) {
+			++c;
+		}
+		if (*c != '\0') {
+			*c++ = '\0';
+		}
+	}
+
+	if (count < 3) {
+		return false;
+	}
+
+	uint16_t address;
+	const char *name = NULL;
+
+	if (dms_strcmp(tokens[0], "al") == 0) {
+		// VICE: al C:1234 .label
+		const char *addr = tokens[1];
+		if (addr[0] != '\0' && addr[1] == ':') {
+			addr += 2;
+		}
+		char *end = NULL;
+		int64_t value = strtoll(addr, &end, 16);
+		if (end == addr || *end != '\0' || value < 0 || value > 0xffff) {
+			return false;
+		}
+		address = (uint16_t) value;
+		name = (tokens[2][0] == '.') ? tokens[2] + 1 : tokens[2];
+	} else if (dms_strcmp(tokens[1], "=") == 0 || dms_strcmp(tokens[1], "equ") == 0 || dms_strcmp(tokens[1], "EQU") == 0) {
+		// assignment: label = $1234
+		if (!cpu_6502_symbol_parse_address(tokens[2], &address)) {
+			return false;
+		}
+		name = tokens[0];
+	} else {
+		return false;
+	}
+
+	if (name[0] == '\0') {
+		return false;
+	}
+
+	symbol->address = address;
+	symbol->name = dms_strdup(name);
+	return true;
+}
+
+static int32_t symbol_lookup(Cpu6502Symbol *symbols, uint16_t address) {
+	// index of the last symbol with an address less than or equal to the address (-1 if none)
+	int32_t lo = 0;
+	int32_t hi = (int32_t) arrlen(symbols) - 1;
+	int32_t result = -1;
+
+	while (lo <= hi) {
+		int32_t mid = (lo + hi) / 2;
+		if (symbols[mid].address <= address) {
+			result = mid;
+			lo = mid + 1;
+		} else {
+			hi = mid - 1;
+		}
+	}
+
+	return result;
+}
+
+static void print_label(char **report, Cpu6502Symbol *symbols, uint16_t address) {
+	int32_t sym = symbol_lookup(symbols, address);
+
+	if (sym < 0) {
+		arr_printf(*report, "$%.4x", address);
+	} else if (symbols[sym].address == address) {
+		arr_printf(*report, "%s", symbols[sym].name);
+	} else {
+		arr_printf(*report, "%s+$%x", symbols[sym].name, address - symbols[sym].address);
+	}
+}
+
+static inline double percentage(uint64_t part, uint64_t total) {
+	return (total > 0) ? (100.0 * (double) part) / (double) total : 0.0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// interface functions
+//
+
+Cpu6502Profile *cpu_6502_profile_create(void) {
+	Cpu6502Profile *profile = (Cpu6502Profile *) dms_calloc(1, sizeof(Cpu6502Profile));
+	profile->current_pc = -1;
+	return profile;
+}
+
+void cpu_6502_profile_destroy(Cpu6502Profile *profile) {
+	assert(profile);
+	dms_free(profile);
+}
+
+void cpu_6502_profile_clear(Cpu6502Profile *profile) {
+	assert(profile);
+	dms_zero(profile, sizeof(Cpu6502Profile));
+	profile->current_pc = -1;
+}
+
+void cpu_6502_profile_next_instruction(Cpu6502Profile *profile, uint8_t last_opcode, uint16_t pc, uint8_t sp, bool running) {
+	assert(profile);
+
+	// the first cycle of the new instruction was already counted
+	uint64_t now = profile->cycle_count - 1;
+
+	if (profile->current_pc >= 0) {
+		profile->cycles[profile->current_pc] += now - profile->current_start;
+
+		if (last_opcode == OP_6502_JSR && profile->call_depth < CPU_6502_PROFILE_CALL_DEPTH) {
+			profile->call_stack[profile->call_depth++] = (Cpu6502ProfileCall) {
+				.start_cycle = profile->current_start,
+				.target = pc,
+				.sp = profile->current_sp
+			};
+			++profile->calls[pc];
+		} else if (last_opcode == OP_6502_RTS) {
+			call_stack_return(profile, profile->current_sp, now);
+		}
+	}
+
+	if (running) {
+		++profile->instructions[pc];
+		profile->current_pc = pc;
+		profile->current_sp = sp;
+		profile->current_start = now;
+	} else {
+		profile->current_pc = -1;
+	}
+}
+
+void cpu_6502_profile_interrupted(Cpu6502Profile *profile) {
+	assert(profile);
+	profile->current_pc = -1;
+	profile->call_depth = 0;
+}
+
+bool cpu_6502_symbol_parse_address(const char *token, uint16_t *address) {
+	assert(token);
+	assert(address);
+
+	const char *digits = token;
+	int base = 10;
+
+	if (token[0] == '$') {
+		digits = token + 1;
+		base = 16;
+	} else if (token[0] == '0' && (token[1] == 'x' || token[1] == 'X')) {
+		digits = token + 2;
+		base = 16;
+	}
+
+	// strtoll skips leading whitespace and accepts a sign: only digits are allowed
+	if (!isxdigit((unsigned char) digits[0])) {
+		return false;
+	}
+
+	char *end = NULL;
+	int64_t value = strtoll(digits, &end, base);
+
+	if (end == digits || *end != '\0' || value < 0 || value > 0xffff) {
+		return false;
+	}
+
+	*address = (uint16_t) value;
+	return true;
+}
+
+Cpu6502Symbol *cpu_6502_symbols_load(const char *filename) {
+	assert(filename);
+
+	FILE *fp = NULL;
+	if (dms_fopen(fp, filename, "r")) {
+		return NULL;
+	}
+
+	Cpu6502Symbol *symbols = NULL;
+	char line[512];
+
+	while (fgets(line, sizeof(line), fp)) {
+		Cpu6502Symbol symbol;
+		if (parse_symbol_line(line, &symbol)) {
+			arrpush(symbols, symbol);
+		}
+	}
+
+	dms_fclose(fp);
+
+	if (symbols) {
+		qsort(symbols, arrlenu(symbols), sizeof(Cpu6502Symbol), compare_symbols);
+	}
+
+	return symbols;
+}
+
+void cpu_6502_symbols_release(Cpu6502Symbol *symbols) {
+	for (size_t i = 0; i < arrlenu(symbols); ++i) {
+		dms_free(symbols[i].name);
+	}
+	arrfree(symbols);
+}
+
+char *cpu_6502_profile_report(Cpu6502Profile *profile, Cpu6502Symbol *symbols, size_t count) {
+	assert(profile);
+
+	char *report = NULL;
+	uint64_t total_instructions = 0;
+
+	// group the addresses in ranges that start at a label (or a page boundary when there's no label)
+	size_t num_symbols = arrlenu(symbols);
+	ProfileRange *ranges = NULL;
+	arrsetlen(ranges, num_symbols + 256);
+	dms_zero(ranges, arrlenu(ranges) * sizeof(ProfileRange));
+
+	for (uint32_t addr = 0; addr < 65536; ++addr) {
+		if (profile->instructions[addr] == 0) {
+			continue;
+		}
+
+		int32_t sym = symbol_lookup(symbols, (uint16_t) addr);
+		ProfileRange *range = &ranges[(sym >= 0) ? (size_t) sym : num_symbols + (addr >> 8)];
+
+		if (range->instructions == 0) {
+			range->first = (uint16_t) addr;
+			range->label = sym;
+		}
+		range->cycles += profile->cycles[addr];
+		range->instructions += profile->instructions[addr];
+		range->last = (uint16_t) addr;
+		total_instructions += profile->instructions[addr];
+	}
+
+	size_t num_ranges = 0;
+	for (size_t i = 0; i < arrlenu(ranges); ++i) {
+		if (ranges[i].instructions > 0) {
+			ranges[num_ranges++] = ranges[i];
+		}
+	}
+	qsort(ranges, num_ranges, sizeof(ProfileRange), compare_ranges);
+
+	arr_printf(report, "total: %" PRIu64 " instructions, %" PRIu64 " cycles\n", total_instructions, profile->cycle_count);
+
+	arr_printf(report, "\nhot ranges (cycles spent in the instructions of the range)\n");
+	arr_printf(report, "%14s %7s %14s  %-11s  %s\n", "cycles", "%", "instructions", "range", "label");
+
+	for (size_t i = 0; i < num_ranges && i < count; ++i) {
+		ProfileRange *range = &ranges[i];
+		arr_printf(report, "%14" PRIu64 " %6.2f%% %14" PRIu64 "  $%.4x-$%.4x  ",
+				   range->cycles, percentage(range->cycles, profile->cycle_count), range->instructions,
+				   range->first, range->last);
+		if (range->label >= 0) {
+			arr_printf(report, "%s\n", symbols[range->label].name);
+		} else {
+			arr_printf(report, "(page $%.2x)\n", range->first >> 8);
+		}
+	}
+
+	// subroutines: reuse the ranges to sort the targets of JSR's on their inclusive cycles
+	stbds_header(ranges)->length = 0;
+	for (uint32_t addr = 0; addr < 65536; ++addr) {
+		if (profile->calls[addr] > 0) {
+			ProfileRange target = {
+				.cycles = profile->inclusive_cycles[addr],
+				.instructions = profile->calls[addr],
+				.first = (uint16_t) addr
+			};
+			arrpush(ranges, target);
+		}
+	}
+	num_ranges = arrlenu(ranges);
+	if (num_ranges > 0) {
+		qsort(ranges, num_ranges, sizeof(ProfileRange), compare_ranges);
+	}
+
+	arr_printf(report, "\nhot subroutines (cycles from JSR until RTS, including nested calls)\n");
+	arr_printf(report, "%14s %7s %14s  %-11s  %s\n", "cycles", "%", "calls", "target", "label");
+
+	for (size_t i = 0; i < num_ranges && i < count; ++i) {
+		ProfileRange *range = &ranges[i];
+		arr_printf(report, "%14" PRIu64 " %6.2f%% %14" PRIu64 "  $%.4x        ",
+				   range->cycles, percentage(range->cycles, profile->cycle_count), range->instructions, range->first);
+		print_label(&report, symbols, range->first);
+		arr_printf(report, "\n");
+	}
+
+	arrfree(ranges);
+	return report;
+}
@@ -0,0 +1,77 @@
+// cpu_6502_profile.h - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Execution profiler for the 6502: counts instructions and cycles per address and cycles spent in subroutines
+
+#ifndef DROMAIUS_CPU_6502_PROFILE_H
+#define DROMAIUS_CPU_6502_PROFILE_H
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// types
+#define CPU_6502_PROFILE_CALL_DEPTH		128
+
+typedef struct Cpu6502ProfileCall {
+	uint64_t		start_cycle;			// cycle at the start of the JSR
+	uint16_t		target;					// address of the subroutine
+	uint8_t			sp;						// stack pointer before the JSR
+} Cpu6502ProfileCall;
+
+typedef struct Cpu6502Profile {
+	// counters (indexed by address)
+	uint64_t		instructions[65536];	// instructions executed with their opcode at the address
+	uint64_t		cycles[65536];			// cycles spent in the instructions at the address (interrupt sequences excluded)
+	uint64_t		calls[65536];			// number of JSR's to the address
+	uint64_t		inclusive_cycles[65536];// cycles from a JSR to the address until the matching RTS (nested calls and interrupts included)
+
+	uint64_t		cycle_count;			// cycles executed while profiling
+
+	// instruction in progress
+	int32_t			current_pc;				// -1 == no instruction (e.g. during an interrupt sequence)
+	uint8_t			current_sp;
+	uint64_t		current_start;
+
+	// shadow call stack
+	Cpu6502ProfileCall	call_stack[CPU_6502_PROFILE_CALL_DEPTH];
+	int32_t				call_depth;
+} Cpu6502Profile;
+
+typedef struct Cpu6502Symbol {
+	uint16_t		address;
+	char *			name;
+} Cpu6502Symbol;
+
+// functions
+Cpu6502Profile *cpu_6502_profile_create(void);
+void cpu_6502_profile_destroy(Cpu6502Profile *profile);
+void cpu_6502_profile_clear(Cpu6502Profile *profile);
+
+// called by the cpu
+//	- cpu_6502_profile_next_instruction: at the start of each instruction or interrupt sequence (running == false),
+//	  last_opcode is the opcode of the instruction that just finished.
+//	- cpu_6502_profile_interrupted: the cpu was reset, forget the instruction in progress and the call stack
+void cpu_6502_profile_next_instruction(Cpu6502Profile *profile, uint8_t last_opcode, uint16_t pc, uint8_t sp, bool running);
+void cpu_6502_profile_interrupted(Cpu6502Profile *profile);
+
+// cpu_6502_symbols_load: read the labels of an assembler symbol file into a dynamic array (sorted by address)
+//	supported formats: VICE label files (also written by ld65 -Ln) "al C:1234 .label"
+//					   assignments (ACME, 64tass, ...) "label = $1234" or "label equ $1234"
+//	returns NULL if the file can't be read or contains no symbols
+Cpu6502Symbol *cpu_6502_symbols_load(const char *filename);
+
+// cpu_6502_symbol_parse_address: a complete token with a 16-bit address in the notation of the symbol files ($1234, 0x1234 or 4660)
+bool cpu_6502_symbol_parse_address(const char *token, uint16_t *address);
+void cpu_6502_symbols_release(Cpu6502Symbol *symbols);
+
+// cpu_6502_profile_report: text report (dynamic array) of the top 'count' ranges between labels and subroutines
+//	- without a label the range is the page of memory
+char *cpu_6502_profile_report(Cpu6502Profile *profile, Cpu6502Symbol *symbols, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DROMAIUS_CPU_6502_PROFILE_H
@@ -0,0 +1,176 @@
+// cpu_6502_trace.c - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Instruction trace of a 6502: a ring buffer with a fixed-size record for each executed instruction
+
+/* Trace file format (values are little-endian)
+	header:	"DMSTRACE", uint32_t version, uint64_t record count, int64_t tick of the newest record
+	record:	Cpu6502TraceRecord (16 bytes), from oldest to newest
+*/
+
+#include "cpu_6502_trace.h"
+#include "crt.h"
+#include "utils.h"
+
+#include <stb/stb_ds.h>
+#include <stdio.h>
+
+#define TRACE_MAGIC		"DMSTRACE"
+
+static_assert(sizeof(Cpu6502TraceRecord) == 16, "Cpu6502TraceRecord should stay compact");
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// helper functions
+//
+
+static inline void write_record(FILE *fp, const Cpu6502TraceRecord *record) {
+	uint8_t buffer[sizeof(Cpu6502TraceRecord)] = {
+		(uint8_t) record->tick_delta, (uint8_t) (record->tick_delta >> 8),
+		(uint8_t) (record->tick_delta >> 16), (uint8_t) (record->tick_delta >> 24),
+		(uint8_t) record->pc, (uint8_t) (record->pc >> 8),
+		(uint8_t) record->address, (uint8_t) (record->address >> 8),
+		record->bytes[0], record->bytes[1], record->bytes[2],
+		record->reg_a, record->reg_x, record->reg_y, record->reg_sp, record->reg_p
+	};
+	dms_fwrite(buffer, 1, sizeof(buffer), fp);
+}
+
+static inline bool read_record(FILE *fp, Cpu6502TraceRecord *record) {
+	uint8_t b[sizeof(Cpu6502TraceRecord)];
+	if (dms_fread(b, 1, sizeof(b), fp) != sizeof(b)) {
+		return false;
+	}
+
+	*record = (Cpu6502TraceRecord) {
+		.tick_delta = (uint32_t) b[0] | ((uint32_t) b[1] << 8) | ((uint32_t) b[2] << 16) | ((uint32_t) b[3] << 24),
+		.pc = (uint16_t) (b[4] | (b[5] << 8)),
+		.address = (uint16_t) (b[6] | (b[7] << 8)),
+		.bytes = {b[8], b[9], b[10]},
+		.reg_a = b[11], .reg_x = b[12], .reg_y = b[13], .reg_sp = b[14], .reg_p = b[15]
+	};
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// interface functions
+//
+
+Cpu6502Trace *cpu_6502_trace_create(uint64_t capacity) {
+	if (capacity > CPU_6502_TRACE_MAX_CAPACITY) {
+		return NULL;
+	}
+
+	uint64_t size = 1;
+	while (size < capacity) {
+		size <<= 1;
+	}
+
+	Cpu6502Trace *trace = (Cpu6502Trace *) dms_calloc(1, sizeof(Cpu6502Trace));
+	if (!trace) {
+		return NULL;
+	}
+
+	trace->records = (Cpu6502TraceRecord *) dms_calloc(size, sizeof(Cpu6502TraceRecord));
+	trace->mask = size - 1;
+
+	if (!trace->records) {
+		dms_free(trace);
+		return NULL;
+	}
+
+	return trace;
+}
+
+void cpu_6502_trace_destroy(Cpu6502Trace *trace) {
+	assert(trace);
+	dms_free(trace->records);
+	dms_free(trace);
+}
+
+void cpu_6502_trace_clear(Cpu6502Trace *trace) {
+	assert(trace);
+	trace->count = 0;
+	trace->last_tick = 0;
+}
+
+int64_t *cpu_6502_trace_ticks(Cpu6502Trace *trace) {
+	assert(trace);
+
+	int64_t *ticks = NULL;
+	uint64_t size = cpu_6502_trace_size(trace);
+	if (size == 0) {
+		return ticks;
+	}
+
+	// only the newest tick is absolute: walk back through the deltas
+	arrsetlen(ticks, size);
+	ticks[size - 1] = trace->last_tick;
+	for (uint64_t i = size - 1; i > 0; --i) {
+		ticks[i - 1] = ticks[i] - cpu_6502_trace_record(trace, i)->tick_delta;
+	}
+
+	return ticks;
+}
+
+bool cpu_6502_trace_save(Cpu6502Trace *trace, const char *filename) {
+	assert(trace);
+	assert(filename);
+
+	FILE *fp = NULL;
+	if (dms_fopen(fp, filename, "wb")) {
+		return false;
+	}
+
+	uint64_t size = cpu_6502_trace_size(trace);
+
+	dms_fwrite(TRACE_MAGIC, 1, 8, fp);
+	file_write_uint_le(fp, CPU_6502_TRACE_VERSION, 4);
+	file_write_uint_le(fp, size, 8);
+	file_write_uint_le(fp, (uint64_t) trace->last_tick, 8);
+
+	for (uint64_t i = 0; i < size; ++i) {
+		write_record(fp, cpu_6502_trace_record(trace, i));
+	}
+
+	bool ok = !ferror(fp);
+	dms_fclose(fp);
+	return ok;
+}
+
+Cpu6502Trace *cpu_6502_trace_load(const char *filename) {
+	assert(filename);
+
+	FILE *fp = NULL;
+	if (dms_fopen(fp, filename, "rb")) {
+		return NULL;
+	}
+
+	char magic[8];
+	uint64_t version, size, last_tick;
+	bool ok = dms_fread(magic, 1, 8, fp) == 8 && dms_memcmp(magic, TRACE_MAGIC, 8) == 0 &&
+			  file_read_uint_le(fp, &version, 4) && version == CPU_6502_TRACE_VERSION &&
+			  file_read_uint_le(fp, &size, 8) && file_read_uint_le(fp, &last_tick, 8);
+
+	// don't trust the header: the records must fit in the ring and actually be present in the file
+	int64_t remaining = (ok) ? file_remaining_size(fp) : -1;
+	ok = ok && remaining >= 0 && size <= CPU_6502_TRACE_MAX_CAPACITY &&
+		 size <= (uint64_t) remaining / sizeof(Cpu6502TraceRecord);
+
+	Cpu6502Trace *trace = (ok) ? cpu_6502_trace_create(size) : NULL;
+
+	for (uint64_t i = 0; trace && i < size; ++i) {
+		if (!read_record(fp, &trace->records[i])) {
+			cpu_6502_trace_destroy(trace);
+			trace = NULL;
+		}
+	}
+
+	if (trace) {
+		trace->count = size;
+		trace->last_tick = (int64_t) last_tick;
+	}
+
+	dms_fclose(fp);
+	return trace;
+}
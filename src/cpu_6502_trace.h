@@ -0,0 +1,68 @@
+// cpu_6502_trace.h - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Instruction trace of a 6502: a ring buffer with a fixed-size record for each executed instruction
+
+#ifndef DROMAIUS_CPU_6502_TRACE_H
+#define DROMAIUS_CPU_6502_TRACE_H
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// types
+#define CPU_6502_TRACE_VERSION		1
+#define CPU_6502_TRACE_MAX_CAPACITY	(1ull << 27)		// 128M instructions (2 GiB of records)
+
+typedef struct Cpu6502TraceRecord {
+	uint32_t	tick_delta;			// ticks since the start of the previous instruction (saturates)
+	uint16_t	pc;					// address of the opcode
+	uint16_t	address;			// effective address of the memory operand (only valid for memory addressing modes)
+	uint8_t		bytes[3];			// opcode + operands (only valid up to the length of the instruction)
+	uint8_t		reg_a;				// registers at the start of the instruction
+	uint8_t		reg_x;
+	uint8_t		reg_y;
+	uint8_t		reg_sp;
+	uint8_t		reg_p;
+} Cpu6502TraceRecord;
+
+typedef struct Cpu6502Trace {
+	Cpu6502TraceRecord *	records;	// ring buffer
+	uint64_t				mask;		// capacity - 1 (the capacity is a power of two)
+	uint64_t				count;		// total number of instructions recorded
+	int64_t					last_tick;	// tick at the start of the newest instruction
+} Cpu6502Trace;
+
+// functions
+// cpu_6502_trace_create: capacity is rounded up to a power of two (NULL when above CPU_6502_TRACE_MAX_CAPACITY)
+Cpu6502Trace *cpu_6502_trace_create(uint64_t capacity);
+void cpu_6502_trace_destroy(Cpu6502Trace *trace);
+void cpu_6502_trace_clear(Cpu6502Trace *trace);
+
+static inline uint64_t cpu_6502_trace_capacity(Cpu6502Trace *trace) {
+	return trace->mask + 1;
+}
+
+// cpu_6502_trace_size: number of records available (the most recent instructions)
+static inline uint64_t cpu_6502_trace_size(Cpu6502Trace *trace) {
+	return (trace->count < trace->mask + 1) ? trace->count : trace->mask + 1;
+}
+
+// cpu_6502_trace_record: index 0 is the oldest available record
+static inline Cpu6502TraceRecord *cpu_6502_trace_record(Cpu6502Trace *trace, uint64_t index) {
+	return &trace->records[(trace->count - cpu_6502_trace_size(trace) + index) & trace->mask];
+}
+
+// cpu_6502_trace_ticks: reconstruct the start tick of each available record (oldest first) into a dynamic array
+int64_t *cpu_6502_trace_ticks(Cpu6502Trace *trace);
+
+// save the available records from oldest to newest, a loaded trace has exactly enough room to hold the records
+bool cpu_6502_trace_save(Cpu6502Trace *trace, const char *filename);
+Cpu6502Trace *cpu_6502_trace_load(const char *filename);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DROMAIUS_CPU_6502_TRACE_H
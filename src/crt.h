@@ -47,12 +47,16 @@
 	#define dms_fread					fread
 	#define dms_fwrite					fwrite
 	#define dms_feof					feof
+	#define dms_fseek					_fseeki64
+	#define dms_ftell					_ftelli64
 #else
 	#define dms_fopen(fp,name,mode)		((fp = fopen(name,mode)) == NULL)
 	#define dms_fclose					fclose
 	#define dms_fread					fread
 	#define dms_fwrite					fwrite
 	#define dms_feof					feof
+	#define dms_fseek					fseek
+	#define dms_ftell					ftell
 #endif
 
 
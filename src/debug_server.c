@@ -0,0 +1,695 @@
+// debug_server.c - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Remote debug server: exposes a DmsContext to external tools over a local socket
+
+#include "debug_server.h"
+
+#include "context.h"
+#include "cpu.h"
+#include "device.h"
+#include "signal_history.h"
+#include "signal_line.h"
+#include "simulator.h"
+
+#include "crt.h"
+
+#include <stb/stb_ds.h>
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_DARWIN)
+	#define DMS_DEBUG_SERVER_POSIX
+#endif
+
+#ifdef DMS_DEBUG_SERVER_POSIX
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// private types
+//
+
+#define DEBUG_MAX_NAME		64
+
+#ifndef MSG_NOSIGNAL
+	#define MSG_NOSIGNAL	0			// SO_NOSIGPIPE is set on the socket instead
+#endif
+
+typedef struct DebugClient {
+	int			socket;
+	uint8_t *	input;				// dynamic array: received data that doesn't form a complete request yet
+	uint8_t *	output;				// dynamic array: data waiting to be sent
+	size_t		output_sent;
+	bool		closed;
+} DebugClient;
+
+typedef struct DebugServer {
+	struct DmsContext *	dms;
+	int					listener;
+	char *				unix_path;			// removed when the server is destroyed
+
+	DebugClient *		clients;			// dynamic array
+	uint8_t *			reply;				// dynamic array: payload of the response being built
+
+	DMS_STATE			last_state;
+	int64_t				run_until_addr;		// temporary breakpoint for RUN_UNTIL (-1 = none)
+} DebugServer;
+
+typedef struct PayloadReader {
+	const uint8_t *		data;
+	size_t				size;
+	size_t				pos;
+	bool				error;
+} PayloadReader;
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// payload encoding
+//
+
+static uint64_t read_le(PayloadReader *reader, size_t bytes) {
+	if (reader->pos + bytes > reader->size) {
+		reader->error = true;
+		return 0;
+	}
+
+	uint64_t result = 0;
+	for (size_t i = 0; i < bytes; ++i) {
+		result |= (uint64_t) reader->data[reader->pos + i] << (i * 8);
+	}
+	reader->pos += bytes;
+	return result;
+}
+
+static void read_name(PayloadReader *reader, char *name) {
+	size_t len = (size_t) read_le(reader, 1);
+
+	if (len >= DEBUG_MAX_NAME || reader->pos + len > reader->size) {
+		reader->error = true;
+		name[0] = '\0';
+		return;
+	}
+
+	dms_memcpy(name, reader->data + reader->pos, len);
+	name[len] = '\0';
+	reader->pos += len;
+}
+
+static void write_le(uint8_t **output, uint64_t value, size_t bytes) {
+	for (size_t i = 0; i < bytes; ++i) {
+		arrpush(*output, (uint8_t) (value >> (i * 8)));
+	}
+}
+
+static void client_send(DebugClient *client, uint16_t command, uint16_t id, const uint8_t *payload, size_t size) {
+	write_le(&client->output, size, 4);
+	write_le(&client->output, command, 2);
+	write_le(&client->output, id, 2);
+	if (size > 0) {
+		dms_memcpy(arraddnptr(client->output, size), payload, size);
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// request handlers
+//
+
+static inline Device *server_device(DebugServer *server) {
+	return dms_get_device(server->dms);
+}
+
+static inline SignalPool *server_signal_pool(DebugServer *server) {
+	return server_device(server)->simulator->signal_pool;
+}
+
+static void write_status(DebugServer *server, uint8_t **output) {
+	DmsStatus status = dms_get_status(server->dms);
+	write_le(output, (uint64_t) dms_get_state(server->dms), 1);
+	write_le(output, (uint64_t) status.current_tick, 8);
+	write_le(output, (uint64_t) status.program_counter, 8);
+}
+
+static DEBUG_STATUS handle_read_memory(DebugServer *server, PayloadReader *req) {
+	size_t address = (size_t) read_le(req, 4);
+	size_t size = (size_t) read_le(req, 4);
+
+	if (req->error || size >= DEBUG_MAX_PAYLOAD) {
+		return DEBUG_STATUS_INVALID_REQUEST;
+	}
+
+	// devices leave the part of the range past the end of their address space untouched
+	uint8_t *output = arraddnptr(server->reply, size);
+	dms_zero(output, size);
+
+	Device *device = server_device(server);
+	device->read_memory(device, address, size, output);
+	return DEBUG_STATUS_OK;
+}
+
+static DEBUG_STATUS handle_write_memory(DebugServer *server, PayloadReader *req) {
+	size_t address = (size_t) read_le(req, 4);
+
+	if (req->error) {
+		return DEBUG_STATUS_INVALID_REQUEST;
+	}
+
+	Device *device = server_device(server);
+	device->write_memory(device, address, req->size - req->pos, (uint8_t *) req->data + req->pos);
+	return DEBUG_STATUS_OK;
+}
+
+static DEBUG_STATUS handle_read_registers(DebugServer *server, PayloadReader *req) {
+	Device *device = server_device(server);
+	Cpu *cpu = device->get_cpu(device);
+
+	if (!cpu || !cpu->register_index) {
+		return DEBUG_STATUS_UNAVAILABLE;
+	}
+
+	size_t count = (size_t) read_le(req, 1);
+
+	for (size_t i = 0; i < count && !req->error; ++i) {
+		char name[DEBUG_MAX_NAME];
+		read_name(req, name);
+
+		int32_t reg = cpu->register_index(cpu, name);
+		if (reg < 0) {
+			return DEBUG_STATUS_NOT_FOUND;
+		}
+		write_le(&server->reply, (uint64_t) cpu->register_value(cpu, reg), 8);
+	}
+
+	return (req->error) ? DEBUG_STATUS_INVALID_REQUEST : DEBUG_STATUS_OK;
+}
+
+static DEBUG_STATUS handle_read_signals(DebugServer *server, PayloadReader *req) {
+	SignalPool *pool = server_signal_pool(server);
+	size_t count = (size_t) read_le(req, 1);
+
+	for (size_t i = 0; i < count && !req->error; ++i) {
+		char name[DEBUG_MAX_NAME];
+		read_name(req, name);
+
+		Signal signal = signal_by_name(pool, name);
+		if (signal_is_undefined(signal)) {
+			return DEBUG_STATUS_NOT_FOUND;
+		}
+		write_le(&server->reply, signal_read(pool, signal), 1);
+	}
+
+	return (req->error) ? DEBUG_STATUS_INVALID_REQUEST : DEBUG_STATUS_OK;
+}
+
+static DEBUG_STATUS handle_breakpoint(DebugServer *server, PayloadReader *req, bool set) {
+	uint8_t kind = (uint8_t) read_le(req, 1);
+
+	switch (kind) {
+		case DEBUG_BP_PC: {
+			int64_t address = (int64_t) read_le(req, 4);
+			if (req->error || address > 0xffff) {
+				return DEBUG_STATUS_INVALID_REQUEST;
+			}
+			if (dms_breakpoint_is_set(server->dms, address) != set) {
+				dms_toggle_breakpoint(server->dms, address);
+			}
+			if (address == server->run_until_addr) {
+				// the breakpoint is now managed by the client
+				server->run_until_addr = -1;
+			}
+			return DEBUG_STATUS_OK;
+		}
+
+		case DEBUG_BP_WATCH: {
+			int64_t address = (int64_t) read_le(req, 4);
+			uint8_t flags = (uint8_t) read_le(req, 1);
+			uint8_t value = (uint8_t) read_le(req, 1);
+			if (req->error || address > 0xffff) {
+				return DEBUG_STATUS_INVALID_REQUEST;
+			}
+			if (set) {
+				dms_watchpoint_set(server->dms, address, flags, value);
+			} else {
+				dms_watchpoint_clear(server->dms, address);
+			}
+			return DEBUG_STATUS_OK;
+		}
+
+		case DEBUG_BP_SIGNAL: {
+			bool pos_edge = read_le(req, 1) != 0;
+			bool neg_edge = read_le(req, 1) != 0;
+			char name[DEBUG_MAX_NAME];
+			read_name(req, name);
+			if (req->error) {
+				return DEBUG_STATUS_INVALID_REQUEST;
+			}
+
+			Signal signal = signal_by_name(server_signal_pool(server), name);
+			if (signal_is_undefined(signal)) {
+				return DEBUG_STATUS_NOT_FOUND;
+			}
+			if (set) {
+				dms_breakpoint_signal_set(server->dms, signal, pos_edge, neg_edge);
+			} else {
+				dms_breakpoint_signal_clear(server->dms, signal);
+			}
+			return DEBUG_STATUS_OK;
+		}
+
+		default:
+			return DEBUG_STATUS_INVALID_REQUEST;
+	}
+}
+
+static DEBUG_STATUS handle_run_until(DebugServer *server, PayloadReader *req) {
+	int64_t address = (int64_t) read_le(req, 4);
+	if (req->error || address > 0xffff) {
+		return DEBUG_STATUS_INVALID_REQUEST;
+	}
+
+	// use a temporary breakpoint, unless there's already a breakpoint at the address
+	if (!dms_breakpoint_is_set(server->dms, address)) {
+		dms_toggle_breakpoint(server->dms, address);
+		server->run_until_addr = address;
+	}
+
+	dms_run(server->dms);
+	return DEBUG_STATUS_OK;
+}
+
+static DEBUG_STATUS handle_history(DebugServer *server, PayloadReader *req) {
+	SignalHistory *history = server_device(server)->simulator->signal_history;
+	SignalPool *pool = server_signal_pool(server);
+
+	SignalHistoryDiagramData diagram = {0};
+	diagram.time_begin = (int64_t) read_le(req, 8);
+	diagram.time_end = (int64_t) read_le(req, 8);
+
+	size_t count = (size_t) read_le(req, 1);
+	for (size_t i = 0; i < count && !req->error; ++i) {
+		char name[DEBUG_MAX_NAME];
+		read_name(req, name);
+
+		Signal signal = signal_by_name(pool, name);
+		if (signal_is_undefined(signal)) {
+			arrfree(diagram.signals);
+			return DEBUG_STATUS_NOT_FOUND;
+		}
+		arrpush(diagram.signals, signal);
+	}
+
+	if (req->error) {
+		arrfree(diagram.signals);
+		return DEBUG_STATUS_INVALID_REQUEST;
+	}
+
+	signal_history_diagram_data(history, &diagram);
+
+	for (size_t i = 0; i < count; ++i) {
+		size_t first = diagram.signal_start_offsets[i];
+		size_t last = (i + 1 < count) ? diagram.signal_start_offsets[i + 1] : arrlenu(diagram.samples_time);
+
+		write_le(&server->reply, last - first, 4);
+		for (size_t s = first; s < last; ++s) {
+			write_le(&server->reply, (uint64_t) diagram.samples_time[s], 8);
+			write_le(&server->reply, diagram.samples_value[s], 1);
+		}
+	}
+
+	signal_history_diagram_release(&diagram);
+	return DEBUG_STATUS_OK;
+}
+
+static DEBUG_STATUS handle_monitor(DebugServer *server, PayloadReader *req) {
+	char *cmd = (char *) dms_calloc(1, req->size + 1);
+	dms_memcpy(cmd, req->data, req->size);
+
+	char *reply = NULL;
+	dms_monitor_cmd(server->dms, cmd, &reply);
+
+	if (reply) {
+		dms_memcpy(arraddnptr(server->reply, arrlenu(reply)), reply, arrlenu(reply));
+		arrfree(reply);
+	}
+
+	dms_free(cmd);
+	return DEBUG_STATUS_OK;
+}
+
+static DEBUG_STATUS execute_request(DebugServer *server, uint16_t command, PayloadReader *req) {
+
+	switch (command) {
+		case DEBUG_CMD_HELLO:
+			write_le(&server->reply, DEBUG_PROTOCOL_VERSION, 2);
+			return DEBUG_STATUS_OK;
+		case DEBUG_CMD_STATUS:
+			write_status(server, &server->reply);
+			return DEBUG_STATUS_OK;
+		case DEBUG_CMD_READ_MEMORY:
+			return handle_read_memory(server, req);
+		case DEBUG_CMD_WRITE_MEMORY:
+			return handle_write_memory(server, req);
+		case DEBUG_CMD_READ_REGISTERS:
+			return handle_read_registers(server, req);
+		case DEBUG_CMD_READ_SIGNALS:
+			return handle_read_signals(server, req);
+		case DEBUG_CMD_BREAKPOINT_SET:
+			return handle_breakpoint(server, req, true);
+		case DEBUG_CMD_BREAKPOINT_CLR:
+			return handle_breakpoint(server, req, false);
+		case DEBUG_CMD_STEP:
+			dms_single_step(server->dms);
+			return DEBUG_STATUS_OK;
+		case DEBUG_CMD_RUN:
+			dms_run(server->dms);
+			return DEBUG_STATUS_OK;
+		case DEBUG_CMD_PAUSE:
+			dms_pause(server->dms);
+			return DEBUG_STATUS_OK;
+		case DEBUG_CMD_RUN_UNTIL:
+			return handle_run_until(server, req);
+		case DEBUG_CMD_HISTORY:
+			return handle_history(server, req);
+		case DEBUG_CMD_MONITOR:
+			return handle_monitor(server, req);
+		default:
+			return DEBUG_STATUS_INVALID_REQUEST;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// connection handling
+//
+
+static bool socket_set_nonblocking(int fd) {
+	int flags = fcntl(fd, F_GETFL, 0);
+	return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static void client_process_input(DebugServer *server, DebugClient *client) {
+	size_t pos = 0;
+
+	// execute all complete requests
+	while (arrlenu(client->input) - pos >= DEBUG_HEADER_SIZE) {
+		PayloadReader header = {.data = client->input + pos, .size = DEBUG_HEADER_SIZE};
+		size_t length = (size_t) read_le(&header, 4);
+		uint16_t command = (uint16_t) read_le(&header, 2);
+		uint16_t id = (uint16_t) read_le(&header, 2);
+
+		if (length > DEBUG_MAX_PAYLOAD) {
+			client->closed = true;
+			return;
+		}
+
+		if (arrlenu(client->input) - pos - DEBUG_HEADER_SIZE < length) {
+			break;
+		}
+
+		PayloadReader req = {.data = client->input + pos + DEBUG_HEADER_SIZE, .size = length};
+
+		arrsetlen(server->reply, 1);
+		DEBUG_STATUS status = execute_request(server, command, &req);
+		if (status != DEBUG_STATUS_OK) {
+			arrsetlen(server->reply, 1);
+		}
+		server->reply[0] = (uint8_t) status;
+
+		client_send(client, command, id, server->reply, arrlenu(server->reply));
+		pos += DEBUG_HEADER_SIZE + length;
+	}
+
+	arrdeln(client->input, 0, pos);
+}
+
+static void client_receive(DebugServer *server, DebugClient *client) {
+	uint8_t buffer[16384];
+
+	for (;;) {
+		ssize_t received = recv(client->socket, buffer, sizeof(buffer), 0);
+
+		if (received > 0) {
+			dms_memcpy(arraddnptr(client->input, (size_t) received), buffer, (size_t) received);
+		} else if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+			client->closed = true;
+			break;
+		} else if (errno != EINTR) {
+			break;
+		}
+	}
+
+	client_process_input(server, client);
+}
+
+static void client_flush(DebugClient *client) {
+	while (client->output_sent < arrlenu(client->output)) {
+		ssize_t sent = send(client->socket, client->output + client->output_sent, arrlenu(client->output) - client->output_sent, MSG_NOSIGNAL);
+
+		if (sent > 0) {
+			client->output_sent += (size_t) sent;
+		} else if (sent < 0 && errno == EINTR) {
+			continue;
+		} else {
+			if (sent == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+				client->closed = true;
+			}
+			return;
+		}
+	}
+
+	if (client->output) {
+		stbds_header(client->output)->length = 0;
+	}
+	client->output_sent = 0;
+}
+
+static void client_close(DebugClient *client) {
+	close(client->socket);
+	arrfree(client->input);
+	arrfree(client->output);
+}
+
+static void server_accept(DebugServer *server) {
+	for (;;) {
+		int fd = accept(server->listener, NULL, NULL);
+		if (fd < 0) {
+			break;
+		}
+
+		if (!socket_set_nonblocking(fd)) {
+			close(fd);
+			continue;
+		}
+
+	#ifdef SO_NOSIGPIPE
+		int no_sigpipe = 1;
+		setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+	#endif
+
+		DebugClient client = {.socket = fd};
+		arrpush(server->clients, client);
+	}
+}
+
+static void server_check_stopped(DebugServer *server) {
+	DMS_STATE state = dms_get_state(server->dms);
+
+	if (state == DS_WAIT && server->last_state != DS_WAIT) {
+		// remove the temporary breakpoint of RUN_UNTIL
+		if (server->run_until_addr >= 0) {
+			if (dms_breakpoint_is_set(server->dms, server->run_until_addr)) {
+				dms_toggle_breakpoint(server->dms, server->run_until_addr);
+			}
+			server->run_until_addr = -1;
+		}
+
+		// notify all clients
+		uint8_t *payload = NULL;
+		write_status(server, &payload);
+		for (size_t i = 0; i < arrlenu(server->clients); ++i) {
+			client_send(&server->clients[i], DEBUG_NOTIFY_STOPPED, 0, payload, arrlenu(payload));
+		}
+		arrfree(payload);
+	}
+
+	server->last_state = state;
+}
+
+static int server_listen(DebugServer *server, const char *address) {
+
+	if (dms_strncmp(address, "unix:", 5) == 0) {
+		struct sockaddr_un addr = {0};
+		addr.sun_family = AF_UNIX;
+
+		const char *path = address + 5;
+		if (*path == '\0' || dms_strlen(path) >= sizeof(addr.sun_path)) {
+			return -1;
+		}
+		dms_memcpy(addr.sun_path, path, dms_strlen(path));
+
+		int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0) {
+			return -1;
+		}
+
+		unlink(path);
+		if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+			close(fd);
+			return -1;
+		}
+
+		server->unix_path = dms_strdup(path);
+		return fd;
+	}
+
+	if (dms_strncmp(address, "tcp:", 4) == 0) {
+		char *end = NULL;
+		long port = strtol(address + 4, &end, 10);
+		if (end == address + 4 || *end != '\0' || port <= 0 || port > 65535) {
+			return -1;
+		}
+
+		struct sockaddr_in addr = {0};
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons((uint16_t) port);
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+		int fd = socket(AF_INET, SOCK_STREAM, 0);
+		if (fd < 0) {
+			return -1;
+		}
+
+		int reuse = 1;
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+		if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+			close(fd);
+			return -1;
+		}
+
+		return fd;
+	}
+
+	return -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// interface
+//
+
+DebugServer *debug_server_create(struct DmsContext *dms, const char *address) {
+	assert(dms);
+	assert(address);
+
+	DebugServer *server = (DebugServer *) dms_calloc(1, sizeof(DebugServer));
+	server->dms = dms;
+	server->last_state = DS_WAIT;
+	server->run_until_addr = -1;
+
+	server->listener = server_listen(server, address);
+	if (server->listener < 0 || listen(server->listener, 4) != 0 || !socket_set_nonblocking(server->listener)) {
+		debug_server_destroy(server);
+		return NULL;
+	}
+
+	return server;
+}
+
+void debug_server_destroy(DebugServer *server) {
+	assert(server);
+
+	for (size_t i = 0; i < arrlenu(server->clients); ++i) {
+		client_close(&server->clients[i]);
+	}
+	arrfree(server->clients);
+	arrfree(server->reply);
+
+	if (server->listener >= 0) {
+		close(server->listener);
+	}
+
+	if (server->unix_path) {
+		unlink(server->unix_path);
+		dms_free(server->unix_path);
+	}
+
+	dms_free(server);
+}
+
+void debug_server_process(DebugServer *server, int32_t timeout_ms) {
+	assert(server);
+
+	// wait for activity
+	struct pollfd *fds = NULL;
+	arrpush(fds, ((struct pollfd) {.fd = server->listener, .events = POLLIN}));
+
+	for (size_t i = 0; i < arrlenu(server->clients); ++i) {
+		DebugClient *client = &server->clients[i];
+		short events = (client->output_sent < arrlenu(client->output)) ? POLLIN | POLLOUT : POLLIN;
+		arrpush(fds, ((struct pollfd) {.fd = client->socket, .events = events}));
+	}
+
+	int ready = poll(fds, (nfds_t) arrlenu(fds), timeout_ms);
+
+	if (ready > 0) {
+		if (fds[0].revents & POLLIN) {
+			server_accept(server);
+		}
+
+		for (size_t i = 1; i < arrlenu(fds); ++i) {
+			if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+				client_receive(server, &server->clients[i - 1]);
+			}
+		}
+	}
+	arrfree(fds);
+
+	// report a stop of the simulation
+	server_check_stopped(server);
+
+	// send responses, drop closed connections
+	for (size_t i = 0; i < arrlenu(server->clients); ) {
+		DebugClient *client = &server->clients[i];
+
+		if (!client->closed) {
+			client_flush(client);
+		}
+
+		if (client->closed) {
+			client_close(client);
+			arrdel(server->clients, i);
+		} else {
+			++i;
+		}
+	}
+}
+
+#else
+
+// sockets are not supported on this platform
+
+struct DebugServer *debug_server_create(struct DmsContext *dms, const char *address) {
+	(void) dms;
+	(void) address;
+	return NULL;
+}
+
+void debug_server_destroy(struct DebugServer *server) {
+	(void) server;
+}
+
+void debug_server_process(struct DebugServer *server, int32_t timeout_ms) {
+	(void) server;
+	(void) timeout_ms;
+}
+
+#endif // DMS_DEBUG_SERVER_POSIX
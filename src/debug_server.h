@@ -0,0 +1,103 @@
+// debug_server.h - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Remote debug server: exposes a DmsContext to external tools over a local socket
+
+/* Protocol
+	All messages start with an 8 byte header, followed by 'length' bytes of payload. Values are little-endian.
+		uint32_t length
+		uint16_t command		- DEBUG_CMD_* for requests and responses, DEBUG_NOTIFY_* for notifications
+		uint16_t id				- chosen by the client, repeated in the response (0 for notifications)
+
+	The payload of a response always starts with a uint8_t status (DEBUG_STATUS_*).
+	A name-list is a uint8_t count followed by count * (uint8_t length, characters).
+
+	Requests (payload -> response payload after the status byte):
+		HELLO			-								-> u16 protocol version
+		STATUS			-								-> u8 state, i64 tick, i64 program counter
+		READ_MEMORY		u32 address, u32 size			-> size bytes
+		WRITE_MEMORY	u32 address, bytes				-> -
+		READ_REGISTERS	name-list						-> i64 value for each register
+		READ_SIGNALS	name-list						-> u8 value for each signal
+		BREAKPOINT_SET	u8 kind, kind specific			-> -
+		BREAKPOINT_CLR	u8 kind, kind specific			-> -
+							DEBUG_BP_PC:		u32 address
+							DEBUG_BP_WATCH:		u32 address, u8 flags (BusWatchFlags), u8 value
+							DEBUG_BP_SIGNAL:	u8 pos_edge, u8 neg_edge, u8 length, name
+		STEP			-								-> -
+		RUN				-								-> -
+		PAUSE			-								-> -
+		RUN_UNTIL		u32 address						-> -
+		HISTORY			i64 time_begin, i64 time_end, name-list
+														-> for each signal: u32 count, count * (i64 time, u8 value), newest first
+		MONITOR			command text					-> reply text
+
+	Notifications:
+		STOPPED			u8 state, i64 tick, i64 program counter		(the simulation stopped running)
+*/
+
+#ifndef DROMAIUS_DEBUG_SERVER_H
+#define DROMAIUS_DEBUG_SERVER_H
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// types
+#define DEBUG_PROTOCOL_VERSION		1
+#define DEBUG_HEADER_SIZE			8
+#define DEBUG_MAX_PAYLOAD			(1024 * 1024)
+
+typedef enum DEBUG_COMMAND {
+	DEBUG_CMD_HELLO				= 0x0001,
+	DEBUG_CMD_STATUS			= 0x0002,
+	DEBUG_CMD_READ_MEMORY		= 0x0010,
+	DEBUG_CMD_WRITE_MEMORY		= 0x0011,
+	DEBUG_CMD_READ_REGISTERS	= 0x0012,
+	DEBUG_CMD_READ_SIGNALS		= 0x0013,
+	DEBUG_CMD_BREAKPOINT_SET	= 0x0020,
+	DEBUG_CMD_BREAKPOINT_CLR	= 0x0021,
+	DEBUG_CMD_STEP				= 0x0030,
+	DEBUG_CMD_RUN				= 0x0031,
+	DEBUG_CMD_PAUSE				= 0x0032,
+	DEBUG_CMD_RUN_UNTIL			= 0x0033,
+	DEBUG_CMD_HISTORY			= 0x0040,
+	DEBUG_CMD_MONITOR			= 0x0050,
+
+	DEBUG_NOTIFY_STOPPED		= 0x8001
+} DEBUG_COMMAND;
+
+typedef enum DEBUG_STATUS {
+	DEBUG_STATUS_OK = 0,
+	DEBUG_STATUS_INVALID_REQUEST = 1,		// unknown command or malformed payload
+	DEBUG_STATUS_NOT_FOUND = 2,				// unknown register or signal
+	DEBUG_STATUS_UNAVAILABLE = 3			// the device doesn't support the request
+} DEBUG_STATUS;
+
+typedef enum DEBUG_BREAKPOINT_KIND {
+	DEBUG_BP_PC = 0,
+	DEBUG_BP_WATCH = 1,
+	DEBUG_BP_SIGNAL = 2
+} DEBUG_BREAKPOINT_KIND;
+
+struct DebugServer;
+struct DmsContext;
+
+// functions
+
+// debug_server_create: start listening on 'unix:<path>' or 'tcp:<port>' (localhost only)
+//	- returns NULL if the address is invalid or sockets aren't supported on this platform
+struct DebugServer *debug_server_create(struct DmsContext *dms, const char *address);
+void debug_server_destroy(struct DebugServer *server);
+
+// debug_server_process: accept connections, execute requests and send notifications
+//	- must be called regularly by the thread that owns the context (requests are executed on this thread)
+//	- waits at most timeout_ms for activity on the sockets
+void debug_server_process(struct DebugServer *server, int32_t timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DROMAIUS_DEBUG_SERVER_H
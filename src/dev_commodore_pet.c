@@ -7,6 +7,7 @@
 #include "crt.h"
 #include "utils.h"
 
+#include "bus_watcher.h"
 #include "chip.h"
 #include "chip_6520.h"
 #include "chip_6522.h"
@@ -22,6 +23,7 @@
 #include "perif_pet_crt.h"
 #include "perif_datassette_1530.h"
 #include "perif_disk_2031.h"
+#include "rom_image.h"
 #include "stb/stb_ds.h"
 
 #include "signal_history_profiles.h"
@@ -788,7 +790,7 @@ typedef struct ChipLiteDisplay {
 
 	DevCommodorePet *	device;
 	Ram8d16a *			vram;
-	uint8_t				char_rom[ROM_6316_DATA_SIZE];
+	const RomImage *	char_rom;			// shared image (NULL == the character rom couldn't be loaded)
 
 	Signal				signals[CHIP_LITE_DISPLAY_PIN_COUNT];
 	SignalPool *		signal_pool;
@@ -811,7 +813,11 @@ static ChipLiteDisplay *lite_display_create(DevCommodorePet *device) {
 
 	GLUE_PIN(VIDEO_ON, CHIP_PIN_INPUT | CHIP_PIN_OUTPUT);
 
-	file_load_binary_fixed("runtime/commodore_pet/characters-2.901447-10.bin", chip->char_rom, ROM_6316_DATA_SIZE);
+	chip->char_rom = rom_image_acquire("runtime/commodore_pet/characters-2.901447-10.bin");
+	if (chip->char_rom && chip->char_rom->size < ROM_6316_DATA_SIZE) {
+		rom_image_release(chip->char_rom);
+		chip->char_rom = NULL;
+	}
 
 	chip->refresh_delay = simulator_interval_to_tick_count(device->simulator, FREQUENCY_TO_PS(60));
 	chip->retrace_hold = simulator_interval_to_tick_count(device->simulator, US_TO_PS(1));
@@ -821,6 +827,7 @@ static ChipLiteDisplay *lite_display_create(DevCommodorePet *device) {
 
 static void lite_display_destroy(ChipLiteDisplay *chip) {
 	assert(chip);
+	rom_image_release(chip->char_rom);
 	dms_free(chip);
 }
 
@@ -836,6 +843,10 @@ void pet_lite_fake_display(ChipLiteDisplay *chip) {
 	const size_t SCREEN_HEIGHT = 25;
 	const size_t CHAR_HEIGHT = 8;
 
+	if (!chip->char_rom) {
+		return;
+	}
+
 	for (size_t pos_char_y = 0; pos_char_y < SCREEN_HEIGHT; ++pos_char_y) {
 		uint8_t *vram_row = chip->vram->data_array + (pos_char_y * SCREEN_WIDTH);
 		for (uint8_t pos_line = 0; pos_line < 8; ++pos_line) {
@@ -849,7 +860,7 @@ void pet_lite_fake_display(ChipLiteDisplay *chip) {
 
 				// get approriate data from the character rom
 				int rom_addr = (int) value << 3 | pos_line;
-				uint8_t line_value = chip->char_rom[rom_addr];
+				uint8_t line_value = chip->char_rom->data[rom_addr];
 
 				// write character line to screen
 				for (int i = 7; i >= 0; --i) {
@@ -922,11 +933,14 @@ static Chip63xxRom *load_rom(DevCommodorePet *device, const char *filename, size
 		chip_6332_rom_create(device->simulator, signals) :
 		chip_6316_rom_create(device->simulator, signals);
 
-	if (file_load_binary_fixed(filename, rom->data_array, (num_lines == 12) ? ROM_6332_DATA_SIZE : ROM_6316_DATA_SIZE) == 0) {
+	// the contents of the roms are shared by all devices
+	const RomImage *image = rom_image_acquire(filename);
+	if (!image) {
 		rom->destroy(rom);
 		return NULL;
 	}
 
+	chip_63xx_rom_use_image(rom, image);
 	return rom;
 }
 
@@ -957,11 +971,13 @@ static Chip63xxRom *load_character_rom(DevCommodorePet *device, const char *file
 										[CHIP_6316_D7] = SIGNAL(CD7)
 	});
 
-	if (file_load_binary_fixed(filename, rom->data_array, ROM_6316_DATA_SIZE) == 0) {
+	const RomImage *image = rom_image_acquire(filename);
+	if (!image) {
 		rom->destroy(rom);
 		return NULL;
 	}
 
+	chip_63xx_rom_use_image(rom, image);
 	return rom;
 }
 
@@ -2168,6 +2184,90 @@ void circuit_lite_create_vram(DevCommodorePet *device) {
 	DEVICE_REGISTER_CHIP("LOGIC7", glue_logic_create_07_lite(device));
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// internal - memory access from outside the simulation
+//
+
+static inline void memory_blocks_map(DevCommodorePet *device, size_t start_address, size_t size,
+									 uint8_t *data, size_t data_mask, bool read_only) {
+	for (size_t addr = start_address; addr < start_address + size; addr += PET_MEMORY_BLOCK_SIZE) {
+		device->memory_blocks[addr / PET_MEMORY_BLOCK_SIZE] = (DevCommodorePetMemoryBlock) {
+			.data = data + ((addr - start_address) & data_mask),
+			.stride = 1,
+			.read_only = read_only
+		};
+	}
+}
+
+static_assert(PET_MEMORY_BLOCK_SIZE * 2 == 0x100, "The fast bus map expects two memory blocks per page");
+
+static void memory_blocks_setup(DevCommodorePet *device) {
+	// look up the memory chips once: read_memory/write_memory only use the blocks
+	dms_zero(device->memory_blocks, sizeof(device->memory_blocks));
+
+	if (!device->is_lite) {
+		// main RAM: two banks of 16k, each address is split in a row (A0-A6) and a column (A7-A13) by the
+		//	multiplexers in front of the 4116 DRAMs. Consecutive addresses in a block are in consecutive rows.
+		Chip8x4116DRam *dram[2] = {
+			(Chip8x4116DRam *) simulator_chip_by_name(device->simulator, "I2-9"),
+			(Chip8x4116DRam *) simulator_chip_by_name(device->simulator, "J2-9")
+		};
+
+		for (size_t block = 0; block < 0x8000 / PET_MEMORY_BLOCK_SIZE; ++block) {
+			size_t col = block & 0x7f;
+			device->memory_blocks[block] = (DevCommodorePetMemoryBlock) {
+				.data = dram[block >> 7]->data_array + (((col & 0x3f) << 1) | ((col & 0x40) >> 6)),
+				.stride = 128,
+				.read_only = false
+			};
+		}
+
+		// screen RAM: 1k of 4-bit chips (high and low nibble), repeated in $8000-$87ff
+		Chip6114SRam *ram_hi = (Chip6114SRam *) simulator_chip_by_name(device->simulator, "F7");
+		Chip6114SRam *ram_lo = (Chip6114SRam *) simulator_chip_by_name(device->simulator, "F8");
+		memory_blocks_map(device, 0x8000, 0x0800, ram_hi->data_array, 0x3ff, false);
+
+		for (size_t addr = 0x8000; addr < 0x8800; addr += PET_MEMORY_BLOCK_SIZE) {
+			device->memory_blocks[addr / PET_MEMORY_BLOCK_SIZE].data_lo = ram_lo->data_array + (addr & 0x3ff);
+		}
+	} else {
+		// main RAM (0-32k)
+		Ram8d16a *ram = (Ram8d16a *) simulator_chip_by_name(device->simulator, "RAM");
+		memory_blocks_map(device, 0x0000, 0x8000, ram->data_array, 0x7fff, false);
+
+		// screen RAM: 1k, repeated in $8000-$87ff
+		Ram8d16a *vram = (Ram8d16a *) simulator_chip_by_name(device->simulator, "VRAM");
+		memory_blocks_map(device, 0x8000, 0x0800, vram->data_array, 0x3ff, false);
+	}
+
+	// roms: basic 1-3, editor and kernal (the free rom slots and the I/O area aren't mapped)
+	memory_blocks_map(device, 0xb000, 0x1000, device->roms[0]->data_array, 0xfff, true);
+	memory_blocks_map(device, 0xc000, 0x1000, device->roms[1]->data_array, 0xfff, true);
+	memory_blocks_map(device, 0xd000, 0x1000, device->roms[2]->data_array, 0xfff, true);
+	memory_blocks_map(device, 0xe000, 0x0800, device->roms[3]->data_array, 0x7ff, true);
+	memory_blocks_map(device, 0xf000, 0x1000, device->roms[4]->data_array, 0xfff, true);
+}
+
+static void fast_bus_map_setup(DevCommodorePet *device) {
+	Cpu6502MemoryMap *map = device->fast_bus_map;
+	dms_zero(map, sizeof(Cpu6502MemoryMap));
+
+	// memory watchpoints need to see the accesses on the bus
+	map->bus_watcher = device->bus_watcher;
+
+	// RAM and ROM pages: both blocks of the page are plain memory that follow each other
+	for (size_t page = 0x00; page <= 0xff; ++page) {
+		const DevCommodorePetMemoryBlock *lo = &device->memory_blocks[page * 2];
+		const DevCommodorePetMemoryBlock *hi = &device->memory_blocks[page * 2 + 1];
+
+		if (lo->data && lo->stride == 1 && !lo->data_lo && hi->data == lo->data + PET_MEMORY_BLOCK_SIZE) {
+			map->read[page] = lo->data;
+			map->write[page] = (lo->read_only) ? NULL : lo->data;
+		}
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // interface functions
@@ -2175,8 +2275,6 @@ void circuit_lite_create_vram(DevCommodorePet *device) {
 
 void dev_commodore_pet_read_memory(DevCommodorePet *device, size_t start_address, size_t size, uint8_t *output);
 void dev_commodore_pet_write_memory(DevCommodorePet *device, size_t start_address, size_t size, uint8_t *input);
-void dev_commodore_pet_lite_read_memory(DevCommodorePet *device, size_t start_address, size_t size, uint8_t *output);
-void dev_commodore_pet_lite_write_memory(DevCommodorePet *device, size_t start_address, size_t size, uint8_t *input);
 size_t dev_commodore_pet_get_irq_signals(DevCommodorePet *device, SignalBreakpoint **irq_signals);
 
 Cpu6502* dev_commodore_pet_get_cpu(DevCommodorePet *device) {
@@ -2193,8 +2291,8 @@ DevCommodorePet *create_pet_device(bool lite) {
 	device->process = (DEVICE_PROCESS) device_process;
 	device->reset = (DEVICE_RESET) dev_commodore_pet_reset;
 	device->destroy = (DEVICE_DESTROY) dev_commodore_pet_destroy;
-	device->read_memory = (DEVICE_READ_MEMORY) ((!lite) ? dev_commodore_pet_read_memory : dev_commodore_pet_lite_read_memory);
-	device->write_memory = (DEVICE_WRITE_MEMORY) ((!lite) ? dev_commodore_pet_write_memory : dev_commodore_pet_lite_write_memory);
+	device->read_memory = (DEVICE_READ_MEMORY) dev_commodore_pet_read_memory;
+	device->write_memory = (DEVICE_WRITE_MEMORY) dev_commodore_pet_write_memory;
 	device->get_irq_signals = (DEVICE_GET_IRQ_SIGNALS) dev_commodore_pet_get_irq_signals;
 
 	device->simulator = simulator_create(6250);		// 6.25 ns - 160 Mhz
@@ -2540,6 +2638,12 @@ DevCommodorePet *create_pet_device(bool lite) {
 	// let the simulator know no more chips will be added
 	simulator_device_complete(device->simulator);
 
+	// mapping of the address space for read_memory/write_memory
+	memory_blocks_setup(device);
+
+	// memory watchpoints
+	device->bus_watcher = bus_watcher_create(SIGNAL(CLK1), SIGNAL(RW), SIGNAL(SYNC), device->sg_cpu_address, device->sg_cpu_data);
+
 	// signal history - logic analyzer profiles
 	dev_commodore_pet_history_profiles(device, "PET", device->simulator->signal_history);
 	cpu_6502_signal_history_profiles(device->cpu, "CPU 6502", device->simulator->signal_history);
@@ -2594,10 +2698,14 @@ void dev_commodore_pet_destroy(DevCommodorePet *device) {
 	signal_group_destroy(device->sg_latched_vram_data);
 	signal_group_destroy(device->sg_char_data);
 
+	bus_watcher_destroy(device->bus_watcher);
+
 	if (device->is_lite) {
 		display_rgba_destroy(device->screen);
 	}
 
+	dms_free(device->fast_bus_map);
+
 	simulator_destroy(device->simulator);
 	dms_free(device);
 }
@@ -2618,80 +2726,48 @@ void dev_commodore_pet_read_memory(DevCommodorePet *device, size_t start_address
 	assert(device);
 	assert(output);
 
-	// note: this function skips the free rom slots
-	static const size_t	REGION_START[] = {0x0000, 0x4000, 0x8000, 0x8800, 0xb000, 0xc000, 0xd000, 0xe000, 0xe800, 0xf000};
-	static const size_t REGION_SIZE[]  = {0x4000, 0x4000, 0x0800, 0x2800, 0x1000, 0x1000, 0x1000, 0x0800, 0x0800, 0x1000};
-	static const int NUM_REGIONS = sizeof(REGION_START) / sizeof(REGION_START[0]);
+	size_t done = 0;
 
-	if (start_address > 0xffff) {
-		dms_zero(output, size);
-		return;
-	}
+	while (done < size) {
+		size_t addr = start_address + done;
+		if (addr > 0xffff) {
+			dms_zero(output + done, size - done);
+			break;
+		}
 
-	// find start region
-	int sr = NUM_REGIONS - 1;
-	while (start_address < REGION_START[sr] && sr > 0) {
-		sr -= 1;
-	}
+		const DevCommodorePetMemoryBlock *block = &device->memory_blocks[addr / PET_MEMORY_BLOCK_SIZE];
+		size_t offset = addr % PET_MEMORY_BLOCK_SIZE;
+		size_t count = MIN(size - done, PET_MEMORY_BLOCK_SIZE - offset);
+		uint8_t *dst = output + done;
 
-	size_t remain = size;
-	size_t done = 0;
-	size_t addr = start_address;
-
-	for (int region = sr; remain > 0 && addr <= 0xffff && region < NUM_REGIONS; ++region) {
-		size_t region_offset = addr - REGION_START[region];
-		size_t to_copy = MIN(remain, REGION_SIZE[region] - region_offset);
-
-		switch (region) {
-			case 0:	{			// RAM (0-16k)
-				Chip8x4116DRam *ram = (Chip8x4116DRam *) simulator_chip_by_name(device->simulator, "I2-9");
-				for (size_t i = 0; i < to_copy; ++i) {
-					size_t row = (region_offset + i) & 0x007f;
-					size_t col = ((region_offset + i) & 0x3f80) >> 7;
-					size_t physical = (row << 7) | ((col & 0x003f) << 1) | ((col & 0x0040) >> 6);
-					output[done+i] = ram->data_array[physical];
-				}
-				break;
+		if (!block->data) {
+			while (done + count < size && addr + count <= 0xffff &&
+				   !device->memory_blocks[(addr + count) / PET_MEMORY_BLOCK_SIZE].data) {
+				count = MIN(size - done, count + PET_MEMORY_BLOCK_SIZE);
 			}
-			case 1:	{			// RAM (16-32k)
-				Chip8x4116DRam *ram = (Chip8x4116DRam *) simulator_chip_by_name(device->simulator, "J2-9");
-				for (size_t i = 0; i < to_copy; ++i) {
-					size_t row = (region_offset + i) & 0x007f;
-					size_t col = ((region_offset + i) & 0x3f80) >> 7;
-					size_t physical = (row << 7) | ((col & 0x003f) << 1) | ((col & 0x0040) >> 6);
-					output[done+i] = ram->data_array[physical];
-				}
-				break;
+			dms_zero(dst, count);
+		} else if (block->data_lo) {
+			for (size_t i = 0; i < count; ++i) {
+				dst[i] = (uint8_t) (((block->data[offset + i] & 0xf) << 4) | (block->data_lo[offset + i] & 0xf));
 			}
-			case 2:	{			// Screen RAM
-				Chip6114SRam *ram_hi = (Chip6114SRam *) simulator_chip_by_name(device->simulator, "F7");
-				Chip6114SRam *ram_lo = (Chip6114SRam *) simulator_chip_by_name(device->simulator, "F8");
-
-				for (size_t i = 0; i < to_copy; ++i) {
-					output[done + i] = (uint8_t) (((ram_hi->data_array[region_offset + i] & 0xf) << 4) |
-												   (ram_lo->data_array[region_offset + i] & 0xf));
+		} else if (block->stride == 1) {
+			// copy the blocks that follow each other in memory at once
+			while (done + count < size && addr + count <= 0xffff) {
+				const DevCommodorePetMemoryBlock *next = &device->memory_blocks[(addr + count) / PET_MEMORY_BLOCK_SIZE];
+				if (next->stride != 1 || next->data_lo || next->data != block->data + offset + count) {
+					break;
 				}
-				break;
+				count = MIN(size - done, count + PET_MEMORY_BLOCK_SIZE);
+			}
+			dms_memcpy(dst, block->data + offset, count);
+		} else {
+			const uint8_t *src = block->data + (offset * block->stride);
+			for (size_t i = 0; i < count; ++i, src += block->stride) {
+				dst[i] = *src;
 			}
-			case 3:				// unused space between video memory and first rom
-			case 8:				// I/O area (pia-1, pia-2, via)
-				dms_zero(output + done, to_copy);
-				break;
-			case 4:				// basic-rom 1
-			case 5:				// basic-rom 2
-			case 6:				// basic-rom 3
-			case 7:				// editor rom
-				dms_memcpy(output + done, device->roms[region-4]->data_array + region_offset, to_copy);
-				break;
-			case 9:				// kernal rom
-				dms_memcpy(output + done, device->roms[4]->data_array + region_offset, to_copy);
-				break;
-
 		}
 
-		remain -= to_copy;
-		addr += to_copy;
-		done += to_copy;
+		done += count;
 	}
 }
 
@@ -2700,197 +2776,109 @@ void dev_commodore_pet_write_memory(DevCommodorePet *device, size_t start_addres
 	assert(input);
 
 	// note: this function only allows writes to the main RAM and video memory
-	static const size_t	REGION_START[] = {0x0000, 0x4000, 0x8000};
-	static const size_t REGION_SIZE[]  = {0x4000, 0x4000, 0x0800};
-	static const int NUM_REGIONS = sizeof(REGION_START) / sizeof(REGION_START[0]);
-
-	if (start_address > 0x87ff) {
-		return;
-	}
-
-	// find start region
-	int sr = NUM_REGIONS - 1;
-	while (start_address < REGION_START[sr] && sr > 0) {
-		sr -= 1;
-	}
-
-	size_t remain = size;
-	size_t done = 0;
-	size_t addr = start_address;
-
-	for (int region = sr; remain > 0 && addr < 0x8800 && region < NUM_REGIONS; ++region) {
-		size_t region_offset = addr - REGION_START[region];
-		size_t to_copy = MIN(remain, REGION_SIZE[region] - region_offset);
-
-		switch (region) {
-			case 0:	{			// RAM (0-16k)
-				Chip8x4116DRam *ram = (Chip8x4116DRam *) simulator_chip_by_name(device->simulator, "I2-9");
-				for (size_t i = 0; i < to_copy; ++i) {
-					size_t row = (region_offset + i) & 0x007f;
-					size_t col = ((region_offset + i) & 0x3f80) >> 7;
-					size_t physical = (row << 7) | ((col & 0x003f) << 1) | ((col & 0x0040) >> 6);
-					ram->data_array[physical] = input[done+i];
-				}
-				break;
+	for (size_t done = 0; done < size && start_address + done <= 0xffff; ) {
+		size_t addr = start_address + done;
+		const DevCommodorePetMemoryBlock *block = &device->memory_blocks[addr / PET_MEMORY_BLOCK_SIZE];
+		size_t offset = addr % PET_MEMORY_BLOCK_SIZE;
+		size_t count = MIN(size - done, PET_MEMORY_BLOCK_SIZE - offset);
+		const uint8_t *src = input + done;
+
+		if (!block->data || block->read_only) {
+			// skip
+		} else if (block->data_lo) {
+			for (size_t i = 0; i < count; ++i) {
+				block->data[offset + i] = (src[i] & 0xf0) >> 4;
+				block->data_lo[offset + i] = src[i] & 0x0f;
 			}
-			case 1:	{			// RAM (16-32k)
-				Chip8x4116DRam *ram = (Chip8x4116DRam *) simulator_chip_by_name(device->simulator, "J2-9");
-				for (size_t i = 0; i < to_copy; ++i) {
-					size_t row = (region_offset + i) & 0x007f;
-					size_t col = ((region_offset + i) & 0x3f80) >> 7;
-					size_t physical = (row << 7) | ((col & 0x003f) << 1) | ((col & 0x0040) >> 6);
-					ram->data_array[physical] = input[done+i];
-				}
-				break;
-			}
-			case 2:	{			// Screen RAM
-				Chip6114SRam *ram_hi = (Chip6114SRam *) simulator_chip_by_name(device->simulator, "F7");
-				Chip6114SRam *ram_lo = (Chip6114SRam *) simulator_chip_by_name(device->simulator, "F8");
-
-				for (size_t i = 0; i < to_copy; ++i) {
-					ram_hi->data_array[region_offset+i] = (input[done+i] & 0xf0) >> 4;
-					ram_lo->data_array[region_offset+i] = (input[done+i] & 0x0f);
-				}
-				break;
+		} else if (block->stride == 1) {
+			dms_memcpy(block->data + offset, src, count);
+		} else {
+			uint8_t *dst = block->data + (offset * block->stride);
+			for (size_t i = 0; i < count; ++i, dst += block->stride) {
+				*dst = src[i];
 			}
 		}
 
-		remain -= to_copy;
-		addr += to_copy;
-		done += to_copy;
+		done += count;
 	}
 }
 
-
-void dev_commodore_pet_lite_read_memory(DevCommodorePet *device, size_t start_address, size_t size, uint8_t *output) {
+size_t dev_commodore_pet_get_irq_signals(DevCommodorePet *device, SignalBreakpoint **irq_signals) {
 	assert(device);
-	assert(output);
-
-	// note: this function skips the free rom slots
-	static const size_t	REGION_START[] = {0x0000, 0x8000, 0x8800, 0xb000, 0xc000, 0xd000, 0xe000, 0xe800, 0xf000};
-	static const size_t REGION_SIZE[]  = {0x8000, 0x0800, 0x2800, 0x1000, 0x1000, 0x1000, 0x0800, 0x0800, 0x1000};
-	static const int NUM_REGIONS = sizeof(REGION_START) / sizeof(REGION_START[0]);
+	assert(irq_signals);
 
-	if (start_address > 0xffff) {
-		dms_zero(output, size);
-		return;
-	}
+	static SignalBreakpoint pet_irq = {
+		.pos_edge = false,
+		.neg_edge = false,
+	};
 
-	// find start region
-	int sr = NUM_REGIONS - 1;
-	while (start_address < REGION_START[sr] && sr > 0) {
-		sr -= 1;
+	if (signal_is_undefined(pet_irq.signal)) {
+		pet_irq = (SignalBreakpoint) {SIGNAL(IRQ_B), false, true};
 	}
 
-	size_t remain = size;
-	size_t done = 0;
-	size_t addr = start_address;
-
-	for (int region = sr; remain > 0 && addr <= 0xffff && region < NUM_REGIONS; ++region) {
-		size_t region_offset = addr - REGION_START[region];
-		size_t to_copy = MIN(remain, REGION_SIZE[region] - region_offset);
+	*irq_signals = &pet_irq;
+	return 1;
+}
 
-		switch (region) {
-			case 0:	{			// RAM (0-32k)
-				Ram8d16a *ram = (Ram8d16a *) simulator_chip_by_name(device->simulator, "RAM");
-				dms_memcpy(output + done, ram->data_array + region_offset, to_copy);
-				break;
-			}
-			case 1:	{			// Screen RAM
-				Ram8d16a *vram = (Ram8d16a *) simulator_chip_by_name(device->simulator, "VRAM");
-				dms_memcpy(output + done, vram->data_array + region_offset, to_copy);
-				break;
-			}
-			case 2:				// unused space between video memory and first rom
-			case 7:				// I/O area (pia-1, pia-2, via)
-				dms_zero(output + done, to_copy);
-				break;
-			case 3:				// basic-rom 1
-			case 4:				// basic-rom 2
-			case 5:				// basic-rom 3
-			case 6:				// editor rom
-				dms_memcpy(output + done, device->roms[region-3]->data_array + region_offset, to_copy);
-				break;
-			case 8:				// kernal rom
-				dms_memcpy(output + done, device->roms[4]->data_array + region_offset, to_copy);
-				break;
-		}
+void dev_commodore_pet_diag_mode(DevCommodorePet *device, bool in_diag) {
+	assert(device);
 
-		remain -= to_copy;
-		addr += to_copy;
-		done += to_copy;
+	if (in_diag != device->diag_mode) {
+		device->diag_mode = in_diag;
+		device->diag_toggled = true;
 	}
 }
 
-void dev_commodore_pet_lite_write_memory(DevCommodorePet *device, size_t start_address, size_t size, uint8_t *input) {
+bool dev_commodore_pet_fast_bus(DevCommodorePet *device, bool enable) {
 	assert(device);
-	assert(input);
 
-	// note: this function only allows writes to the main RAM and video memory
-	static const size_t	REGION_START[] = {0x0000, 0x8000};
-	static const size_t REGION_SIZE[]  = {0x8000, 0x0800};
-	static const int NUM_REGIONS = sizeof(REGION_START) / sizeof(REGION_START[0]);
-
-	if (start_address > 0x87ff) {
-		return;
+	if (!device->is_lite) {
+		return false;
 	}
 
-	// find start region
-	int sr = NUM_REGIONS - 1;
-	while (start_address < REGION_START[sr] && sr > 0) {
-		sr -= 1;
+	if (!enable) {
+		cpu_6502_set_memory_map(device->cpu, NULL);
+		return true;
 	}
 
-	size_t remain = size;
-	size_t done = 0;
-	size_t addr = start_address;
-
-	for (int region = sr; remain > 0 && addr < 0x8800 && region < NUM_REGIONS; ++region) {
-		size_t region_offset = addr - REGION_START[region];
-		size_t to_copy = MIN(remain, REGION_SIZE[region] - region_offset);
-
-		switch (region) {
-			case 0:	{			// RAM (0-32k)
-				Ram8d16a *ram = (Ram8d16a *) simulator_chip_by_name(device->simulator, "RAM");
-				dms_memcpy(ram->data_array + region_offset, input + done, to_copy);
-				break;
-			}
-			case 1:	{			// Screen RAM
-				Ram8d16a *vram = (Ram8d16a *) simulator_chip_by_name(device->simulator, "VRAM");
-				dms_memcpy(vram->data_array + region_offset, input + done, to_copy);
-				break;
-			}
-		}
-
-		remain -= to_copy;
-		addr += to_copy;
-		done += to_copy;
+	if (!device->fast_bus_map) {
+		device->fast_bus_map = (Cpu6502MemoryMap *) dms_calloc(1, sizeof(Cpu6502MemoryMap));
+		fast_bus_map_setup(device);
 	}
+
+	cpu_6502_set_memory_map(device->cpu, device->fast_bus_map);
+	return true;
 }
 
-size_t dev_commodore_pet_get_irq_signals(DevCommodorePet *device, SignalBreakpoint **irq_signals) {
+uint8_t *dev_commodore_pet_rom_private_copy(DevCommodorePet *device, size_t index) {
 	assert(device);
-	assert(irq_signals);
+	assert(index < sizeof(device->roms) / sizeof(device->roms[0]));
 
-	static SignalBreakpoint pet_irq = {
-		.pos_edge = false,
-		.neg_edge = false,
-	};
+	Chip63xxRom *rom = device->roms[index];
+	if (!rom) {
+		return NULL;
+	}
 
-	if (signal_is_undefined(pet_irq.signal)) {
-		pet_irq = (SignalBreakpoint) {SIGNAL(IRQ_B), false, true};
+	chip_63xx_rom_private_copy(rom);
+
+	// the memory map still points into the shared image
+	memory_blocks_setup(device);
+	if (device->fast_bus_map) {
+		fast_bus_map_setup(device);
 	}
 
-	*irq_signals = &pet_irq;
-	return 1;
+	return rom->data_array;
 }
 
-void dev_commodore_pet_diag_mode(DevCommodorePet *device, bool in_diag) {
+void dev_commodore_pet_zero_latency_roms(DevCommodorePet *device, bool enable) {
 	assert(device);
 
-	if (in_diag != device->diag_mode) {
-		device->diag_mode = in_diag;
-		device->diag_toggled = true;
+	for (size_t i = 0; i < 5; ++i) {
+		chip_63xx_rom_zero_latency(device->roms[i], enable);
+	}
+
+	if (!device->is_lite) {
+		chip_63xx_rom_zero_latency((Chip63xxRom *) simulator_chip_by_name(device->simulator, "F10"), enable);
 	}
 }
 
@@ -437,6 +437,17 @@ enum DevCommodorePetSignalAssignment {
 
 typedef Signal DevCommodorePetSignals[SIG_P2001N_SIGNAL_COUNT];
 
+// mapping of a block of the address space to the memory chips, used by read_memory/write_memory
+#define PET_MEMORY_BLOCK_SIZE	128
+#define PET_MEMORY_BLOCK_COUNT	(0x10000 / PET_MEMORY_BLOCK_SIZE)
+
+typedef struct DevCommodorePetMemoryBlock {
+	uint8_t *	data;			// memory of the first address in the block (NULL == reads zero, writes are ignored)
+	uint8_t *	data_lo;		// 4-bit screen RAM (full PET): low nibbles, data holds the high nibbles
+	uint16_t	stride;			// distance in data between consecutive addresses (the DRAMs scramble the address)
+	bool		read_only;
+} DevCommodorePetMemoryBlock;
+
 typedef struct DevCommodorePet {
 	DEVICE_DECLARE_FUNCTIONS
 
@@ -459,6 +470,9 @@ typedef struct DevCommodorePet {
 
 	bool					in_reset;
 
+	struct Cpu6502MemoryMap *	fast_bus_map;		// memory map of the cpu in fast bus mode (lite-PET only)
+	DevCommodorePetMemoryBlock	memory_blocks[PET_MEMORY_BLOCK_COUNT];
+
 	bool					diag_mode;
 	bool					diag_toggled;
 
@@ -494,6 +508,20 @@ void dev_commodore_pet_reset(DevCommodorePet *device);
 
 void dev_commodore_pet_diag_mode(DevCommodorePet *device, bool in_diag);
 
+// dev_commodore_pet_fast_bus: let the cpu access RAM and ROM directly instead of over the signal bus (see
+//	cpu_6502_set_memory_map). Only the I/O area and the unused address space still use bus cycles.
+//	- while memory watchpoints are set, all accesses use bus cycles again (at regular speed)
+//	- only the lite-PET supports fast bus mode, returns false for the full PET
+bool dev_commodore_pet_fast_bus(DevCommodorePet *device, bool enable);
+
+// dev_commodore_pet_zero_latency_roms: let the roms (including the character rom) output their data in the same timestep
+//	as the address change instead of after their access time (see chip_63xx_rom_zero_latency)
+void dev_commodore_pet_zero_latency_roms(DevCommodorePet *device, bool enable);
+
+// dev_commodore_pet_rom_private_copy: the contents of the roms are shared by all devices and read-only, give the rom at
+//	the index (in roms) a writable copy for this device only, e.g. to patch it. Returns the contents of the rom.
+uint8_t *dev_commodore_pet_rom_private_copy(DevCommodorePet *device, size_t index);
+
 bool dev_commodore_pet_load_prg(DevCommodorePet* device, const char* filename, bool use_prg_address);
 
 #ifdef __cplusplus
@@ -8,6 +8,7 @@
 #include "utils.h"
 #include "stb/stb_ds.h"
 
+#include "bus_watcher.h"
 #include "chip_6520.h"
 #include "chip_hd44780.h"
 #include "chip_oscillator.h"
@@ -365,6 +366,9 @@ DevMinimal6502 *dev_minimal_6502_create(const uint8_t *rom_data) {
 	// let the simulator know no more chips will be added
 	simulator_device_complete(device->simulator);
 
+	// memory watchpoints
+	device->bus_watcher = bus_watcher_create(SIGNAL(CLOCK), SIGNAL(CPU_RW), SIGNAL(CPU_SYNC), device->sg_address, device->sg_data);
+
 	return device;
 }
 
@@ -373,6 +377,7 @@ void dev_minimal_6502_destroy(DevMinimal6502 *device) {
 
 	signal_group_destroy(device->sg_address);
 	signal_group_destroy(device->sg_data);
+	bus_watcher_destroy(device->bus_watcher);
 
 	simulator_destroy(device->simulator);
 	dms_free(device);
@@ -31,7 +31,8 @@ typedef size_t (*DEVICE_GET_IRQ_SIGNALS)(void *device, SignalBreakpoint **irq_si
 	DEVICE_WRITE_MEMORY write_memory;		\
 	DEVICE_GET_IRQ_SIGNALS get_irq_signals; \
 											\
-	struct Simulator *simulator;
+	struct Simulator *simulator;			\
+	struct BusWatcher *bus_watcher;
 
 #define DEVICE_REGISTER_CHIP(name,c)	simulator_register_chip(device->simulator, (Chip *) (c), (name))
 
@@ -172,3 +172,8 @@ size_t filt_6502_asm_count_instruction(const uint8_t *binary, size_t bin_size, s
 
 	return count;
 }
+
+bool filt_6502_asm_is_indexed_or_indirect(uint8_t opcode) {
+	ADDR_MODE mode = OPCODE_ADDRESS_MODES[opcode];
+	return mode >= ZPX && mode <= INDY && mode != ABS;
+}
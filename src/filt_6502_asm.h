@@ -14,6 +14,9 @@ extern "C" {
 size_t filt_6502_asm_line(const uint8_t *binary, size_t bin_size, size_t bin_index, size_t bin_offset, char **line);
 size_t filt_6502_asm_count_instruction(const uint8_t *binary, size_t bin_size, size_t from, size_t until);
 
+// filt_6502_asm_is_indexed_or_indirect: true if the effective address of the opcode differs from its operand
+bool filt_6502_asm_is_indexed_or_indirect(uint8_t opcode);
+
 #ifdef __cplusplus
 }
 #endif
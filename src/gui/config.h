@@ -4,6 +4,7 @@
 #define DROMAIUS_GUI_CONFIG_H
 
 #include "types.h"
+#include <string>
 #include <string_view>
 
 enum class MachineType : int {
@@ -15,6 +16,9 @@ enum class MachineType : int {
 struct Config {
 public:
 	MachineType		machine_type = MachineType::CommodorePet;
+	std::string		debug_server_address;			// empty = no remote debug server
+	std::string		input_record_file;				// empty = don't record the input events
+	std::string		input_replay_file;				// empty = don't replay recorded input events
 
 public:
 	bool set_machine_type(const std::string_view &text);
@@ -35,6 +35,9 @@ static void glfw_error_callback(int error, const char* description) {
 
 using argh_list_t = std::initializer_list<const char *const>;
 static constexpr argh_list_t ARG_MACHINE = {"-m", "--machine"};
+static constexpr argh_list_t ARG_DEBUG_SERVER = {"-d", "--debug-server"};
+static constexpr argh_list_t ARG_RECORD = {"--record"};
+static constexpr argh_list_t ARG_REPLAY = {"--replay"};
 static constexpr argh_list_t ARG_HELP = {"-h", "--help"};
 
 void print_help() {
@@ -56,6 +59,12 @@ void print_help() {
 	printf("Options\n");
 	printf(" %-25s specify machine to emulate (commodore-pet, commodore-pet-lite, minimal-6502).\n",
 			format_argh_list(ARG_MACHINE).c_str());
+	printf(" %-25s start a remote debug server (unix:<path> or tcp:<port>).\n",
+			format_argh_list(ARG_DEBUG_SERVER).c_str());
+	printf(" %-25s record keys, tapes, disks and resets to a file.\n",
+			format_argh_list(ARG_RECORD).c_str());
+	printf(" %-25s replay a recording made with --record.\n",
+			format_argh_list(ARG_REPLAY).c_str());
 	printf(" %-25s display this help message and stop execution.\n",
 			format_argh_list(ARG_HELP).c_str());
 }
@@ -77,6 +86,9 @@ int main(int argc, char **argv)
 	// parse command-line arguments
 	argh::parser cmd_line;
 	cmd_line.add_params(ARG_MACHINE);
+	cmd_line.add_params(ARG_DEBUG_SERVER);
+	cmd_line.add_params(ARG_RECORD);
+	cmd_line.add_params(ARG_REPLAY);
 	cmd_line.add_params(ARG_HELP);
 	cmd_line.parse(argc, argv);
 
@@ -96,6 +108,10 @@ int main(int argc, char **argv)
 			fprintf(stderr, "Invalid machine type specified (%s)\n", machine.c_str());
 			exit(EXIT_FAILURE);
 		}
+
+		cmd_line(ARG_DEBUG_SERVER, "") >> ui_config.debug_server_address;
+		cmd_line(ARG_RECORD, "") >> ui_config.input_record_file;
+		cmd_line(ARG_REPLAY, "") >> ui_config.input_replay_file;
 	}
 
     // Setup window
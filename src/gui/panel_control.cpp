@@ -49,6 +49,8 @@ public:
 		freq_column_0_width = std::max(ImGuiEx::ButtonWidth(txt_freq_header_type), ImGuiEx::ButtonWidth(txt_freq_normal));
 		freq_column_0_width = std::max(freq_column_0_width, ImGuiEx::ButtonWidth(txt_freq_actual));
 		freq_column_0_width = std::max(freq_column_0_width, ImGuiEx::ButtonWidth(txt_freq_target));
+		freq_column_0_width = std::max(freq_column_0_width, ImGuiEx::ButtonWidth(txt_pacing_jitter));
+		freq_column_0_width = std::max(freq_column_0_width, ImGuiEx::ButtonWidth(txt_pacing_overshoot));
 
 		freq_combo_width = ImGuiEx::ButtonWidth(FREQUENCY_UNITS[0]);
 		for (size_t i = 1; i < sizeof(FREQUENCY_UNITS) / sizeof(FREQUENCY_UNITS[0]); ++i) {
@@ -94,8 +96,7 @@ public:
 			ImGui::SameLine();
 
 			if (ImGui::Button(txt_reset_soft)) {
-				Device *device = dms_get_device(ui_context->dms_ctx);
-				device->reset(device);
+				dms_input_reset(ui_context->dms_ctx);
 			}
 
 			ImGui::Spacing();
@@ -188,10 +189,35 @@ public:
 					dms_change_simulation_speed_ratio(ui_context->dms_ctx, speed_ratio);
 				}
 
+				// pacing statistics
+				DmsPacingStats pacing = dms_pacing_stats(ui_context->dms_ctx);
+
+				ImGui::TableNextRow();
+				ImGui::TableSetColumnIndex(0);
+				ImGui::Text(txt_pacing_jitter);
+				ImGui::TableSetColumnIndex(1);
+				ImGui::Text("%.2f ms (slice %.2f ms)", static_cast<double>(pacing.jitter_ps) / 1e9, static_cast<double>(pacing.slice_ps) / 1e9);
+
+				ImGui::TableNextRow();
+				ImGui::TableSetColumnIndex(0);
+				ImGui::Text(txt_pacing_overshoot);
+				ImGui::TableSetColumnIndex(1);
+				ImGui::Text("%.2f ms", static_cast<double>(pacing.overshoot_ps) / 1e9);
+
 				ImGui::EndTable();
 
 			}
 
+			// warp mode during tape/disk transfers
+			bool auto_warp = dms_auto_warp(ui_context->dms_ctx);
+			if (ImGui::Checkbox(txt_auto_warp, &auto_warp)) {
+				dms_auto_warp_set(ui_context->dms_ctx, auto_warp);
+			}
+			if (dms_get_status(ui_context->dms_ctx).warp) {
+				ImGui::SameLine();
+				ImGui::Text(txt_warp_active);
+			}
+
 		ImGui::End();
 	}
 
@@ -221,6 +247,10 @@ private:
 	static constexpr const char *txt_freq_normal = "Normal";
 	static constexpr const char *txt_freq_actual = "Actual";
 	static constexpr const char *txt_freq_target = "Target";
+	static constexpr const char *txt_pacing_jitter = "Jitter";
+	static constexpr const char *txt_pacing_overshoot = "Overshoot";
+	static constexpr const char *txt_auto_warp = "Warp during tape/disk I/O";
+	static constexpr const char *txt_warp_active = "(warping)";
 
 private:
 	ImVec2					position;
@@ -3,7 +3,10 @@
 #include "panel_datassette.h"
 #include "ui_context.h"
 
+#include "context.h"
 #include "perif_datassette_1530.h"
+#include "utils.h"
+#include <stb/stb_ds.h>
 
 #include "widgets.h"
 #include "imgui_ex.h"
@@ -67,32 +70,32 @@ public:
 			// tape control buttons
 
 			if (ImGui::Button("Record")) {
-				perif_datassette_key_pressed(datassette, DS_KEY_RECORD);
+				dms_input_datassette_key(ui_context->dms_ctx, datassette, DS_KEY_RECORD);
 			}
 			ImGui::SameLine();
 
 			if (ImGui::Button("Play")) {
-				perif_datassette_key_pressed(datassette, DS_KEY_PLAY);
+				dms_input_datassette_key(ui_context->dms_ctx, datassette, DS_KEY_PLAY);
 			}
 			ImGui::SameLine();
 
 			if (ImGui::Button("Rewind")) {
-				perif_datassette_key_pressed(datassette, DS_KEY_REWIND);
+				dms_input_datassette_key(ui_context->dms_ctx, datassette, DS_KEY_REWIND);
 			}
 			ImGui::SameLine();
 
 			if (ImGui::Button("F.Fwd")) {
-				perif_datassette_key_pressed(datassette, DS_KEY_FFWD);
+				dms_input_datassette_key(ui_context->dms_ctx, datassette, DS_KEY_FFWD);
 			}
 			ImGui::SameLine();
 
 			if (ImGui::Button("Stop")) {
-				perif_datassette_key_pressed(datassette, DS_KEY_STOP);
+				dms_input_datassette_key(ui_context->dms_ctx, datassette, DS_KEY_STOP);
 			}
 			ImGui::SameLine();
 
 			if (ImGui::Button("Eject")) {
-				perif_datassette_key_pressed(datassette, DS_KEY_EJECT);
+				dms_input_datassette_key(ui_context->dms_ctx, datassette, DS_KEY_EJECT);
 			}
 
 			// signals
@@ -110,7 +113,12 @@ public:
 		if (load_tap) {
 			tap_selection->display_popup([&](std::string selected_file) {
 				load_tap_filename = selected_file;
-				perif_datassette_load_tap_from_file(datassette, path_for_tap_file(selected_file).c_str());
+				int8_t *raw = nullptr;
+				size_t len = file_load_binary(path_for_tap_file(selected_file).c_str(), &raw);
+				if (len > 0) {
+					dms_input_tape_load(ui_context->dms_ctx, datassette, raw, len);
+				}
+				arrfree(raw);
 			});
 		}
 
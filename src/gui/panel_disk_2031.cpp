@@ -3,7 +3,10 @@
 #include "panel_disk_2031.h"
 #include "ui_context.h"
 
+#include "context.h"
 #include "perif_disk_2031.h"
+#include "utils.h"
+#include <stb/stb_ds.h>
 
 #include "widgets.h"
 #include "imgui_ex.h"
@@ -134,7 +137,12 @@ public:
 		if (load_d64) {
 			d64_selection->display_popup([&](std::string selected_file) {
 				loaded_filename = selected_file;
-				perif_fd2031_load_d64_from_file(tester, path_for_d64_file(selected_file).c_str());
+				int8_t *raw = nullptr;
+				size_t len = file_load_binary(path_for_d64_file(selected_file).c_str(), &raw);
+				if (len > 0) {
+					dms_input_disk_load(ui_context->dms_ctx, tester, raw, len);
+				}
+				arrfree(raw);
 			});
 		}
 
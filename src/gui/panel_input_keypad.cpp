@@ -4,6 +4,7 @@
 #include "ui_context.h"
 #include "imgui_ex.h"
 
+#include "context.h"
 #include "input_keypad.h"
 
 class PanelInputKeypad : public Panel {
@@ -12,7 +13,7 @@ public:
 		Panel(ctx),
 		position(pos),
 		keypad(keypad) {
-		input_keypad_set_dwell_time_ms(keypad, key_dwell_ms);
+		dms_input_key_dwell_time(ui_context->dms_ctx, keypad, key_dwell_ms);
 	}
 
 	void display() override {
@@ -32,7 +33,7 @@ public:
 					ImGui::InvisibleButton(labels[r*4+c].c_str(), {32,32});
 
 					if (ImGui::IsItemHovered() && ImGui::IsMouseDown(0)) {
-						input_keypad_key_pressed(keypad, r, c);
+						dms_input_key_pressed(ui_context->dms_ctx, keypad, r, c);
 					}
 
 					ImGui::SameLine();
@@ -50,7 +51,7 @@ public:
 
 			ImGui::SetNextItemWidth(-FLT_MIN);
 			if (ImGui::DragInt("##dwell", &key_dwell_ms, 1, 1, 2000, "%d ms")) {
-				input_keypad_set_dwell_time_ms(keypad, key_dwell_ms);
+				dms_input_key_dwell_time(ui_context->dms_ctx, keypad, key_dwell_ms);
 			}
 		}
 		ImGui::End();
@@ -4,6 +4,7 @@
 #include "ui_context.h"
 #include "imgui_ex.h"
 
+#include "context.h"
 #include "input_keypad.h"
 
 #include <GLFW/glfw3.h>
@@ -15,7 +16,7 @@ public:
 		Panel(ctx),
 		position(pos),
 		keypad(keypad) {
-		input_keypad_set_dwell_time_ms(keypad, key_dwell_ms);
+		dms_input_key_dwell_time(ui_context->dms_ctx, keypad, key_dwell_ms);
 	}
 
 	void init() override {
@@ -57,7 +58,7 @@ public:
 					ImGuiEx::Text(labels[k].c_str(), {key.width, KEY_SIZE}, ImGuiEx::TAH_CENTER , ImGuiEx::TAV_CENTER);
 					if (ImGui::InvisibleButton(labels[k].c_str(), {key.width, KEY_SIZE}) ||
 				        (key.key_code != 0 && ImGui::IsWindowFocused() && glfwGetKey(ui_context->glfw_window, key.key_code))) {
-						input_keypad_key_pressed(keypad, r, c);
+						dms_input_key_pressed(ui_context->dms_ctx, keypad, r, c);
 					}
 					ImGui::PopID();
 				}
@@ -77,7 +78,7 @@ public:
 			}
 
 			if (shift_locked) {
-				input_keypad_key_pressed(keypad, KEY_SHIFT_R, KEY_SHIFT_C);
+				dms_input_key_pressed(ui_context->dms_ctx, keypad, KEY_SHIFT_R, KEY_SHIFT_C);
 			}
 
 			ImGui::EndChild();
@@ -88,7 +89,7 @@ public:
 
 			ImGui::SetNextItemWidth(128);
 			if (ImGui::DragInt("##dwell", &key_dwell_ms, 1, 1, 2000, "%d ms")) {
-				input_keypad_set_dwell_time_ms(keypad, key_dwell_ms);
+				dms_input_key_dwell_time(ui_context->dms_ctx, keypad, key_dwell_ms);
 			}
 
 			if (ImGui::IsWindowFocused() && !ImGui::IsAnyItemActive() && !ImGui::IsMouseClicked(0)) {
@@ -117,7 +118,7 @@ public:
 			if (found != label_to_index.end()) {
 				auto r = found->second / 8;
 				auto c = found->second % 8;
-				input_keypad_key_pressed(keypad, r, c);
+				dms_input_key_pressed(ui_context->dms_ctx, keypad, r, c);
 				send_delay = 5;
 			}
 			++send_index;
@@ -4,12 +4,15 @@
 
 #include "panel_logic_analyzer.h"
 #include "signal_history.h"
+#include "signal_trigger.h"
 #include "context.h"
 #include "ui_context.h"
 #include "device.h"
+#include "utils.h"
 
 #include "imgui_ex.h"
 #include <imgui.h>
+#include <algorithm>
 #include <vector>
 
 class PanelLogicAnalyzer : public Panel {
@@ -18,13 +21,22 @@ public:
 		Panel(ctx),
 		position(pos) {
 		input[0] = '\0';
+		find_input[0] = '\0';
 		title = ui_context->unique_panel_id("LogicAnalyzer");
+		trigger_config = signal_trigger_create();
+	}
+
+	~PanelLogicAnalyzer() {
+		signal_trigger_destroy(trigger_config);
+		signal_history_diagram_release(&diagram_data);
+		arrfree(transactions);
 	}
 
 	void init() override {
 		// 20 pixels = 1 timebase (default: 1 µs = 1000 ns == 1 MHz)
 		time_scale = (1000000.0f / (float) time_base) / (20.0f * (float) ui_context->device->simulator->tick_duration_ps);
 		enable_history = ui_context->device->simulator->signal_history->capture_active;
+		update_capture_mask();
 	}
 
 	void display() override {
@@ -48,6 +60,12 @@ public:
 				}
 			}
 
+			// >> only capture the signals that are shown
+			ImGui::SameLine();
+			if (ImGui::Checkbox("Visible only", &capture_visible_only)) {
+				update_capture_mask();
+			}
+
 			// >> enable GtkWave output
 #ifdef DMS_GTKWAVE_EXPORT
 			ImGui::SameLine();
@@ -80,6 +98,38 @@ public:
 			}
 			ImGui::EndDisabled();
 
+			// >> choose bus (group channel)
+			if (sim->signal_history->group_count > 0) {
+				ImGui::SameLine(0, 12);
+				ImGui::Text("Bus");
+				ImGui::SameLine();
+				ImGui::SetNextItemWidth(192);
+				ImGui::Combo("##groups", &current_group,
+							 signal_history_group_names(sim->signal_history),
+							 (int) sim->signal_history->group_count);
+
+				ImGui::SameLine();
+				if (ImGui::Button(" Add ##add_group")) {
+					add_group((uint32_t) current_group);
+				}
+			}
+
+			// >> choose protocol decoder
+			if (signal_history_decoder_count(sim->signal_history) > 0) {
+				ImGui::SameLine(0, 12);
+				ImGui::Text("Decoder");
+				ImGui::SameLine();
+				ImGui::SetNextItemWidth(160);
+				ImGui::Combo("##decoders", &current_decoder,
+							 signal_history_decoder_names(sim->signal_history),
+							 (int) signal_history_decoder_count(sim->signal_history));
+
+				ImGui::SameLine();
+				if (ImGui::Button(" Add ##add_decoder")) {
+					add_decoder((uint32_t) current_decoder);
+				}
+			}
+
 			// >> add new signal
 			if (ImGui::IsWindowFocused() && !ImGui::IsAnyItemActive() && !ImGui::IsMouseClicked(0)) {
 				ImGui::SetKeyboardFocusHere(0);
@@ -111,6 +161,16 @@ public:
 				time_scale = (1000000.0f / (float) time_base) / (20.0f * (float) ui_context->device->simulator->tick_duration_ps);
 			}
 
+			// >> trigger
+			ImGui::SameLine(0, 12);
+			trigger_controls();
+
+			// >> search decoded transactions
+			if (!decoder_lanes.empty()) {
+				ImGui::SameLine(0, 12);
+				search_controls();
+			}
+
 			// divider between header and body
 			ImGui::Spacing();
 			ImGui::Separator();
@@ -118,12 +178,12 @@ public:
 
 			// body
 			auto region = ImGui::GetContentRegionAvail();
-			ImGui::SetNextWindowContentSize({region.x, (float) signal_names.size() * 40.0f});
+			ImGui::SetNextWindowContentSize({region.x, (float) lane_count() * 40.0f});
 			ImGui::BeginChild("display", region, false, 0);
 
 			// >> calculate what time interval to fetch data for
 			int64_t available_time = (int64_t) ((region.x - (BORDER_WIDTH * 2.0f)) * time_scale);
-			diagram_data.time_end = sim->current_tick;
+			diagram_data.time_end = (view_time_end >= 0) ? std::min(view_time_end, sim->current_tick) : sim->current_tick;
 			diagram_data.time_begin = diagram_data.time_end - available_time;
 			if (diagram_data.time_begin < 0) {
 				diagram_data.time_begin = 0;
@@ -133,6 +193,11 @@ public:
 			// >> fetch data
 			signal_history_diagram_data(ui_context->device->simulator->signal_history, &diagram_data);
 
+			if (!decoder_lanes.empty()) {
+				signal_history_transactions_range(sim->signal_history, diagram_data.time_begin, diagram_data.time_end,
+												  decoder_mask(), &transactions);
+			}
+
 			// >> context menu
 			context_menu();
 
@@ -141,6 +206,14 @@ public:
 				draw_signal(si);
 			}
 
+			for (size_t gi = 0; gi < arrlenu(diagram_data.groups); ++gi) {
+				draw_group(gi);
+			}
+
+			for (size_t di = 0; di < decoder_lanes.size(); ++di) {
+				draw_decoder(di);
+			}
+
 			// >> vertical line at cursor
 			draw_vertical_guide();
 
@@ -158,7 +231,10 @@ private:
 	static constexpr  auto COLOR_HOVERED = IM_COL32(150, 150, 50, 200);
 	static constexpr ImU32 COLOR_BACKGROUND[2] = {IM_COL32(30, 30, 30, 128), IM_COL32(60, 60, 60, 128)};
 	static constexpr  auto COLOR_GUIDE = IM_COL32(255, 0, 0, 128);
+	static constexpr  auto COLOR_TRANSACTION = IM_COL32(40, 90, 140, 200);
+	static constexpr  auto COLOR_FOUND = IM_COL32(200, 120, 0, 220);
 	static constexpr float TRUE_OFFSET = -20.0f;
+	static constexpr float BUS_SLOPE = 3.0f;
 
 	void draw_signal(size_t signal_idx) {
 
@@ -192,11 +268,116 @@ private:
 		}
 
 		// signal-name
-		const char *label = signal_names[signal_idx].c_str();
+		draw_label(signal_idx, signal_names[signal_idx].c_str());
+	}
+
+	void draw_group(size_t group_idx) {
+
+		auto draw_list = ImGui::GetWindowDrawList();
+		auto origin = ImGui::GetCursorScreenPos();
+		auto region = ImGui::GetContentRegionAvail();
+		auto sim = ui_context->device->simulator;
+		size_t lane = arrlenu(diagram_data.signals) + group_idx;
+
+		float signal_y = origin.y + ((float) lane * 40.0f) + 30.0f;
+		float top_y = signal_y + TRUE_OFFSET;
+		float mid_y = signal_y + (TRUE_OFFSET / 2.0f);
+
+		draw_list->AddRectFilled({origin.x, signal_y - 30.0f}, {origin.x + region.x, signal_y + 10.0f}, COLOR_BACKGROUND[lane % 2]);
+
+		auto diagram_x = [&](int64_t t) -> float {
+			return origin.x + BORDER_WIDTH + (float) (t - diagram_data.time_begin) / time_scale;
+		};
+
+		int hex_digits = (int) (signal_history_group_size(sim->signal_history, diagram_data.groups[group_idx]) + 3) / 4;
+		float left_limit = origin.x + BORDER_WIDTH;
+
+		// draw from right to left (starting at current position)
+		float right_x = diagram_x(sim->current_tick);
+
+		for (size_t sample = diagram_data.group_start_offsets[group_idx]; sample < diagram_data.group_start_offsets[group_idx+1]; ++sample) {
+			float left_x = std::max(diagram_x(diagram_data.group_samples_time[sample]), left_limit);
+
+			// transition
+			draw_list->AddLine({left_x, mid_y}, {left_x + BUS_SLOPE, top_y}, COLOR_SIGNAL, 2.0f);
+			draw_list->AddLine({left_x, mid_y}, {left_x + BUS_SLOPE, signal_y}, COLOR_SIGNAL, 2.0f);
+
+			// value lane
+			if (right_x > left_x + BUS_SLOPE) {
+				draw_list->AddLine({left_x + BUS_SLOPE, top_y}, {right_x, top_y}, COLOR_SIGNAL, 2.0f);
+				draw_list->AddLine({left_x + BUS_SLOPE, signal_y}, {right_x, signal_y}, COLOR_SIGNAL, 2.0f);
+			}
+
+			// value (only when there is enough room)
+			char value_text[24];
+			snprintf(value_text, sizeof(value_text), "%0*llX", hex_digits, (unsigned long long) diagram_data.group_samples_value[sample]);
+			auto text_size = ImGui::CalcTextSize(value_text);
+			if (text_size.x + (4 * BUS_SLOPE) < right_x - left_x) {
+				draw_list->AddText({(left_x + right_x - text_size.x) / 2.0f, mid_y - (text_size.y / 2.0f)}, COLOR_SIGNAL, value_text);
+			}
+
+			right_x = left_x;
+		}
+
+		// group-name
+		draw_label(lane, group_names[group_idx].c_str());
+	}
+
+	void draw_decoder(size_t decoder_idx) {
+
+		auto draw_list = ImGui::GetWindowDrawList();
+		auto origin = ImGui::GetCursorScreenPos();
+		auto region = ImGui::GetContentRegionAvail();
+		auto sim = ui_context->device->simulator;
+		size_t lane = signal_names.size() + group_names.size() + decoder_idx;
+		uint32_t decoder = decoder_lanes[decoder_idx];
+
+		float signal_y = origin.y + ((float) lane * 40.0f) + 30.0f;
+		float top_y = signal_y + TRUE_OFFSET;
+
+		draw_list->AddRectFilled({origin.x, signal_y - 30.0f}, {origin.x + region.x, signal_y + 10.0f}, COLOR_BACKGROUND[lane % 2]);
+
+		auto diagram_x = [&](int64_t t) -> float {
+			return origin.x + BORDER_WIDTH + (float) (t - diagram_data.time_begin) / time_scale;
+		};
+
+		float left_limit = origin.x + BORDER_WIDTH;
+
+		for (size_t ti = 0; ti < arrlenu(transactions); ++ti) {
+			const SignalTransaction &trans = transactions[ti];
+			if (trans.decoder != decoder) {
+				continue;
+			}
+
+			float left_x = std::max(diagram_x(trans.time_begin), left_limit);
+			float right_x = std::max(diagram_x(trans.time_end + 1), left_x + 1.0f);
+			bool is_found = found_valid && trans.decoder == found.decoder && trans.time_begin == found.time_begin;
+
+			draw_list->AddRectFilled({left_x, top_y}, {right_x, signal_y}, (is_found) ? COLOR_FOUND : COLOR_TRANSACTION, 3.0f);
+
+			// description (only when there is enough room)
+			char text[64];
+			signal_history_transaction_describe(sim->signal_history, &trans, text, sizeof(text));
+			auto text_size = ImGui::CalcTextSize(text);
+			if (text_size.x + (4 * BUS_SLOPE) < right_x - left_x) {
+				draw_list->AddText({(left_x + right_x - text_size.x) / 2.0f, top_y + ((signal_y - top_y - text_size.y) / 2.0f)}, COLOR_TEXT, text);
+			}
+		}
+
+		// decoder-name
+		draw_label(lane, decoder_lane_names[decoder_idx].c_str());
+	}
+
+	void draw_label(size_t lane, const char *label) {
+		auto draw_list = ImGui::GetWindowDrawList();
+		auto origin = ImGui::GetCursorScreenPos();
+
+		float signal_y = origin.y + ((float) lane * 40.0f) + 30.0f;
+
 		const ImVec2 label_pos = {origin.x + BORDER_WIDTH, signal_y - 20};
 		const float label_padding = 2.0f;
 		auto text_size = ImGui::CalcTextSize(label);
-		const bool is_hovered = (int) signal_idx == selected_signal;
+		const bool is_hovered = (int) lane == selected_signal;
 
 		draw_list->AddRectFilled({label_pos.x - label_padding, label_pos.y - label_padding},
 								 {label_pos.x + text_size.x + label_padding, label_pos.y + text_size.y + label_padding},
@@ -205,6 +386,101 @@ private:
 		draw_list->AddText(label_pos, COLOR_TEXT, label);
 	}
 
+	void trigger_controls() {
+		static const char *STATE_TEXT[] = {"", "armed", "capturing", "done"};
+
+		auto trigger = ui_context->device->simulator->signal_trigger;
+		auto state = signal_trigger_state(trigger);
+
+		ImGui::Text("Trigger");
+		ImGui::SameLine();
+
+		ImGui::BeginDisabled(trigger_busy());
+		ImGui::SetNextItemWidth(64);
+		ImGui::DragInt("##pre", &trigger_pre_depth, 1.0f, 0, 100000, "pre %d");
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(64);
+		ImGui::DragInt("##post", &trigger_post_depth, 1.0f, 0, 100000, "post %d");
+		ImGui::EndDisabled();
+
+		// the simulator thread owns the trigger: changes are requests it applies before the next timestep
+		ImGui::SameLine();
+		if (!trigger_busy()) {
+			ImGui::BeginDisabled(arrlenu(trigger_config->stages) == 0);
+			if (ImGui::Button(" Arm ##arm_trigger")) {
+				signal_trigger_set_depth(trigger_config, (size_t) trigger_pre_depth, (size_t) trigger_post_depth);
+				signal_trigger_request_arm(trigger, trigger_config);
+			}
+			ImGui::EndDisabled();
+		} else {
+			if (ImGui::Button(" Disarm ##disarm_trigger")) {
+				signal_trigger_request_disarm(trigger);
+			}
+		}
+
+		ImGui::SameLine();
+		ImGui::Text("%s %s", trigger_description.c_str(), (signal_trigger_request_pending(trigger)) ? "pending" : STATE_TEXT[state]);
+	}
+
+	void search_controls() {
+		auto sim = ui_context->device->simulator;
+
+		ImGui::Text("Find");
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(48);
+		ImGui::InputText("##find", find_input, sizeof(find_input), ImGuiInputTextFlags_CharsHexadecimal);
+
+		// search the decoder of the first decoder lane, an empty address matches every transaction
+		SignalTransactionQuery query = {};
+		query.decoder = decoder_lanes[0];
+		query.type_mask = (uint32_t) -1;
+		int64_t find_address = 0;
+		if (find_input[0] != '\0' && string_to_hexint(find_input, &find_address)) {
+			query.address = (uint32_t) find_address;
+			query.address_mask = (uint32_t) -1;
+		}
+
+		int64_t from_time = (found_valid) ? found.time_begin : diagram_data.time_begin + ((diagram_data.time_end - diagram_data.time_begin) / 2);
+
+		for (int dir = 0; dir < 2; ++dir) {
+			ImGui::SameLine();
+			if (ImGui::Button((dir == 0) ? " < ##find_prev" : " > ##find_next")) {
+				SignalTransaction result;
+				if (signal_history_transaction_search(sim->signal_history, &query, from_time, dir == 1, &result)) {
+					found = result;
+					found_valid = true;
+
+					// center the view on the transaction
+					int64_t half_window = (diagram_data.time_end - diagram_data.time_begin) / 2;
+					view_time_end = found.time_begin + half_window;
+				}
+			}
+		}
+
+		ImGui::SameLine();
+		ImGui::BeginDisabled(view_time_end < 0);
+		if (ImGui::Button(" Live ##find_live")) {
+			view_time_end = -1;
+			found_valid = false;
+		}
+		ImGui::EndDisabled();
+	}
+
+	bool trigger_busy() {
+		auto trigger = ui_context->device->simulator->signal_trigger;
+		auto state = signal_trigger_state(trigger);
+		return state == TRIGGER_ARMED || state == TRIGGER_CAPTURING || signal_trigger_request_pending(trigger);
+	}
+
+	void set_edge_trigger(int signal_idx, bool pos_edge) {
+		// only the configuration owned by the panel is changed, the trigger of the simulator picks it up when armed
+		signal_trigger_clear_stages(trigger_config);
+		uint32_t stage = signal_trigger_stage_add(trigger_config, 1);
+		signal_trigger_stage_edge(trigger_config, stage, diagram_data.signals[signal_idx], pos_edge, !pos_edge);
+
+		trigger_description = signal_names[signal_idx] + ((pos_edge) ? " (pos)" : " (neg)");
+	}
+
 	void draw_vertical_guide() {
 		auto draw_list = ImGui::GetWindowDrawList();
 		auto origin = ImGui::GetCursorScreenPos();
@@ -220,7 +496,7 @@ private:
 			auto origin = ImGui::GetCursorScreenPos();
 			auto mouse = ImGui::GetMousePos();
 			selected_signal = (int) ((mouse.y - origin.y) / 40.0f);
-			if (selected_signal < 0 || (size_t) selected_signal >= signal_names.size()) {
+			if (selected_signal < 0 || (size_t) selected_signal >= lane_count()) {
 				selected_signal = -1;
 			}
 		}
@@ -229,6 +505,22 @@ private:
 			return;
 		}
 
+		if ((size_t) selected_signal >= signal_names.size()) {
+			if (ImGui::BeginPopupContextWindow("signal_context")) {
+				if (ImGui::MenuItem("Remove")) {
+					size_t lane = (size_t) selected_signal - signal_names.size();
+					if (lane < group_names.size()) {
+						remove_group(lane);
+					} else {
+						remove_decoder(lane - group_names.size());
+					}
+					selected_signal = -1;
+				}
+				ImGui::EndPopup();
+			}
+			return;
+		}
+
 		if (ImGui::BeginPopupContextWindow("signal_context")) {
 			// remove signal
 			if (ImGui::MenuItem("Remove")) {
@@ -242,6 +534,16 @@ private:
 			if (ImGui::MenuItem(bp_text)) {
 				dms_toggle_signal_breakpoint(ui_context->dms_ctx, diagram_data.signals[selected_signal]);
 			}
+
+			// trigger
+			ImGui::BeginDisabled(trigger_busy());
+			if (ImGui::MenuItem("Trigger on positive edge")) {
+				set_edge_trigger(selected_signal, true);
+			}
+			if (ImGui::MenuItem("Trigger on negative edge")) {
+				set_edge_trigger(selected_signal, false);
+			}
+			ImGui::EndDisabled();
 			ImGui::EndPopup();
 		}
 	}
@@ -265,6 +567,7 @@ private:
 
 			input[0] = '\0';
 			ImGui::SetItemDefaultFocus();
+			update_capture_mask();
 		}
 	}
 
@@ -287,11 +590,79 @@ private:
 
 			arrpush(diagram_data.signals, signals[i]);
 		}
+
+		update_capture_mask();
 	}
 
 	void remove_signal(ptrdiff_t index) {
 		arrdel(diagram_data.signals, (size_t) index);
 		signal_names.erase(signal_names.begin() + index);
+		update_capture_mask();
+	}
+
+	void add_group(uint32_t group) {
+		Simulator *sim = ui_context->device->simulator;
+
+		group_names.push_back(signal_history_group_names(sim->signal_history)[group]);
+		arrpush(diagram_data.groups, group);
+		update_capture_mask();
+	}
+
+	void remove_group(size_t index) {
+		arrdel(diagram_data.groups, index);
+		group_names.erase(group_names.begin() + (ptrdiff_t) index);
+		update_capture_mask();
+	}
+
+	void add_decoder(uint32_t decoder) {
+		Simulator *sim = ui_context->device->simulator;
+
+		if (std::find(decoder_lanes.begin(), decoder_lanes.end(), decoder) != decoder_lanes.end()) {
+			return;
+		}
+
+		decoder_lane_names.push_back(signal_history_decoder_names(sim->signal_history)[decoder]);
+		decoder_lanes.push_back(decoder);
+		update_capture_mask();
+	}
+
+	void remove_decoder(size_t index) {
+		decoder_lanes.erase(decoder_lanes.begin() + (ptrdiff_t) index);
+		decoder_lane_names.erase(decoder_lane_names.begin() + (ptrdiff_t) index);
+		found_valid = false;
+		update_capture_mask();
+	}
+
+	uint64_t decoder_mask() const {
+		uint64_t mask = 0;
+		for (auto decoder : decoder_lanes) {
+			mask |= 1ull << decoder;
+		}
+		return mask;
+	}
+
+	size_t lane_count() const {
+		return signal_names.size() + group_names.size() + decoder_lanes.size();
+	}
+
+	void update_capture_mask() {
+		auto history = ui_context->device->simulator->signal_history;
+
+		uint64_t group_mask = 0;
+		for (size_t i = 0; i < arrlenu(diagram_data.groups); ++i) {
+			group_mask |= 1ull << diagram_data.groups[i];
+		}
+		signal_history_capture_groups_set(history, group_mask);
+		signal_history_capture_decoders_set(history, decoder_mask());
+
+		// without visible signals there is nothing to limit the capture to: keep capturing everything
+		if (capture_visible_only && arrlenu(diagram_data.signals) > 0) {
+			uint64_t capture_mask[SIGNAL_BLOCKS] = {0};
+			signal_history_capture_mask_add_signals(capture_mask, arrlenu(diagram_data.signals), diagram_data.signals);
+			signal_history_capture_mask_set(history, capture_mask);
+		} else {
+			signal_history_capture_mask_reset(history);
+		}
 	}
 
 private:
@@ -301,16 +672,33 @@ private:
 
 	bool						enable_history = false;
 	bool						enable_gtkwave = false;
+	bool						capture_visible_only = true;
 	int							current_profile = 0;
+	int							current_group = 0;
+	int							current_decoder = 0;
 
 	int							time_base = 1;
 	float						time_scale = 0;
 
 	int							selected_signal = -1;
 
+	int							trigger_pre_depth = 64;
+	int							trigger_post_depth = 192;
+	std::string					trigger_description;
+	SignalTrigger *				trigger_config = nullptr;		// never armed, copied into the trigger of the simulator
+
 	std::vector<std::string>	signal_names;
+	std::vector<std::string>	group_names;
+	std::vector<uint32_t>		decoder_lanes;
+	std::vector<std::string>	decoder_lane_names;
 	SignalHistoryDiagramData	diagram_data = {};
+	SignalTransaction *			transactions = nullptr;
 	char						input[256];
+
+	char						find_input[8];
+	SignalTransaction			found = {};
+	bool						found_valid = false;
+	int64_t						view_time_end = -1;			// -1 = follow the simulation
 };
 
 Panel::uptr_t panel_logic_analyzer_create(UIContext *ctx, struct ImVec2 pos) {
@@ -7,10 +7,12 @@
 
 #include <context.h>
 #include <cpu.h>
+#include <debug_server.h>
 #include <dev_minimal_6502.h>
 #include <dev_commodore_pet.h>
 
 #include <algorithm>
+#include <cstdio>
 #include <iterator>
 
 #include "panel_control.h"
@@ -40,6 +42,11 @@ void UIContext::setup_ui(struct GLFWwindow *window) {
 
 void UIContext::shutdown_ui() {
 
+	if (debug_server) {
+		debug_server_destroy(debug_server);
+		debug_server = nullptr;
+	}
+
 #ifndef DMS_NO_THREADING
 	if (dms_ctx) {
 		dms_stop_execution(dms_ctx);
@@ -67,6 +74,10 @@ void UIContext::draw_ui() {
 	dms_execute(dms_ctx);
 #endif // DMS_NO_THREADING
 
+	if (debug_server) {
+		debug_server_process(debug_server, 0);
+	}
+
 	Cpu *cpu = device->get_cpu(device);
 
 	if (cpu && cpu->is_at_start_of_instruction(cpu)) {
@@ -122,6 +133,13 @@ void UIContext::create_device(MachineType machine) {
 	}
 	last_pc = 0;
 
+	if (!config.debug_server_address.empty()) {
+		debug_server = debug_server_create(dms_ctx, config.debug_server_address.c_str());
+		if (!debug_server) {
+			fprintf(stderr, "Unable to start debug server (%s)\n", config.debug_server_address.c_str());
+		}
+	}
+
 #ifndef DMS_NO_THREADING
 	// start dromaius context
 	dms_start_execution(dms_ctx);
@@ -133,9 +151,7 @@ void UIContext::create_minimal_6502() {
 	DevMinimal6502 *device_6502 = dev_minimal_6502_create(NULL);
 	device = (Device *) device_6502;
 
-	// create dromaius context
-	dms_ctx = dms_create_context();
-	dms_set_device(dms_ctx, device);
+	create_context();
 
 	// create UI panels
 	panel_add(panel_control_create(this, {0, 0}, device_6502->oscillator,
@@ -151,9 +167,7 @@ void UIContext::create_commodore_pet(bool lite) {
 	DevCommodorePet *device_pet = (lite) ? dev_commodore_pet_lite_create() : dev_commodore_pet_create();
 	device = (Device *) device_pet;
 
-	// create dromaius context
-	dms_ctx = dms_create_context();
-	dms_set_device(dms_ctx, device);
+	create_context();
 
 	// create UI panels
 	std::initializer_list<StepSignal> lite_signals = {{device_pet->signals[SIG_P2001N_CLK1], true, true}};
@@ -169,6 +183,22 @@ void UIContext::create_commodore_pet(bool lite) {
 	panel_add(panel_dev_commodore_pet_create(this, {0, 240}, device_pet));
 }
 
+void UIContext::create_context() {
+
+	// create dromaius context
+	dms_ctx = dms_create_context();
+	dms_set_device(dms_ctx, device);
+
+	// record before the panels are created, they send the initial keypad configuration as input events
+	if (!config.input_record_file.empty() && !dms_input_record_start(dms_ctx, config.input_record_file.c_str())) {
+		fprintf(stderr, "Unable to record input (%s)\n", config.input_record_file.c_str());
+	}
+
+	if (!config.input_replay_file.empty() && !dms_input_replay(dms_ctx, config.input_replay_file.c_str())) {
+		fprintf(stderr, "Unable to replay input (%s)\n", config.input_replay_file.c_str());
+	}
+}
+
 void UIContext::setup_dockspace() {
 	auto viewport = ImGui::GetMainViewport();
 	dock_id_main = ImGui::DockSpaceOverViewport(viewport, ImGuiDockNodeFlags_PassthruCentralNode);
@@ -40,6 +40,7 @@ private:
 	void create_device(MachineType machine);
 	void create_minimal_6502();
 	void create_commodore_pet(bool lite);
+	void create_context();
 
 	void setup_dockspace();
 
@@ -47,6 +48,7 @@ private:
 public:
 	Config config;
 	struct DmsContext *dms_ctx = nullptr;
+	struct DebugServer *debug_server = nullptr;
 	struct GLFWwindow *glfw_window = nullptr;
 
 	struct Device * device = nullptr;
@@ -144,7 +144,7 @@ public:
 
 	void context_reset() {
 		assert(dms_ctx);
-		pet_device->reset(pet_device);
+		dms_input_reset(dms_ctx);
 	}
 
 	std::string context_status() {
@@ -174,7 +174,7 @@ public:
 
 	void keyboard_key_pressed(int row, int col) {
 		assert(pet_device);
-		input_keypad_key_pressed(pet_device->keypad, row, col);
+		dms_input_key_pressed(dms_ctx, pet_device->keypad, row, col);
 	}
 
 	std::vector<KeyInfo> keyboard_keys_down() const {
@@ -199,13 +199,13 @@ public:
 
 	void keyboard_set_dwell_time(int32_t key_dwell_ms) const {
 		assert(pet_device);
-		input_keypad_set_dwell_time_ms(pet_device->keypad, key_dwell_ms);
+		dms_input_key_dwell_time(dms_ctx, pet_device->keypad, key_dwell_ms);
 	}
 
 	// datassette control
 	void datassette_load_tap(std::string tap_data) {
-		perif_datassette_load_tap_from_memory(
-				pet_device->datassette,
+		dms_input_tape_load(
+				dms_ctx, pet_device->datassette,
 				reinterpret_cast<const int8_t *> (tap_data.c_str()),
 				tap_data.size());
 	}
@@ -216,27 +216,27 @@ public:
 	}
 
 	void datassette_record() {
-		perif_datassette_key_pressed(pet_device->datassette, DS_KEY_RECORD);
+		dms_input_datassette_key(dms_ctx, pet_device->datassette, DS_KEY_RECORD);
 	}
 
 	void datassette_play() {
-		perif_datassette_key_pressed(pet_device->datassette, DS_KEY_PLAY);
+		dms_input_datassette_key(dms_ctx, pet_device->datassette, DS_KEY_PLAY);
 	}
 
 	void datassette_rewind() {
-		perif_datassette_key_pressed(pet_device->datassette, DS_KEY_REWIND);
+		dms_input_datassette_key(dms_ctx, pet_device->datassette, DS_KEY_REWIND);
 	}
 
 	void datassette_fast_forward() {
-		perif_datassette_key_pressed(pet_device->datassette, DS_KEY_FFWD);
+		dms_input_datassette_key(dms_ctx, pet_device->datassette, DS_KEY_FFWD);
 	}
 
 	void datassette_stop() {
-		perif_datassette_key_pressed(pet_device->datassette, DS_KEY_STOP);
+		dms_input_datassette_key(dms_ctx, pet_device->datassette, DS_KEY_STOP);
 	}
 
 	void datassette_eject() {
-		perif_datassette_key_pressed(pet_device->datassette, DS_KEY_EJECT);
+		dms_input_datassette_key(dms_ctx, pet_device->datassette, DS_KEY_EJECT);
 	}
 
 	int datassette_valid_buttons() {
@@ -249,8 +249,8 @@ public:
 
 	// disk 2031 control
 	void disk2031_load_d64(std::string d64_data) {
-		perif_fd2031_load_d64_from_memory(
-				pet_device->disk_2031,
+		dms_input_disk_load(
+				dms_ctx, pet_device->disk_2031,
 				reinterpret_cast<const int8_t *>(d64_data.c_str()),
 				d64_data.size());
 	}
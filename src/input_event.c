@@ -0,0 +1,242 @@
+// input_event.c - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// External inputs (keys, tapes, disks, reset) stamped with the simulator tick at which they took effect
+
+/* Recording file format (values are little-endian)
+	header:	"DMSINPUT", uint32_t version
+	event:	int64_t tick, uint8_t type, uint8_t name length, chip name, int32_t param[2], uint32_t data length, data
+*/
+
+#include "input_event.h"
+
+#include "crt.h"
+#include "device.h"
+#include "input_keypad.h"
+#include "perif_datassette_1530.h"
+#include "perif_disk_2031.h"
+#include "simulator.h"
+#include "utils.h"
+
+#include <stb/stb_ds.h>
+#include <stdio.h>
+
+#define RECORDING_MAGIC		"DMSINPUT"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// internal types
+//
+
+struct InputRecorder {
+	FILE *			fp;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// helper functions
+//
+
+static bool event_chip_valid(InputEvent *event) {
+	// the chip name comes from the file: make sure it's the kind of chip the event is cast to
+	switch (event->type) {
+		case INPUT_EVENT_KEY_PRESSED:
+		case INPUT_EVENT_KEY_DWELL:
+			return event->chip && input_keypad_is_instance(event->chip);
+		case INPUT_EVENT_DATASSETTE_KEY:
+		case INPUT_EVENT_TAPE_LOAD:
+			return event->chip && perif_datassette_is_instance(event->chip);
+		case INPUT_EVENT_DISK_LOAD:
+			return event->chip && perif_fd2031_is_instance(event->chip);
+		case INPUT_EVENT_RESET:
+			return true;
+	}
+	return false;
+}
+
+static bool event_params_valid(InputEvent *event) {
+	// reject the parameters the receiving chip would assert on
+	switch (event->type) {
+		case INPUT_EVENT_KEY_PRESSED: {
+			InputKeypad *keypad = (InputKeypad *) event->chip;
+			return event->param[0] >= 0 && (size_t) event->param[0] < keypad->row_count &&
+				   event->param[1] >= 0 && (size_t) event->param[1] < keypad->col_count;
+		}
+		case INPUT_EVENT_KEY_DWELL:
+			return event->param[0] > 0;
+		default:
+			return true;
+	}
+}
+
+static bool read_event(FILE *fp, Simulator *sim, InputEvent *event) {
+	uint64_t tick, type, name_len, param0, param1, data_len;
+	char name[256];
+
+	if (!file_read_uint_le(fp, &tick, 8) || !file_read_uint_le(fp, &type, 1) || !file_read_uint_le(fp, &name_len, 1)) {
+		return false;
+	}
+	if (dms_fread(name, 1, name_len, fp) != name_len) {
+		return false;
+	}
+	name[name_len] = '\0';
+
+	if (!file_read_uint_le(fp, &param0, 4) || !file_read_uint_le(fp, &param1, 4) || !file_read_uint_le(fp, &data_len, 4) ||
+		type > INPUT_EVENT_KEY_DWELL || data_len > INPUT_EVENT_MAX_DATA) {
+		return false;
+	}
+
+	*event = (InputEvent) {
+		.tick = (int64_t) tick,
+		.type = (INPUT_EVENT_TYPE) type,
+		.chip = (name_len > 0) ? simulator_chip_by_name(sim, name) : NULL,
+		.param = {(int32_t) param0, (int32_t) param1}
+	};
+
+	if (!event_chip_valid(event) || !event_params_valid(event)) {
+		return false;
+	}
+
+	if (data_len > 0) {
+		arrsetlen(event->data, data_len);
+		if (dms_fread(event->data, 1, data_len, fp) != data_len) {
+			arrfree(event->data);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// interface functions
+//
+
+void input_event_apply(InputEvent *event, Device *device) {
+	assert(event);
+	assert(device);
+
+	switch (event->type) {
+		case INPUT_EVENT_KEY_PRESSED:
+			input_keypad_key_pressed((InputKeypad *) event->chip, (size_t) event->param[0], (size_t) event->param[1]);
+			break;
+		case INPUT_EVENT_DATASSETTE_KEY:
+			perif_datassette_key_pressed((PerifDatassette *) event->chip, (PerifDatassetteKeys) event->param[0]);
+			break;
+		case INPUT_EVENT_TAPE_LOAD:
+			perif_datassette_load_tap_from_memory((PerifDatassette *) event->chip, event->data, arrlenu(event->data));
+			break;
+		case INPUT_EVENT_DISK_LOAD:
+			perif_fd2031_load_d64_from_memory((PerifDisk2031 *) event->chip, event->data, arrlenu(event->data));
+			break;
+		case INPUT_EVENT_RESET:
+			device->reset(device);
+			break;
+		case INPUT_EVENT_KEY_DWELL:
+			input_keypad_set_dwell_time_ms((InputKeypad *) event->chip, event->param[0]);
+			break;
+	}
+}
+
+void input_event_release(InputEvent *event) {
+	assert(event);
+	arrfree(event->data);
+}
+
+InputRecorder *input_recorder_open(const char *filename) {
+	assert(filename);
+
+	FILE *fp = NULL;
+	if (dms_fopen(fp, filename, "wb")) {
+		return NULL;
+	}
+
+	dms_fwrite(RECORDING_MAGIC, 1, 8, fp);
+	file_write_uint_le(fp, INPUT_RECORDING_VERSION, 4);
+
+	InputRecorder *recorder = (InputRecorder *) dms_calloc(1, sizeof(InputRecorder));
+	recorder->fp = fp;
+	return recorder;
+}
+
+void input_recorder_close(InputRecorder *recorder) {
+	assert(recorder);
+
+	dms_fclose(recorder->fp);
+	dms_free(recorder);
+}
+
+void input_recorder_write(InputRecorder *recorder, const InputEvent *event) {
+	assert(recorder);
+	assert(event);
+
+	const char *name = (event->chip) ? event->chip->name : "";
+	size_t name_len = MIN(dms_strlen(name), 255u);
+
+	file_write_uint_le(recorder->fp, (uint64_t) event->tick, 8);
+	file_write_uint_le(recorder->fp, (uint64_t) event->type, 1);
+	file_write_uint_le(recorder->fp, name_len, 1);
+	dms_fwrite(name, 1, name_len, recorder->fp);
+	file_write_uint_le(recorder->fp, (uint32_t) event->param[0], 4);
+	file_write_uint_le(recorder->fp, (uint32_t) event->param[1], 4);
+	file_write_uint_le(recorder->fp, arrlenu(event->data), 4);
+	if (event->data) {
+		dms_fwrite(event->data, 1, arrlenu(event->data), recorder->fp);
+	}
+
+	// keep the recording usable when the application doesn't shut down cleanly
+	fflush(recorder->fp);
+}
+
+bool input_recording_load(const char *filename, Simulator *sim, InputEvent **events) {
+	assert(filename);
+	assert(sim);
+	assert(events);
+
+	*events = NULL;
+
+	FILE *fp = NULL;
+	if (dms_fopen(fp, filename, "rb")) {
+		return false;
+	}
+
+	char magic[8];
+	uint64_t version;
+	bool ok = dms_fread(magic, 1, 8, fp) == 8 && dms_memcmp(magic, RECORDING_MAGIC, 8) == 0 &&
+			  file_read_uint_le(fp, &version, 4) && version == INPUT_RECORDING_VERSION;
+
+	while (ok) {
+		// a recording ends between two events, not halfway through one
+		int next = fgetc(fp);
+		if (next == EOF) {
+			break;
+		}
+		ungetc(next, fp);
+
+		InputEvent event;
+		if (!read_event(fp, sim, &event)) {
+			ok = false;
+		} else if (arrlen(*events) > 0 && event.tick < arrlast(*events).tick) {
+			input_event_release(&event);
+			ok = false;
+		} else {
+			arrpush(*events, event);
+		}
+	}
+
+	dms_fclose(fp);
+
+	if (!ok) {
+		input_recording_release(*events);
+		*events = NULL;
+	}
+
+	return ok;
+}
+
+void input_recording_release(InputEvent *events) {
+	for (size_t i = 0; i < arrlenu(events); ++i) {
+		input_event_release(&events[i]);
+	}
+	arrfree(events);
+}
@@ -0,0 +1,59 @@
+// input_event.h - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// External inputs (keys, tapes, disks, reset) stamped with the simulator tick at which they took effect
+
+#ifndef DROMAIUS_INPUT_EVENT_H
+#define DROMAIUS_INPUT_EVENT_H
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// types
+#define INPUT_RECORDING_VERSION		1
+#define INPUT_EVENT_MAX_DATA		(16 * 1024 * 1024)		// largest tap/d64 image accepted from a recording
+
+typedef enum INPUT_EVENT_TYPE {
+	INPUT_EVENT_KEY_PRESSED = 0,		// keypad: param[0] = row, param[1] = column
+	INPUT_EVENT_DATASSETTE_KEY = 1,		// datassette: param[0] = PerifDatassetteKeys
+	INPUT_EVENT_TAPE_LOAD = 2,			// datassette: data = contents of a tap-file
+	INPUT_EVENT_DISK_LOAD = 3,			// disk drive: data = contents of a d64-file
+	INPUT_EVENT_RESET = 4,				// reset the device (no chip)
+	INPUT_EVENT_KEY_DWELL = 5			// keypad: param[0] = dwell time in ms
+} INPUT_EVENT_TYPE;
+
+typedef struct InputEvent {
+	int64_t				tick;			// simulator tick at which the event takes effect
+	INPUT_EVENT_TYPE	type;
+	struct Chip *		chip;			// chip that receives the input (NULL for a reset)
+	int32_t				param[2];
+	int8_t *			data;			// dynamic array (owned by the event)
+} InputEvent;
+
+typedef struct InputRecorder InputRecorder;
+
+struct Device;
+struct Simulator;
+
+// functions
+void input_event_apply(InputEvent *event, struct Device *device);
+void input_event_release(InputEvent *event);
+
+// input_recorder_open: start a new recording, returns NULL if the file can't be created
+InputRecorder *input_recorder_open(const char *filename);
+void input_recorder_close(InputRecorder *recorder);
+void input_recorder_write(InputRecorder *recorder, const InputEvent *event);
+
+// input_recording_load: read the events (sorted by tick) of a recording into a dynamic array
+//	- returns false if the file isn't a valid recording
+//	- the chips are looked up by name in the simulator: the recording must be replayed on the same type of device
+bool input_recording_load(const char *filename, struct Simulator *sim, InputEvent **events);
+void input_recording_release(InputEvent *events);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DROMAIUS_INPUT_EVENT_H
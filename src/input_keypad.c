@@ -109,6 +109,11 @@ void input_keypad_destroy(InputKeypad *keypad) {
 	dms_free(PRIVATE(keypad));
 }
 
+bool input_keypad_is_instance(Chip *chip) {
+	assert(chip);
+	return chip->process == (CHIP_PROCESS_FUNC) input_keypad_process;
+}
+
 void input_keypad_process(InputKeypad *keypad) {
 	assert(keypad);
 
@@ -45,6 +45,9 @@ void input_keypad_register_dependencies(InputKeypad *keypad);
 void input_keypad_destroy(InputKeypad *keypad);
 void input_keypad_process(InputKeypad *keypad);
 
+// input_keypad_is_instance: true if 'chip' was created by input_keypad_create
+bool input_keypad_is_instance(Chip *chip);
+
 void input_keypad_key_pressed(InputKeypad *keypad, size_t row, size_t col);
 void input_keypad_set_dwell_time_ms(InputKeypad *keypad, int dwell_ms);
 
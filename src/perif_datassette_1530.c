@@ -264,6 +264,11 @@ PerifDatassette *perif_datassette_create(struct Simulator *sim, PerifDatassetteS
 	return datassette;
 }
 
+bool perif_datassette_is_instance(Chip *chip) {
+	assert(chip);
+	return chip->process == (CHIP_PROCESS_FUNC) perif_datassette_process;
+}
+
 static void perif_datassette_destroy(PerifDatassette *datassette) {
 	assert(datassette);
 	dms_free(datassette);
@@ -275,6 +280,9 @@ static void perif_datassette_process(PerifDatassette *datassette) {
 	// sense signal
 	SIGNAL_WRITE(SENSE, datassette->sense_out);
 
+	// loading from tape in real-time is slow: ask the context to stop synchronizing with real-time
+	simulator_request_warp(datassette->simulator, datassette->id, datassette->state == STATE_PLAYING && SIGNAL_READ(MOTOR));
+
 	// recording - timing is driven by the signals from the computer
 	if (datassette->state == STATE_RECORDING) {
 		bool motor = SIGNAL_READ(MOTOR);
@@ -73,6 +73,9 @@ typedef struct PerifDatassette {
 // functions
 PerifDatassette *perif_datassette_create(struct Simulator *sim, PerifDatassetteSignals signals);
 
+// perif_datassette_is_instance: true if 'chip' was created by perif_datassette_create
+bool perif_datassette_is_instance(Chip *chip);
+
 void perif_datassette_key_pressed(PerifDatassette *datassette, PerifDatassetteKeys key);
 void perif_datassette_load_tap_from_file(PerifDatassette *datassette, const char *filename);
 void perif_datassette_load_tap_from_memory(PerifDatassette *datassette, const int8_t *data, size_t data_len);
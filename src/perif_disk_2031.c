@@ -236,6 +236,11 @@ PerifDisk2031 *perif_fd2031_create(Simulator *sim, PerifDisk2031Signals signals)
 	return disk;
 }
 
+bool perif_fd2031_is_instance(Chip *chip) {
+	assert(chip);
+	return chip->process == (CHIP_PROCESS_FUNC) perif_fd2031_process;
+}
+
 static void perif_fd2031_destroy(PerifDisk2031 *disk) {
 	assert(disk);
 	signal_group_destroy(disk->sg_dio);
@@ -396,6 +401,9 @@ static void perif_fd2031_process(PerifDisk2031 *disk) {
 		}
 	}
 
+	// don't synchronize with real-time while a transfer is in progress
+	simulator_request_warp(disk->simulator, disk->id, disk->bus_state != FD2031_BUS_IDLE);
+
 	// schedule wakeup to check for 'commands' from the UI-panel
 	if (disk->simulator->current_tick >= disk->next_wakeup) {
 		disk->next_wakeup = disk->simulator->current_tick + simulator_interval_to_tick_count(disk->simulator, MS_TO_PS(100));
@@ -99,6 +99,9 @@ typedef struct PerifDisk2031 {
 // functions
 PerifDisk2031 *perif_fd2031_create(struct Simulator *sim, PerifDisk2031Signals signals);
 
+// perif_fd2031_is_instance: true if 'chip' was created by perif_fd2031_create
+bool perif_fd2031_is_instance(Chip *chip);
+
 void perif_fd2031_load_d64_from_file(PerifDisk2031 *disk, const char *filename);
 void perif_fd2031_load_d64_from_memory(PerifDisk2031 *disk, const int8_t *data, size_t data_len);
 
@@ -15,6 +15,8 @@ static uint8_t PerifPetCrt_PinTypes[CHIP_PETCRT_PIN_COUNT] = {
 	[PIN_PETCRT_HORZ_DRIVE_IN] = CHIP_PIN_INPUT | CHIP_PIN_TRIGGER,
 };
 
+#define WARP_FRAME_INTERVAL	10		/* only render one in this many frames in warp mode */
+
 #define COLOR_ON	0xff55ff55
 #define COLOR_OFF	0xff111111
 
@@ -68,8 +70,18 @@ static void perif_pet_crt_process(PerifPetCrt *crt) {
 	}
 
 	if (SIGNAL_CHANGED(VERT_DRIVE_IN)) {
-		crt->schedule_timestamp = crt->simulator->current_tick + crt->vert_overscan_delay;
-		crt->next_action = MAX(crt->next_action, crt->schedule_timestamp);
+		// start of a new frame: render at a reduced rate when the simulation runs in warp mode
+		crt->frame_count += 1;
+		crt->skip_frame = crt->simulator->warp_active && (crt->frame_count % WARP_FRAME_INTERVAL) != 0;
+
+		if (!crt->skip_frame) {
+			crt->schedule_timestamp = crt->simulator->current_tick + crt->vert_overscan_delay;
+			crt->next_action = MAX(crt->next_action, crt->schedule_timestamp);
+		}
+	}
+
+	if (crt->skip_frame) {
+		return;
 	}
 
 	// positive transition on horzontal drive signal? (== start horizontal retrace)
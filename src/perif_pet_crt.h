@@ -37,6 +37,9 @@ typedef struct PerifPetCrt {
 	int64_t					vert_overscan_delay;
 	int64_t					horz_overscan_delay;
 	int64_t					next_action;
+
+	uint32_t				frame_count;
+	bool					skip_frame;				// don't render the current frame (warp mode)
 } PerifPetCrt;
 
 // functions
@@ -29,14 +29,14 @@ static uint8_t Ram8d16a_PinTypes[CHIP_RAM8D16A_PIN_COUNT] = {
 	[CHIP_RAM8D16A_A13 ] = CHIP_PIN_INPUT | CHIP_PIN_TRIGGER,
 	[CHIP_RAM8D16A_A14 ] = CHIP_PIN_INPUT | CHIP_PIN_TRIGGER,
 	[CHIP_RAM8D16A_A15 ] = CHIP_PIN_INPUT | CHIP_PIN_TRIGGER,
-	[CHIP_RAM8D16A_D0  ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT | CHIP_PIN_TRIGGER,
-	[CHIP_RAM8D16A_D1  ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT | CHIP_PIN_TRIGGER,
-	[CHIP_RAM8D16A_D2  ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT | CHIP_PIN_TRIGGER,
-	[CHIP_RAM8D16A_D3  ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT | CHIP_PIN_TRIGGER,
-	[CHIP_RAM8D16A_D4  ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT | CHIP_PIN_TRIGGER,
-	[CHIP_RAM8D16A_D5  ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT | CHIP_PIN_TRIGGER,
-	[CHIP_RAM8D16A_D6  ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT | CHIP_PIN_TRIGGER,
-	[CHIP_RAM8D16A_D7  ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT | CHIP_PIN_TRIGGER,
+	[CHIP_RAM8D16A_D0  ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT,
+	[CHIP_RAM8D16A_D1  ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT,
+	[CHIP_RAM8D16A_D2  ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT,
+	[CHIP_RAM8D16A_D3  ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT,
+	[CHIP_RAM8D16A_D4  ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT,
+	[CHIP_RAM8D16A_D5  ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT,
+	[CHIP_RAM8D16A_D6  ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT,
+	[CHIP_RAM8D16A_D7  ] = CHIP_PIN_INPUT | CHIP_PIN_OUTPUT,
 };
 
 //////////////////////////////////////////////////////////////////////////////
@@ -77,6 +77,7 @@ Ram8d16a *ram_8d16a_create(uint8_t num_address_lines, Simulator *sim, Ram8d16aSi
 	SIGNAL_DEFINE(OE_B);
 
 	// init cache variables
+	ram->address = -1;
 	ram->last_data = -1;
 
 	return ram;
@@ -89,31 +90,88 @@ static void ram_8d16a_destroy(Ram8d16a *ram) {
 	dms_free(ram);
 }
 
+static inline void ram_8d16a_watch_signal(Ram8d16a *ram, Signal signal, bool watch) {
+	// the chip-enable line is always watched (take care when it's also connected to another pin)
+	if (signal_equal(signal, SIGNAL(CE_B))) {
+		return;
+	} else if (watch) {
+		signal_add_dependency(ram->signal_pool, signal, ram->id);
+	} else {
+		signal_remove_dependency(ram->signal_pool, signal, ram->id);
+	}
+}
+
+static void ram_8d16a_watch_bus(Ram8d16a *ram, bool watch) {
+	// stop being woken up by the address, output- and write-enable lines while the chip isn't selected
+	for (size_t i = 0, n = arrlenu(ram->sg_address); i < n; ++i) {
+		ram_8d16a_watch_signal(ram, *ram->sg_address[i], watch);
+	}
+
+	ram_8d16a_watch_signal(ram, SIGNAL(OE_B), watch);
+	ram_8d16a_watch_signal(ram, SIGNAL(WE_B), watch);
+	ram->deselected = !watch;
+}
+
+static void ram_8d16a_watch_data(Ram8d16a *ram, bool watch) {
+	for (size_t i = 0, n = arrlenu(ram->sg_data); i < n; ++i) {
+		ram_8d16a_watch_signal(ram, *ram->sg_data[i], watch);
+	}
+	ram->watch_data = watch;
+}
+
 static void ram_8d16a_process(Ram8d16a *ram) {
 	assert(ram);
 
 	if (!ACTLO_ASSERTED(SIGNAL_READ(CE_B))) {
-		if (SIGNAL_CHANGED(CE_B)) {
+		if (!ram->deselected) {
 			SIGNAL_GROUP_NO_WRITE(data);
 			ram->last_data = -1;
+			ram->address = -1;
+			ram_8d16a_watch_bus(ram, false);
+		}
+		if (ram->watch_data) {
+			ram_8d16a_watch_data(ram, false);
 		}
 		return;
 	}
 
-	uint16_t address = SIGNAL_GROUP_READ_U16(address);
+	if (ram->deselected) {
+		ram_8d16a_watch_bus(ram, true);
+	}
 
-	if (ACTLO_ASSERTED(SIGNAL_READ(OE_B))) {
-		if (ram->data_array[address] != ram->last_data) {
-			SIGNAL_GROUP_WRITE(data, ram->data_array[address]);
-			ram->last_data = ram->data_array[address];
-		}
+	// decode the address: each change of an address line wakes up the chip while it's selected,
+	//	flipping the bits of the lines that changed keeps the address up-to-date
+	if (ram->address < 0) {
+		ram->address = SIGNAL_GROUP_READ_U32(address);
 	} else {
-		if (SIGNAL_CHANGED(OE_B)) {
-			SIGNAL_GROUP_NO_WRITE(data);
-			ram->last_data = -1;
+		for (size_t i = 0, n = arrlenu(ram->sg_address); i < n; ++i) {
+			ram->address ^= signal_changed(ram->signal_pool, *ram->sg_address[i]) << i;
+		}
+	}
+
+	if (ACTLO_ASSERTED(SIGNAL_READ(OE_B))) {
+		if (ram->watch_data) {
+			ram_8d16a_watch_data(ram, false);
 		}
-		if (ACTLO_ASSERTED(SIGNAL_READ(WE_B))) {
-			ram->data_array[address] = SIGNAL_GROUP_READ_U8(data);
+		if (ram->data_array[ram->address] != ram->last_data) {
+			SIGNAL_GROUP_WRITE(data, ram->data_array[ram->address]);
+			ram->last_data = ram->data_array[ram->address];
 		}
+		return;
+	}
+
+	if (ram->last_data != -1) {
+		SIGNAL_GROUP_NO_WRITE(data);
+		ram->last_data = -1;
+	}
+
+	// write: the memory follows the data lines as long as write-enable is asserted
+	bool write = ACTLO_ASSERTED(SIGNAL_READ(WE_B));
+	if (write != ram->watch_data) {
+		ram_8d16a_watch_data(ram, write);
+	}
+
+	if (write) {
+		ram->data_array[ram->address] = SIGNAL_GROUP_READ_U8(data);
 	}
 }
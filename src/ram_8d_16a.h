@@ -1,6 +1,8 @@
 // ram_8d_16a.h - Johan Smet - BSD-3-Clause (see LICENSE)
 //
 // Emulation of a memory module with an 8-bit wide databus and a maximum of 16 datalines (64kb)
+//	- only the chip-enable line always wakes up the chip. The other lines are watched while they matter: the
+//	  address, output- and write-enable lines while the chip is selected, the data lines during a write.
 
 #ifndef DROMAIUS_RAM_8D_16A_H
 #define DROMAIUS_RAM_8D_16A_H
@@ -62,7 +64,10 @@ typedef struct Ram8d16a {
 	SignalGroup			sg_data;
 
 	// cache
+	int32_t				address;			// decoded address (-1 == read all address lines at the next activation)
 	int16_t				last_data;
+	bool				deselected;			// the address, OE and WE lines aren't watched while the chip isn't selected
+	bool				watch_data;			// the data lines are only watched during a write
 
 	// data
 	size_t		data_size;
@@ -0,0 +1,277 @@
+// rom_image.c - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Read-only images of rom files, shared by all the devices in the process. The files are mapped into memory when the
+// platform supports it: the operating system then shares the contents with other processes too.
+
+#include "rom_image.h"
+#include "crt.h"
+#include "utils.h"
+#include "sys/atomics.h"
+
+#include <stb/stb_ds.h>
+
+#undef DMS_MMAP_POSIX
+#undef DMS_MMAP_WIN32
+#undef DMS_MMAP_NONE
+
+#if defined(PLATFORM_LINUX)
+	#define DMS_MMAP_POSIX
+#elif defined(PLATFORM_DARWIN)
+	#define DMS_MMAP_POSIX
+#elif defined(PLATFORM_WINDOWS)
+	#define DMS_MMAP_WIN32
+#else
+	#define DMS_MMAP_NONE			// e.g. emscripten: read the file into memory
+#endif // platform detection
+
+#ifdef DMS_MMAP_POSIX
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif // DMS_MMAP_POSIX
+
+#ifdef DMS_MMAP_WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#include <Windows.h>
+#endif // DMS_MMAP_WIN32
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// types
+//
+
+typedef struct RomImage_private {
+	RomImage		public;
+	int32_t			ref_count;
+#ifdef DMS_MMAP_NONE
+	int8_t *		buffer;					// dynamic array with the contents of the file
+#endif
+} RomImage_private;
+
+typedef struct RomImageMap {
+	char *				key;				// filename
+	RomImage_private *	value;
+} RomImageMap;
+
+#define PRIVATE(img)	((RomImage_private *) (img))
+#define PUBLIC(img)		(&(img)->public)
+
+static RomImageMap *rom_images = NULL;		// hashmap filename -> image (several files can share an image)
+static volatile flag_t rom_images_lock = FLAG_INIT;
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// platform specific functions
+//
+
+#ifdef DMS_MMAP_POSIX
+
+static bool rom_image_map_file(RomImage_private *image, const char *filename) {
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		close(fd);
+		return false;
+	}
+
+	// the mapping stays valid after closing the file
+	void *data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (data == MAP_FAILED) {
+		return false;
+	}
+
+	image->public.data = (const uint8_t *) data;
+	image->public.size = (size_t) st.st_size;
+	return true;
+}
+
+static void rom_image_unmap_file(RomImage_private *image) {
+	munmap((void *) image->public.data, image->public.size);
+}
+
+#endif // DMS_MMAP_POSIX
+
+#ifdef DMS_MMAP_WIN32
+
+static bool rom_image_map_file(RomImage_private *image, const char *filename) {
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	// the view keeps the file and the mapping object alive
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (!mapping) {
+		return false;
+	}
+
+	const void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!data) {
+		return false;
+	}
+
+	image->public.data = (const uint8_t *) data;
+	image->public.size = (size_t) size.QuadPart;
+	return true;
+}
+
+static void rom_image_unmap_file(RomImage_private *image) {
+	UnmapViewOfFile(image->public.data);
+}
+
+#endif // DMS_MMAP_WIN32
+
+#ifdef DMS_MMAP_NONE
+
+static bool rom_image_map_file(RomImage_private *image, const char *filename) {
+	if (file_load_binary(filename, &image->buffer) == 0) {
+		arrfree(image->buffer);
+		return false;
+	}
+
+	image->public.data = (const uint8_t *) image->buffer;
+	image->public.size = arrlenu(image->buffer);
+	return true;
+}
+
+static void rom_image_unmap_file(RomImage_private *image) {
+	arrfree(image->buffer);
+}
+
+#endif // DMS_MMAP_NONE
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// helper functions
+//
+
+static uint64_t rom_image_hash(const uint8_t *data, size_t size) {
+	// 64-bit FNV-1a: the same value on every platform
+	uint64_t hash = 0xcbf29ce484222325ull;
+
+	for (size_t i = 0; i < size; ++i) {
+		hash = (hash ^ data[i]) * 0x100000001b3ull;
+	}
+
+	return hash;
+}
+
+static RomImage_private *rom_image_load(const char *filename) {
+	// expects the cache to be locked
+	RomImage_private *image = (RomImage_private *) dms_calloc(1, sizeof(RomImage_private));
+
+	if (!rom_image_map_file(image, filename)) {
+		dms_free(image);
+		return NULL;
+	}
+
+	image->public.hash = rom_image_hash(image->public.data, image->public.size);
+
+	// share the image of another file with the same contents
+	for (size_t i = 0, n = shlenu(rom_images); i < n; ++i) {
+		const RomImage *other = PUBLIC(rom_images[i].value);
+
+		if (other->hash == image->public.hash && other->size == image->public.size &&
+			dms_memcmp(other->data, image->public.data, other->size) == 0) {
+			rom_image_unmap_file(image);
+			dms_free(image);
+			return rom_images[i].value;
+		}
+	}
+
+	return image;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// interface functions
+//
+
+const RomImage *rom_image_acquire(const char *filename) {
+	assert(filename);
+
+	flag_acquire_lock(&rom_images_lock);
+
+	if (!rom_images) {
+		sh_new_arena(rom_images);
+	}
+
+	RomImage_private *image = shget(rom_images, filename);
+
+	if (!image) {
+		image = rom_image_load(filename);
+		if (image) {
+			shput(rom_images, filename, image);
+		}
+	}
+
+	if (image) {
+		image->ref_count += 1;
+	}
+
+	flag_release_lock(&rom_images_lock);
+
+	return (image) ? PUBLIC(image) : NULL;
+}
+
+void rom_image_release(const RomImage *image) {
+	if (!image) {
+		return;
+	}
+
+	flag_acquire_lock(&rom_images_lock);
+
+	RomImage_private *priv = PRIVATE(image);
+	assert(priv->ref_count > 0);
+
+	if (--priv->ref_count == 0) {
+		// remove all the filenames that refer to the image (deleting moves the last entry: walk backwards)
+		for (ptrdiff_t i = shlen(rom_images) - 1; i >= 0; --i) {
+			if (rom_images[i].value == priv) {
+				(void) shdel(rom_images, rom_images[i].key);
+			}
+		}
+
+		rom_image_unmap_file(priv);
+		dms_free(priv);
+
+		if (shlen(rom_images) == 0) {
+			shfree(rom_images);
+		}
+	}
+
+	flag_release_lock(&rom_images_lock);
+}
+
+size_t rom_image_cache_size(void) {
+	flag_acquire_lock(&rom_images_lock);
+
+	size_t count = 0;
+
+	for (size_t i = 0, n = shlenu(rom_images); i < n; ++i) {
+		// an image is counted once, at the first filename that refers to it
+		bool first = true;
+		for (size_t j = 0; first && j < i; ++j) {
+			first = rom_images[j].value != rom_images[i].value;
+		}
+		count += first;
+	}
+
+	flag_release_lock(&rom_images_lock);
+	return count;
+}
@@ -0,0 +1,40 @@
+// rom_image.h - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Read-only images of rom files, shared by all the devices in the process. The files are mapped into memory when the
+// platform supports it: the operating system then shares the contents with other processes too.
+
+#ifndef DROMAIUS_ROM_IMAGE_H
+#define DROMAIUS_ROM_IMAGE_H
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// types
+typedef struct RomImage {
+	const uint8_t *	data;				// read-only: writing to the contents of the image isn't allowed
+	size_t			size;
+	uint64_t		hash;				// hash of the contents (64-bit FNV-1a)
+} RomImage;
+
+// functions
+
+// rom_image_acquire: reference to the image of a file, the file is only opened if it isn't in the cache yet
+//	- the cache is keyed by filename and by contents: a file with the same contents as a cached image shares that image
+//	- changes to a file aren't picked up while its image is in use
+//	- returns NULL if the file can't be opened or is empty
+const RomImage *rom_image_acquire(const char *filename);
+
+// rom_image_release: drop a reference to the image, it's removed from the cache when the last reference is gone
+void rom_image_release(const RomImage *image);
+
+// rom_image_cache_size: number of images in the cache
+size_t rom_image_cache_size(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DROMAIUS_ROM_IMAGE_H
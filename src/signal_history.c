@@ -9,11 +9,14 @@
 #include "sys/threads.h"
 
 #include <stb/stb_ds.h>
+#include <stdlib.h>
 
 #ifdef DMS_GTKWAVE_EXPORT
 #include <gtkwave/lxt_write.h>
 #endif // DMS_GTKWAVE_EXPORT
 
+#define DEFAULT_TRANSACTION_CAPACITY	16384
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // private types
@@ -23,8 +26,21 @@ typedef struct HistoryIncoming {
 	int64_t		time;
 	uint64_t	signals_value[SIGNAL_BLOCKS];
 	uint64_t	signals_changed[SIGNAL_BLOCKS];
+	uint64_t	groups_changed;
+	uint64_t	decoders_changed;
 } HistoryIncoming;
 
+typedef struct HistoryTransactionView {
+	size_t		first;
+	size_t		count;
+	int64_t		max_duration;
+	size_t		min_accessed;			// lowest index that was read through the view
+} HistoryTransactionView;
+
+typedef struct HistoryGroupMask {
+	uint64_t	mask[SIGNAL_BLOCKS];
+} HistoryGroupMask;
+
 typedef struct SignalHistory_private {
 	SignalHistory	public;
 
@@ -39,11 +55,43 @@ typedef struct SignalHistory_private {
 	mutex_t			mtx_work;
 	cond_t			cnd_work;
 
-	flag_t			lock_ui_access;
-
 	bool			force_capture_all;
 
+	// sequence counters (seqlocks) that let the UI thread read the sample buffers without blocking the history thread
+	//	- odd while the history thread is modifying the buffer, readers retry when a sample they copied was overwritten
+	atomic_uint32_t *	signal_samples_seq;			// one counter per signal
+	atomic_uint32_t *	group_samples_seq;			// dynamic array: one counter per group
+	atomic_uint32_t *	transaction_seq;			// dynamic array: one counter per decoder
+
+	// capture mask
+	uint64_t		signals_valid[SIGNAL_BLOCKS];		// mask of the signals that exist
+	uint64_t		capture_mask[SIGNAL_BLOCKS];		// only accessed by the simulator thread
+	uint64_t		capture_snapshot[SIGNAL_BLOCKS];	// signals that were added to the mask and need their current value stored
+
+	flag_t			lock_capture_mask;
+	atomic_uint32_t	capture_mask_changed;
+	uint64_t		capture_mask_next[SIGNAL_BLOCKS];	// set by the UI thread, picked up by the simulator thread
+
+	// group channels
+	char **				group_names;				// dynamic array
+	Signal **			group_signals;				// dynamic array of dynamic arrays
+	HistoryGroupMask *	group_masks;				// dynamic array
+
+	uint64_t			groups_active;				// only accessed by the simulator thread
+	uint64_t			groups_snapshot;
+	uint64_t			groups_active_next;
+
+	// decoders
+	char **				decoder_names;				// dynamic array
+	SignalDecoder **	decoders;					// dynamic array
+	HistoryGroupMask *	decoder_masks;				// dynamic array
+
+	uint64_t			decoders_active;			// only accessed by the simulator thread
+	uint64_t			decoders_snapshot;
+	uint64_t			decoders_active_next;
+
 	// gtkwave export
+	flag_t			lock_gtkwave;
 	bool			gtkwave_enabled;
 	int64_t			timestep_duration_ps;
 
@@ -68,8 +116,120 @@ static inline unsigned int next_index(SignalHistory *history, unsigned int idx)
 	return (idx + 1) % history->incoming_count;
 }
 
+static inline void seqlock_write_begin(atomic_uint32_t *seq) {
+	// only called from the history thread
+	atomic_store_uint32_relaxed(seq, atomic_load_uint32_relaxed(seq) + 1);
+	atomic_fence_release();
+}
+
+static inline void seqlock_write_end(atomic_uint32_t *seq) {
+	atomic_fence_release();
+	atomic_store_uint32_relaxed(seq, atomic_load_uint32_relaxed(seq) + 1);
+}
+
+static inline uint32_t seqlock_read_begin(atomic_uint32_t *seq) {
+	uint32_t result;
+
+	// the writer only holds the sequence odd for the duration of a single sample
+	while ((result = atomic_load_uint32_relaxed(seq)) & 1);
+
+	atomic_fence_acquire();
+	return result;
+}
+
+static inline uint32_t seqlock_read_writes(atomic_uint32_t *seq, uint32_t seq_begin) {
+	// number of writes that were started since seqlock_read_begin
+	atomic_fence_acquire();
+	return (atomic_load_uint32_relaxed(seq) - seq_begin + 1) / 2;
+}
+
+static inline size_t seqlock_intact_samples(SignalHistory *history, atomic_uint32_t *seq, uint32_t seq_begin) {
+	// each write to a sample ring overwrites its oldest sample: the newest samples (at the start of the read) are still valid
+	uint32_t writes = seqlock_read_writes(seq, seq_begin);
+	return (writes < history->sample_count) ? history->sample_count - writes : 0;
+}
+
+static inline void capture_mask_update(SignalHistory *history) {
+	// runs on the simulator thread
+	flag_acquire_lock(&PRIVATE(history)->lock_capture_mask);
+
+	for (int blk = 0; blk < SIGNAL_BLOCKS; ++blk) {
+		uint64_t new_mask = PRIVATE(history)->capture_mask_next[blk];
+		PRIVATE(history)->capture_snapshot[blk] |= new_mask & ~PRIVATE(history)->capture_mask[blk] & PRIVATE(history)->signals_valid[blk];
+		PRIVATE(history)->capture_mask[blk] = new_mask;
+	}
+
+	PRIVATE(history)->groups_snapshot |= PRIVATE(history)->groups_active_next & ~PRIVATE(history)->groups_active;
+	PRIVATE(history)->groups_active = PRIVATE(history)->groups_active_next;
+
+	PRIVATE(history)->decoders_snapshot |= PRIVATE(history)->decoders_active_next & ~PRIVATE(history)->decoders_active;
+	PRIVATE(history)->decoders_active = PRIVATE(history)->decoders_active_next;
+
+	atomic_exchange_uint32(&PRIVATE(history)->capture_mask_changed, 0);
+	flag_release_lock(&PRIVATE(history)->lock_capture_mask);
+}
+
+static inline uint64_t channel_changed_mask(uint64_t active, HistoryGroupMask *masks, uint64_t *signals_changed) {
+	// runs on the simulator thread
+	uint64_t result = 0;
+
+	for (uint64_t channels = active; channels; channels &= channels - 1) {
+		int32_t channel = bit_lowest_set(channels);
+		HistoryGroupMask *gm = &masks[channel];
+
+		for (int blk = 0; blk < SIGNAL_BLOCKS; ++blk) {
+			if (signals_changed[blk] & gm->mask[blk]) {
+				result |= 1ull << channel;
+				break;
+			}
+		}
+	}
+
+	return result;
+}
+
+static inline uint64_t group_value(SignalHistory *history, uint32_t group, uint64_t *signals_value) {
+	uint64_t result = 0;
+	Signal *signals = PRIVATE(history)->group_signals[group];
+
+	for (size_t i = 0; i < arrlenu(signals); ++i) {
+		result |= ((signals_value[signals[i].block] >> signals[i].index) & 1ull) << i;
+	}
+
+	return result;
+}
+
+static char *concat_names(const char *chip_name, const char *name) {
+	const char *separator = " - ";
+	size_t len = dms_strlen(chip_name) + dms_strlen(name) + dms_strlen(separator) + 1;
+	char *full_name = dms_malloc(len);
+	assert(full_name);
+	dms_strlcpy(full_name, chip_name, len);
+	dms_strlcat(full_name, separator, len);
+	dms_strlcat(full_name, name, len);
+	return full_name;
+}
+
+static inline void array_truncate(void *array, size_t length) {
+	if (array) {
+		stbds_header(array)->length = length;
+	}
+}
+
 static void prepare_diagram_data(SignalHistoryDiagramData *data) {
 
+	if (data->group_start_offsets) {
+		stbds_header(data->group_start_offsets)->length = 0;
+	}
+
+	if (data->group_samples_time) {
+		stbds_header(data->group_samples_time)->length = 0;
+	}
+
+	if (data->group_samples_value) {
+		stbds_header(data->group_samples_value)->length = 0;
+	}
+
 	if (data->signal_start_offsets) {
 		stbds_header(data->signal_start_offsets)->length = 0;
 	}
@@ -130,16 +290,16 @@ static void gtkwave_lxt_open(SignalHistory *history, const char *filename) {
 }
 
 static void gtkwave_lxt_start(SignalHistory *history) {
-	flag_acquire_lock(&PRIVATE(history)->lock_ui_access);
+	flag_acquire_lock(&PRIVATE(history)->lock_gtkwave);
 	PRIVATE(history)->gtkwave_enabled = true;
-	flag_release_lock(&PRIVATE(history)->lock_ui_access);
+	flag_release_lock(&PRIVATE(history)->lock_gtkwave);
 }
 
 static void gtkwave_lxt_close(SignalHistory *history) {
 
-	flag_acquire_lock(&PRIVATE(history)->lock_ui_access);
+	flag_acquire_lock(&PRIVATE(history)->lock_gtkwave);
 	PRIVATE(history)->gtkwave_enabled = false;
-	flag_release_lock(&PRIVATE(history)->lock_ui_access);
+	flag_release_lock(&PRIVATE(history)->lock_gtkwave);
 
 	lt_close(PRIVATE(history)->lxt);
 	dms_free(PRIVATE(history)->lxt_symbols);
@@ -189,8 +349,17 @@ SignalHistory *signal_history_create(size_t incoming_count, size_t signal_count,
 		history->signal_samples_tail[si] = (size_t) -1;
 	}
 
+	priv->signal_samples_seq = (atomic_uint32_t *) dms_calloc(signal_count, sizeof(atomic_uint32_t));
+
 	priv->timestep_duration_ps = timestep_duration;
 
+	size_t signals_left = signal_count;
+	for (int blk = 0; blk < SIGNAL_BLOCKS; ++blk, signals_left -= MIN(signals_left, 64)) {
+		priv->signals_valid[blk] = (signals_left >= 64) ? (uint64_t) -1 : (1ull << signals_left) - 1;
+		priv->capture_mask[blk] = (uint64_t) -1;
+		priv->capture_mask_next[blk] = (uint64_t) -1;
+	}
+
 	// private variables
 	mutex_init_plain(&priv->mtx_work);
 	cond_init(&priv->cnd_work);
@@ -204,6 +373,8 @@ void signal_history_destroy(SignalHistory *history) {
 	dms_free(history->signal_samples_base);
 	dms_free(history->samples_time);
 	dms_free(history->samples_value);
+	dms_free(PRIVATE(history)->signal_samples_seq);
+	arrfree(PRIVATE(history)->group_samples_seq);
 
 	for (size_t i = 0; i < arrlenu(PRIVATE(history)->profile_names); ++i) {
 		dms_free((char *) PRIVATE(history)->profile_names[i]);
@@ -216,6 +387,32 @@ void signal_history_destroy(SignalHistory *history) {
 		}
 		arrfree(PRIVATE(history)->profile_signal_aliases[i]);
 	}
+	for (size_t i = 0; i < arrlenu(PRIVATE(history)->group_names); ++i) {
+		dms_free(PRIVATE(history)->group_names[i]);
+		arrfree(PRIVATE(history)->group_signals[i]);
+	}
+	arrfree(PRIVATE(history)->group_names);
+	arrfree(PRIVATE(history)->group_signals);
+	arrfree(PRIVATE(history)->group_masks);
+	arrfree(history->group_samples_head);
+	arrfree(history->group_samples_tail);
+	arrfree(history->group_samples_time);
+	arrfree(history->group_samples_value);
+
+	for (size_t i = 0; i < arrlenu(PRIVATE(history)->decoders); ++i) {
+		dms_free(PRIVATE(history)->decoder_names[i]);
+		PRIVATE(history)->decoders[i]->destroy(PRIVATE(history)->decoders[i]);
+	}
+	arrfree(PRIVATE(history)->decoder_names);
+	arrfree(PRIVATE(history)->decoders);
+	arrfree(PRIVATE(history)->decoder_masks);
+
+	for (size_t i = 0; i < arrlenu(history->transaction_rings); ++i) {
+		dms_free(history->transaction_rings[i].transactions);
+	}
+	arrfree(history->transaction_rings);
+	arrfree(PRIVATE(history)->transaction_seq);
+
 	arrfree(PRIVATE(history)->profile_names);
 	arrfree(PRIVATE(history)->profile_signals);
 	arrfree(PRIVATE(history)->profile_signal_aliases);
@@ -259,12 +456,58 @@ void signal_history_process_stop(SignalHistory *history) {
 		history->signal_samples_head[si] = (size_t) -1;
 		history->signal_samples_tail[si] = (size_t) -1;
 	}
+	for (size_t gi = 0; gi < history->group_count; ++gi) {
+		history->group_samples_head[gi] = (size_t) -1;
+		history->group_samples_tail[gi] = (size_t) -1;
+	}
+	for (size_t di = 0; di < arrlenu(PRIVATE(history)->decoders); ++di) {
+		PRIVATE(history)->decoders[di]->primed = false;
+		history->transaction_rings[di].first = 0;
+		history->transaction_rings[di].count = 0;
+		history->transaction_rings[di].max_duration = 0;
+	}
 }
 
 bool signal_history_add(SignalHistory *history, int64_t time, uint64_t *signals_value, uint64_t *signals_changed, bool block) {
 	// runs on the simulator thread
 	assert(history);
 
+	// apply the capture mask before anything is queued
+	if (atomic_load_uint32(&PRIVATE(history)->capture_mask_changed)) {
+		capture_mask_update(history);
+	}
+
+	uint64_t changed[SIGNAL_BLOCKS];
+	uint64_t any_changed = 0;
+	uint64_t any_captured = 0;
+	uint64_t groups_changed = 0;
+	uint64_t decoders_changed = 0;
+
+	if (!PRIVATE(history)->force_capture_all) {
+		for (int blk = 0; blk < SIGNAL_BLOCKS; ++blk) {
+			any_changed |= signals_changed[blk];
+			changed[blk] = (signals_changed[blk] | PRIVATE(history)->capture_snapshot[blk]) & PRIVATE(history)->capture_mask[blk];
+			any_captured |= changed[blk];
+		}
+		groups_changed = channel_changed_mask(PRIVATE(history)->groups_active, PRIVATE(history)->group_masks, signals_changed) |
+						 PRIVATE(history)->groups_snapshot;
+		decoders_changed = channel_changed_mask(PRIVATE(history)->decoders_active, PRIVATE(history)->decoder_masks, signals_changed) |
+						   PRIVATE(history)->decoders_snapshot;
+		any_captured |= groups_changed | decoders_changed;
+	} else {
+		for (int blk = 0; blk < SIGNAL_BLOCKS; ++blk) {
+			changed[blk] = PRIVATE(history)->signals_valid[blk] & PRIVATE(history)->capture_mask[blk];
+		}
+		groups_changed = PRIVATE(history)->groups_active;
+		decoders_changed = PRIVATE(history)->decoders_active;
+		any_changed = any_captured = 1;
+	}
+
+	// nothing left to store after masking
+	if (any_changed && !any_captured) {
+		return true;
+	}
+
 	// don't let next_in index 'catch up' with first_out index
 	while (next_index(history, PRIVATE(history)->next_in) == atomic_load_uint32(&PRIVATE(history)->first_out)) {
 		if (!block) {
@@ -278,15 +521,13 @@ bool signal_history_add(SignalHistory *history, int64_t time, uint64_t *signals_
 	HistoryIncoming *in = &history->incoming[PRIVATE(history)->next_in];
 	in->time = time;
 	dms_memcpy(in->signals_value, signals_value, sizeof(uint64_t) * SIGNAL_BLOCKS);
-	if (!PRIVATE(history)->force_capture_all) {
-		dms_memcpy(in->signals_changed, signals_changed, sizeof(uint64_t) * SIGNAL_BLOCKS);
-	} else {
-		size_t signals_left = history->signal_count;
-		for (size_t i = 0; i < SIGNAL_BLOCKS; ++i, signals_left -= 64) {
-			in->signals_changed[i] = (signals_left > 64) ? (uint64_t) -1 : (1ull << signals_left) - 1;
-		}
-		PRIVATE(history)->force_capture_all = false;
-	}
+	dms_memcpy(in->signals_changed, changed, sizeof(uint64_t) * SIGNAL_BLOCKS);
+	in->groups_changed = groups_changed;
+	in->decoders_changed = decoders_changed;
+	dms_zero(PRIVATE(history)->capture_snapshot, sizeof(uint64_t) * SIGNAL_BLOCKS);
+	PRIVATE(history)->groups_snapshot = 0;
+	PRIVATE(history)->decoders_snapshot = 0;
+	PRIVATE(history)->force_capture_all = false;
 
 	// move pointer along -- there's only one thread writing to next_in
 	atomic_exchange_uint32(&PRIVATE(history)->next_in, next_index(history, PRIVATE(history)->next_in));
@@ -297,6 +538,48 @@ bool signal_history_add(SignalHistory *history, int64_t time, uint64_t *signals_
 	return true;
 }
 
+void signal_history_force_capture_all(SignalHistory *history) {
+	// runs on the simulator thread
+	assert(history);
+	PRIVATE(history)->force_capture_all = true;
+}
+
+void signal_history_capture_mask_set(SignalHistory *history, const uint64_t *capture_mask) {
+	assert(history);
+	assert(capture_mask);
+
+	flag_acquire_lock(&PRIVATE(history)->lock_capture_mask);
+	dms_memcpy(PRIVATE(history)->capture_mask_next, capture_mask, sizeof(uint64_t) * SIGNAL_BLOCKS);
+	atomic_exchange_uint32(&PRIVATE(history)->capture_mask_changed, 1);
+	flag_release_lock(&PRIVATE(history)->lock_capture_mask);
+}
+
+void signal_history_capture_mask_reset(SignalHistory *history) {
+	assert(history);
+
+	uint64_t capture_all[SIGNAL_BLOCKS];
+	for (int blk = 0; blk < SIGNAL_BLOCKS; ++blk) {
+		capture_all[blk] = (uint64_t) -1;
+	}
+	signal_history_capture_mask_set(history, capture_all);
+}
+
+void signal_history_capture_mask_add_signals(uint64_t *capture_mask, size_t count, const Signal *signals) {
+	assert(capture_mask);
+
+	for (size_t i = 0; i < count; ++i) {
+		capture_mask[signals[i].block] |= 1ull << signals[i].index;
+	}
+}
+
+void signal_history_capture_mask_add_profile(SignalHistory *history, uint32_t profile, uint64_t *capture_mask) {
+	assert(history);
+	assert(profile < arrlen(PRIVATE(history)->profile_signals));
+
+	Signal *signals = PRIVATE(history)->profile_signals[profile];
+	signal_history_capture_mask_add_signals(capture_mask, arrlenu(signals), signals);
+}
+
 void signal_history_diagram_data(struct SignalHistory *history, SignalHistoryDiagramData *diagram_data) {
 	assert(history);
 	assert(diagram_data);
@@ -304,46 +587,116 @@ void signal_history_diagram_data(struct SignalHistory *history, SignalHistoryDia
 	// clear any data that's already in there
 	prepare_diagram_data(diagram_data);
 
-	flag_acquire_lock(&PRIVATE(history)->lock_ui_access);
-
 	// iterate signals
 	for (size_t idx = 0; idx < arrlenu(diagram_data->signals); ++idx) {
 
 		size_t si = signal_array_subscript(diagram_data->signals[idx]);
+		size_t first = arrlenu(diagram_data->samples_time);
 
 		// save start of data for this signal
-		arrpush(diagram_data->signal_start_offsets, arrlenu(diagram_data->samples_time));
+		arrpush(diagram_data->signal_start_offsets, first);
 
-		// iterate over store changes of signal data
-		size_t base = history->signal_samples_base[si];
-		size_t cur = history->signal_samples_head[si];
-		size_t end = history->signal_samples_tail[si];
+		// the history thread keeps on adding samples while they are being copied
+		for (;;) {
+			uint32_t seq = seqlock_read_begin(&PRIVATE(history)->signal_samples_seq[si]);
+
+			// iterate over store changes of signal data
+			size_t base = history->signal_samples_base[si];
+			size_t cur = history->signal_samples_head[si];
+			size_t end = history->signal_samples_tail[si];
+			size_t examined = 0;
+			size_t skipped = 0;
+
+			while (cur < history->sample_count) {
+				size_t sample = base + cur;
+				int64_t time = history->samples_time[sample];
+				++examined;
+
+				if (time < diagram_data->time_end) {
+					arrpush(diagram_data->samples_time, time);
+					arrpush(diagram_data->samples_value, history->samples_value[sample]);
+				} else if (arrlenu(diagram_data->samples_time) == first) {
+					++skipped;
+				}
+
+				if (time < diagram_data->time_begin || cur == end)  {
+					break;
+				}
+
+				cur = (cur - 1 + history->sample_count) % history->sample_count;
+			}
 
-		if (cur > history->sample_count) {
-			// no samples for signal
-			continue;
+			// drop the oldest samples if they might have been overwritten while copying, retry if nothing is left
+			size_t intact = seqlock_intact_samples(history, &PRIVATE(history)->signal_samples_seq[si], seq);
+			size_t keep = (intact > skipped) ? intact - skipped : 0;
+
+			if (intact > 0 || examined == 0) {
+				array_truncate(diagram_data->samples_time, first + MIN(keep, arrlenu(diagram_data->samples_time) - first));
+				array_truncate(diagram_data->samples_value, first + MIN(keep, arrlenu(diagram_data->samples_value) - first));
+				break;
+			}
+
+			array_truncate(diagram_data->samples_time, first);
+			array_truncate(diagram_data->samples_value, first);
 		}
+	}
 
-		for (;;) {
+	arrpush(diagram_data->signal_start_offsets, arrlenu(diagram_data->samples_time));
+
+	// iterate groups
+	for (size_t idx = 0; idx < arrlenu(diagram_data->groups); ++idx) {
+
+		uint32_t gi = diagram_data->groups[idx];
+		assert(gi < history->group_count);
+
+		size_t first = arrlenu(diagram_data->group_samples_time);
 
-			size_t sample = base + cur;
+		// save start of data for this group
+		arrpush(diagram_data->group_start_offsets, first);
 
-			if (history->samples_time[sample] < diagram_data->time_end) {
-				arrpush(diagram_data->samples_time, history->samples_time[sample]);
-				arrpush(diagram_data->samples_value, history->samples_value[sample]);
+		for (;;) {
+			uint32_t seq = seqlock_read_begin(&PRIVATE(history)->group_samples_seq[gi]);
+
+			size_t base = gi * history->sample_count;
+			size_t cur = history->group_samples_head[gi];
+			size_t end = history->group_samples_tail[gi];
+			size_t examined = 0;
+			size_t skipped = 0;
+
+			while (cur < history->sample_count) {
+				size_t sample = base + cur;
+				int64_t time = history->group_samples_time[sample];
+				++examined;
+
+				if (time < diagram_data->time_end) {
+					arrpush(diagram_data->group_samples_time, time);
+					arrpush(diagram_data->group_samples_value, history->group_samples_value[sample]);
+				} else if (arrlenu(diagram_data->group_samples_time) == first) {
+					++skipped;
+				}
+
+				if (time < diagram_data->time_begin || cur == end)  {
+					break;
+				}
+
+				cur = (cur - 1 + history->sample_count) % history->sample_count;
 			}
 
-			if (history->samples_time[sample] < diagram_data->time_begin || cur == end)  {
+			size_t intact = seqlock_intact_samples(history, &PRIVATE(history)->group_samples_seq[gi], seq);
+			size_t keep = (intact > skipped) ? intact - skipped : 0;
+
+			if (intact > 0 || examined == 0) {
+				array_truncate(diagram_data->group_samples_time, first + MIN(keep, arrlenu(diagram_data->group_samples_time) - first));
+				array_truncate(diagram_data->group_samples_value, first + MIN(keep, arrlenu(diagram_data->group_samples_value) - first));
 				break;
 			}
 
-			cur = (cur - 1 + history->sample_count) % history->sample_count;
+			array_truncate(diagram_data->group_samples_time, first);
+			array_truncate(diagram_data->group_samples_value, first);
 		}
 	}
 
-	arrpush(diagram_data->signal_start_offsets, arrlenu(diagram_data->samples_time));
-
-	flag_release_lock(&PRIVATE(history)->lock_ui_access);
+	arrpush(diagram_data->group_start_offsets, arrlenu(diagram_data->group_samples_time));
 }
 
 void signal_history_diagram_release(SignalHistoryDiagramData *diagram_data) {
@@ -352,12 +705,18 @@ void signal_history_diagram_release(SignalHistoryDiagramData *diagram_data) {
 	arrfree(diagram_data->signal_start_offsets);
 	arrfree(diagram_data->samples_time);
 	arrfree(diagram_data->samples_value);
+	arrfree(diagram_data->groups);
+	arrfree(diagram_data->group_start_offsets);
+	arrfree(diagram_data->group_samples_time);
+	arrfree(diagram_data->group_samples_value);
 }
 
 void signal_history_store_data(SignalHistory *history, size_t signal, int64_t time, bool value) {
 	assert(history);
 	assert(signal < history->signal_count);
 
+	seqlock_write_begin(&PRIVATE(history)->signal_samples_seq[signal]);
+
 	// store
 	size_t idx = history->signal_samples_base[signal] + ((history->signal_samples_head[signal] + 1) % history->sample_count);
 	history->samples_time[idx] = time;
@@ -369,6 +728,8 @@ void signal_history_store_data(SignalHistory *history, size_t signal, int64_t ti
 		history->signal_samples_tail[signal] = (history->signal_samples_tail[signal] + 1) % history->sample_count;
 	}
 
+	seqlock_write_end(&PRIVATE(history)->signal_samples_seq[signal]);
+
 	// gtkwave export
 #ifdef DMS_GTKWAVE_EXPORT
 	if (PRIVATE(history)->gtkwave_enabled) {
@@ -377,6 +738,85 @@ void signal_history_store_data(SignalHistory *history, size_t signal, int64_t ti
 #endif // DMS_GTKWAVE_EXPORT
 }
 
+static void signal_history_store_group_data(SignalHistory *history, size_t group, int64_t time, uint64_t value) {
+	assert(group < history->group_count);
+
+	seqlock_write_begin(&PRIVATE(history)->group_samples_seq[group]);
+
+	size_t head = (history->group_samples_head[group] + 1) % history->sample_count;
+	history->group_samples_time[(group * history->sample_count) + head] = time;
+	history->group_samples_value[(group * history->sample_count) + head] = value;
+
+	// move pointers
+	history->group_samples_head[group] = head;
+	if (head == history->group_samples_tail[group] || history->group_samples_tail[group] == (size_t) -1) {
+		history->group_samples_tail[group] = (history->group_samples_tail[group] + 1) % history->sample_count;
+	}
+
+	seqlock_write_end(&PRIVATE(history)->group_samples_seq[group]);
+}
+
+static inline SignalTransaction *transaction_at(SignalTransactionRing *ring, size_t idx) {
+	return &ring->transactions[(ring->first + idx) % ring->capacity];
+}
+
+static inline HistoryTransactionView transaction_view_begin(SignalTransactionRing *ring) {
+	HistoryTransactionView view = {
+		.first = ring->first,
+		.count = ring->count,
+		.max_duration = ring->max_duration,
+		.min_accessed = ring->count
+	};
+	return view;
+}
+
+static inline SignalTransaction *transaction_view_at(SignalTransactionRing *ring, HistoryTransactionView *view, size_t idx) {
+	view->min_accessed = MIN(view->min_accessed, idx);
+	return &ring->transactions[(view->first + idx) % ring->capacity];
+}
+
+static inline bool transaction_view_valid(SignalTransactionRing *ring, atomic_uint32_t *seq, HistoryTransactionView *view, uint32_t seq_begin) {
+	// writes only overwrite the oldest transactions once the buffer is full
+	size_t writes = seqlock_read_writes(seq, seq_begin);
+	size_t free_slots = ring->capacity - view->count;
+	size_t overwritten = (writes > free_slots) ? writes - free_slots : 0;
+	return view->min_accessed >= overwritten;
+}
+
+static size_t transaction_lower_bound(SignalTransactionRing *ring, HistoryTransactionView *view, int64_t time_end) {
+	// index of the first transaction that ends at or after the specified time
+	size_t lo = 0;
+	size_t hi = view->count;
+
+	while (lo < hi) {
+		size_t mid = lo + ((hi - lo) / 2);
+		if (transaction_view_at(ring, view, mid)->time_end < time_end) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+static int compare_transactions(const void *a, const void *b) {
+	const SignalTransaction *ta = (const SignalTransaction *) a;
+	const SignalTransaction *tb = (const SignalTransaction *) b;
+
+	if (ta->time_end != tb->time_end) {
+		return (ta->time_end < tb->time_end) ? -1 : 1;
+	}
+	return (ta->decoder > tb->decoder) - (ta->decoder < tb->decoder);
+}
+
+static inline bool transaction_matches(const SignalTransaction *trans, const SignalTransactionQuery *query) {
+	return trans->decoder == query->decoder &&
+		   ((1u << trans->type) & query->type_mask) != 0 &&
+		   (trans->address & query->address_mask) == (query->address & query->address_mask) &&
+		   (trans->data & query->data_mask) == (query->data & query->data_mask);
+}
+
 bool signal_history_process_incoming_single(SignalHistory *history) {
 	// runs on the dedicated history thread
 	assert(history);
@@ -386,8 +826,10 @@ bool signal_history_process_incoming_single(SignalHistory *history) {
 		return false;
 	}
 
-	// don't let UI thread access data while it's being changed
-	flag_acquire_lock(&PRIVATE(history)->lock_ui_access);
+#ifdef DMS_GTKWAVE_EXPORT
+	// only contended while the export is being started or stopped
+	flag_acquire_lock(&PRIVATE(history)->lock_gtkwave);
+#endif // DMS_GTKWAVE_EXPORT
 
 	HistoryIncoming *in = &history->incoming[PRIVATE(history)->first_out];
 
@@ -406,7 +848,24 @@ bool signal_history_process_incoming_single(SignalHistory *history) {
 		}
 	}
 
-	flag_release_lock(&PRIVATE(history)->lock_ui_access);
+	for (uint64_t groups = in->groups_changed; groups; groups &= groups - 1) {
+		int32_t group = bit_lowest_set(groups);
+		signal_history_store_group_data(history, (size_t) group, in->time, group_value(history, (uint32_t) group, in->signals_value));
+	}
+
+	for (uint64_t decoders = in->decoders_changed; decoders; decoders &= decoders - 1) {
+		SignalDecoder *decoder = PRIVATE(history)->decoders[bit_lowest_set(decoders)];
+		if (decoder->primed) {
+			decoder->process(decoder, history, in->time, in->signals_value);
+		}
+		dms_memcpy(decoder->last_value, in->signals_value, sizeof(uint64_t) * SIGNAL_BLOCKS);
+		decoder->primed = true;
+	}
+
+#ifdef DMS_GTKWAVE_EXPORT
+	flag_release_lock(&PRIVATE(history)->lock_gtkwave);
+#endif // DMS_GTKWAVE_EXPORT
+
 	atomic_exchange_uint32(&PRIVATE(history)->first_out, next_index(history, PRIVATE(history)->first_out));
 	return true;
 }
@@ -432,20 +891,58 @@ void signal_history_gtkwave_disable(SignalHistory *history) {
 
 #endif // DMS_GTKWAVE_EXPORT
 
+uint32_t signal_history_group_create(SignalHistory *history, const char *chip_name, const char *group_name, SignalGroup group) {
+	assert(history);
+	assert(!history->capture_active);
+	assert(history->group_count < 64);
+	assert(signal_group_size(group) <= 64);
+
+	HistoryGroupMask mask = {0};
+	Signal *signals = NULL;
+
+	for (size_t i = 0; i < signal_group_size(group); ++i) {
+		arrpush(signals, *group[i]);
+		mask.mask[group[i]->block] |= 1ull << group[i]->index;
+	}
+
+	arrpush(PRIVATE(history)->group_names, concat_names(chip_name, group_name));
+	arrpush(PRIVATE(history)->group_signals, signals);
+	arrpush(PRIVATE(history)->group_masks, mask);
+
+	arrpush(history->group_samples_head, (size_t) -1);
+	arrpush(history->group_samples_tail, (size_t) -1);
+	arrpush(PRIVATE(history)->group_samples_seq, 0);
+	arrsetlen(history->group_samples_time, (history->group_count + 1) * history->sample_count);
+	arrsetlen(history->group_samples_value, (history->group_count + 1) * history->sample_count);
+
+	return (uint32_t) history->group_count++;
+}
+
+void signal_history_capture_groups_set(SignalHistory *history, uint64_t group_mask) {
+	assert(history);
+
+	flag_acquire_lock(&PRIVATE(history)->lock_capture_mask);
+	PRIVATE(history)->groups_active_next = group_mask;
+	atomic_exchange_uint32(&PRIVATE(history)->capture_mask_changed, 1);
+	flag_release_lock(&PRIVATE(history)->lock_capture_mask);
+}
+
+const char **signal_history_group_names(SignalHistory *history) {
+	assert(history);
+	return (const char **) PRIVATE(history)->group_names;
+}
+
+size_t signal_history_group_size(SignalHistory *history, uint32_t group) {
+	assert(history);
+	assert(group < history->group_count);
+	return arrlenu(PRIVATE(history)->group_signals[group]);
+}
+
 uint32_t signal_history_profile_create(SignalHistory *history, const char *chip_name, const char *profile_name) {
 	assert(history);
 	assert(arrlen(PRIVATE(history)->profile_names) == arrlen(PRIVATE(history)->profile_signals));
 
-	// concatenate name
-	const char *separator = " - ";
-	size_t len = dms_strlen(chip_name) + dms_strlen(profile_name) + dms_strlen(separator) + 1;
-	char *full_name = dms_malloc(len);
-	assert(full_name);
-	dms_strlcpy(full_name, chip_name, len);
-	dms_strlcat(full_name, separator, len);
-	dms_strlcat(full_name, profile_name, len);
-
-	arrpush(PRIVATE(history)->profile_names, full_name);
+	arrpush(PRIVATE(history)->profile_names, concat_names(chip_name, profile_name));
 	arrpush(PRIVATE(history)->profile_signals, NULL);
 	arrpush(PRIVATE(history)->profile_signal_aliases, NULL);
 
@@ -481,3 +978,201 @@ const char **signal_history_profile_signal_aliases(SignalHistory *history, uint3
 	assert(profile < arrlen(PRIVATE(history)->profile_signals));
 	return (const char **) PRIVATE(history)->profile_signal_aliases[profile];
 }
+
+uint32_t signal_history_decoder_add(SignalHistory *history, const char *chip_name, const char *decoder_name, SignalDecoder *decoder) {
+	assert(history);
+	assert(decoder);
+	assert(decoder->process);
+	assert(decoder->destroy);
+	assert(!history->capture_active);
+	assert(arrlenu(PRIVATE(history)->decoders) < 64);
+
+	HistoryGroupMask mask;
+	dms_memcpy(mask.mask, decoder->signal_mask, sizeof(uint64_t) * SIGNAL_BLOCKS);
+
+	decoder->id = (uint32_t) arrlenu(PRIVATE(history)->decoders);
+	decoder->primed = false;
+
+	SignalTransactionRing ring = {
+		.capacity = (decoder->transaction_capacity > 0) ? decoder->transaction_capacity : DEFAULT_TRANSACTION_CAPACITY
+	};
+	ring.transactions = (SignalTransaction *) dms_malloc(sizeof(SignalTransaction) * ring.capacity);
+
+	arrpush(PRIVATE(history)->decoder_names, concat_names(chip_name, decoder_name));
+	arrpush(PRIVATE(history)->decoders, decoder);
+	arrpush(PRIVATE(history)->decoder_masks, mask);
+	arrpush(history->transaction_rings, ring);
+	arrpush(PRIVATE(history)->transaction_seq, 0);
+
+	return decoder->id;
+}
+
+void signal_history_capture_decoders_set(SignalHistory *history, uint64_t decoder_mask) {
+	assert(history);
+
+	flag_acquire_lock(&PRIVATE(history)->lock_capture_mask);
+	PRIVATE(history)->decoders_active_next = decoder_mask;
+	atomic_exchange_uint32(&PRIVATE(history)->capture_mask_changed, 1);
+	flag_release_lock(&PRIVATE(history)->lock_capture_mask);
+}
+
+const char **signal_history_decoder_names(SignalHistory *history) {
+	assert(history);
+	return (const char **) PRIVATE(history)->decoder_names;
+}
+
+size_t signal_history_decoder_count(SignalHistory *history) {
+	assert(history);
+	return arrlenu(PRIVATE(history)->decoders);
+}
+
+void signal_history_transaction_add(SignalHistory *history, const SignalTransaction *trans) {
+	// runs on the history thread (called by the decoders)
+	assert(history);
+	assert(trans);
+	assert(trans->time_begin <= trans->time_end);
+	assert(trans->decoder < arrlenu(history->transaction_rings));
+
+	SignalTransactionRing *ring = &history->transaction_rings[trans->decoder];
+	assert(ring->count == 0 || transaction_at(ring, ring->count - 1)->time_end <= trans->time_end);
+
+	seqlock_write_begin(&PRIVATE(history)->transaction_seq[trans->decoder]);
+
+	if (ring->count == ring->capacity) {
+		// overwrite the oldest transaction
+		ring->first = (ring->first + 1) % ring->capacity;
+	} else {
+		ring->count += 1;
+	}
+
+	*transaction_at(ring, ring->count - 1) = *trans;
+	ring->max_duration = MAX(ring->max_duration, trans->time_end - trans->time_begin);
+
+	seqlock_write_end(&PRIVATE(history)->transaction_seq[trans->decoder]);
+}
+
+size_t signal_history_transaction_describe(SignalHistory *history, const SignalTransaction *trans, char *buffer, size_t buffer_size) {
+	assert(history);
+	assert(trans);
+	assert(trans->decoder < arrlenu(PRIVATE(history)->decoders));
+
+	SignalDecoder *decoder = PRIVATE(history)->decoders[trans->decoder];
+	if (!decoder->describe) {
+		return (size_t) dms_snprintf(buffer, buffer_size, "$%.2x", trans->data);
+	}
+
+	return decoder->describe(decoder, trans, buffer, buffer_size);
+}
+
+void signal_history_transactions_range(SignalHistory *history, int64_t time_begin, int64_t time_end, uint64_t decoder_mask, SignalTransaction **transactions) {
+	assert(history);
+	assert(transactions);
+
+	if (*transactions) {
+		stbds_header(*transactions)->length = 0;
+	}
+
+	size_t decoders_found = 0;
+
+	for (size_t di = 0; di < arrlenu(history->transaction_rings); ++di) {
+		if (!(decoder_mask & (1ull << di))) {
+			continue;
+		}
+
+		SignalTransactionRing *ring = &history->transaction_rings[di];
+		atomic_uint32_t *seq = &PRIVATE(history)->transaction_seq[di];
+		size_t first_result = arrlenu(*transactions);
+
+		for (;;) {
+			uint32_t seq_begin = seqlock_read_begin(seq);
+			HistoryTransactionView view = transaction_view_begin(ring);
+
+			// transactions are sorted on their end time: everything ending in the window or a transaction's length after it
+			for (size_t idx = transaction_lower_bound(ring, &view, time_begin); idx < view.count; ++idx) {
+				SignalTransaction trans = *transaction_view_at(ring, &view, idx);
+
+				if (trans.time_end >= time_end + view.max_duration) {
+					break;
+				}
+
+				if (trans.time_begin < time_end) {
+					arrpush(*transactions, trans);
+				}
+			}
+
+			if (transaction_view_valid(ring, seq, &view, seq_begin)) {
+				break;
+			}
+
+			if (*transactions) {
+				stbds_header(*transactions)->length = first_result;
+			}
+		}
+
+		decoders_found += arrlenu(*transactions) > first_result;
+	}
+
+	// merge the results of the decoders
+	if (decoders_found > 1) {
+		qsort(*transactions, arrlenu(*transactions), sizeof(SignalTransaction), compare_transactions);
+	}
+}
+
+bool signal_history_transaction_search(SignalHistory *history, const SignalTransactionQuery *query, int64_t from_time, bool forward, SignalTransaction *result) {
+	assert(history);
+	assert(query);
+	assert(result);
+
+	if (query->decoder >= arrlenu(history->transaction_rings)) {
+		return false;
+	}
+
+	SignalTransactionRing *ring = &history->transaction_rings[query->decoder];
+	atomic_uint32_t *seq = &PRIVATE(history)->transaction_seq[query->decoder];
+
+	for (;;) {
+		bool found = false;
+		SignalTransaction trans;
+
+		uint32_t seq_begin = seqlock_read_begin(seq);
+		HistoryTransactionView view = transaction_view_begin(ring);
+
+		size_t start = transaction_lower_bound(ring, &view, (forward) ? from_time + 1 : from_time + view.max_duration);
+		size_t bound_accessed = view.min_accessed;
+
+		if (forward) {
+			// first matching transaction that starts after from_time
+			for (size_t idx = start; idx < view.count; ++idx) {
+				trans = *transaction_view_at(ring, &view, idx);
+				if (trans.time_begin > from_time && transaction_matches(&trans, query)) {
+					found = true;
+					break;
+				}
+			}
+		} else {
+			// last matching transaction that starts before from_time
+			for (size_t idx = start; idx > 0; --idx) {
+				trans = *transaction_view_at(ring, &view, idx - 1);
+				if (trans.time_begin < from_time && transaction_matches(&trans, query)) {
+					found = true;
+					break;
+				}
+			}
+		}
+
+		// not finding anything in transactions that were overwritten during the search is fine, they are gone
+		if (!found) {
+			view.min_accessed = bound_accessed;
+		}
+
+		if (!transaction_view_valid(ring, seq, &view, seq_begin)) {
+			// transactions that were examined have been overwritten, try again
+			continue;
+		}
+
+		if (found) {
+			*result = trans;
+		}
+		return found;
+	}
+}
@@ -4,12 +4,58 @@
 #define DROMAIUS_SIGNAL_HISTORY_H
 
 #include "signal_types.h"
+#include "signal_pool.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 // types
+typedef struct SignalTransaction {
+	int64_t		time_begin;
+	int64_t		time_end;
+	uint32_t	decoder;					// id of the decoder that generated the transaction
+	uint32_t	type;						// decoder specific type of the transaction
+	uint32_t	address;					// decoder specific (e.g. address of a bus cycle)
+	uint32_t	data;						// decoder specific (e.g. value of the data bus)
+} SignalTransaction;
+
+typedef struct SignalTransactionQuery {
+	uint32_t	decoder;
+	uint32_t	type_mask;					// bit (1 << type) is set for each type that matches
+	uint32_t	address;
+	uint32_t	address_mask;
+	uint32_t	data;
+	uint32_t	data_mask;
+} SignalTransactionQuery;
+
+struct SignalDecoder;
+struct SignalHistory;
+
+typedef void (*SIGNAL_DECODER_PROCESS)(struct SignalDecoder *decoder, struct SignalHistory *history, int64_t time, const uint64_t *signals_value);
+typedef size_t (*SIGNAL_DECODER_DESCRIBE)(struct SignalDecoder *decoder, const SignalTransaction *trans, char *buffer, size_t buffer_size);
+typedef void (*SIGNAL_DECODER_DESTROY)(struct SignalDecoder *decoder);
+
+typedef struct SignalDecoder {
+	SIGNAL_DECODER_PROCESS	process;			// called on the history thread when any of the input signals changed
+	SIGNAL_DECODER_DESCRIBE	describe;			// textual representation of a transaction
+	SIGNAL_DECODER_DESTROY	destroy;
+
+	uint32_t				id;
+	size_t					transaction_capacity;			// size of the decoder's transaction ring buffer (0 = default)
+	uint64_t				signal_mask[SIGNAL_BLOCKS];		// input signals
+	uint64_t				last_value[SIGNAL_BLOCKS];		// signal values at the previous call (maintained by the history)
+	bool					primed;							// false until last_value is valid
+} SignalDecoder;
+
+typedef struct SignalTransactionRing {
+	size_t					capacity;
+	size_t					first;						// index of the oldest transaction
+	size_t					count;
+	SignalTransaction *		transactions;
+	int64_t					max_duration;
+} SignalTransactionRing;
+
 typedef struct SignalHistory {
 	bool					capture_active;
 
@@ -23,6 +69,17 @@ typedef struct SignalHistory {
 	size_t *				signal_samples_tail;		// offset of oldest sample for signal (relative to base)
 	int64_t *				samples_time;
 	bool *					samples_value;
+
+	// group channels: a group of signals stored as a single multi-bit value
+	size_t					group_count;
+	size_t *				group_samples_head;			// dynamic array: offset of newest sample for group (relative to base)
+	size_t *				group_samples_tail;			// dynamic array: offset of oldest sample for group (relative to base)
+	int64_t *				group_samples_time;			// dynamic array: sample_count entries per group
+	uint64_t *				group_samples_value;		// dynamic array: sample_count entries per group
+
+	// decoded transactions: a ring buffer per decoder (a busy decoder doesn't push out the transactions of another),
+	// ordered by time_end
+	SignalTransactionRing *	transaction_rings;			// dynamic array: one ring per decoder
 } SignalHistory;
 
 typedef struct SignalHistoryDiagramData {
@@ -33,6 +90,11 @@ typedef struct SignalHistoryDiagramData {
 	size_t *				signal_start_offsets;		// dynamic array
 	int64_t	*				samples_time;				// dynamic array
 	bool *					samples_value;				// dynamic array
+
+	uint32_t *				groups;						// dynamic array
+	size_t *				group_start_offsets;		// dynamic array
+	int64_t *				group_samples_time;			// dynamic array
+	uint64_t *				group_samples_value;		// dynamic array
 } SignalHistoryDiagramData;
 
 // forward declaration of private types
@@ -49,6 +111,44 @@ void signal_history_process_stop(SignalHistory *history);
 // signal_history_add: add batch changed signals to the history (called from simulator)
 bool signal_history_add(struct SignalHistory *history, int64_t time, uint64_t *signals_value, uint64_t *signals_changed, bool block);
 
+// signal_history_force_capture_all: store the value of all signals for the next added batch, not just the changed signals
+void signal_history_force_capture_all(struct SignalHistory *history);
+
+// capture masks: only changes of signals in the capture mask are stored in the history (default = all signals)
+//	- a mask is an array of SIGNAL_BLOCKS 64-bit values
+//	- the mask can be changed while capturing, signals that are added to the mask start with their current value
+void signal_history_capture_mask_set(SignalHistory *history, const uint64_t *capture_mask);
+void signal_history_capture_mask_reset(SignalHistory *history);
+void signal_history_capture_mask_add_signals(uint64_t *capture_mask, size_t count, const Signal *signals);
+void signal_history_capture_mask_add_profile(SignalHistory *history, uint32_t profile, uint64_t *capture_mask);
+
+// group channels: capture a group of signals (max 64) as one stream of values whenever any of its members changes
+//	- groups have to be created before capturing starts
+//	- only groups enabled in the group mask are captured (default = none)
+uint32_t signal_history_group_create(SignalHistory *history, const char *chip_name, const char *group_name, SignalGroup group);
+void signal_history_capture_groups_set(SignalHistory *history, uint64_t group_mask);
+
+const char **signal_history_group_names(SignalHistory *history);
+size_t signal_history_group_size(SignalHistory *history, uint32_t group);
+
+// decoders: convert captured signals into transactions (runs on the history processing thread)
+//	- decoders have to be added before capturing starts, the history takes ownership of the decoder
+//	- only decoders enabled in the decoder mask are run (default = none)
+uint32_t signal_history_decoder_add(SignalHistory *history, const char *chip_name, const char *decoder_name, SignalDecoder *decoder);
+void signal_history_capture_decoders_set(SignalHistory *history, uint64_t decoder_mask);
+
+const char **signal_history_decoder_names(SignalHistory *history);
+size_t signal_history_decoder_count(SignalHistory *history);
+
+// signal_history_transaction_add: store a decoded transaction (called by decoders)
+void signal_history_transaction_add(SignalHistory *history, const SignalTransaction *trans);
+
+// transaction queries
+//	- signal_history_transactions_range returns the transactions of all the decoders in the mask, ordered by time_end
+size_t signal_history_transaction_describe(SignalHistory *history, const SignalTransaction *trans, char *buffer, size_t buffer_size);
+void signal_history_transactions_range(SignalHistory *history, int64_t time_begin, int64_t time_end, uint64_t decoder_mask, SignalTransaction **transactions);
+bool signal_history_transaction_search(SignalHistory *history, const SignalTransactionQuery *query, int64_t from_time, bool forward, SignalTransaction *result);
+
 // signal_history_diagram_data: retrieve data to build an logic analyzer display in the UI
 void signal_history_diagram_data(SignalHistory *history, SignalHistoryDiagramData *diagram_data);
 void signal_history_diagram_release(SignalHistoryDiagramData *diagram_data);
@@ -0,0 +1,243 @@
+// signal_history_decoders.c - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Protocol decoders that turn captured signals into transactions
+
+#include "signal_history_decoders.h"
+#include "signal_history.h"
+#include "signal_line.h"
+
+#include "crt.h"
+
+#include <stb/stb_ds.h>
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// private types
+//
+
+#define DECODER_MAX_BITS	16
+
+typedef struct DecoderBits {
+	Signal		signals[DECODER_MAX_BITS];
+	size_t		count;
+} DecoderBits;
+
+typedef struct Decoder6502 {
+	SignalDecoder	base;
+
+	Signal			clk;
+	Signal			rw;
+	Signal			sync;
+	DecoderBits		address;
+	DecoderBits		data;
+
+	int64_t			cycle_start;
+} Decoder6502;
+
+typedef struct DecoderIeee488 {
+	SignalDecoder	base;
+
+	Signal			dav_b;
+	Signal			atn_b;
+	Signal			eoi_b;
+	DecoderBits		dio;
+
+	int64_t			latch_time;
+	SignalTransaction latched;
+} DecoderIeee488;
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// helper functions
+//
+
+static inline bool decoder_read(const uint64_t *signals_value, Signal signal) {
+	return (signals_value[signal.block] >> signal.index) & 1ull;
+}
+
+static inline bool decoder_pos_edge(SignalDecoder *decoder, const uint64_t *signals_value, Signal signal) {
+	return !decoder_read(decoder->last_value, signal) && decoder_read(signals_value, signal);
+}
+
+static inline bool decoder_neg_edge(SignalDecoder *decoder, const uint64_t *signals_value, Signal signal) {
+	return decoder_read(decoder->last_value, signal) && !decoder_read(signals_value, signal);
+}
+
+static inline uint32_t decoder_read_bits(const uint64_t *signals_value, DecoderBits *bits) {
+	uint32_t result = 0;
+
+	for (size_t i = 0; i < bits->count; ++i) {
+		result |= (uint32_t) decoder_read(signals_value, bits->signals[i]) << i;
+	}
+
+	return result;
+}
+
+static void decoder_init_bits(DecoderBits *bits, SignalGroup group) {
+	assert(signal_group_size(group) <= DECODER_MAX_BITS);
+
+	bits->count = signal_group_size(group);
+	for (size_t i = 0; i < bits->count; ++i) {
+		bits->signals[i] = *group[i];
+	}
+}
+
+static inline void decoder_add_signal(SignalDecoder *decoder, Signal signal) {
+	decoder->signal_mask[signal.block] |= 1ull << signal.index;
+}
+
+static void decoder_destroy(SignalDecoder *decoder) {
+	dms_free(decoder);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// MOS 6502 bus cycles
+//
+
+static void decoder_6502_process(SignalDecoder *decoder, SignalHistory *history, int64_t time, const uint64_t *signals_value) {
+	Decoder6502 *dec = (Decoder6502 *) decoder;
+
+	// the cpu latches the data bus on the negative edge of phase-2, the address lines are still valid at that point
+	if (!decoder_neg_edge(decoder, signals_value, dec->clk)) {
+		return;
+	}
+
+	SignalTransaction trans = {
+		.time_begin = dec->cycle_start,
+		.time_end = time,
+		.decoder = decoder->id,
+		.address = decoder_read_bits(signals_value, &dec->address),
+		.data = decoder_read_bits(signals_value, &dec->data)
+	};
+
+	if (!decoder_read(signals_value, dec->rw)) {
+		trans.type = DECODER_6502_WRITE;
+	} else if (decoder_read(signals_value, dec->sync)) {
+		trans.type = DECODER_6502_OPCODE_FETCH;
+	} else {
+		trans.type = DECODER_6502_READ;
+	}
+
+	if (trans.time_begin >= 0) {
+		signal_history_transaction_add(history, &trans);
+	}
+
+	dec->cycle_start = time + 1;
+}
+
+static size_t decoder_6502_describe(SignalDecoder *decoder, const SignalTransaction *trans, char *buffer, size_t buffer_size) {
+	(void) decoder;
+	static const char *type_prefix[] = {"R", "W", "F"};
+	assert(trans->type < sizeof(type_prefix) / sizeof(type_prefix[0]));
+
+	return (size_t) dms_snprintf(buffer, buffer_size, "%s %.4x:%.2x", type_prefix[trans->type], trans->address, trans->data);
+}
+
+SignalDecoder *signal_decoder_6502_create(Signal clk, Signal rw, Signal sync, SignalGroup address, SignalGroup data) {
+	Decoder6502 *dec = (Decoder6502 *) dms_calloc(1, sizeof(Decoder6502));
+
+	dec->base.process = decoder_6502_process;
+	dec->base.describe = decoder_6502_describe;
+	dec->base.destroy = decoder_destroy;
+	dec->base.transaction_capacity = 65536;			// one transaction per clock cycle: ~65 ms at 1 MHz
+
+	dec->clk = clk;
+	dec->rw = rw;
+	dec->sync = sync;
+	decoder_init_bits(&dec->address, address);
+	decoder_init_bits(&dec->data, data);
+
+	// rw/sync/address/data are sampled at the clock edge, only the clock has to trigger the decoder
+	decoder_add_signal(&dec->base, clk);
+
+	dec->cycle_start = -1;
+
+	return &dec->base;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// IEEE-488 bus
+//
+
+static void decoder_ieee488_process(SignalDecoder *decoder, SignalHistory *history, int64_t time, const uint64_t *signals_value) {
+	DecoderIeee488 *dec = (DecoderIeee488 *) decoder;
+
+	// talker asserts DAV when the data lines are valid
+	if (decoder_neg_edge(decoder, signals_value, dec->dav_b)) {
+		dec->latch_time = time;
+		dec->latched.data = ~decoder_read_bits(signals_value, &dec->dio) & 0xff;
+
+		if (!decoder_read(signals_value, dec->atn_b)) {
+			dec->latched.type = DECODER_IEEE488_COMMAND;
+		} else if (!decoder_read(signals_value, dec->eoi_b)) {
+			dec->latched.type = DECODER_IEEE488_DATA_EOI;
+		} else {
+			dec->latched.type = DECODER_IEEE488_DATA;
+		}
+		return;
+	}
+
+	// ... and releases it after all listeners accepted the byte
+	if (decoder_pos_edge(decoder, signals_value, dec->dav_b) && dec->latch_time >= 0) {
+		dec->latched.time_begin = dec->latch_time;
+		dec->latched.time_end = time;
+		dec->latched.decoder = decoder->id;
+		signal_history_transaction_add(history, &dec->latched);
+		dec->latch_time = -1;
+	}
+}
+
+static size_t decoder_ieee488_describe(SignalDecoder *decoder, const SignalTransaction *trans, char *buffer, size_t buffer_size) {
+	(void) decoder;
+
+	if (trans->type != DECODER_IEEE488_COMMAND) {
+		char c = (trans->data >= 0x20 && trans->data < 0x7f) ? (char) trans->data : '.';
+		return (size_t) dms_snprintf(buffer, buffer_size, "%.2x '%c'%s", trans->data, c, (trans->type == DECODER_IEEE488_DATA_EOI) ? " EOI" : "");
+	}
+
+	uint32_t device = trans->data & 0x1f;
+
+	switch (trans->data & 0xe0) {
+		case 0x20:
+			if (device == 0x1f) {
+				return (size_t) dms_snprintf(buffer, buffer_size, "UNLISTEN");
+			}
+			return (size_t) dms_snprintf(buffer, buffer_size, "LISTEN %u", device);
+		case 0x40:
+			if (device == 0x1f) {
+				return (size_t) dms_snprintf(buffer, buffer_size, "UNTALK");
+			}
+			return (size_t) dms_snprintf(buffer, buffer_size, "TALK %u", device);
+		case 0x60:
+			return (size_t) dms_snprintf(buffer, buffer_size, "SECONDARY %u", trans->data & 0x0f);
+		case 0xe0:
+			if ((trans->data & 0x10) == 0) {
+				return (size_t) dms_snprintf(buffer, buffer_size, "CLOSE %u", trans->data & 0x0f);
+			}
+			return (size_t) dms_snprintf(buffer, buffer_size, "OPEN %u", trans->data & 0x0f);
+		default:
+			return (size_t) dms_snprintf(buffer, buffer_size, "CMD %.2x", trans->data);
+	}
+}
+
+SignalDecoder *signal_decoder_ieee488_create(Signal dav_b, Signal atn_b, Signal eoi_b, SignalGroup dio) {
+	DecoderIeee488 *dec = (DecoderIeee488 *) dms_calloc(1, sizeof(DecoderIeee488));
+
+	dec->base.process = decoder_ieee488_process;
+	dec->base.describe = decoder_ieee488_describe;
+	dec->base.destroy = decoder_destroy;
+	dec->base.transaction_capacity = 4096;			// a few kilobytes per second on a busy bus
+
+	// data lines, ATN and EOI are latched when DAV changes
+	dec->dav_b = dav_b;
+	dec->atn_b = atn_b;
+	dec->eoi_b = eoi_b;
+	decoder_init_bits(&dec->dio, dio);
+	decoder_add_signal(&dec->base, dav_b);
+
+	dec->latch_time = -1;
+
+	return &dec->base;
+}
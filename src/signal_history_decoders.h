@@ -0,0 +1,40 @@
+// signal_history_decoders.h - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Protocol decoders that turn captured signals into transactions
+
+#ifndef DROMAIUS_SIGNAL_HISTORY_DECODERS_H
+#define DROMAIUS_SIGNAL_HISTORY_DECODERS_H
+
+#include "signal_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// forward declarations
+struct SignalDecoder;
+
+// types
+typedef enum SignalDecoder6502Type {
+	DECODER_6502_READ = 0,
+	DECODER_6502_WRITE = 1,
+	DECODER_6502_OPCODE_FETCH = 2,			// read cycle with SYNC asserted
+} SignalDecoder6502Type;
+
+typedef enum SignalDecoderIeee488Type {
+	DECODER_IEEE488_DATA = 0,
+	DECODER_IEEE488_DATA_EOI = 1,			// last byte of a transmission
+	DECODER_IEEE488_COMMAND = 2,			// byte sent with ATN asserted
+} SignalDecoderIeee488Type;
+
+// signal_decoder_6502_create: decode bus cycles at the end of each phase-2 clock (negative edge of clk)
+struct SignalDecoder *signal_decoder_6502_create(Signal clk, Signal rw, Signal sync, SignalGroup address, SignalGroup data);
+
+// signal_decoder_ieee488_create: decode the three-wire handshake, all signals are active low as on the bus
+struct SignalDecoder *signal_decoder_ieee488_create(Signal dav_b, Signal atn_b, Signal eoi_b, SignalGroup dio);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DROMAIUS_SIGNAL_HISTORY_DECODERS_H
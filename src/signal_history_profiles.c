@@ -2,6 +2,7 @@
 
 #include "signal_history_profiles.h"
 #include "signal_history.h"
+#include "signal_history_decoders.h"
 
 #include "dev_commodore_pet.h"
 
@@ -25,6 +26,20 @@ void dev_commodore_pet_history_profiles(struct DevCommodorePet *pet, const char
 		signal_history_profile_add_signal(history, prof_address, *pet->sg_cpu_address[i], NULL);
 	}
 
+	signal_history_group_create(history, chip_name, "Address Bus", pet->sg_cpu_address);
+	signal_history_group_create(history, chip_name, "Data Bus", pet->sg_cpu_data);
+	signal_history_group_create(history, chip_name, "Buffered Address Bus", pet->sg_buf_address);
+	signal_history_group_create(history, chip_name, "Buffered Data Bus", pet->sg_buf_data);
+
+	signal_history_decoder_add(history, chip_name, "6502 Bus Cycles",
+							   signal_decoder_6502_create(pet->signals[SIG_P2001N_CLK1], pet->signals[SIG_P2001N_RW], pet->signals[SIG_P2001N_SYNC],
+														  pet->sg_cpu_address, pet->sg_cpu_data));
+	SignalGroup sg_dio = signal_group_create_from_array(8, &pet->signals[SIG_P2001N_DIO0]);
+	signal_history_decoder_add(history, chip_name, "IEEE-488",
+							   signal_decoder_ieee488_create(pet->signals[SIG_P2001N_DAV_B], pet->signals[SIG_P2001N_ATN_B], pet->signals[SIG_P2001N_EOI_B],
+															 sg_dio));
+	signal_group_destroy(sg_dio);
+
 	uint32_t prof_video = signal_history_profile_create(history, chip_name, "Video");
 	signal_history_profile_add_signal(history, prof_video, pet->signals[SIG_P2001N_HORZ_DISP_ON], NULL);
 	signal_history_profile_add_signal(history, prof_video, pet->signals[SIG_P2001N_HORZ_DISP_OFF], NULL);
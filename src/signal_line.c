@@ -45,6 +45,14 @@ void signal_add_dependency(SignalPool *pool, Signal signal, int32_t chip_id) {
 	pool->dependent_components[signal_array_subscript(signal)] |= dep_mask;
 }
 
+void signal_remove_dependency(SignalPool *pool, Signal signal, int32_t chip_id) {
+	assert(pool);
+	assert(chip_id >= 0 && chip_id < 64);
+
+	uint64_t dep_mask = 1ull << chip_id;
+	pool->dependent_components[signal_array_subscript(signal)] &= ~dep_mask;
+}
+
 void signal_default(SignalPool *pool, Signal signal, bool value) {
 	assert(pool);
 
@@ -23,6 +23,7 @@ const char * signal_get_name(SignalPool *pool, Signal signal);
 Signal signal_by_name(SignalPool *pool, const char *name);
 
 void signal_add_dependency(SignalPool *pool, Signal signal, int32_t chip_id);
+void signal_remove_dependency(SignalPool *pool, Signal signal, int32_t chip_id);
 
 void signal_default(SignalPool *pool, Signal signal, bool value);
 
@@ -258,6 +259,7 @@ static inline bool signal_group_changed(SignalPool *pool, SignalGroup sg) {
 	}
 
 #define SIGNAL_DEPENDENCY(sig)				signal_add_dependency(SIGNAL_POOL, SIGNAL(sig), SIGNAL_CHIP_ID)
+#define SIGNAL_NO_DEPENDENCY(sig)			signal_remove_dependency(SIGNAL_POOL, SIGNAL(sig), SIGNAL_CHIP_ID)
 
 #define SIGNAL_READ(sig)					signal_read(SIGNAL_POOL, SIGNAL(sig))
 #define SIGNAL_READ_NEXT(sig)				signal_read_next(SIGNAL_POOL, SIGNAL(sig))
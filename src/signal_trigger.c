@@ -0,0 +1,328 @@
+// signal_trigger.c - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Trigger engine that limits signal history capture to the window around an event of interest
+
+#include "signal_trigger.h"
+#include "signal_history.h"
+#include "signal_line.h"
+
+#include "crt.h"
+#include "sys/atomics.h"
+
+#include <stb/stb_ds.h>
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// private types
+//
+
+typedef enum SignalTriggerRequest {
+	REQUEST_NONE = 0,
+	REQUEST_ARM,
+	REQUEST_DISARM
+} SignalTriggerRequest;
+
+typedef struct SignalTrigger_private {
+	SignalTrigger		public;
+
+	atomic_uint32_t		state;						// SignalTriggerState: written by the simulator thread, read by any thread
+
+	// pending request: set by another thread, applied by the simulator thread
+	flag_t				lock_request;
+	atomic_uint32_t		request;					// SignalTriggerRequest
+	SignalTriggerStage *request_stages;				// dynamic array
+	size_t				request_pre_depth;
+	size_t				request_post_depth;
+} SignalTrigger_private;
+
+#define PRIVATE(trigger)	((SignalTrigger_private *) (trigger))
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// private functions
+//
+
+static inline bool trigger_stage_matches(SignalTriggerStage *stage, uint64_t *signals_value, uint64_t *signals_changed) {
+
+	uint64_t edge_used = 0;
+	uint64_t edge_hit = 0;
+	uint64_t value_changed = 0;
+
+	for (int blk = 0; blk < SIGNAL_BLOCKS; ++blk) {
+		if ((signals_value[blk] & stage->value_mask[blk]) != stage->value_match[blk]) {
+			return false;
+		}
+
+		edge_used |= stage->pos_edge[blk] | stage->neg_edge[blk];
+		edge_hit |= signals_changed[blk] & ((signals_value[blk] & stage->pos_edge[blk]) | (~signals_value[blk] & stage->neg_edge[blk]));
+		value_changed |= signals_changed[blk] & stage->value_mask[blk];
+	}
+
+	// a stage with edges matches when any of its edges occurs (and the values match)
+	// a stage with only values matches when the values start to match
+	return (edge_used) ? edge_hit != 0 : value_changed != 0;
+}
+
+static inline void trigger_pre_buffer_push(SignalTrigger *trigger, int64_t time, uint64_t *signals_value, uint64_t *signals_changed) {
+
+	if (trigger->pre_trigger_depth == 0) {
+		return;
+	}
+
+	trigger->pre_head = (trigger->pre_head + 1) % trigger->pre_trigger_depth;
+	trigger->pre_used = MIN(trigger->pre_used + 1, trigger->pre_trigger_depth);
+
+	trigger->pre_time[trigger->pre_head] = time;
+	dms_memcpy(trigger->pre_value + (trigger->pre_head * SIGNAL_BLOCKS), signals_value, sizeof(uint64_t) * SIGNAL_BLOCKS);
+	dms_memcpy(trigger->pre_changed + (trigger->pre_head * SIGNAL_BLOCKS), signals_changed, sizeof(uint64_t) * SIGNAL_BLOCKS);
+}
+
+static void trigger_pre_buffer_flush(SignalTrigger *trigger, SignalHistory *history) {
+
+	// oldest entry first; the history should start with a full snapshot of all signals
+	signal_history_force_capture_all(history);
+
+	size_t idx = (trigger->pre_head + trigger->pre_trigger_depth + 1 - trigger->pre_used) % MAX(trigger->pre_trigger_depth, 1);
+
+	for (size_t i = 0; i < trigger->pre_used; ++i) {
+		signal_history_add(history, trigger->pre_time[idx],
+						   trigger->pre_value + (idx * SIGNAL_BLOCKS),
+						   trigger->pre_changed + (idx * SIGNAL_BLOCKS),
+						   true);
+		idx = (idx + 1) % trigger->pre_trigger_depth;
+	}
+
+	trigger->pre_used = 0;
+}
+
+static void trigger_free_pre_buffer(SignalTrigger *trigger) {
+	dms_free(trigger->pre_time);
+	dms_free(trigger->pre_value);
+	dms_free(trigger->pre_changed);
+	trigger->pre_time = NULL;
+	trigger->pre_value = NULL;
+	trigger->pre_changed = NULL;
+}
+
+static inline void trigger_set_state(SignalTrigger *trigger, SignalTriggerState state) {
+	atomic_exchange_uint32(&PRIVATE(trigger)->state, state);
+}
+
+static void trigger_apply_request(SignalTrigger *trigger) {
+	// runs on the simulator thread
+	SignalTrigger_private *priv = PRIVATE(trigger);
+
+	flag_acquire_lock(&priv->lock_request);
+
+	// the configuration only changes while the trigger is disabled
+	trigger_set_state(trigger, TRIGGER_DISABLED);
+
+	if (priv->request == REQUEST_ARM) {
+		arrfree(trigger->stages);
+		trigger->stages = priv->request_stages;
+		priv->request_stages = NULL;
+
+		signal_trigger_set_depth(trigger, priv->request_pre_depth, priv->request_post_depth);
+		signal_trigger_arm(trigger);
+	}
+
+	atomic_exchange_uint32(&priv->request, REQUEST_NONE);
+	flag_release_lock(&priv->lock_request);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// interface
+//
+
+SignalTrigger *signal_trigger_create(void) {
+	SignalTrigger *trigger = (SignalTrigger *) dms_calloc(1, sizeof(SignalTrigger_private));
+	trigger->trigger_time = -1;
+	return trigger;
+}
+
+void signal_trigger_destroy(SignalTrigger *trigger) {
+	assert(trigger);
+
+	trigger_free_pre_buffer(trigger);
+	arrfree(trigger->stages);
+	arrfree(PRIVATE(trigger)->request_stages);
+	dms_free(PRIVATE(trigger));
+}
+
+void signal_trigger_set_depth(SignalTrigger *trigger, size_t pre_trigger_depth, size_t post_trigger_depth) {
+	assert(trigger);
+	assert(signal_trigger_state(trigger) != TRIGGER_ARMED && signal_trigger_state(trigger) != TRIGGER_CAPTURING);
+
+	if (pre_trigger_depth != trigger->pre_trigger_depth) {
+		trigger_free_pre_buffer(trigger);
+
+		if (pre_trigger_depth > 0) {
+			trigger->pre_time = (int64_t *) dms_malloc(sizeof(int64_t) * pre_trigger_depth);
+			trigger->pre_value = (uint64_t *) dms_malloc(sizeof(uint64_t) * SIGNAL_BLOCKS * pre_trigger_depth);
+			trigger->pre_changed = (uint64_t *) dms_malloc(sizeof(uint64_t) * SIGNAL_BLOCKS * pre_trigger_depth);
+		}
+	}
+
+	trigger->pre_trigger_depth = pre_trigger_depth;
+	trigger->post_trigger_depth = post_trigger_depth;
+	trigger->pre_head = 0;
+	trigger->pre_used = 0;
+}
+
+void signal_trigger_clear_stages(SignalTrigger *trigger) {
+	assert(trigger);
+	assert(signal_trigger_state(trigger) != TRIGGER_ARMED && signal_trigger_state(trigger) != TRIGGER_CAPTURING);
+
+	arrfree(trigger->stages);
+}
+
+uint32_t signal_trigger_stage_add(SignalTrigger *trigger, uint32_t count) {
+	assert(trigger);
+	assert(signal_trigger_state(trigger) != TRIGGER_ARMED && signal_trigger_state(trigger) != TRIGGER_CAPTURING);
+
+	SignalTriggerStage stage = {
+		.count = MAX(count, 1u)
+	};
+	arrpush(trigger->stages, stage);
+
+	return (uint32_t) (arrlenu(trigger->stages) - 1);
+}
+
+void signal_trigger_stage_edge(SignalTrigger *trigger, uint32_t stage, Signal signal, bool pos_edge, bool neg_edge) {
+	assert(trigger);
+	assert(stage < arrlenu(trigger->stages));
+
+	uint64_t mask = 1ull << signal.index;
+	SignalTriggerStage *ts = &trigger->stages[stage];
+	FLAG_SET_CLEAR_U64(ts->pos_edge[signal.block], mask, pos_edge);
+	FLAG_SET_CLEAR_U64(ts->neg_edge[signal.block], mask, neg_edge);
+}
+
+void signal_trigger_stage_signal_value(SignalTrigger *trigger, uint32_t stage, Signal signal, bool value) {
+	assert(trigger);
+	assert(stage < arrlenu(trigger->stages));
+
+	uint64_t mask = 1ull << signal.index;
+	SignalTriggerStage *ts = &trigger->stages[stage];
+	ts->value_mask[signal.block] |= mask;
+	FLAG_SET_CLEAR_U64(ts->value_match[signal.block], mask, value);
+}
+
+void signal_trigger_stage_group_value(SignalTrigger *trigger, uint32_t stage, SignalGroup group, uint64_t value) {
+	assert(trigger);
+	assert(stage < arrlenu(trigger->stages));
+
+	for (size_t i = 0; i < signal_group_size(group); ++i) {
+		signal_trigger_stage_signal_value(trigger, stage, *group[i], (value >> i) & 1);
+	}
+}
+
+void signal_trigger_arm(SignalTrigger *trigger) {
+	assert(trigger);
+
+	trigger->current_stage = 0;
+	trigger->current_count = 0;
+	trigger->pre_head = 0;
+	trigger->pre_used = 0;
+	trigger->trigger_time = -1;
+	trigger_set_state(trigger, TRIGGER_ARMED);
+}
+
+void signal_trigger_disarm(SignalTrigger *trigger) {
+	assert(trigger);
+	trigger_set_state(trigger, TRIGGER_DISABLED);
+}
+
+SignalTriggerState signal_trigger_state(SignalTrigger *trigger) {
+	assert(trigger);
+	return (SignalTriggerState) atomic_load_uint32(&PRIVATE(trigger)->state);
+}
+
+void signal_trigger_request_arm(SignalTrigger *trigger, const SignalTrigger *config) {
+	assert(trigger);
+	assert(config);
+
+	SignalTrigger_private *priv = PRIVATE(trigger);
+
+	flag_acquire_lock(&priv->lock_request);
+
+	arrsetlen(priv->request_stages, arrlenu(config->stages));
+	if (arrlenu(config->stages) > 0) {
+		dms_memcpy(priv->request_stages, config->stages, sizeof(SignalTriggerStage) * arrlenu(config->stages));
+	}
+	priv->request_pre_depth = config->pre_trigger_depth;
+	priv->request_post_depth = config->post_trigger_depth;
+	atomic_exchange_uint32(&priv->request, REQUEST_ARM);
+
+	flag_release_lock(&priv->lock_request);
+}
+
+void signal_trigger_request_disarm(SignalTrigger *trigger) {
+	assert(trigger);
+
+	flag_acquire_lock(&PRIVATE(trigger)->lock_request);
+	atomic_exchange_uint32(&PRIVATE(trigger)->request, REQUEST_DISARM);
+	flag_release_lock(&PRIVATE(trigger)->lock_request);
+}
+
+bool signal_trigger_request_pending(SignalTrigger *trigger) {
+	assert(trigger);
+	return atomic_load_uint32(&PRIVATE(trigger)->request) != REQUEST_NONE;
+}
+
+void signal_trigger_apply_request(SignalTrigger *trigger) {
+	// runs on the simulator thread
+	assert(trigger);
+
+	if (atomic_load_uint32_relaxed(&PRIVATE(trigger)->request) != REQUEST_NONE) {
+		trigger_apply_request(trigger);
+	}
+}
+
+void signal_trigger_process(SignalTrigger *trigger, SignalHistory *history, int64_t time, uint64_t *signals_value, uint64_t *signals_changed) {
+	// runs on the simulator thread
+	assert(trigger);
+	assert(history);
+
+	signal_trigger_apply_request(trigger);
+
+	switch (signal_trigger_state(trigger)) {
+		case TRIGGER_DISABLED:
+			signal_history_add(history, time, signals_value, signals_changed, true);
+			break;
+
+		case TRIGGER_ARMED:
+			if (trigger->current_stage < arrlenu(trigger->stages) &&
+				trigger_stage_matches(&trigger->stages[trigger->current_stage], signals_value, signals_changed)) {
+				if (++trigger->current_count >= trigger->stages[trigger->current_stage].count) {
+					trigger->current_stage += 1;
+					trigger->current_count = 0;
+				}
+			}
+
+			if (arrlenu(trigger->stages) == 0 || trigger->current_stage < arrlenu(trigger->stages)) {
+				trigger_pre_buffer_push(trigger, time, signals_value, signals_changed);
+				break;
+			}
+
+			// trigger fired
+			trigger->trigger_time = time;
+			trigger_pre_buffer_flush(trigger, history);
+			signal_history_add(history, time, signals_value, signals_changed, true);
+
+			trigger->post_trigger_left = trigger->post_trigger_depth;
+			trigger_set_state(trigger, (trigger->post_trigger_left > 0) ? TRIGGER_CAPTURING : TRIGGER_DONE);
+			break;
+
+		case TRIGGER_CAPTURING:
+			signal_history_add(history, time, signals_value, signals_changed, true);
+			if (--trigger->post_trigger_left == 0) {
+				trigger_set_state(trigger, TRIGGER_DONE);
+			}
+			break;
+
+		case TRIGGER_DONE:
+			break;
+	}
+}
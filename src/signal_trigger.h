@@ -0,0 +1,91 @@
+// signal_trigger.h - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Trigger engine that limits signal history capture to the window around an event of interest
+
+#ifndef DROMAIUS_SIGNAL_TRIGGER_H
+#define DROMAIUS_SIGNAL_TRIGGER_H
+
+#include "signal_types.h"
+#include "signal_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// forward declarations
+struct SignalHistory;
+
+// types
+typedef enum SignalTriggerState {
+	TRIGGER_DISABLED = 0,			// trigger not used: every timestep is forwarded to the signal history
+	TRIGGER_ARMED,					// waiting for the trigger condition, timesteps are kept in the pre-trigger buffer
+	TRIGGER_CAPTURING,				// trigger fired, forwarding the post-trigger timesteps to the signal history
+	TRIGGER_DONE					// capture complete, nothing is forwarded to the signal history anymore
+} SignalTriggerState;
+
+typedef struct SignalTriggerStage {
+	uint64_t	pos_edge[SIGNAL_BLOCKS];		// signals that match on a positive edge
+	uint64_t	neg_edge[SIGNAL_BLOCKS];		// signals that match on a negative edge
+	uint64_t	value_mask[SIGNAL_BLOCKS];		// signals that have to have a specific value ...
+	uint64_t	value_match[SIGNAL_BLOCKS];		// ... and the value they should have
+
+	uint32_t	count;							// number of times the condition has to match before advancing to the next stage
+} SignalTriggerStage;
+
+typedef struct SignalTrigger {
+	SignalTriggerStage *stages;					// dynamic array
+	uint32_t			current_stage;
+	uint32_t			current_count;
+
+	size_t				pre_trigger_depth;		// number of timesteps kept from before the trigger
+	size_t				post_trigger_depth;		// number of timesteps captured after the trigger
+	size_t				post_trigger_left;
+
+	int64_t				trigger_time;			// timestamp when the trigger fired (-1 when it hasn't fired yet)
+
+	// pre-trigger circular buffer
+	size_t				pre_head;
+	size_t				pre_used;
+	int64_t *			pre_time;
+	uint64_t *			pre_value;				// pre_trigger_depth * SIGNAL_BLOCKS entries
+	uint64_t *			pre_changed;			// pre_trigger_depth * SIGNAL_BLOCKS entries
+} SignalTrigger;
+
+// construction
+SignalTrigger *signal_trigger_create(void);
+void signal_trigger_destroy(SignalTrigger *trigger);
+
+// configuration - only change the trigger when it isn't armed, from the thread that processes the trigger
+void signal_trigger_set_depth(SignalTrigger *trigger, size_t pre_trigger_depth, size_t post_trigger_depth);
+void signal_trigger_clear_stages(SignalTrigger *trigger);
+
+uint32_t signal_trigger_stage_add(SignalTrigger *trigger, uint32_t count);
+void signal_trigger_stage_edge(SignalTrigger *trigger, uint32_t stage, Signal signal, bool pos_edge, bool neg_edge);
+void signal_trigger_stage_signal_value(SignalTrigger *trigger, uint32_t stage, Signal signal, bool value);
+void signal_trigger_stage_group_value(SignalTrigger *trigger, uint32_t stage, SignalGroup group, uint64_t value);
+
+// control - from the thread that processes the trigger
+void signal_trigger_arm(SignalTrigger *trigger);
+void signal_trigger_disarm(SignalTrigger *trigger);
+
+SignalTriggerState signal_trigger_state(SignalTrigger *trigger);
+
+// requests from another thread (e.g. the UI), applied by the simulator thread before it processes the next timestep
+//	- signal_trigger_request_arm copies the stages and depths of 'config' (a trigger that is never armed itself)
+//	- a new request replaces a request that wasn't applied yet
+void signal_trigger_request_arm(SignalTrigger *trigger, const SignalTrigger *config);
+void signal_trigger_request_disarm(SignalTrigger *trigger);
+bool signal_trigger_request_pending(SignalTrigger *trigger);
+
+// signal_trigger_apply_request: apply the pending request (called from simulator each timestep, also when not capturing)
+void signal_trigger_apply_request(SignalTrigger *trigger);
+
+// signal_trigger_process: evaluate the trigger for a timestep and feed the signal history as needed (called from simulator)
+//	- applies the pending request first
+void signal_trigger_process(SignalTrigger *trigger, struct SignalHistory *history, int64_t time, uint64_t *signals_value, uint64_t *signals_changed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DROMAIUS_SIGNAL_TRIGGER_H
@@ -7,6 +7,7 @@
 #include "crt.h"
 #include "signal_line.h"
 #include "signal_history.h"
+#include "signal_trigger.h"
 
 #include <stb/stb_ds.h>
 #include <assert.h>
@@ -16,10 +17,16 @@
 // types
 //
 
+typedef struct ChipNameMap {
+	char *					key;
+	Chip *					value;
+} ChipNameMap;
+
 typedef struct Simulator_private {
 	Simulator				public;
 
 	Chip **					chips;
+	ChipNameMap *			chip_names;				// hashmap name -> chip
 	uint64_t				dirty_chips;
 	uint64_t				layer_chips[SIGNAL_LAYERS];
 
@@ -84,6 +91,7 @@ Simulator *simulator_create(int64_t tick_duration_ps) {
 
 	PUBLIC(priv_sim)->signal_pool = signal_pool_create();
 	PUBLIC(priv_sim)->tick_duration_ps = tick_duration_ps;
+	sh_new_arena(priv_sim->chip_names);
 
 	return &priv_sim->public;
 }
@@ -99,12 +107,17 @@ void simulator_destroy(Simulator *sim) {
 	simulator_free_event_list(PRIVATE(sim)->event_pool);
 
 	arrfree(PRIVATE(sim)->chips);
+	shfree(PRIVATE(sim)->chip_names);
 
 	if (sim->signal_history) {
 		signal_history_process_stop(sim->signal_history);
 		signal_history_destroy(sim->signal_history);
 	}
 
+	if (sim->signal_trigger) {
+		signal_trigger_destroy(sim->signal_trigger);
+	}
+
 	signal_pool_destroy(sim->signal_pool);
 	dms_free(PRIVATE(sim));
 }
@@ -119,6 +132,11 @@ Chip *simulator_register_chip(Simulator *sim, Chip *chip, const char *name) {
 	arrpush(PRIVATE(sim)->chips, chip);
 	PRIVATE(sim)->dirty_chips |= 1ull << chip->id;
 
+	// keep the first chip registered with a name
+	if (name && shgeti(PRIVATE(sim)->chip_names, name) < 0) {
+		shput(PRIVATE(sim)->chip_names, name, chip);
+	}
+
 	return chip;
 }
 
@@ -126,13 +144,7 @@ Chip *simulator_chip_by_name(Simulator *sim, const char *name) {
 	assert(sim);
 	assert(name);
 
-	for (int32_t id = 0; id < arrlen(PRIVATE(sim)->chips); ++id) {
-		if (strcmp(PRIVATE(sim)->chips[id]->name, name) == 0) {
-			return PRIVATE(sim)->chips[id];
-		}
-	}
-
-	return NULL;
+	return shget(PRIVATE(sim)->chip_names, name);
 }
 
 const char *simulator_chip_name(Simulator *sim, int32_t chip_id) {
@@ -173,6 +185,7 @@ void simulator_device_complete(Simulator *sim) {
 	}
 
 	sim->signal_history = signal_history_create(32, sim->signal_pool->signals_count, 256, sim->tick_duration_ps);
+	sim->signal_trigger = signal_trigger_create();
 }
 
 void simulator_simulate_timestep(Simulator *sim) {
@@ -195,8 +208,11 @@ void simulator_simulate_timestep(Simulator *sim) {
 	// determine changed signals and dirty chips for next simulation step
 	PRIVATE(sim)->dirty_chips = signal_pool_cycle(sim->signal_pool);
 
+	// requests from the UI are applied even when not capturing, or they would stay pending
+	signal_trigger_apply_request(sim->signal_trigger);
+
 	if (sim->signal_history->capture_active) {
-		signal_history_add(sim->signal_history, sim->current_tick, sim->signal_pool->signals_value, sim->signal_pool->signals_changed, true);
+		signal_trigger_process(sim->signal_trigger, sim->signal_history, sim->current_tick, sim->signal_pool->signals_value, sim->signal_pool->signals_changed);
 	}
 }
 
@@ -29,6 +29,11 @@ typedef struct Simulator {
 
 	// signal history
 	struct SignalHistory *	signal_history;
+	struct SignalTrigger *	signal_trigger;
+
+	// warp mode: run as fast as possible while a peripheral is transferring data
+	uint64_t		warp_requests;			// one bit for each chip (by id) that requests warp mode
+	bool			warp_active;			// set by the context when it stopped synchronizing with real-time
 } Simulator;
 
 struct Chip;
@@ -55,6 +60,11 @@ static inline int64_t simulator_interval_to_tick_count(Simulator *sim, int64_t i
 	return interval_ps / sim->tick_duration_ps;
 }
 
+// warp mode
+static inline void simulator_request_warp(Simulator *sim, int32_t chip_id, bool warp) {
+	FLAG_SET_CLEAR_U64(sim->warp_requests, 1ull << chip_id, warp);
+}
+
 
 #ifdef __cplusplus
 }
@@ -5,6 +5,9 @@
 #include "stopwatch.h"
 #include "crt.h"
 
+#define GRANULARITY_SAMPLES		8
+#define GRANULARITY_INTERVAL_PS	US_TO_PS(100)
+
 #undef DMS_TIMER_WIN32
 #undef DMS_TIMER_POSIX
 
@@ -133,3 +136,31 @@ int64_t stopwatch_time_elapsed_ps(Stopwatch *stopwatch) {
 void stopwatch_sleep(int64_t interval_ps) {
 	stopwatch_platform_sleep(interval_ps);
 }
+
+int64_t stopwatch_timestamp_ps(void) {
+	return timestamp_current();
+}
+
+int64_t stopwatch_sleep_granularity_ps(void) {
+	int64_t result = 0;
+
+	for (int i = 0; i < GRANULARITY_SAMPLES; ++i) {
+		int64_t start = timestamp_current();
+		stopwatch_platform_sleep(GRANULARITY_INTERVAL_PS);
+		result = MAX(result, timestamp_current() - start - GRANULARITY_INTERVAL_PS);
+	}
+
+	return result;
+}
+
+void stopwatch_sleep_precise(int64_t interval_ps, int64_t margin_ps) {
+	int64_t deadline = timestamp_current() + interval_ps;
+
+	if (interval_ps > margin_ps) {
+		stopwatch_platform_sleep(interval_ps - margin_ps);
+	}
+
+	while (timestamp_current() < deadline) {
+		// spin
+	}
+}
@@ -28,6 +28,15 @@ int64_t stopwatch_time_elapsed_ps(Stopwatch *stopwatch);
 
 void stopwatch_sleep(int64_t interval_ps);
 
+// stopwatch_timestamp_ps: monotonic host time
+int64_t stopwatch_timestamp_ps(void);
+
+// stopwatch_sleep_granularity_ps: measure how far a short sleep overshoots on this host (worst of a few samples)
+int64_t stopwatch_sleep_granularity_ps(void);
+
+// stopwatch_sleep_precise: sleep until 'margin_ps' before the end of the interval and spin for the remainder
+void stopwatch_sleep_precise(int64_t interval_ps, int64_t margin_ps);
+
 #ifdef __cplusplus
 }
 #endif
@@ -51,6 +51,22 @@ static inline uint_least32_t atomic_load_uint32(volatile atomic_uint32_t *obj) {
 	return atomic_load(obj);
 }
 
+static inline uint_least32_t atomic_load_uint32_relaxed(volatile atomic_uint32_t *obj) {
+	return atomic_load_explicit(obj, memory_order_relaxed);
+}
+
+static inline void atomic_store_uint32_relaxed(volatile atomic_uint32_t *obj, uint32_t desired) {
+	atomic_store_explicit(obj, desired, memory_order_relaxed);
+}
+
+static inline void atomic_fence_acquire(void) {
+	atomic_thread_fence(memory_order_acquire);
+}
+
+static inline void atomic_fence_release(void) {
+	atomic_thread_fence(memory_order_release);
+}
+
 #endif // DMS_ATOMICS_C11
 
 //////////////////////////////////////////////////////////////////////////////
@@ -84,6 +100,22 @@ static inline uint_least32_t atomic_load_uint32(volatile atomic_uint32_t *obj) {
 	return InterlockedOr((volatile LONG *) obj, 0);
 }
 
+static inline uint_least32_t atomic_load_uint32_relaxed(volatile atomic_uint32_t *obj) {
+	return *obj;
+}
+
+static inline void atomic_store_uint32_relaxed(volatile atomic_uint32_t *obj, uint32_t desired) {
+	*obj = desired;
+}
+
+static inline void atomic_fence_acquire(void) {
+	MemoryBarrier();
+}
+
+static inline void atomic_fence_release(void) {
+	MemoryBarrier();
+}
+
 #endif // DMS_ATOMICS_WIN32
 
 #endif // DROMAIUS_SYS_ATOMICS_H
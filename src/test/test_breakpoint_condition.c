@@ -0,0 +1,180 @@
+// test/test_breakpoint_condition.c - Johan Smet - BSD-3-Clause (see LICENSE)
+
+#include "munit/munit.h"
+
+#include "breakpoint_condition.h"
+#include "cpu.h"
+#include "device.h"
+#include "signal_pool.h"
+#include "signal_line.h"
+
+#include <string.h>
+
+// minimal cpu and device that expose a few registers and 256 bytes of memory
+typedef struct TestCpu {
+	CPU_DECLARE_FUNCTIONS
+	int64_t		registers[3];
+} TestCpu;
+
+typedef struct TestDevice {
+	DEVICE_DECLARE_FUNCTIONS
+	uint8_t		memory[256];
+} TestDevice;
+
+typedef struct ConditionFixture {
+	TestCpu		cpu;
+	TestDevice	device;
+	SignalPool *pool;
+	Signal		sig_rw;
+} ConditionFixture;
+
+static int32_t test_cpu_register_index(TestCpu *cpu, const char *name) {
+	static const char *names[] = {"A", "X", "Y"};
+	for (int32_t i = 0; i < 3; ++i) {
+		if (strcmp(names[i], name) == 0) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+static int64_t test_cpu_register_value(TestCpu *cpu, int32_t index) {
+	return cpu->registers[index];
+}
+
+static void test_device_read_memory(TestDevice *device, size_t start_address, size_t size, uint8_t *output) {
+	for (size_t i = 0; i < size; ++i) {
+		output[i] = device->memory[(start_address + i) & 0xff];
+	}
+}
+
+static void *breakpoint_condition_setup(const MunitParameter params[], void *user_data) {
+	ConditionFixture *fixture = (ConditionFixture *) calloc(1, sizeof(ConditionFixture));
+
+	fixture->cpu.register_index = (CPU_REGISTER_INDEX) test_cpu_register_index;
+	fixture->cpu.register_value = (CPU_REGISTER_VALUE) test_cpu_register_value;
+	fixture->device.read_memory = (DEVICE_READ_MEMORY) test_device_read_memory;
+
+	fixture->pool = signal_pool_create();
+	fixture->sig_rw = signal_create(fixture->pool);
+	signal_set_name(fixture->pool, fixture->sig_rw, "RW");
+
+	return fixture;
+}
+
+static void breakpoint_condition_teardown(void *fixture) {
+	signal_pool_destroy(((ConditionFixture *) fixture)->pool);
+	free(fixture);
+}
+
+static bool evaluate(ConditionFixture *fixture, const char *source) {
+	const char *error = NULL;
+	BreakpointCondition *cond = breakpoint_condition_compile(source, (Cpu *) &fixture->cpu, fixture->pool, &error);
+	munit_assert_not_null(cond);
+	munit_assert_null(error);
+	munit_assert_string_equal(cond->source, source);
+
+	bool result = breakpoint_condition_evaluate(cond, (Cpu *) &fixture->cpu, (Device *) &fixture->device, fixture->pool);
+	breakpoint_condition_destroy(cond);
+	return result;
+}
+
+static MunitResult test_expressions(const MunitParameter params[], void* user_data_or_fixture) {
+	ConditionFixture *fixture = (ConditionFixture *) user_data_or_fixture;
+
+	fixture->cpu.registers[0] = 0x0d;
+	fixture->cpu.registers[1] = 5;
+	fixture->cpu.registers[2] = 0;
+
+	// numbers & registers
+	munit_assert_true(evaluate(fixture, "1"));
+	munit_assert_false(evaluate(fixture, "0"));
+	munit_assert_true(evaluate(fixture, "A == $0d"));
+	munit_assert_true(evaluate(fixture, "A = 0x0D"));
+	munit_assert_true(evaluate(fixture, "A == 13"));
+	munit_assert_true(evaluate(fixture, "A == %1101"));
+	munit_assert_false(evaluate(fixture, "Y"));
+
+	// precedence
+	munit_assert_true(evaluate(fixture, "A == $0d && X > 3"));
+	munit_assert_false(evaluate(fixture, "A == $0d && X > 5"));
+	munit_assert_true(evaluate(fixture, "A == 1 || X >= 5"));
+	munit_assert_true(evaluate(fixture, "1 + 2 * 3 == 7"));
+	munit_assert_true(evaluate(fixture, "(1 + 2) * 3 == 9"));
+	munit_assert_true(evaluate(fixture, "A & $0c | 1 == 13"));
+	munit_assert_true(evaluate(fixture, "X % 2 == 1 && X / 2 == 2 && X - 6 == -1"));
+	munit_assert_true(evaluate(fixture, "!Y && (~A & $ff) == $f2"));
+	munit_assert_true(evaluate(fixture, "(A ^ $0f) == 2 && X != Y && Y < X && X <= 5"));
+	munit_assert_false(evaluate(fixture, "X / Y"));
+
+	// arithmetic wraps around instead of overflowing
+	munit_assert_true(evaluate(fixture, "$7fffffffffffffff + 1 == -$7fffffffffffffff - 1"));
+	munit_assert_true(evaluate(fixture, "$7fffffffffffffff * 2 == -2"));
+	munit_assert_true(evaluate(fixture, "-(-$7fffffffffffffff - 1) == -$7fffffffffffffff - 1"));
+	munit_assert_true(evaluate(fixture, "(-$7fffffffffffffff - 1) / -1 == -$7fffffffffffffff - 1"));
+	munit_assert_false(evaluate(fixture, "(-$7fffffffffffffff - 1) % -1"));
+	munit_assert_true(evaluate(fixture, "-7 / -1 == 7"));
+
+	// memory
+	fixture->device.memory[0x10] = 0x42;
+	fixture->device.memory[0x42] = 0x99;
+	munit_assert_true(evaluate(fixture, "[$10] == $42"));
+	munit_assert_true(evaluate(fixture, "[[$10]] == $99"));
+	munit_assert_true(evaluate(fixture, "[$0b + X] == $42"));
+
+	// signals
+	munit_assert_false(evaluate(fixture, "RW"));
+	signal_write(fixture->pool, fixture->sig_rw, true);
+	signal_pool_cycle(fixture->pool);
+	munit_assert_true(evaluate(fixture, "RW && A"));
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_errors(const MunitParameter params[], void* user_data_or_fixture) {
+	ConditionFixture *fixture = (ConditionFixture *) user_data_or_fixture;
+
+	static const char *invalid[] = {
+		"",
+		"A ==",
+		"(A == 1",
+		"[$10",
+		"B == 1",
+		"A == 1 2",
+		"A # 1",
+		"$",
+		"1+(1+(1+(1+(1+(1+(1+(1+(1+(1+(1+(1+(1+(1+(1+(1+(1+1))))))))))))))))"
+	};
+
+	for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i) {
+		const char *error = NULL;
+		BreakpointCondition *cond = breakpoint_condition_compile(invalid[i], (Cpu *) &fixture->cpu, fixture->pool, &error);
+		munit_assert_null(cond);
+		munit_assert_not_null(error);
+	}
+
+	// deeply nested expressions are rejected before they exhaust the stack of the parser
+	static char nested[100001];
+	static const char nesting[] = {'(', '[', '-', '!', '~'};
+
+	for (size_t n = 0; n < sizeof(nesting); ++n) {
+		memset(nested, nesting[n], sizeof(nested) - 2);
+		nested[sizeof(nested) - 2] = '1';
+		nested[sizeof(nested) - 1] = '\0';
+
+		const char *error = NULL;
+		munit_assert_null(breakpoint_condition_compile(nested, (Cpu *) &fixture->cpu, fixture->pool, &error));
+		munit_assert_string_equal(error, "expression nested too deeply");
+	}
+
+	// a few levels are fine
+	munit_assert_true(evaluate(fixture, "-((!!~~[[(0)]])) == 0 && --(((1))) == 1"));
+
+    return MUNIT_OK;
+}
+
+MunitTest breakpoint_condition_tests[] = {
+    { "/expressions", test_expressions, breakpoint_condition_setup, breakpoint_condition_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
+    { "/errors", test_errors, breakpoint_condition_setup, breakpoint_condition_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
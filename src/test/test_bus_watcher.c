@@ -0,0 +1,102 @@
+// test/test_bus_watcher.c - Johan Smet - BSD-3-Clause (see LICENSE)
+
+#include "munit/munit.h"
+
+#include "bus_watcher.h"
+#include "signal_line.h"
+
+// strobe = 0, rw = 1, sync = 2, address = 8-23, data = 24-31
+#define SIG_RW		(1ull << 1)
+#define SIG_SYNC	(1ull << 2)
+
+static void *bus_watcher_setup(const MunitParameter params[], void *user_data) {
+	Signal address[16], data[8];
+
+	for (uint8_t i = 0; i < 16; ++i) {
+		address[i] = (Signal) {(uint8_t) (8 + i), 0, 0};
+	}
+	for (uint8_t i = 0; i < 8; ++i) {
+		data[i] = (Signal) {(uint8_t) (24 + i), 0, 0};
+	}
+
+	SignalGroup sg_address = signal_group_create_from_array(16, address);
+	SignalGroup sg_data = signal_group_create_from_array(8, data);
+
+	BusWatcher *watcher = bus_watcher_create((Signal) {0, 0, 0}, (Signal) {1, 0, 0}, (Signal) {2, 0, 0}, sg_address, sg_data);
+
+	signal_group_destroy(sg_address);
+	signal_group_destroy(sg_data);
+
+	return watcher;
+}
+
+static void bus_watcher_teardown(void *fixture) {
+	bus_watcher_destroy((BusWatcher *) fixture);
+}
+
+static bool bus_cycle(BusWatcher *watcher, int64_t tick, uint64_t control, uint16_t address, uint8_t data) {
+	uint64_t signals_value[SIGNAL_BLOCKS] = {control | ((uint64_t) address << 8) | ((uint64_t) data << 24)};
+	return bus_watcher_process(watcher, tick, signals_value);
+}
+
+static MunitResult test_read_write(const MunitParameter params[], void* user_data_or_fixture) {
+	BusWatcher *watcher = (BusWatcher *) user_data_or_fixture;
+
+	bus_watcher_set(watcher, (BusWatchpoint) {0x1000, BUS_WATCH_READ, 0});
+	bus_watcher_set(watcher, (BusWatchpoint) {0x2000, BUS_WATCH_WRITE, 0});
+	munit_assert_uint32(watcher->watch_count, ==, 2);
+
+	// unwatched addresses and the wrong kind of access are ignored
+	munit_assert_false(bus_cycle(watcher, 1, SIG_RW | SIG_SYNC, 0xc000, 0xad));
+	munit_assert_false(bus_cycle(watcher, 2, SIG_RW, 0x1001, 0x12));
+	munit_assert_false(bus_cycle(watcher, 3, 0, 0x1000, 0x12));
+	munit_assert_false(bus_cycle(watcher, 4, SIG_RW, 0x2000, 0x12));
+
+	// read of a read watchpoint
+	munit_assert_true(bus_cycle(watcher, 5, SIG_RW, 0x1000, 0x34));
+	munit_assert_int64(watcher->last_hit.tick, ==, 5);
+	munit_assert_int64(watcher->last_hit.address, ==, 0x1000);
+	munit_assert_int64(watcher->last_hit.pc, ==, 0xc000);
+	munit_assert_uint8(watcher->last_hit.value, ==, 0x34);
+	munit_assert_false(watcher->last_hit.write);
+
+	// write of a write watchpoint
+	munit_assert_false(bus_cycle(watcher, 6, SIG_RW | SIG_SYNC, 0xc003, 0x8d));
+	munit_assert_true(bus_cycle(watcher, 7, 0, 0x2000, 0x56));
+	munit_assert_int64(watcher->last_hit.address, ==, 0x2000);
+	munit_assert_int64(watcher->last_hit.pc, ==, 0xc003);
+	munit_assert_uint8(watcher->last_hit.value, ==, 0x56);
+	munit_assert_true(watcher->last_hit.write);
+
+	// clearing a watchpoint
+	bus_watcher_set(watcher, (BusWatchpoint) {0x1000, 0, 0});
+	munit_assert_uint32(watcher->watch_count, ==, 1);
+	munit_assert_false(bus_cycle(watcher, 8, SIG_RW, 0x1000, 0x34));
+
+	bus_watcher_clear(watcher);
+	munit_assert_uint32(watcher->watch_count, ==, 0);
+	munit_assert_false(bus_cycle(watcher, 9, 0, 0x2000, 0x56));
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_value(const MunitParameter params[], void* user_data_or_fixture) {
+	BusWatcher *watcher = (BusWatcher *) user_data_or_fixture;
+
+	bus_watcher_set(watcher, (BusWatchpoint) {0x0080, BUS_WATCH_READ | BUS_WATCH_WRITE | BUS_WATCH_VALUE, 0x42});
+
+	munit_assert_false(bus_cycle(watcher, 1, 0, 0x0080, 0x41));
+	munit_assert_false(bus_cycle(watcher, 2, SIG_RW, 0x0080, 0x00));
+	munit_assert_true(bus_cycle(watcher, 3, SIG_RW, 0x0080, 0x42));
+	munit_assert_false(watcher->last_hit.write);
+	munit_assert_true(bus_cycle(watcher, 4, 0, 0x0080, 0x42));
+	munit_assert_true(watcher->last_hit.write);
+
+    return MUNIT_OK;
+}
+
+MunitTest bus_watcher_tests[] = {
+    { "/read_write", test_read_write, bus_watcher_setup, bus_watcher_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
+    { "/value", test_value, bus_watcher_setup, bus_watcher_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
@@ -3,6 +3,8 @@
 #include "munit/munit.h"
 #include "chip_ram_dynamic.h"
 #include "simulator.h"
+#include "signal_pool.h"
+#include "crt.h"
 
 #define SIGNAL_PREFIX		CHIP_4116_
 #define SIGNAL_OWNER		chip
@@ -57,7 +59,7 @@ MunitResult test_8x4116_read(const MunitParameter params[], void *user_data_or_f
 		ram_8x4116_cycle(chip);
 		munit_assert_int(chip->row, ==, row);
 		munit_assert_int(chip->col, ==, col);
-		munit_assert_uint8(SIGNAL_GROUP_READ_NEXT_U8(dout), ==, 0);
+		munit_assert_uint8(SIGNAL_GROUP_READ_NEXT_U8(dout), ==, expected_data);
 
 		// check output
 		ram_8x4116_cycle(chip);
@@ -123,7 +125,7 @@ MunitResult test_8x4116_write(const MunitParameter params[], void *user_data_or_
 		ram_8x4116_cycle(chip);
 		munit_assert_int(chip->row, ==, row);
 		munit_assert_int(chip->col, ==, col);
-		munit_assert_uint8(SIGNAL_GROUP_READ_NEXT_U8(dout), ==, 0);
+		munit_assert_uint8(SIGNAL_GROUP_READ_NEXT_U8(dout), ==, expected_data);
 
 		// check output
 		ram_8x4116_cycle(chip);
@@ -297,7 +299,7 @@ MunitResult test_8x4116_page_mode_read(const MunitParameter params[], void *user
 			ram_8x4116_cycle(chip);
 			munit_assert_int(chip->row, ==, row);
 			munit_assert_int(chip->col, ==, col);
-			munit_assert_uint8(SIGNAL_GROUP_READ_NEXT_U8(dout), ==, 0);
+			munit_assert_uint8(SIGNAL_GROUP_READ_NEXT_U8(dout), ==, expected_data);
 
 			// check output
 			ram_8x4116_cycle(chip);
@@ -414,11 +416,91 @@ MunitResult test_8x4116_page_mode_write(const MunitParameter params[], void *use
 	return MUNIT_OK;
 }
 
+MunitResult test_8x4116_refresh(const MunitParameter params[], void *user_data_or_fixture) {
+
+	Simulator *sim = simulator_create(NS_TO_PS(100));
+	Chip8x4116DRam *chip = chip_8x4116_dram_create(sim, (Chip8x4116DRamSignals) {0});
+	simulator_register_chip(sim, (Chip *) chip, "DRAM");
+	simulator_device_complete(sim);
+
+	uint64_t chip_mask = 1ull << chip->id;
+	uint64_t *dependents = sim->signal_pool->dependent_components;
+	munit_assert_uint64(dependents[signal_array_subscript(SIGNAL(RAS_B))] & chip_mask, ==, chip_mask);
+	munit_assert_uint64(dependents[signal_array_subscript(SIGNAL(CAS_B))] & chip_mask, ==, chip_mask);
+	munit_assert_uint64(dependents[signal_array_subscript(SIGNAL(WE_B))] & chip_mask, ==, 0);
+
+	chip->data_array[0x21 * 128 + 0x12] = 0x5a;
+
+	// RAS-only refresh cycle
+	SIGNAL_WRITE(RAS_B, ACTLO_DEASSERT);
+	SIGNAL_WRITE(CAS_B, ACTLO_DEASSERT);
+	SIGNAL_WRITE(WE_B, ACTLO_DEASSERT);
+	ram_8x4116_cycle(chip);
+
+	SIGNAL_GROUP_WRITE(address, 0x21);
+	SIGNAL_WRITE(RAS_B, ACTLO_ASSERT);
+	ram_8x4116_cycle(chip);
+	munit_assert_uint8(chip->row, ==, 0x21);
+	munit_assert_ptr_equal(chip->row_data, chip->data_array + 0x21 * 128);
+
+	SIGNAL_WRITE(RAS_B, ACTLO_DEASSERT);
+	ram_8x4116_cycle(chip);
+	munit_assert_false(chip->output);
+	munit_assert_uint8(SIGNAL_GROUP_READ_NEXT_U8(dout), ==, 0);
+
+	// read cycle: write-enable is only watched while CAS is asserted
+	SIGNAL_WRITE(RAS_B, ACTLO_ASSERT);
+	ram_8x4116_cycle(chip);
+	SIGNAL_GROUP_WRITE(address, 0x12);
+	SIGNAL_WRITE(CAS_B, ACTLO_ASSERT);
+	ram_8x4116_cycle(chip);
+	munit_assert_true(chip->output);
+	munit_assert_uint8(SIGNAL_GROUP_READ_NEXT_U8(dout), ==, 0x5a);
+	munit_assert_uint64(dependents[signal_array_subscript(SIGNAL(WE_B))] & chip_mask, ==, chip_mask);
+
+	SIGNAL_WRITE(CAS_B, ACTLO_DEASSERT);
+	SIGNAL_WRITE(RAS_B, ACTLO_DEASSERT);
+	ram_8x4116_cycle(chip);
+	munit_assert_false(chip->output);
+	munit_assert_uint64(dependents[signal_array_subscript(SIGNAL(WE_B))] & chip_mask, ==, 0);
+
+	simulator_destroy(sim);
+
+	return MUNIT_OK;
+}
+
+MunitResult test_8x4116_load_save(const MunitParameter params[], void *user_data_or_fixture) {
+
+	Chip8x4116DRam *chip = chip_8x4116_dram_create(simulator_create(NS_TO_PS(100)), (Chip8x4116DRamSignals) {0});
+
+	uint8_t *src = (uint8_t *) dms_calloc(CHIP_4116_DATA_SIZE, 1);
+	uint8_t *dst = (uint8_t *) dms_calloc(CHIP_4116_DATA_SIZE, 1);
+
+	for (size_t i = 0; i < CHIP_4116_DATA_SIZE; ++i) {
+		src[i] = (uint8_t) (i * 13);
+	}
+
+	chip_8x4116_dram_load(chip, src);
+	munit_assert_uint8(chip->data_array[0x10 * 128 + 0x03], ==, src[0x0803]);
+
+	chip_8x4116_dram_save(chip, dst);
+	munit_assert_memory_equal(CHIP_4116_DATA_SIZE, src, dst);
+
+	dms_free(dst);
+	dms_free(src);
+	simulator_destroy(chip->simulator);
+	chip->destroy(chip);
+
+	return MUNIT_OK;
+}
+
 MunitTest chip_ram_dynamic_tests[] = {
 	{ "/8x4116_read", test_8x4116_read, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/8x4116_write", test_8x4116_write, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/8x4116_early_write", test_8x4116_early_write, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/8x4116_page_mode_read", test_8x4116_page_mode_read, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/8x4116_page_mode_write", test_8x4116_page_mode_write, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/8x4116_refresh", test_8x4116_refresh, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/8x4116_load_save", test_8x4116_load_save, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 	{ NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
@@ -65,8 +65,81 @@ MunitResult test_6114_write(const MunitParameter params[], void *user_data_or_fi
 	return MUNIT_OK;
 }
 
+static bool chip_6114_cycle(Chip6114SRam *chip) {
+	// process the chip only when it depends on one of the signals that changed, like the simulator does
+	uint64_t dirty_chips = signal_pool_cycle(chip->signal_pool);
+	bool activated = (dirty_chips & (1ull << chip->id)) != 0;
+
+	if (activated) {
+		chip->process(chip);
+	}
+	return activated;
+}
+
+MunitResult test_6114_activations(const MunitParameter params[], void *user_data_or_fixture) {
+
+	Simulator *sim = simulator_create(NS_TO_PS(100));
+	Chip6114SRam *chip = chip_6114_sram_create(sim, (Chip6114SRamSignals) {0});
+	simulator_register_chip(sim, (Chip *) chip, "SRAM");
+	simulator_device_complete(sim);
+
+	uint64_t chip_mask = 1ull << chip->id;
+	uint64_t *dependents = sim->signal_pool->dependent_components;
+
+	chip->data_array[0x155] = 0x09;
+
+	// read: driving the io lines doesn't wake up the chip itself
+	SIGNAL_WRITE(CE_B, ACTLO_ASSERT);
+	SIGNAL_WRITE(RW, true);
+	SIGNAL_GROUP_WRITE(address, 0x155);
+	munit_assert_true(chip_6114_cycle(chip));
+	munit_assert_false(chip_6114_cycle(chip));
+	munit_assert_uint8(SIGNAL_GROUP_READ_U8(io), ==, 0x09);
+	munit_assert_uint64(dependents[signal_array_subscript(SIGNAL(IO0))] & chip_mask, ==, 0);
+
+	// the address is kept up-to-date from the address lines that changed
+	SIGNAL_GROUP_WRITE(address, 0x2aa);
+	munit_assert_true(chip_6114_cycle(chip));
+	munit_assert_int32(chip->address, ==, 0x2aa);
+
+	// write: the io lines are watched while R/W is low
+	SIGNAL_WRITE(RW, false);
+	SIGNAL_GROUP_WRITE(io, 0x03);
+	munit_assert_true(chip_6114_cycle(chip));
+	munit_assert_uint64(dependents[signal_array_subscript(SIGNAL(IO0))] & chip_mask, ==, chip_mask);
+
+	SIGNAL_GROUP_WRITE(io, 0x0c);
+	munit_assert_true(chip_6114_cycle(chip));
+	munit_assert_uint8(chip->data_array[0x2aa], ==, 0x0c);
+
+	// deselected: only chip-enable is watched
+	SIGNAL_WRITE(CE_B, ACTLO_DEASSERT);
+	SIGNAL_WRITE(RW, true);
+	SIGNAL_GROUP_NO_WRITE(io);
+	munit_assert_true(chip_6114_cycle(chip));
+	munit_assert_true(chip->deselected);
+
+	SIGNAL_GROUP_WRITE(address, 0x155);
+	munit_assert_false(chip_6114_cycle(chip));
+	SIGNAL_WRITE(RW, false);
+	munit_assert_false(chip_6114_cycle(chip));
+	SIGNAL_WRITE(RW, true);
+	munit_assert_false(chip_6114_cycle(chip));
+
+	// selecting the chip reads all address lines again
+	SIGNAL_WRITE(CE_B, ACTLO_ASSERT);
+	munit_assert_true(chip_6114_cycle(chip));
+	munit_assert_int32(chip->address, ==, 0x155);
+	munit_assert_uint8(SIGNAL_GROUP_READ_NEXT_U8(io), ==, 0x09);
+
+	simulator_destroy(sim);
+
+	return MUNIT_OK;
+}
+
 MunitTest chip_ram_static_tests[] = {
 	{ "/6114_read", test_6114_read, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/6144_write", test_6114_write, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/6114_activations", test_6114_activations, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 	{ NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
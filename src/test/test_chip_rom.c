@@ -2,7 +2,11 @@
 
 #include "munit/munit.h"
 #include "chip_rom.h"
+#include "rom_image.h"
 #include "simulator.h"
+#include "signal_pool.h"
+
+#include <stdio.h>
 
 #define SIGNAL_OWNER	chip
 #define SIGNAL_PREFIX
@@ -30,6 +34,11 @@ static inline void rom_63xx_cycle(Chip63xxRom *chip) {
 	chip->process(chip);
 }
 
+static inline bool rom_63xx_depends_on(Chip63xxRom *chip, uint32_t pin) {
+	uint64_t dependents = chip->signal_pool->dependent_components[signal_array_subscript(chip->signals[pin])];
+	return (dependents & (1ull << chip->id)) != 0;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // tests
@@ -157,10 +166,124 @@ static MunitResult test_6332_cs(const MunitParameter params[], void *user_data_o
 	return MUNIT_OK;
 }
 
+static MunitResult test_6316_zero_latency(const MunitParameter params[], void *user_data_or_fixture) {
+
+	Chip63xxRom *chip = chip_6316_rom_create(simulator_create(NS_TO_PS(100)), (Chip63xxSignals) {0});
+	fill_rom_8bit(chip->data_array, chip->data_size);
+	chip_63xx_rom_zero_latency(chip, true);
+
+	for (uint32_t i = 0; i < ROM_6316_DATA_SIZE; i += 7) {
+		rom_6316_strobe(chip, ACTLO_ASSERT, ACTLO_ASSERT, ACTHI_ASSERT);
+		SIGNAL_GROUP_WRITE(address, i);
+		rom_63xx_cycle(chip);
+		munit_assert_int64(chip->schedule_timestamp, ==, 0);
+		munit_assert_uint8(SIGNAL_GROUP_READ_NEXT_U8(data), ==, i & 0xff);
+	}
+
+	// back to regular behaviour
+	chip_63xx_rom_zero_latency(chip, false);
+	SIGNAL_GROUP_WRITE(address, 0x0123);
+	rom_63xx_cycle(chip);
+	munit_assert_int64(chip->schedule_timestamp, !=, 0);
+
+	simulator_destroy(chip->simulator);
+	chip->destroy(chip);
+
+	return MUNIT_OK;
+}
+
+static MunitResult test_6332_deselect(const MunitParameter params[], void *user_data_or_fixture) {
+
+	Simulator *sim = simulator_create(NS_TO_PS(100));
+	Chip63xxRom *chip = chip_6332_rom_create(sim, (Chip63xxSignals) {0});
+	fill_rom_8bit(chip->data_array, chip->data_size);
+	simulator_register_chip(sim, (Chip *) chip, "ROM");
+	simulator_device_complete(sim);
+
+	munit_assert_true(rom_63xx_depends_on(chip, CHIP_6332_A0));
+	munit_assert_true(rom_63xx_depends_on(chip, CHIP_6332_A11));
+
+	// not selected: address lines aren't watched, the chip-select lines are
+	rom_6332_strobe(chip, ACTLO_DEASSERT, ACTHI_ASSERT);
+	SIGNAL_GROUP_WRITE(address, 0x0635);
+	rom_63xx_cycle(chip);
+	munit_assert_true(chip->deselected);
+	munit_assert_false(rom_63xx_depends_on(chip, CHIP_6332_A0));
+	munit_assert_false(rom_63xx_depends_on(chip, CHIP_6332_A11));
+	munit_assert_true(rom_63xx_depends_on(chip, CHIP_6332_CS1_B));
+	munit_assert_true(rom_63xx_depends_on(chip, CHIP_6332_CS3));
+
+	// selected again
+	rom_6332_strobe(chip, ACTLO_ASSERT, ACTHI_ASSERT);
+	rom_63xx_cycle(chip);
+	rom_63xx_cycle(chip);
+	munit_assert_false(chip->deselected);
+	munit_assert_true(rom_63xx_depends_on(chip, CHIP_6332_A0));
+	munit_assert_true(rom_63xx_depends_on(chip, CHIP_6332_A11));
+	munit_assert_uint8(SIGNAL_GROUP_READ_NEXT_U8(data), ==, 0x35);
+
+	simulator_destroy(sim);
+
+	return MUNIT_OK;
+}
+
+static MunitResult test_6332_image(const MunitParameter params[], void *user_data_or_fixture) {
+
+	static const char *ROM_FILE = "test_chip_rom_image.bin";
+
+	FILE *fp = fopen(ROM_FILE, "wb");
+	munit_assert_not_null(fp);
+	for (size_t i = 0; i < ROM_6332_DATA_SIZE; ++i) {
+		fputc((int) ((i * 3) & 0xff), fp);
+	}
+	fclose(fp);
+
+	const RomImage *image = rom_image_acquire(ROM_FILE);
+	remove(ROM_FILE);
+	munit_assert_not_null(image);
+
+	// two chips read from the same image
+	Chip63xxRom *chip = chip_6332_rom_create(simulator_create(NS_TO_PS(100)), (Chip63xxSignals) {0});
+	Chip63xxRom *other = chip_6332_rom_create(chip->simulator, (Chip63xxSignals) {0});
+	chip_63xx_rom_use_image(chip, image);
+	chip_63xx_rom_use_image(other, rom_image_acquire(ROM_FILE));		// from the cache, the file is gone
+	munit_assert_ptr_equal(chip->data_array, image->data);
+	munit_assert_ptr_equal(other->data_array, image->data);
+
+	chip_63xx_rom_zero_latency(chip, true);
+	rom_6332_strobe(chip, ACTLO_ASSERT, ACTHI_ASSERT);
+	SIGNAL_GROUP_WRITE(address, 0x0123);
+	rom_63xx_cycle(chip);
+	munit_assert_uint8(SIGNAL_GROUP_READ_NEXT_U8(data), ==, (0x0123 * 3) & 0xff);
+
+	// a private copy can be changed without affecting the other chip
+	chip_63xx_rom_private_copy(chip);
+	munit_assert_ptr_not_equal(chip->data_array, image->data);
+	munit_assert_null(chip->image);
+	chip->data_array[0x0123] = 0xaa;
+	munit_assert_uint8(other->data_array[0x0123], ==, (0x0123 * 3) & 0xff);
+
+	SIGNAL_GROUP_WRITE(address, 0x0124);
+	rom_63xx_cycle(chip);
+	SIGNAL_GROUP_WRITE(address, 0x0123);
+	rom_63xx_cycle(chip);
+	munit_assert_uint8(SIGNAL_GROUP_READ_NEXT_U8(data), ==, 0xaa);
+
+	simulator_destroy(chip->simulator);
+	other->destroy(other);
+	chip->destroy(chip);
+	munit_assert_size(rom_image_cache_size(), ==, 0);
+
+	return MUNIT_OK;
+}
+
 MunitTest chip_rom_tests[] = {
 	{ "/6316_read", test_6316_read, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/6316_cs", test_6316_cs, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/6332_read", test_6332_read, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/6332_cs", test_6332_cs, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/6316_zero_latency", test_6316_zero_latency, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/6332_deselect", test_6332_deselect, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/6332_image", test_6332_image, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 	{ NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
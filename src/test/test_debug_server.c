@@ -0,0 +1,311 @@
+// test/test_debug_server.c - Johan Smet - BSD-3-Clause (see LICENSE)
+
+#include "munit/munit.h"
+
+#include "debug_server.h"
+#include "context.h"
+#include "dev_minimal_6502.h"
+#include "cpu_6502_opcodes.h"
+#include "ram_8d_16a.h"
+
+#include "stb/stb_ds.h"
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_DARWIN)
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+typedef struct ServerFixture {
+	DevMinimal6502 *		device;
+	struct DmsContext *		dms;
+	struct DebugServer *	server;
+	int						client;
+	char					path[64];
+	uint8_t *				received;		// dynamic array
+} ServerFixture;
+
+typedef struct Message {
+	uint16_t	command;
+	uint16_t	id;
+	uint8_t *	payload;					// dynamic array
+} Message;
+
+static void *debug_server_setup(const MunitParameter params[], void *user_data) {
+	ServerFixture *fixture = (ServerFixture *) calloc(1, sizeof(ServerFixture));
+
+	// INC $00 / JMP $c000, irq-handler at $fe00
+	uint8_t *rom = NULL;
+	arrsetlen(rom, 1 << 14);
+	memset(rom, 0, arrlenu(rom));
+	rom[0x0000] = OP_6502_INC_ZP;
+	rom[0x0001] = 0x00;
+	rom[0x0002] = OP_6502_JMP_ABS;
+	rom[0x0003] = 0x00;
+	rom[0x0004] = 0xc0;
+	rom[0xfe00 - 0xc000] = OP_6502_JMP_ABS;
+	rom[0xfe01 - 0xc000] = 0x00;
+	rom[0xfe02 - 0xc000] = 0xfe;
+	rom[0xfffc - 0xc000] = 0x00;
+	rom[0xfffd - 0xc000] = 0xc0;
+
+	fixture->device = dev_minimal_6502_create(rom);
+	arrfree(rom);
+
+	fixture->dms = dms_create_context();
+	dms_set_device(fixture->dms, (struct Device *) fixture->device);
+
+	snprintf(fixture->path, sizeof(fixture->path), "/tmp/dms_debug_test_%d", (int) getpid());
+	char address[80];
+	snprintf(address, sizeof(address), "unix:%s", fixture->path);
+	fixture->server = debug_server_create(fixture->dms, address);
+	munit_assert_not_null(fixture->server);
+
+	struct sockaddr_un addr = {0};
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, fixture->path);
+
+	fixture->client = socket(AF_UNIX, SOCK_STREAM, 0);
+	munit_assert_int(connect(fixture->client, (struct sockaddr *) &addr, sizeof(addr)), ==, 0);
+
+	return fixture;
+}
+
+static void debug_server_teardown(void *data) {
+	ServerFixture *fixture = (ServerFixture *) data;
+
+	close(fixture->client);
+	debug_server_destroy(fixture->server);
+	dms_release_context(fixture->dms);
+	dev_minimal_6502_destroy(fixture->device);
+	arrfree(fixture->received);
+	free(fixture);
+}
+
+static void put_le(uint8_t **buffer, uint64_t value, size_t bytes) {
+	for (size_t i = 0; i < bytes; ++i) {
+		arrpush(*buffer, (uint8_t) (value >> (i * 8)));
+	}
+}
+
+static uint64_t get_le(const uint8_t *data, size_t bytes) {
+	uint64_t result = 0;
+	for (size_t i = 0; i < bytes; ++i) {
+		result |= (uint64_t) data[i] << (i * 8);
+	}
+	return result;
+}
+
+static void put_name(uint8_t **buffer, const char *name) {
+	put_le(buffer, strlen(name), 1);
+	memcpy(arraddnptr(*buffer, strlen(name)), name, strlen(name));
+}
+
+static void send_request(ServerFixture *fixture, uint16_t command, uint16_t id, uint8_t *payload) {
+	uint8_t *msg = NULL;
+	put_le(&msg, arrlenu(payload), 4);
+	put_le(&msg, command, 2);
+	put_le(&msg, id, 2);
+	if (arrlenu(payload) > 0) {
+		memcpy(arraddnptr(msg, arrlenu(payload)), payload, arrlenu(payload));
+	}
+
+	munit_assert_int(send(fixture->client, msg, arrlenu(msg), 0), ==, (int) arrlenu(msg));
+	arrfree(msg);
+	arrfree(payload);
+}
+
+static Message receive_message(ServerFixture *fixture) {
+	uint8_t buffer[4096];
+
+	for (int attempt = 0; ; ++attempt) {
+		munit_assert_int(attempt, <, 1000);
+
+		// complete message available?
+		if (arrlenu(fixture->received) >= DEBUG_HEADER_SIZE) {
+			size_t length = (size_t) get_le(fixture->received, 4);
+
+			if (arrlenu(fixture->received) >= DEBUG_HEADER_SIZE + length) {
+				Message msg = {
+					.command = (uint16_t) get_le(fixture->received + 4, 2),
+					.id = (uint16_t) get_le(fixture->received + 6, 2),
+					.payload = NULL
+				};
+				memcpy(arraddnptr(msg.payload, length), fixture->received + DEBUG_HEADER_SIZE, length);
+				arrdeln(fixture->received, 0, DEBUG_HEADER_SIZE + length);
+				return msg;
+			}
+		}
+
+		debug_server_process(fixture->server, 1);
+
+		ssize_t n;
+		while ((n = recv(fixture->client, buffer, sizeof(buffer), MSG_DONTWAIT)) > 0) {
+			memcpy(arraddnptr(fixture->received, (size_t) n), buffer, (size_t) n);
+		}
+	}
+}
+
+static Message request(ServerFixture *fixture, uint16_t command, uint8_t *payload) {
+	static uint16_t next_id = 1;
+	uint16_t id = next_id++;
+
+	send_request(fixture, command, id, payload);
+	Message msg = receive_message(fixture);
+
+	munit_assert_uint16(msg.command, ==, command);
+	munit_assert_uint16(msg.id, ==, id);
+	munit_assert_size(arrlenu(msg.payload), >=, 1);
+	return msg;
+}
+
+static MunitResult test_requests(const MunitParameter params[], void *user_data_or_fixture) {
+	ServerFixture *fixture = (ServerFixture *) user_data_or_fixture;
+
+	// hello
+	Message msg = request(fixture, DEBUG_CMD_HELLO, NULL);
+	munit_assert_uint8(msg.payload[0], ==, DEBUG_STATUS_OK);
+	munit_assert_uint64(get_le(msg.payload + 1, 2), ==, DEBUG_PROTOCOL_VERSION);
+	arrfree(msg.payload);
+
+	// status
+	msg = request(fixture, DEBUG_CMD_STATUS, NULL);
+	munit_assert_uint8(msg.payload[0], ==, DEBUG_STATUS_OK);
+	munit_assert_size(arrlenu(msg.payload), ==, 18);
+	munit_assert_uint8(msg.payload[1], ==, DS_WAIT);
+	arrfree(msg.payload);
+
+	// write memory
+	uint8_t *payload = NULL;
+	put_le(&payload, 0x0200, 4);
+	put_le(&payload, 0x04030201, 4);
+	msg = request(fixture, DEBUG_CMD_WRITE_MEMORY, payload);
+	munit_assert_uint8(msg.payload[0], ==, DEBUG_STATUS_OK);
+	munit_assert_uint8(fixture->device->ram->data_array[0x0203], ==, 0x04);
+	arrfree(msg.payload);
+
+	// read the entire address space in one request
+	payload = NULL;
+	put_le(&payload, 0x0000, 4);
+	put_le(&payload, 0x10000, 4);
+	msg = request(fixture, DEBUG_CMD_READ_MEMORY, payload);
+	munit_assert_uint8(msg.payload[0], ==, DEBUG_STATUS_OK);
+	munit_assert_size(arrlenu(msg.payload), ==, 0x10001);
+	munit_assert_uint32((uint32_t) get_le(msg.payload + 1 + 0x0200, 4), ==, 0x04030201);
+	munit_assert_uint8(msg.payload[1 + 0xc000], ==, OP_6502_INC_ZP);
+	uint8_t *memory = msg.payload;
+
+	// read across the top of the address space: the bytes past the end are zero, not left over from a previous reply
+	payload = NULL;
+	put_le(&payload, 0xfffc, 4);
+	put_le(&payload, 0x0400, 4);
+	msg = request(fixture, DEBUG_CMD_READ_MEMORY, payload);
+	munit_assert_uint8(msg.payload[0], ==, DEBUG_STATUS_OK);
+	munit_assert_size(arrlenu(msg.payload), ==, 0x0401);
+	munit_assert_memory_equal(4, msg.payload + 1, memory + 1 + 0xfffc);
+	for (size_t i = 5; i < arrlenu(msg.payload); ++i) {
+		munit_assert_uint8(msg.payload[i], ==, 0);
+	}
+	arrfree(msg.payload);
+	arrfree(memory);
+
+	// registers
+	payload = NULL;
+	put_le(&payload, 2, 1);
+	put_name(&payload, "A");
+	put_name(&payload, "PC");
+	msg = request(fixture, DEBUG_CMD_READ_REGISTERS, payload);
+	munit_assert_uint8(msg.payload[0], ==, DEBUG_STATUS_OK);
+	munit_assert_size(arrlenu(msg.payload), ==, 17);
+	arrfree(msg.payload);
+
+	payload = NULL;
+	put_le(&payload, 1, 1);
+	put_name(&payload, "Q");
+	msg = request(fixture, DEBUG_CMD_READ_REGISTERS, payload);
+	munit_assert_uint8(msg.payload[0], ==, DEBUG_STATUS_NOT_FOUND);
+	munit_assert_size(arrlenu(msg.payload), ==, 1);
+	arrfree(msg.payload);
+
+	// signals
+	payload = NULL;
+	put_le(&payload, 1, 1);
+	put_name(&payload, "CLK");
+	msg = request(fixture, DEBUG_CMD_READ_SIGNALS, payload);
+	munit_assert_uint8(msg.payload[0], ==, DEBUG_STATUS_OK);
+	munit_assert_size(arrlenu(msg.payload), ==, 2);
+	arrfree(msg.payload);
+
+	// breakpoints
+	payload = NULL;
+	put_le(&payload, DEBUG_BP_PC, 1);
+	put_le(&payload, 0xc002, 4);
+	msg = request(fixture, DEBUG_CMD_BREAKPOINT_SET, payload);
+	munit_assert_uint8(msg.payload[0], ==, DEBUG_STATUS_OK);
+	munit_assert_true(dms_breakpoint_is_set(fixture->dms, 0xc002));
+	arrfree(msg.payload);
+
+	payload = NULL;
+	put_le(&payload, DEBUG_BP_PC, 1);
+	put_le(&payload, 0xc002, 4);
+	msg = request(fixture, DEBUG_CMD_BREAKPOINT_CLR, payload);
+	munit_assert_uint8(msg.payload[0], ==, DEBUG_STATUS_OK);
+	munit_assert_false(dms_breakpoint_is_set(fixture->dms, 0xc002));
+	arrfree(msg.payload);
+
+	// malformed and unknown requests
+	payload = NULL;
+	put_le(&payload, 0x0200, 2);
+	msg = request(fixture, DEBUG_CMD_READ_MEMORY, payload);
+	munit_assert_uint8(msg.payload[0], ==, DEBUG_STATUS_INVALID_REQUEST);
+	arrfree(msg.payload);
+
+	msg = request(fixture, 0x7777, NULL);
+	munit_assert_uint8(msg.payload[0], ==, DEBUG_STATUS_INVALID_REQUEST);
+	arrfree(msg.payload);
+
+	return MUNIT_OK;
+}
+
+static MunitResult test_run_until(const MunitParameter params[], void *user_data_or_fixture) {
+	ServerFixture *fixture = (ServerFixture *) user_data_or_fixture;
+
+	uint8_t *payload = NULL;
+	put_le(&payload, 0xc002, 4);
+	Message msg = request(fixture, DEBUG_CMD_RUN_UNTIL, payload);
+	munit_assert_uint8(msg.payload[0], ==, DEBUG_STATUS_OK);
+	munit_assert_true(dms_breakpoint_is_set(fixture->dms, 0xc002));
+	arrfree(msg.payload);
+
+	// there's no background thread: execute the simulation on this thread
+	while (dms_get_state(fixture->dms) != DS_WAIT) {
+		dms_execute_no_sync(fixture->dms);
+	}
+
+	// the stop is reported asynchronously and the temporary breakpoint is removed
+	msg = receive_message(fixture);
+	munit_assert_uint16(msg.command, ==, DEBUG_NOTIFY_STOPPED);
+	munit_assert_size(arrlenu(msg.payload), ==, 17);
+	munit_assert_uint8(msg.payload[0], ==, DS_WAIT);
+	munit_assert_uint64(get_le(msg.payload + 9, 8), ==, 0xc002);
+	munit_assert_false(dms_breakpoint_is_set(fixture->dms, 0xc002));
+	munit_assert_uint8(fixture->device->ram->data_array[0x00], ==, 1);
+	arrfree(msg.payload);
+
+	return MUNIT_OK;
+}
+
+MunitTest debug_server_tests[] = {
+	{ "/requests", test_requests, debug_server_setup, debug_server_teardown, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/run_until", test_run_until, debug_server_setup, debug_server_teardown, MUNIT_TEST_OPTION_NONE, NULL },
+	{ NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+#else
+
+MunitTest debug_server_tests[] = {
+	{ NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
+
+#endif
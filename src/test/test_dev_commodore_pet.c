@@ -3,6 +3,8 @@
 #include "munit/munit.h"
 #include "dev_commodore_pet.h"
 
+#include "bus_watcher.h"
+#include "context.h"
 #include "crt.h"
 #include "chip_ram_static.h"
 #include "chip_ram_dynamic.h"
@@ -22,6 +24,18 @@ static void *dev_commodore_pet_lite_setup(const MunitParameter params[], void *u
 	return  dev_commodore_pet_lite_create();
 }
 
+static void *dev_commodore_pet_lite_fast_setup(const MunitParameter params[], void *user_data) {
+	DevCommodorePet *device = dev_commodore_pet_lite_create();
+	dev_commodore_pet_fast_bus(device, true);
+	return device;
+}
+
+static void *dev_commodore_pet_zero_latency_setup(const MunitParameter params[], void *user_data) {
+	DevCommodorePet *device = dev_commodore_pet_create();
+	dev_commodore_pet_zero_latency_roms(device, true);
+	return device;
+}
+
 static void dev_commodore_pet_teardown(void *fixture) {
 	DevCommodorePet *dev = (DevCommodorePet *) fixture;
 	dev_commodore_pet_destroy(dev);
@@ -357,7 +371,7 @@ MunitResult test_vram_program(const MunitParameter params[], void *user_data_or_
 	DevCommodorePet *device = (DevCommodorePet *) user_data_or_fixture;
 
 	// replace the kernal rom with a custom ROM
-	uint8_t *rom = device->roms[4]->data_array;
+	uint8_t *rom = dev_commodore_pet_rom_private_copy(device, 4);
 	int idx = 0;
 
 	// >> init stack pointer
@@ -420,6 +434,63 @@ MunitResult test_vram_program(const MunitParameter params[], void *user_data_or_
 	return MUNIT_OK;
 }
 
+static MunitResult test_boot_basic(const MunitParameter params[], void *user_data_or_fixture) {
+// boot the PET until BASIC clears the screen and prints its banner
+
+	DevCommodorePet *device = (DevCommodorePet *) user_data_or_fixture;
+	Simulator *sim = device->simulator;
+
+	int64_t max_ticks = simulator_interval_to_tick_count(sim, MS_TO_PS(2000));
+	uint8_t first_char = 0;
+
+	while (first_char != 0x2a && sim->current_tick < max_ticks) {
+		device->process(device);
+		device->read_memory(device, 0x8000, 1, &first_char);
+	}
+	munit_assert_uint8(first_char, ==, 0x2a);
+
+	// the jiffy clock ($8d-$8f) is updated by the interrupt handler, triggered by the vertical retrace (via pia-1)
+	uint8_t jiffies_start[3];
+	device->read_memory(device, 0x8d, 3, jiffies_start);
+
+	int64_t end_tick = sim->current_tick + simulator_interval_to_tick_count(sim, MS_TO_PS(100));
+	while (sim->current_tick < end_tick) {
+		device->process(device);
+	}
+
+	uint8_t jiffies_end[3];
+	device->read_memory(device, 0x8d, 3, jiffies_end);
+	munit_assert_uint8((uint8_t) (jiffies_end[2] - jiffies_start[2]), >=, 5);
+
+	return MUNIT_OK;
+}
+
+static MunitResult test_watchpoint(const MunitParameter params[], void *user_data_or_fixture) {
+// the clear screen routine writes a space to the first character of the screen, also in fast bus mode
+
+	DevCommodorePet *device = (DevCommodorePet *) user_data_or_fixture;
+
+	struct DmsContext *dms = dms_create_context();
+	dms_set_device(dms, (struct Device *) device);
+	dms_watchpoint_set(dms, 0x8000, BUS_WATCH_WRITE | BUS_WATCH_VALUE, 0x20);
+
+	int limit = 100000;
+	do {
+		dms_execute_no_sync(dms);
+	} while (--limit > 0 && dms_get_state(dms) != DS_WAIT);
+
+	munit_assert_int(limit, >, 0);
+
+	BusWatchHit hit = dms_watchpoint_last_hit(dms);
+	munit_assert_int64(hit.address, ==, 0x8000);
+	munit_assert_uint8(hit.value, ==, 0x20);
+	munit_assert_true(hit.write);
+
+	dms_release_context(dms);
+
+	return MUNIT_OK;
+}
+
 static MunitResult test_read_write_memory(const MunitParameter params[], void *user_data_or_fixture) {
 
 	DevCommodorePet *device = (DevCommodorePet *) user_data_or_fixture;
@@ -446,6 +517,94 @@ static MunitResult test_read_write_memory(const MunitParameter params[], void *u
 	return MUNIT_OK;
 }
 
+static MunitResult test_read_write_memory_full(const MunitParameter params[], void *user_data_or_fixture) {
+
+	DevCommodorePet *device = (DevCommodorePet *) user_data_or_fixture;
+
+	uint8_t *src_buffer = (uint8_t *) dms_calloc(0x10000, 1);
+	uint8_t *dst_buffer = (uint8_t *) dms_calloc(0x10001, 1);
+
+	for (size_t i = 0; i < 0x10000; ++i) {
+		src_buffer[i] = (uint8_t) ((i >> 8) ^ (i * 7));
+	}
+
+	// write the entire address space: only RAM and video memory are changed
+	device->write_memory(device, 0, 0x10000, src_buffer);
+
+	dms_memset(dst_buffer, 0xaa, 0x10001);
+	device->read_memory(device, 0, 0x10001, dst_buffer);
+
+	munit_assert_memory_equal(0x8000, src_buffer, dst_buffer);
+
+	// video memory: 1k, the last write to the mirrored range wins
+	munit_assert_memory_equal(0x0400, src_buffer + 0x8400, dst_buffer + 0x8000);
+	munit_assert_memory_equal(0x0400, src_buffer + 0x8400, dst_buffer + 0x8400);
+
+	// roms
+	munit_assert_memory_equal(0x1000, device->roms[0]->data_array, dst_buffer + 0xb000);
+	munit_assert_memory_equal(0x1000, device->roms[1]->data_array, dst_buffer + 0xc000);
+	munit_assert_memory_equal(0x1000, device->roms[2]->data_array, dst_buffer + 0xd000);
+	munit_assert_memory_equal(0x0800, device->roms[3]->data_array, dst_buffer + 0xe000);
+	munit_assert_memory_equal(0x1000, device->roms[4]->data_array, dst_buffer + 0xf000);
+
+	// unused space, I/O area and past the end of the address space
+	for (size_t i = 0x8800; i < 0xb000; ++i) {
+		munit_assert_uint8(dst_buffer[i], ==, 0);
+	}
+	for (size_t i = 0xe800; i < 0xf000; ++i) {
+		munit_assert_uint8(dst_buffer[i], ==, 0);
+	}
+	munit_assert_uint8(dst_buffer[0x10000], ==, 0);
+
+	// main memory is stored in the chips as the simulated cpu would see it
+	if (!device->is_lite) {
+		Chip8x4116DRam *ram = (Chip8x4116DRam *) simulator_chip_by_name(device->simulator, "J2-9");
+		size_t row = 0x5678 & 0x007f;
+		size_t col = (0x5678 & 0x3f80) >> 7;
+		munit_assert_uint8(ram->data_array[(row << 7) | ((col & 0x003f) << 1) | ((col & 0x0040) >> 6)], ==, src_buffer[0x5678]);
+	} else {
+		Ram8d16a *ram = (Ram8d16a *) simulator_chip_by_name(device->simulator, "RAM");
+		munit_assert_uint8(ram->data_array[0x5678], ==, src_buffer[0x5678]);
+	}
+
+	dms_free(dst_buffer);
+	dms_free(src_buffer);
+
+	return MUNIT_OK;
+}
+
+MunitResult test_shared_roms(const MunitParameter params[], void *user_data_or_fixture) {
+
+	DevCommodorePet *device = (DevCommodorePet *) user_data_or_fixture;
+	DevCommodorePet *other = dev_commodore_pet_create();
+
+	// all devices read from the same rom images
+	for (int rom = 0; device->roms[rom] != NULL; ++rom) {
+		munit_assert_not_null(device->roms[rom]->image);
+		munit_assert_ptr_equal(device->roms[rom]->data_array, other->roms[rom]->data_array);
+	}
+
+	Chip63xxRom *char_rom = (Chip63xxRom *) simulator_chip_by_name(device->simulator, "F10");
+	Chip63xxRom *other_char_rom = (Chip63xxRom *) simulator_chip_by_name(other->simulator, "F10");
+	munit_assert_ptr_equal(char_rom->data_array, other_char_rom->data_array);
+
+	// patching a rom only changes the rom of that device
+	uint8_t original = device->roms[4]->data_array[0x0ffc];
+	uint8_t *kernal = dev_commodore_pet_rom_private_copy(device, 4);
+	munit_assert_ptr_not_equal(kernal, other->roms[4]->data_array);
+	kernal[0x0ffc] = (uint8_t) (original ^ 0xff);
+
+	uint8_t value = 0;
+	device->read_memory(device, 0xfffc, 1, &value);
+	munit_assert_uint8(value, ==, original ^ 0xff);
+	other->read_memory(other, 0xfffc, 1, &value);
+	munit_assert_uint8(value, ==, original);
+
+	dev_commodore_pet_destroy(other);
+
+	return MUNIT_OK;
+}
+
 MunitTest dev_commodore_pet_tests[] = {
 	{ "/address_signals", test_signals_address, dev_commodore_pet_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/address_data", test_signals_data, dev_commodore_pet_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
@@ -457,11 +616,20 @@ MunitTest dev_commodore_pet_tests[] = {
 	{ "/startup", test_startup, dev_commodore_pet_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/vram_program", test_vram_program, dev_commodore_pet_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/access_mem", test_read_write_memory, dev_commodore_pet_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/access_mem_full", test_read_write_memory_full, dev_commodore_pet_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/shared_roms", test_shared_roms, dev_commodore_pet_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/zero_latency__rom", test_rom, dev_commodore_pet_zero_latency_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/zero_latency__vram_program", test_vram_program, dev_commodore_pet_zero_latency_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/lite__ram", test_ram, dev_commodore_pet_lite_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/lite__vram", test_vram_lite, dev_commodore_pet_lite_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/lite__rom", test_rom, dev_commodore_pet_lite_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/lite__startup", test_startup, dev_commodore_pet_lite_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/lite__vram_prog", test_vram_program, dev_commodore_pet_lite_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/lite__access_mem", test_read_write_memory, dev_commodore_pet_lite_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/lite__access_mem_full", test_read_write_memory_full, dev_commodore_pet_lite_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/lite__boot", test_boot_basic, dev_commodore_pet_lite_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/lite_fast__vram_prog", test_vram_program, dev_commodore_pet_lite_fast_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/lite_fast__boot", test_boot_basic, dev_commodore_pet_lite_fast_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/lite_fast__watchpoint", test_watchpoint, dev_commodore_pet_lite_fast_setup, dev_commodore_pet_teardown, MUNIT_TEST_OPTION_NONE, NULL },
 	{ NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
@@ -3,12 +3,37 @@
 #include "dev_minimal_6502.h"
 
 #include "crt.h"
+#include "context.h"
 #include "chip_6520.h"
 #include "cpu_6502.h"
+#include "cpu_6502_coverage.h"
 #include "cpu_6502_opcodes.h"
+#include "cpu_6502_profile.h"
+#include "cpu_6502_trace.h"
+#include "input_event.h"
 #include "ram_8d_16a.h"
+#include "signal_history.h"
+#include "signal_trigger.h"
+#include "simulator.h"
+#include "stopwatch.h"
+#include "utils.h"
 
 #include "stb/stb_ds.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static void temp_file_path(char *buffer, size_t size, const char *name) {
+	// keep the files the tests write out of the working directory
+	const char *dir = getenv("TMPDIR");
+	if (!dir || !*dir) {
+		dir = getenv("TEMP");
+	}
+	if (!dir || !*dir) {
+		dir = "/tmp";
+	}
+
+	snprintf(buffer, size, "%s/%s", dir, name);
+}
 
 static DevMinimal6502 *dev_minimal_6502_setup(int program) {
 
@@ -52,6 +77,56 @@ static DevMinimal6502 *dev_minimal_6502_setup(int program) {
 		arrput(rom, 0x02);
 		arrput(rom, 0x80);
 		arrput(rom, OP_6502_BRK);
+	} else if (program == 2) {
+		arrput(rom, OP_6502_LDA_IMM);
+		arrput(rom, 0xf0);
+		arrput(rom, OP_6502_STA_ABS);		// write the PIA - DDRB (keypad rows are outputs, columns inputs)
+		arrput(rom, 0x02);
+		arrput(rom, 0x80);
+		arrput(rom, OP_6502_LDA_IMM);
+		arrput(rom, 0b00000100);
+		arrput(rom, OP_6502_STA_ABS);		// write the PIA - CRB (select ORB instead of DDRB)
+		arrput(rom, 0x03);
+		arrput(rom, 0x80);
+		arrput(rom, OP_6502_LDA_IMM);		// loop: scan the first row of the keypad and add the columns to $00
+		arrput(rom, 0x10);
+		arrput(rom, OP_6502_STA_ABS);		// write the PIA - ORB (activate the first row of the keypad)
+		arrput(rom, 0x02);
+		arrput(rom, 0x80);
+		arrput(rom, OP_6502_LDA_ABS);		// read the PIA - ORB
+		arrput(rom, 0x02);
+		arrput(rom, 0x80);
+		arrput(rom, OP_6502_AND_IMM);
+		arrput(rom, 0x0f);
+		arrput(rom, OP_6502_CLC);
+		arrput(rom, OP_6502_ADC_ZP);
+		arrput(rom, 0x00);
+		arrput(rom, OP_6502_STA_ZP);
+		arrput(rom, 0x00);
+		arrput(rom, OP_6502_LDA_IMM);
+		arrput(rom, 0x00);
+		arrput(rom, OP_6502_STA_ABS);		// write the PIA - ORB (deactivate the row)
+		arrput(rom, 0x02);
+		arrput(rom, 0x80);
+		arrput(rom, OP_6502_JMP_ABS);
+		arrput(rom, 0x0a);
+		arrput(rom, 0xc0);
+	} else if (program == 3) {
+		arrput(rom, OP_6502_LDX_IMM);		// call the subroutine at $c010 three times
+		arrput(rom, 3);
+		arrput(rom, OP_6502_JSR);
+		arrput(rom, 0x10);
+		arrput(rom, 0xc0);
+		arrput(rom, OP_6502_DEX);
+		arrput(rom, OP_6502_BNE);
+		arrput(rom, 0xfa);
+		arrput(rom, OP_6502_JMP_ABS);		// $c008: endless loop
+		arrput(rom, 0x08);
+		arrput(rom, 0xc0);
+		arrsetlen(rom, 0x10);
+		arrput(rom, OP_6502_NOP);			// $c010: subroutine
+		arrput(rom, OP_6502_NOP);
+		arrput(rom, OP_6502_RTS);
 	} else {
 		arrput(rom, OP_6502_BRK);
 	}
@@ -157,9 +232,651 @@ static MunitResult test_read_write_memory(const MunitParameter params[], void *u
 	return MUNIT_OK;
 }
 
+static MunitResult test_watchpoint(const MunitParameter params[], void *user_data_or_fixture) {
+
+	DevMinimal6502 *dev = dev_minimal_6502_setup(0);
+	dev->ram->data_array[0x61] = 0;
+
+	struct DmsContext *dms = dms_create_context();
+	dms_set_device(dms, (struct Device *) dev);
+	dms_watchpoint_set(dms, 0x61, BUS_WATCH_WRITE, 0);
+	munit_assert_uint8(dms_watchpoint_flags(dms, 0x61), ==, BUS_WATCH_WRITE);
+
+	// run the computer until the watchpoint pauses the simulation
+	int limit = 100;
+
+	do {
+		dms_execute_no_sync(dms);
+	} while (--limit > 0 && dms_get_state(dms) != DS_WAIT);
+
+	munit_assert_int(limit, >, 0);
+
+	BusWatchHit hit = dms_watchpoint_last_hit(dms);
+	munit_assert_int64(hit.address, ==, 0x61);
+	munit_assert_int64(hit.pc, ==, 0xc004);
+	munit_assert_uint8(hit.value, ==, 10);
+	munit_assert_true(hit.write);
+
+	dms_release_context(dms);
+	dev_minimal_6502_teardown(dev);
+
+	return MUNIT_OK;
+}
+
+static MunitResult test_conditional_breakpoint(const MunitParameter params[], void *user_data_or_fixture) {
+
+	DevMinimal6502 *dev = dev_minimal_6502_setup(0);
+	dev->ram->data_array[0x61] = 0;
+
+	struct DmsContext *dms = dms_create_context();
+	dms_set_device(dms, (struct Device *) dev);
+
+	// the irq-handler is an endless loop: break the third time it's executed after the program stored 10 at $61
+	const char *error = NULL;
+	munit_assert_true(dms_toggle_breakpoint(dms, 0xfe00));
+	munit_assert_false(dms_breakpoint_condition_set(dms, DMS_BREAKPOINT_PC, 0xfe00, "A == ", &error));
+	munit_assert_not_null(error);
+	munit_assert_true(dms_breakpoint_condition_set(dms, DMS_BREAKPOINT_PC, 0xfe00, "A == $0a && [$61] == 10", &error));
+	munit_assert_string_equal(dms_breakpoint_condition(dms, DMS_BREAKPOINT_PC, 0xfe00), "A == $0a && [$61] == 10");
+	dms_breakpoint_ignore_count_set(dms, DMS_BREAKPOINT_PC, 0xfe00, 2);
+
+	int limit = 100;
+
+	do {
+		dms_execute_no_sync(dms);
+	} while (--limit > 0 && dms_get_state(dms) != DS_WAIT);
+
+	munit_assert_int(limit, >, 0);
+	munit_assert_uint16(dev->cpu->reg_pc, ==, 0xfe00);
+	munit_assert_int64(dms_breakpoint_hit_count(dms, DMS_BREAKPOINT_PC, 0xfe00), ==, 3);
+
+	// a condition that is never true
+	munit_assert_true(dms_breakpoint_condition_set(dms, DMS_BREAKPOINT_PC, 0xfe00, "X != 0", &error));
+
+	limit = 20;
+
+	do {
+		dms_execute_no_sync(dms);
+	} while (--limit > 0 && dms_get_state(dms) != DS_WAIT);
+
+	munit_assert_int(limit, ==, 0);
+	munit_assert_int64(dms_breakpoint_hit_count(dms, DMS_BREAKPOINT_PC, 0xfe00), ==, 3);
+
+	// the monitor only creates a breakpoint for a valid condition
+	char *reply = NULL;
+	dms_monitor_cmd(dms, "bc c004 A ==", &reply);
+	munit_assert_not_null(reply);
+	munit_assert_memory_equal(4, reply, "NOK:");
+	munit_assert_false(dms_breakpoint_is_set(dms, 0xc004));
+	arrfree(reply);
+
+	dms_monitor_cmd(dms, "bc c004 A == 10", &reply);
+	munit_assert_memory_equal(3, reply, "OK:");
+	munit_assert_true(dms_breakpoint_is_set(dms, 0xc004));
+	arrfree(reply);
+
+	// an invalid condition leaves an existing breakpoint alone
+	dms_monitor_cmd(dms, "bc c004 (", &reply);
+	munit_assert_memory_equal(4, reply, "NOK:");
+	munit_assert_true(dms_breakpoint_is_set(dms, 0xc004));
+	munit_assert_string_equal(dms_breakpoint_condition(dms, DMS_BREAKPOINT_PC, 0xc004), "A == 10");
+	arrfree(reply);
+
+	dms_release_context(dms);
+	dev_minimal_6502_teardown(dev);
+
+	return MUNIT_OK;
+}
+
+static MunitResult test_run_until(const MunitParameter params[], void *user_data_or_fixture) {
+
+	DevMinimal6502 *dev = dev_minimal_6502_setup(0);
+	dev->ram->data_array[0x00] = 0;
+
+	struct DmsContext *dms = dms_create_context();
+	dms_set_device(dms, (struct Device *) dev);
+
+	// start of the program
+	munit_assert_int(dms_run_until_pc(dms, 0xc000, 1000000), ==, DMS_STOP_REACHED);
+	munit_assert_int64(dms_get_status(dms).program_counter, ==, 0xc000);
+
+	// INC $00 & LDA #10
+	munit_assert_int(dms_run_for_instructions(dms, 2, 1000000), ==, DMS_STOP_REACHED);
+	munit_assert_int64(dms_get_status(dms).program_counter, ==, 0xc004);
+	munit_assert_uint8(dev->ram->data_array[0x00], ==, 1);
+
+	// STA $61 writes to memory
+	munit_assert_int(dms_run_until_signal(dms, dev->signals[SIG_M6502_CPU_RW], false, true, 1000000), ==, DMS_STOP_REACHED);
+	munit_assert_false(signal_read(dev->simulator->signal_pool, dev->signals[SIG_M6502_CPU_RW]));
+
+	// the irq-handler is an endless loop
+	munit_assert_int(dms_run_until_pc(dms, 0xfe00, 1000000), ==, DMS_STOP_REACHED);
+	munit_assert_int(dms_run_until_pc(dms, 0xc000, 1000000), ==, DMS_STOP_TICK_LIMIT);
+
+	int64_t tick = dev->simulator->current_tick;
+	munit_assert_int(dms_run_for_ticks(dms, 100), ==, DMS_STOP_REACHED);
+	munit_assert_int64(dev->simulator->current_tick, >=, tick + 100);
+	munit_assert_int64(dms_get_status(dms).current_tick, ==, dev->simulator->current_tick);
+
+	dms_release_context(dms);
+	dev_minimal_6502_teardown(dev);
+
+	return MUNIT_OK;
+}
+
+static MunitResult test_instruction_trace(const MunitParameter params[], void *user_data_or_fixture) {
+
+	char TRACE_FILE[1024];
+	char CORRUPT_FILE[1024];
+	temp_file_path(TRACE_FILE, sizeof(TRACE_FILE), "test_instruction_trace.dmstrace");
+	temp_file_path(CORRUPT_FILE, sizeof(CORRUPT_FILE), "test_instruction_trace_corrupt.dmstrace");
+
+	DevMinimal6502 *dev = dev_minimal_6502_setup(0);
+	dev->ram->data_array[0x00] = 0;
+
+	Cpu6502Trace *trace = cpu_6502_trace_create(6);
+	munit_assert_uint64(cpu_6502_trace_capacity(trace), ==, 8);
+	cpu_6502_set_trace(dev->cpu, trace);
+
+	struct DmsContext *dms = dms_create_context();
+	dms_set_device(dms, (struct Device *) dev);
+
+	// the reset sequence isn't an instruction, the record is created when the instruction starts
+	munit_assert_int(dms_run_until_pc(dms, 0xc000, 1000000), ==, DMS_STOP_REACHED);
+	munit_assert_uint64(trace->count, ==, 1);
+
+	// INC $00, LDA #10, STA $61, BRK and the first JMP $fe00 of the irq-handler
+	munit_assert_int(dms_run_for_instructions(dms, 4, 1000000), ==, DMS_STOP_REACHED);
+	munit_assert_uint64(cpu_6502_trace_size(trace), ==, 5);
+
+	Cpu6502TraceRecord *rec = cpu_6502_trace_record(trace, 0);
+	munit_assert_uint16(rec->pc, ==, 0xc000);
+	munit_assert_uint8(rec->bytes[0], ==, OP_6502_INC_ZP);
+	munit_assert_uint8(rec->bytes[1], ==, 0x00);
+	munit_assert_uint16(rec->address, ==, 0x0000);
+
+	rec = cpu_6502_trace_record(trace, 2);
+	munit_assert_uint16(rec->pc, ==, 0xc004);
+	munit_assert_uint8(rec->bytes[0], ==, OP_6502_STA_ZP);
+	munit_assert_uint8(rec->bytes[1], ==, 0x61);
+	munit_assert_uint8(rec->reg_a, ==, 10);
+	munit_assert_uint16(rec->address, ==, 0x0061);
+
+	rec = cpu_6502_trace_record(trace, 3);
+	munit_assert_uint16(rec->pc, ==, 0xc006);
+	munit_assert_uint8(rec->bytes[0], ==, OP_6502_BRK);
+	munit_assert_uint16(cpu_6502_trace_record(trace, 4)->pc, ==, 0xfe00);
+
+	// the ring buffer keeps the most recent instructions
+	munit_assert_int(dms_run_for_instructions(dms, 10, 1000000), ==, DMS_STOP_REACHED);
+	munit_assert_uint64(trace->count, ==, 15);
+	munit_assert_uint64(cpu_6502_trace_size(trace), ==, 8);
+
+	for (uint64_t i = 0; i < 7; ++i) {
+		rec = cpu_6502_trace_record(trace, i);
+		munit_assert_uint16(rec->pc, ==, 0xfe00);
+		munit_assert_uint8(rec->bytes[0], ==, OP_6502_JMP_ABS);
+		munit_assert_uint8(rec->bytes[1], ==, 0x00);
+		munit_assert_uint8(rec->bytes[2], ==, 0xfe);
+	}
+
+	// every JMP takes the same time
+	int64_t *ticks = cpu_6502_trace_ticks(trace);
+	munit_assert_int64(ticks[7], ==, trace->last_tick);
+	munit_assert_int64(ticks[7] - ticks[6], >, 0);
+	munit_assert_int64(ticks[7] - ticks[6], ==, ticks[1] - ticks[0]);
+	arrfree(ticks);
+
+	// save and load the trace
+	munit_assert_true(cpu_6502_trace_save(trace, TRACE_FILE));
+	Cpu6502Trace *loaded = cpu_6502_trace_load(TRACE_FILE);
+	munit_assert_not_null(loaded);
+	munit_assert_uint64(cpu_6502_trace_size(loaded), ==, 8);
+	munit_assert_int64(loaded->last_tick, ==, trace->last_tick);
+	for (uint64_t i = 0; i < 8; ++i) {
+		munit_assert_memory_equal(sizeof(Cpu6502TraceRecord), cpu_6502_trace_record(loaded, i), cpu_6502_trace_record(trace, i));
+	}
+	cpu_6502_trace_destroy(loaded);
+
+	// a header with a record count that is too large or not backed by the file is rejected
+	munit_assert_uint64(CPU_6502_TRACE_MAX_CAPACITY, >=, 100000000);		// room for the last 100 million instructions
+	munit_assert_null(cpu_6502_trace_create(CPU_6502_TRACE_MAX_CAPACITY + 1));
+
+	int8_t *data = NULL;
+	munit_assert_size(file_load_binary(TRACE_FILE, &data), ==, 28 + 8 * sizeof(Cpu6502TraceRecord));
+
+	static const uint64_t bad_sizes[] = {UINT64_MAX, (1ull << 63) + 1, CPU_6502_TRACE_MAX_CAPACITY + 1, 9};
+	for (size_t i = 0; i < sizeof(bad_sizes) / sizeof(bad_sizes[0]); ++i) {
+		for (size_t b = 0; b < 8; ++b) {
+			data[12 + b] = (int8_t) (bad_sizes[i] >> (b * 8));
+		}
+		munit_assert_true(file_save_binary(CORRUPT_FILE, data, arrlenu(data)));
+		munit_assert_null(cpu_6502_trace_load(CORRUPT_FILE));
+	}
+	arrfree(data);
+
+	remove(TRACE_FILE);
+	remove(CORRUPT_FILE);
+
+	munit_assert_null(cpu_6502_trace_load(TRACE_FILE));
+
+	// stop tracing
+	cpu_6502_set_trace(dev->cpu, NULL);
+	munit_assert_int(dms_run_for_instructions(dms, 2, 1000000), ==, DMS_STOP_REACHED);
+	munit_assert_uint64(trace->count, ==, 15);
+
+	cpu_6502_trace_destroy(trace);
+	dms_release_context(dms);
+	dev_minimal_6502_teardown(dev);
+
+	return MUNIT_OK;
+}
+
+static MunitResult test_profile(const MunitParameter params[], void *user_data_or_fixture) {
+
+	static const char *SYMBOL_FILE = "test_profile.sym";
+
+	DevMinimal6502 *dev = dev_minimal_6502_setup(3);
+	Cpu6502Profile *profile = cpu_6502_profile_create();
+
+	struct DmsContext *dms = dms_create_context();
+	dms_set_device(dms, (struct Device *) dev);
+
+	// start profiling at the start of the program
+	munit_assert_int(dms_run_until_pc(dms, 0xc000, 1000000), ==, DMS_STOP_REACHED);
+	cpu_6502_set_profile(dev->cpu, profile);
+	munit_assert_int(dms_run_until_pc(dms, 0xc008, 1000000), ==, DMS_STOP_REACHED);
+	munit_assert_int(dms_run_for_instructions(dms, 1, 1000000), ==, DMS_STOP_REACHED);
+
+	// the instruction at $c000 was already started when the profile was attached
+	munit_assert_uint64(profile->instructions[0xc000], ==, 0);
+	munit_assert_uint64(profile->instructions[0xc002], ==, 3);
+	munit_assert_uint64(profile->instructions[0xc006], ==, 3);
+	munit_assert_uint64(profile->instructions[0xc008], ==, 2);
+	munit_assert_uint64(profile->instructions[0xc010], ==, 3);
+	munit_assert_uint64(profile->instructions[0xc012], ==, 3);
+
+	munit_assert_uint64(profile->cycles[0xc002], ==, 3 * 6);		// JSR
+	munit_assert_uint64(profile->cycles[0xc005], ==, 3 * 2);		// DEX
+	munit_assert_uint64(profile->cycles[0xc006], ==, 2 * 3 + 2);	// BNE: taken twice
+	munit_assert_uint64(profile->cycles[0xc010], ==, 3 * 2);		// NOP
+	munit_assert_uint64(profile->cycles[0xc012], ==, 3 * 6);		// RTS
+	munit_assert_uint64(profile->cycles[0xc008], ==, 3);			// JMP (the second one is in progress)
+
+	// JSR + NOP + NOP + RTS
+	munit_assert_uint64(profile->calls[0xc010], ==, 3);
+	munit_assert_uint64(profile->inclusive_cycles[0xc010], ==, 3 * 16);
+	munit_assert_int(profile->call_depth, ==, 0);
+
+	// no counting when the profile is detached
+	cpu_6502_set_profile(dev->cpu, NULL);
+	munit_assert_int(dms_run_for_instructions(dms, 10, 1000000), ==, DMS_STOP_REACHED);
+	munit_assert_uint64(profile->instructions[0xc008], ==, 2);
+
+	// report with labels
+	FILE *fp = fopen(SYMBOL_FILE, "w");
+	munit_assert_not_null(fp);
+	fprintf(fp, "al C:c000 .main\n");
+	fprintf(fp, "subroutine = $c010\n");
+	fprintf(fp, "; comment\n");
+	fprintf(fp, "no_digits = $\n");
+	fprintf(fp, "no_hex_digits = 0x\n");
+	fclose(fp);
+
+	Cpu6502Symbol *symbols = cpu_6502_symbols_load(SYMBOL_FILE);
+	remove(SYMBOL_FILE);
+	munit_assert_size(arrlenu(symbols), ==, 2);
+	munit_assert_uint16(symbols[0].address, ==, 0xc000);
+	munit_assert_string_equal(symbols[0].name, "main");
+	munit_assert_uint16(symbols[1].address, ==, 0xc010);
+	munit_assert_string_equal(symbols[1].name, "subroutine");
+
+	uint16_t address = 0xffff;
+	munit_assert_true(cpu_6502_symbol_parse_address("0x1234", &address));
+	munit_assert_uint16(address, ==, 0x1234);
+	munit_assert_true(cpu_6502_symbol_parse_address("4660", &address));
+	munit_assert_uint16(address, ==, 0x1234);
+	munit_assert_false(cpu_6502_symbol_parse_address("$", &address));
+	munit_assert_false(cpu_6502_symbol_parse_address("0x", &address));
+	munit_assert_false(cpu_6502_symbol_parse_address("$-1", &address));
+	munit_assert_false(cpu_6502_symbol_parse_address("$10000", &address));
+
+	char *report = cpu_6502_profile_report(profile, symbols, 10);
+	munit_assert_not_null(strstr(report, "$c002-$c008  main"));
+	munit_assert_not_null(strstr(report, "$c010-$c012  subroutine"));
+	munit_assert_not_null(strstr(report, "$c010        subroutine"));
+	arrfree(report);
+
+	cpu_6502_symbols_release(symbols);
+	cpu_6502_profile_destroy(profile);
+	dms_release_context(dms);
+	dev_minimal_6502_teardown(dev);
+
+	return MUNIT_OK;
+}
+
+static MunitResult test_coverage(const MunitParameter params[], void *user_data_or_fixture) {
+
+	static const char *COVERAGE_FILE = "test_coverage.dmscov";
+	static const char *LINES_FILE = "test_coverage.lines";
+	static const char *SYMBOL_FILE = "test_coverage.sym";
+
+	DevMinimal6502 *dev = dev_minimal_6502_setup(0);
+	Cpu6502Coverage *coverage = cpu_6502_coverage_create();
+	cpu_6502_set_coverage(dev->cpu, coverage);
+
+	// run the program until the program counter reaches the IRQ-handler (after the BRK)
+	int limit = 1000;
+
+	while (limit > 0 && dev->cpu->reg_pc != 0xfe00) {
+		dev->process(dev);
+		--limit;
+	}
+	munit_assert_int(limit, >, 0);
+
+	// reset: the stack accesses are dummy reads
+	munit_assert_uint8(coverage->flags[0xfffc], ==, COVERAGE_6502_READ);
+	munit_assert_uint8(coverage->flags[0xfffd], ==, COVERAGE_6502_READ);
+	munit_assert_uint8(coverage->flags[0x01ff], ==, 0);
+
+	// inc $00 / lda #10 / sta $61 / brk
+	munit_assert_uint8(coverage->flags[0xc000], ==, COVERAGE_6502_OPCODE);
+	munit_assert_uint8(coverage->flags[0xc001], ==, COVERAGE_6502_OPERAND);
+	munit_assert_uint8(coverage->flags[0x0000], ==, COVERAGE_6502_READ | COVERAGE_6502_WRITE);
+	munit_assert_uint8(coverage->flags[0xc002], ==, COVERAGE_6502_OPCODE);
+	munit_assert_uint8(coverage->flags[0xc003], ==, COVERAGE_6502_OPERAND);
+	munit_assert_uint8(coverage->flags[0xc004], ==, COVERAGE_6502_OPCODE);
+	munit_assert_uint8(coverage->flags[0xc005], ==, COVERAGE_6502_OPERAND);
+	munit_assert_uint8(coverage->flags[0x0061], ==, COVERAGE_6502_WRITE);
+	munit_assert_uint8(coverage->flags[0xc006], ==, COVERAGE_6502_OPCODE);
+	munit_assert_uint8(coverage->flags[0xc007], ==, 0);
+	munit_assert_uint8(coverage->flags[0x01fd], ==, COVERAGE_6502_WRITE);
+	munit_assert_uint8(coverage->flags[0x01fc], ==, COVERAGE_6502_WRITE);
+	munit_assert_uint8(coverage->flags[0x01fb], ==, COVERAGE_6502_WRITE);
+	munit_assert_uint8(coverage->flags[0xfffe], ==, COVERAGE_6502_READ);
+	munit_assert_uint8(coverage->flags[0xffff], ==, COVERAGE_6502_READ);
+
+	munit_assert_size(cpu_6502_coverage_count(coverage, COVERAGE_6502_OPCODE), ==, 4);
+	munit_assert_size(cpu_6502_coverage_count(coverage, COVERAGE_6502_EXECUTED), ==, 7);
+
+	// save, load and merge
+	cpu_6502_set_coverage(dev->cpu, NULL);
+	munit_assert_true(cpu_6502_coverage_save(coverage, COVERAGE_FILE));
+
+	Cpu6502Coverage *merged = cpu_6502_coverage_load(COVERAGE_FILE);
+	remove(COVERAGE_FILE);
+	munit_assert_not_null(merged);
+	munit_assert_memory_equal(sizeof(coverage->flags), merged->flags, coverage->flags);
+
+	cpu_6502_coverage_clear(coverage);
+	coverage->flags[0xc008] = COVERAGE_6502_OPCODE;
+	coverage->flags[0x0000] = COVERAGE_6502_READ;
+	cpu_6502_coverage_merge(merged, coverage);
+	munit_assert_uint8(merged->flags[0xc008], ==, COVERAGE_6502_OPCODE);
+	munit_assert_uint8(merged->flags[0x0000], ==, COVERAGE_6502_READ | COVERAGE_6502_WRITE);
+	munit_assert_size(cpu_6502_coverage_count(merged, COVERAGE_6502_OPCODE), ==, 5);
+
+	// lcov tracefile
+	FILE *fp = fopen(LINES_FILE, "w");
+	munit_assert_not_null(fp);
+	fprintf(fp, "# address file:line\n");
+	fprintf(fp, "$c000 prog.asm:1\n");
+	fprintf(fp, "$c002 prog.asm:2\n");
+	fprintf(fp, "$c004 prog.asm:3\n");
+	fprintf(fp, "$c006 prog.asm:4\n");
+	fprintf(fp, "$c009 prog.asm:6\n");
+	fprintf(fp, "0xfe00 irq.asm:10\n");
+	fprintf(fp, "invalid\n");
+	fprintf(fp, "$ prog.asm:7\n");
+	fprintf(fp, "0x prog.asm:8\n");
+	fclose(fp);
+
+	fp = fopen(SYMBOL_FILE, "w");
+	munit_assert_not_null(fp);
+	fprintf(fp, "main = $c000\n");
+	fprintf(fp, "unused = $c009\n");
+	fclose(fp);
+
+	Cpu6502LineMap *map = cpu_6502_line_map_load(LINES_FILE);
+	Cpu6502Symbol *symbols = cpu_6502_symbols_load(SYMBOL_FILE);
+	remove(LINES_FILE);
+	remove(SYMBOL_FILE);
+	munit_assert_not_null(map);
+	munit_assert_size(arrlenu(map->files), ==, 2);
+	munit_assert_size(arrlenu(map->lines), ==, 6);
+
+	char *lcov = cpu_6502_coverage_lcov(merged, map, symbols, "minimal");
+	arrput(lcov, '\0');
+	munit_assert_not_null(strstr(lcov, "TN:minimal\nSF:prog.asm\n"));
+	munit_assert_not_null(strstr(lcov, "FN:1,main\nFN:6,unused\nFNDA:1,main\nFNDA:0,unused\nFNF:2\nFNH:1\n"));
+	munit_assert_not_null(strstr(lcov, "DA:4,1\nDA:6,0\nLF:5\nLH:4\nend_of_record\n"));
+	munit_assert_not_null(strstr(lcov, "SF:irq.asm\nDA:10,0\nLF:1\nLH:0\nend_of_record\n"));
+	arrfree(lcov);
+
+	cpu_6502_symbols_release(symbols);
+	cpu_6502_line_map_release(map);
+	cpu_6502_coverage_destroy(merged);
+	cpu_6502_coverage_destroy(coverage);
+	dev_minimal_6502_teardown(dev);
+
+	return MUNIT_OK;
+}
+
+static void write_recording_event(const char *filename, uint8_t type, const char *chip_name, int32_t param0, uint32_t data_len) {
+	// a recording with a single event without data (the data length can be anything)
+	FILE *fp = fopen(filename, "wb");
+	munit_assert_not_null(fp);
+
+	fwrite("DMSINPUT", 1, 8, fp);
+	file_write_uint_le(fp, INPUT_RECORDING_VERSION, 4);
+	file_write_uint_le(fp, 0, 8);
+	file_write_uint_le(fp, type, 1);
+	file_write_uint_le(fp, strlen(chip_name), 1);
+	fwrite(chip_name, 1, strlen(chip_name), fp);
+	file_write_uint_le(fp, (uint32_t) param0, 4);
+	file_write_uint_le(fp, 0, 4);
+	file_write_uint_le(fp, data_len, 4);
+	fclose(fp);
+}
+
+static bool replay_accepted(DevMinimal6502 *dev, const char *filename) {
+	struct DmsContext *dms = dms_create_context();
+	dms_set_device(dms, (struct Device *) dev);
+	bool result = dms_input_replay(dms, filename);
+	dms_release_context(dms);
+	return result;
+}
+
+static MunitResult test_input_replay(const MunitParameter params[], void *user_data_or_fixture) {
+
+	char RECORDING[1024];
+	char MALFORMED[1024];
+	temp_file_path(RECORDING, sizeof(RECORDING), "test_input_replay.dmsinput");
+	temp_file_path(MALFORMED, sizeof(MALFORMED), "test_input_replay_malformed.dmsinput");
+
+	// record a session with a few keypresses and a reset
+	DevMinimal6502 *dev_rec = dev_minimal_6502_setup(2);
+	const int64_t ms = simulator_interval_to_tick_count(dev_rec->simulator, MS_TO_PS(1));
+	struct DmsContext *dms = dms_create_context();
+	dms_set_device(dms, (struct Device *) dev_rec);
+	munit_assert_true(dms_input_record_start(dms, RECORDING));
+
+	dms_input_key_dwell_time(dms, dev_rec->keypad, 20);
+	dms_run_for_ticks(dms, 3 * ms);
+	dms_input_key_pressed(dms, dev_rec->keypad, 0, 1);
+	dms_run_for_ticks(dms, 7 * ms);
+	dms_input_key_pressed(dms, dev_rec->keypad, 0, 3);
+	dms_run_for_ticks(dms, 13 * ms);
+	dms_input_reset(dms);
+	dms_run_for_ticks(dms, 5 * ms);
+	dms_input_key_pressed(dms, dev_rec->keypad, 0, 2);
+	dms_run_for_ticks(dms, 11 * ms);
+
+	dms_input_record_stop(dms);
+	dms_release_context(dms);
+
+	int64_t tick_end = dev_rec->simulator->current_tick;
+
+	// replaying the recording on a new device ends up in the exact same state
+	DevMinimal6502 *dev_play = dev_minimal_6502_setup(2);
+	dms = dms_create_context();
+	dms_set_device(dms, (struct Device *) dev_play);
+	munit_assert_true(dms_input_replay(dms, RECORDING));
+	dms_run_for_ticks(dms, tick_end);
+
+	munit_assert_int64(dev_play->simulator->current_tick, ==, tick_end);
+	munit_assert_memory_equal(sizeof(uint64_t) * SIGNAL_BLOCKS, dev_play->simulator->signal_pool->signals_value, dev_rec->simulator->signal_pool->signals_value);
+	munit_assert_memory_equal(0x100, dev_play->ram->data_array, dev_rec->ram->data_array);
+	dms_release_context(dms);
+
+	// without the inputs the result is different
+	DevMinimal6502 *dev_none = dev_minimal_6502_setup(2);
+	dms = dms_create_context();
+	dms_set_device(dms, (struct Device *) dev_none);
+	dms_run_for_ticks(dms, tick_end);
+	munit_assert_uint8(dev_none->ram->data_array[0x00], !=, dev_rec->ram->data_array[0x00]);
+	dms_release_context(dms);
+
+	// an invalid recording is rejected
+	dms = dms_create_context();
+	dms_set_device(dms, (struct Device *) dev_none);
+	munit_assert_false(dms_input_replay(dms, "test_input_replay.missing"));
+	dms_release_context(dms);
+
+	// as is a recording with event parameters the chip doesn't accept (a dwell time of 0 for the first event)
+	int8_t *data = NULL;
+	munit_assert_size(file_load_binary(RECORDING, &data), >, 26);
+	size_t param_offset = 8 + 4 + 8 + 1 + 1 + (size_t) data[8 + 4 + 8 + 1];
+	munit_assert_int8(data[param_offset], ==, 20);
+	data[param_offset] = 0;
+
+	FILE *fp = fopen(MALFORMED, "wb");
+	munit_assert_not_null(fp);
+	fwrite(data, 1, arrlenu(data), fp);
+	fclose(fp);
+	arrfree(data);
+
+	dms = dms_create_context();
+	dms_set_device(dms, (struct Device *) dev_none);
+	munit_assert_false(dms_input_replay(dms, MALFORMED));
+	dms_release_context(dms);
+
+	// events must target the kind of chip they're meant for and can't claim huge amounts of data
+	write_recording_event(MALFORMED, INPUT_EVENT_KEY_DWELL, "KEYPAD", 20, 0);
+	munit_assert_true(replay_accepted(dev_none, MALFORMED));
+	write_recording_event(MALFORMED, INPUT_EVENT_KEY_DWELL, "RAM", 20, 0);
+	munit_assert_false(replay_accepted(dev_none, MALFORMED));
+	write_recording_event(MALFORMED, INPUT_EVENT_TAPE_LOAD, "KEYPAD", 0, 0);
+	munit_assert_false(replay_accepted(dev_none, MALFORMED));
+	write_recording_event(MALFORMED, INPUT_EVENT_DISK_LOAD, "PIA", 0, 0);
+	munit_assert_false(replay_accepted(dev_none, MALFORMED));
+	write_recording_event(MALFORMED, INPUT_EVENT_KEY_DWELL, "KEYPAD", 20, UINT32_MAX);
+	munit_assert_false(replay_accepted(dev_none, MALFORMED));
+
+	remove(RECORDING);
+	remove(MALFORMED);
+	dev_minimal_6502_teardown(dev_rec);
+	dev_minimal_6502_teardown(dev_play);
+	dev_minimal_6502_teardown(dev_none);
+
+	return MUNIT_OK;
+}
+
+static MunitResult test_trigger_request(const MunitParameter params[], void *user_data_or_fixture) {
+
+	DevMinimal6502 *dev = dev_minimal_6502_setup(0);
+	Simulator *sim = dev->simulator;
+	munit_assert_false(sim->signal_history->capture_active);
+
+	struct DmsContext *dms = dms_create_context();
+	dms_set_device(dms, (struct Device *) dev);
+
+	// arming while not capturing still applies the request
+	SignalTrigger *config = signal_trigger_create();
+	uint32_t stage = signal_trigger_stage_add(config, 1);
+	signal_trigger_stage_edge(config, stage, dev->cpu->signals[PIN_6502_RW], true, false);
+	signal_trigger_set_depth(config, 4, 4);
+
+	signal_trigger_request_arm(sim->signal_trigger, config);
+	munit_assert_true(signal_trigger_request_pending(sim->signal_trigger));
+
+	munit_assert_int(dms_run_for_instructions(dms, 2, 1000000), ==, DMS_STOP_REACHED);
+	munit_assert_false(signal_trigger_request_pending(sim->signal_trigger));
+	munit_assert_int(signal_trigger_state(sim->signal_trigger), ==, TRIGGER_ARMED);
+
+	// and so does disarming
+	signal_trigger_request_disarm(sim->signal_trigger);
+	munit_assert_int(dms_run_for_instructions(dms, 1, 1000000), ==, DMS_STOP_REACHED);
+	munit_assert_false(signal_trigger_request_pending(sim->signal_trigger));
+	munit_assert_int(signal_trigger_state(sim->signal_trigger), ==, TRIGGER_DISABLED);
+
+	signal_trigger_destroy(config);
+	dms_release_context(dms);
+	dev_minimal_6502_teardown(dev);
+
+	return MUNIT_OK;
+}
+
+#ifndef DMS_NO_THREADING
+
+static MunitResult test_background_thread(const MunitParameter params[], void *user_data_or_fixture) {
+
+	DevMinimal6502 *dev = dev_minimal_6502_setup(0);
+
+	struct DmsContext *dms = dms_create_context();
+	dms_set_device(dms, (struct Device *) dev);
+	dms_change_simulation_speed_ratio(dms, 100.0);
+	dms_start_execution(dms);
+
+	// breakpoints and state changes are picked up by the running simulation thread
+	munit_assert_true(dms_toggle_breakpoint(dms, 0xfe00));
+	dms_run(dms);
+
+	int limit = 5000;
+	while (--limit > 0 && dms_get_state(dms) != DS_WAIT) {
+		stopwatch_sleep(MS_TO_PS(1));
+	}
+
+	munit_assert_int(limit, >, 0);
+	DmsStatus status = dms_get_status(dms);
+	munit_assert_int(status.state, ==, DS_WAIT);
+	munit_assert_int64(status.program_counter, ==, 0xfe00);
+	munit_assert_int64(status.current_tick, >, 0);
+	munit_assert_int64(dms_breakpoint_hit_count(dms, DMS_BREAKPOINT_PC, 0xfe00), ==, 1);
+	munit_assert_int64(dms_pacing_stats(dms).slice_ps, >=, US_TO_PS(100));
+
+	// a single step moves the simulation forward without blocking the caller
+	dms_single_step(dms);
+	limit = 5000;
+	while (--limit > 0 && dms_get_status(dms).current_tick == status.current_tick) {
+		stopwatch_sleep(MS_TO_PS(1));
+	}
+	munit_assert_int(limit, >, 0);
+	munit_assert_int(dms_get_state(dms), ==, DS_WAIT);
+
+	dms_stop_execution(dms);
+	dms_release_context(dms);
+	dev_minimal_6502_teardown(dev);
+
+	return MUNIT_OK;
+}
+
+#endif // DMS_NO_THREADING
+
 MunitTest dev_minimal_6502_tests[] = {
 	{ "/run_program", test_program, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/pia", test_pia, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/read_write_memory", test_read_write_memory, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/watchpoint", test_watchpoint, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/conditional_breakpoint", test_conditional_breakpoint, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/run_until", test_run_until, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/input_replay", test_input_replay, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/instruction_trace", test_instruction_trace, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/profile", test_profile, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/coverage", test_coverage, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/trigger_request", test_trigger_request, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+#ifndef DMS_NO_THREADING
+	{ "/background_thread", test_background_thread, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+#endif // DMS_NO_THREADING
 	{ NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
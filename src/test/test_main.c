@@ -23,9 +23,15 @@ extern MunitTest dev_minimal_6502_tests[];
 extern MunitTest input_keypad_tests[];
 extern MunitTest ram_8d16a_tests[];
 extern MunitTest rom_8d16a_tests[];
+extern MunitTest rom_image_tests[];
 extern MunitTest utils_tests[];
 extern MunitTest filt_6502_asm_tests[];
 extern MunitTest signal_history_tests[];
+extern MunitTest signal_trigger_tests[];
+extern MunitTest signal_history_decoders_tests[];
+extern MunitTest bus_watcher_tests[];
+extern MunitTest breakpoint_condition_tests[];
+extern MunitTest debug_server_tests[];
 
 static MunitSuite extern_suites[] = {
 	{	.prefix = "/atomics",
@@ -58,6 +64,12 @@ static MunitSuite extern_suites[] = {
 		.iterations = 1,
 		.options = MUNIT_SUITE_OPTION_NONE
 	},
+	{	.prefix = "/rom_image",
+		.tests = rom_image_tests,
+		.suites = NULL,
+		.iterations = 1,
+		.options = MUNIT_SUITE_OPTION_NONE
+	},
 	{	.prefix = "/chip_6520",
 		.tests = chip_6520_tests,
 		.suites = NULL,
@@ -160,6 +172,36 @@ static MunitSuite extern_suites[] = {
 		.iterations = 1,
 		.options = MUNIT_SUITE_OPTION_NONE
 	},
+	{	.prefix = "/signal_trigger",
+		.tests = signal_trigger_tests,
+		.suites = NULL,
+		.iterations = 1,
+		.options = MUNIT_SUITE_OPTION_NONE
+	},
+	{	.prefix = "/signal_history_decoders",
+		.tests = signal_history_decoders_tests,
+		.suites = NULL,
+		.iterations = 1,
+		.options = MUNIT_SUITE_OPTION_NONE
+	},
+	{	.prefix = "/bus_watcher",
+		.tests = bus_watcher_tests,
+		.suites = NULL,
+		.iterations = 1,
+		.options = MUNIT_SUITE_OPTION_NONE
+	},
+	{	.prefix = "/breakpoint_condition",
+		.tests = breakpoint_condition_tests,
+		.suites = NULL,
+		.iterations = 1,
+		.options = MUNIT_SUITE_OPTION_NONE
+	},
+	{	.prefix = "/debug_server",
+		.tests = debug_server_tests,
+		.suites = NULL,
+		.iterations = 1,
+		.options = MUNIT_SUITE_OPTION_NONE
+	},
 	{ NULL, NULL, NULL, 0, MUNIT_SUITE_OPTION_NONE}
 };
 
@@ -71,8 +71,92 @@ MunitResult test_write(const MunitParameter params[], void *user_data_or_fixture
 	return MUNIT_OK;
 }
 
+static bool ram_8d16a_cycle(Ram8d16a *ram) {
+	// process the chip only when it depends on one of the signals that changed, like the simulator does
+	uint64_t dirty_chips = signal_pool_cycle(ram->signal_pool);
+	bool activated = (dirty_chips & (1ull << ram->id)) != 0;
+
+	if (activated) {
+		ram->process(ram);
+	}
+	return activated;
+}
+
+MunitResult test_activations(const MunitParameter params[], void *user_data_or_fixture) {
+
+	Simulator *sim = simulator_create(NS_TO_PS(100));
+	Ram8d16a *ram = ram_8d16a_create(10, sim, (Ram8d16aSignals){0});
+	simulator_register_chip(sim, (Chip *) ram, "RAM");
+	simulator_device_complete(sim);
+
+	uint64_t chip_mask = 1ull << ram->id;
+	uint64_t *dependents = sim->signal_pool->dependent_components;
+
+	for (uint32_t i = 0; i < 1024; ++i) {
+		ram->data_array[i] = (uint8_t) (i * 7);
+	}
+
+	SIGNAL_WRITE(CE_B, ACTLO_DEASSERT);
+	SIGNAL_WRITE(OE_B, ACTLO_DEASSERT);
+	SIGNAL_WRITE(WE_B, ACTLO_DEASSERT);
+	ram_8d16a_cycle(ram);
+	munit_assert_true(ram->deselected);
+	munit_assert_uint64(dependents[signal_array_subscript(SIGNAL(A0))] & chip_mask, ==, 0);
+	munit_assert_uint64(dependents[signal_array_subscript(SIGNAL(OE_B))] & chip_mask, ==, 0);
+	munit_assert_uint64(dependents[signal_array_subscript(SIGNAL(CE_B))] & chip_mask, ==, chip_mask);
+
+	// read cycles, every other one selects another chip: address (+ chip enable), output enable, release
+	int activations = 0;
+
+	for (uint32_t i = 0; i < 256; ++i) {
+		bool selected = (i & 1) == 0;
+		SIGNAL_GROUP_WRITE(address, (i * 37) & 0x3ff);
+		SIGNAL_WRITE(CE_B, !selected);
+		activations += ram_8d16a_cycle(ram);
+
+		SIGNAL_WRITE(OE_B, ACTLO_ASSERT);
+		activations += ram_8d16a_cycle(ram);
+		if (selected) {
+			munit_assert_uint8(SIGNAL_GROUP_READ_NEXT_U8(data), ==, (uint8_t) (((i * 37) & 0x3ff) * 7));
+		}
+
+		SIGNAL_WRITE(OE_B, ACTLO_DEASSERT);
+		activations += ram_8d16a_cycle(ram);
+	}
+
+	// 3 activations for a selected cycle, 1 (chip enable) for a deselected one
+	munit_assert_int(activations, ==, 128 * 3 + 128 * 1);
+
+	// write cycle: the data lines are only watched while write-enable is asserted
+	SIGNAL_GROUP_WRITE(address, 0x123);
+	SIGNAL_WRITE(CE_B, ACTLO_ASSERT);
+	munit_assert_true(ram_8d16a_cycle(ram));
+	munit_assert_uint64(dependents[signal_array_subscript(SIGNAL(D0))] & chip_mask, ==, 0);
+
+	SIGNAL_GROUP_WRITE(data, 0x5a);
+	munit_assert_false(ram_8d16a_cycle(ram));
+
+	SIGNAL_WRITE(WE_B, ACTLO_ASSERT);
+	munit_assert_true(ram_8d16a_cycle(ram));
+	munit_assert_uint64(dependents[signal_array_subscript(SIGNAL(D0))] & chip_mask, ==, chip_mask);
+	munit_assert_uint8(ram->data_array[0x123], ==, 0x5a);
+
+	SIGNAL_GROUP_WRITE(data, 0xa5);
+	munit_assert_true(ram_8d16a_cycle(ram));
+	munit_assert_uint8(ram->data_array[0x123], ==, 0xa5);
+
+	SIGNAL_WRITE(WE_B, ACTLO_DEASSERT);
+	munit_assert_true(ram_8d16a_cycle(ram));
+	munit_assert_uint64(dependents[signal_array_subscript(SIGNAL(D0))] & chip_mask, ==, 0);
+
+	simulator_destroy(sim);
+
+	return MUNIT_OK;
+}
+
 MunitTest ram_8d16a_tests[] = {
 	{ "/read", test_read, ram_8d16a_setup, ram_8d16a_teardown, MUNIT_TEST_OPTION_NONE, NULL },
 	{ "/write", test_write, ram_8d16a_setup, ram_8d16a_teardown, MUNIT_TEST_OPTION_NONE, NULL },
+	{ "/activations", test_activations, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
 	{ NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
@@ -0,0 +1,84 @@
+// test/test_rom_image.c - Johan Smet - BSD-3-Clause (see LICENSE)
+
+#include "munit/munit.h"
+#include "rom_image.h"
+
+#include <stdio.h>
+
+static const char *ROM_FILE_A = "test_rom_image_a.bin";
+static const char *ROM_FILE_B = "test_rom_image_b.bin";
+static const char *ROM_FILE_C = "test_rom_image_c.bin";
+static const char *ROM_FILE_EMPTY = "test_rom_image_empty.bin";
+
+static void write_rom_file(const char *filename, uint8_t seed, size_t size) {
+	FILE *fp = fopen(filename, "wb");
+	munit_assert_not_null(fp);
+
+	for (size_t i = 0; i < size; ++i) {
+		fputc((uint8_t) (i + seed), fp);
+	}
+	fclose(fp);
+}
+
+static MunitResult test_acquire(const MunitParameter params[], void *user_data_or_fixture) {
+
+	write_rom_file(ROM_FILE_A, 0, 4096);
+	write_rom_file(ROM_FILE_B, 0, 4096);
+	write_rom_file(ROM_FILE_C, 1, 2048);
+	write_rom_file(ROM_FILE_EMPTY, 0, 0);
+
+	munit_assert_size(rom_image_cache_size(), ==, 0);
+
+	// the file is only loaded once
+	const RomImage *image_a = rom_image_acquire(ROM_FILE_A);
+	munit_assert_not_null(image_a);
+	munit_assert_size(image_a->size, ==, 4096);
+	munit_assert_uint8(image_a->data[0x0000], ==, 0x00);
+	munit_assert_uint8(image_a->data[0x0fff], ==, 0xff);
+	munit_assert_ptr_equal(rom_image_acquire(ROM_FILE_A), image_a);
+	munit_assert_size(rom_image_cache_size(), ==, 1);
+
+	// a file with the same contents shares the image
+	const RomImage *image_b = rom_image_acquire(ROM_FILE_B);
+	munit_assert_ptr_equal(image_b, image_a);
+	munit_assert_size(rom_image_cache_size(), ==, 1);
+
+	const RomImage *image_c = rom_image_acquire(ROM_FILE_C);
+	munit_assert_not_null(image_c);
+	munit_assert_ptr_not_equal(image_c, image_a);
+	munit_assert_size(image_c->size, ==, 2048);
+	munit_assert_uint8(image_c->data[0x0000], ==, 0x01);
+	munit_assert_uint64(image_c->hash, !=, image_a->hash);
+	munit_assert_size(rom_image_cache_size(), ==, 2);
+
+	// files that can't be loaded
+	munit_assert_null(rom_image_acquire("test_rom_image_missing.bin"));
+	munit_assert_null(rom_image_acquire(ROM_FILE_EMPTY));
+	munit_assert_size(rom_image_cache_size(), ==, 2);
+
+	remove(ROM_FILE_A);
+	remove(ROM_FILE_B);
+	remove(ROM_FILE_C);
+	remove(ROM_FILE_EMPTY);
+
+	// the image stays available while it's referenced, even if the file is gone
+	munit_assert_ptr_equal(rom_image_acquire(ROM_FILE_A), image_a);
+
+	rom_image_release(image_a);
+	rom_image_release(image_a);
+	rom_image_release(image_b);
+	munit_assert_size(rom_image_cache_size(), ==, 2);
+	munit_assert_uint8(image_a->data[0x0fff], ==, 0xff);
+
+	rom_image_release(image_a);
+	rom_image_release(image_c);
+	munit_assert_size(rom_image_cache_size(), ==, 0);
+	munit_assert_null(rom_image_acquire(ROM_FILE_A));
+
+	return MUNIT_OK;
+}
+
+MunitTest rom_image_tests[] = {
+	{ "/acquire", test_acquire, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL },
+	{ NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
@@ -3,7 +3,10 @@
 #include "munit/munit.h"
 
 #include "signal_history.h"
-#include "signal_pool.h"
+#include "signal_line.h"
+
+#include "sys/atomics.h"
+#include "sys/threads.h"
 
 static void *signal_history_setup(const MunitParameter params[], void *user_data) {
 	SignalHistory *history = signal_history_create(16, 4, 32, 6125);
@@ -187,11 +190,350 @@ static MunitResult test_diagram_data(const MunitParameter params[], void* user_d
     return MUNIT_OK;
 }
 
+static MunitResult test_capture_mask(const MunitParameter params[], void* user_data_or_fixture) {
+	SignalHistory *history = (SignalHistory *) user_data_or_fixture;
+
+	uint64_t sample_values[SIGNAL_BLOCKS] = {0};
+	uint64_t sample_changed[SIGNAL_BLOCKS] = {0};
+
+	// only capture signals 1 and 2
+	uint64_t capture_mask[SIGNAL_BLOCKS] = {0};
+	Signal capture_signals[] = {{1, 0, 0}, {2, 0, 0}};
+	signal_history_capture_mask_add_signals(capture_mask, 2, capture_signals);
+	munit_assert_uint64(capture_mask[0], ==, 0b00000110);
+	signal_history_capture_mask_set(history, capture_mask);
+
+	// initial values
+	sample_changed[0] = 0b00001111;
+	munit_assert_true(signal_history_add(history, 0, sample_values, sample_changed, false));
+	munit_assert_true(signal_history_process_incoming_single(history));
+	munit_assert_size(history->signal_samples_head[0], ==, (size_t) -1);
+	munit_assert_size(history->signal_samples_head[1], ==, 0);
+	munit_assert_size(history->signal_samples_head[2], ==, 0);
+	munit_assert_size(history->signal_samples_head[3], ==, (size_t) -1);
+
+	// changes that are completely masked out aren't queued
+	sample_changed[0] = 0b00001001;
+	sample_values[0]  = 0b00001001;
+	munit_assert_true(signal_history_add(history, 3, sample_values, sample_changed, false));
+	munit_assert_false(signal_history_process_incoming_single(history));
+
+	// extend the mask while capturing: signal 3 starts with its current value
+	capture_mask[0] |= 0b00001000;
+	signal_history_capture_mask_set(history, capture_mask);
+
+	sample_changed[0] = 0b00000010;
+	sample_values[0]  = 0b00001011;
+	munit_assert_true(signal_history_add(history, 5, sample_values, sample_changed, false));
+	munit_assert_true(signal_history_process_incoming_single(history));
+	munit_assert_size(history->signal_samples_head[0], ==, (size_t) -1);
+	munit_assert_size(history->signal_samples_head[1], ==, 1);
+	munit_assert_size(history->signal_samples_head[2], ==, 0);
+	munit_assert_size(history->signal_samples_head[3], ==, 0);
+	munit_assert_int64(history->samples_time[history->signal_samples_base[3]], ==, 5);
+	munit_assert_true(history->samples_value[history->signal_samples_base[3]]);
+
+	// existing data is kept when the mask is reset
+	signal_history_capture_mask_reset(history);
+	sample_changed[0] = 0b00000001;
+	sample_values[0]  = 0b00001010;
+	munit_assert_true(signal_history_add(history, 7, sample_values, sample_changed, false));
+	munit_assert_true(signal_history_process_incoming_single(history));
+	munit_assert_size(history->signal_samples_head[0], ==, 0);
+	munit_assert_size(history->signal_samples_head[1], ==, 1);
+	munit_assert_size(history->signal_samples_head[3], ==, 0);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_group_channel(const MunitParameter params[], void* user_data_or_fixture) {
+	SignalHistory *history = (SignalHistory *) user_data_or_fixture;
+
+	uint64_t sample_values[SIGNAL_BLOCKS] = {0};
+	uint64_t sample_changed[SIGNAL_BLOCKS] = {0};
+
+	// group of signals 1-3 (reversed), don't capture individual signals
+	Signal group_signals[] = {{3, 0, 0}, {2, 0, 0}, {1, 0, 0}};
+	SignalGroup group = signal_group_create_from_array(3, group_signals);
+	uint32_t gi = signal_history_group_create(history, "Test", "Bus", group);
+	signal_group_destroy(group);
+
+	munit_assert_uint32(gi, ==, 0);
+	munit_assert_size(history->group_count, ==, 1);
+	munit_assert_string_equal(signal_history_group_names(history)[gi], "Test - Bus");
+	munit_assert_size(signal_history_group_size(history, gi), ==, 3);
+
+	uint64_t capture_mask[SIGNAL_BLOCKS] = {0};
+	signal_history_capture_mask_set(history, capture_mask);
+	signal_history_capture_groups_set(history, 1ull << gi);
+
+	// first timestep: group is captured because it was just enabled
+	sample_changed[0] = 0b00000001;
+	sample_values[0]  = 0b00000011;
+	munit_assert_true(signal_history_add(history, 0, sample_values, sample_changed, false));
+	munit_assert_true(signal_history_process_incoming_single(history));
+	munit_assert_size(history->group_samples_head[gi], ==, 0);
+	munit_assert_uint64(history->group_samples_value[0], ==, 0b100);
+	munit_assert_size(history->signal_samples_head[1], ==, (size_t) -1);
+
+	// change of a non-member isn't queued
+	sample_changed[0] = 0b00000001;
+	sample_values[0]  = 0b00000010;
+	munit_assert_true(signal_history_add(history, 2, sample_values, sample_changed, false));
+	munit_assert_false(signal_history_process_incoming_single(history));
+
+	// change of members
+	sample_changed[0] = 0b00001100;
+	sample_values[0]  = 0b00001110;
+	munit_assert_true(signal_history_add(history, 4, sample_values, sample_changed, false));
+	munit_assert_true(signal_history_process_incoming_single(history));
+	munit_assert_size(history->group_samples_head[gi], ==, 1);
+	munit_assert_int64(history->group_samples_time[1], ==, 4);
+	munit_assert_uint64(history->group_samples_value[1], ==, 0b111);
+
+	// diagram data
+	SignalHistoryDiagramData diagram_data = {
+		.time_begin = 0,
+		.time_end = 10
+	};
+	arrpush(diagram_data.groups, gi);
+	signal_history_diagram_data(history, &diagram_data);
+
+	munit_assert_size(arrlenu(diagram_data.group_samples_time), ==, 2);
+	munit_assert_size(diagram_data.group_start_offsets[0], ==, 0);
+	munit_assert_size(diagram_data.group_start_offsets[1], ==, 2);
+	munit_assert_int64(diagram_data.group_samples_time[0], ==, 4);
+	munit_assert_uint64(diagram_data.group_samples_value[0], ==, 0b111);
+	munit_assert_int64(diagram_data.group_samples_time[1], ==, 0);
+	munit_assert_uint64(diagram_data.group_samples_value[1], ==, 0b100);
+
+	signal_history_diagram_release(&diagram_data);
+
+    return MUNIT_OK;
+}
+
+static void transaction_decoder_process(SignalDecoder *decoder, SignalHistory *history, int64_t time, const uint64_t *signals_value) {
+	// transactions are added directly by the test
+}
+
+static void transaction_decoder_destroy(SignalDecoder *decoder) {
+	free(decoder);
+}
+
+static uint32_t transaction_decoder_add(SignalHistory *history, size_t transaction_capacity) {
+	SignalDecoder *decoder = (SignalDecoder *) calloc(1, sizeof(SignalDecoder));
+	decoder->process = transaction_decoder_process;
+	decoder->destroy = transaction_decoder_destroy;
+	decoder->transaction_capacity = transaction_capacity;
+	return signal_history_decoder_add(history, "Test", "Decoder", decoder);
+}
+
+static MunitResult test_transactions(const MunitParameter params[], void* user_data_or_fixture) {
+	SignalHistory *history = (SignalHistory *) user_data_or_fixture;
+
+	munit_assert_uint32(transaction_decoder_add(history, 0), ==, 0);
+	munit_assert_uint32(transaction_decoder_add(history, 16), ==, 1);
+	munit_assert_size(history->transaction_rings[0].capacity, ==, 16384);
+	munit_assert_size(history->transaction_rings[1].capacity, ==, 16);
+
+	// the history orders transactions by end time, a query also returns transactions that are partially visible
+	for (int64_t t = 0; t < 100; t += 10) {
+		SignalTransaction trans = {
+			.time_begin = t, .time_end = t + 8,
+			.decoder = (uint32_t) (t / 10) & 1,
+			.type = 0,
+			.address = (uint32_t) t,
+			.data = (uint32_t) (t / 10)
+		};
+		signal_history_transaction_add(history, &trans);
+	}
+
+	munit_assert_size(history->transaction_rings[0].count, ==, 5);
+	munit_assert_size(history->transaction_rings[1].count, ==, 5);
+	munit_assert_int64(history->transaction_rings[0].max_duration, ==, 8);
+
+	SignalTransaction *range = NULL;
+	signal_history_transactions_range(history, 25, 45, 0b11, &range);
+	munit_assert_size(arrlenu(range), ==, 3);
+	munit_assert_int64(range[0].time_begin, ==, 20);
+	munit_assert_int64(range[1].time_begin, ==, 30);
+	munit_assert_int64(range[2].time_begin, ==, 40);
+
+	signal_history_transactions_range(history, 25, 45, 0b01, &range);
+	munit_assert_size(arrlenu(range), ==, 2);
+	munit_assert_int64(range[0].time_begin, ==, 20);
+	munit_assert_int64(range[1].time_begin, ==, 40);
+	arrfree(range);
+
+	// search
+	SignalTransactionQuery query = {
+		.decoder = 1,
+		.type_mask = 1,
+		.address = 0x10, .address_mask = 0x10,
+	};
+	SignalTransaction found;
+	munit_assert_true(signal_history_transaction_search(history, &query, 0, true, &found));
+	munit_assert_int64(found.time_begin, ==, 30);
+	munit_assert_true(signal_history_transaction_search(history, &query, 30, true, &found));
+	munit_assert_int64(found.time_begin, ==, 50);
+	munit_assert_true(signal_history_transaction_search(history, &query, 90, false, &found));
+	munit_assert_int64(found.time_begin, ==, 50);
+	munit_assert_true(signal_history_transaction_search(history, &query, 49, false, &found));
+	munit_assert_int64(found.time_begin, ==, 30);
+	munit_assert_false(signal_history_transaction_search(history, &query, 30, false, &found));
+
+	query.address_mask = 0;
+	query.data = 7;
+	query.data_mask = 0xff;
+	munit_assert_true(signal_history_transaction_search(history, &query, 0, true, &found));
+	munit_assert_int64(found.time_begin, ==, 70);
+
+	// ring buffer overwrites the oldest transactions, but only those of the same decoder
+	for (size_t i = 0; i < history->transaction_rings[1].capacity; ++i) {
+		SignalTransaction trans = {.time_begin = 100 + (int64_t) i, .time_end = 100 + (int64_t) i, .decoder = 1};
+		signal_history_transaction_add(history, &trans);
+	}
+	munit_assert_size(history->transaction_rings[1].count, ==, history->transaction_rings[1].capacity);
+	munit_assert_false(signal_history_transaction_search(history, &query, 0, true, &found));
+
+	signal_history_transactions_range(history, 0, 100, 0b01, &range);
+	munit_assert_size(arrlenu(range), ==, 5);
+	arrfree(range);
+
+    return MUNIT_OK;
+}
+
+// concurrency stress test: the value of signal 'i' at time 't' is bit 'i' of 't'
+#define STRESS_SIGNALS		8
+
+typedef struct StressContext {
+	SignalHistory *	history;
+	atomic_uint32_t	stop;
+	atomic_uint32_t	time;
+} StressContext;
+
+static int stress_producer(StressContext *ctx) {
+	uint64_t last_value = 0;
+
+	for (uint32_t t = 0; !atomic_load_uint32(&ctx->stop); ++t) {
+		uint64_t sample_values[SIGNAL_BLOCKS] = {t & 0xff};
+		uint64_t sample_changed[SIGNAL_BLOCKS] = {(t & 0xff) ^ last_value};
+		last_value = t & 0xff;
+
+		signal_history_add(ctx->history, t, sample_values, sample_changed, true);
+		atomic_exchange_uint32(&ctx->time, t);
+	}
+
+	return 0;
+}
+
+static void stress_decoder_process(SignalDecoder *decoder, SignalHistory *history, int64_t time, const uint64_t *signals_value) {
+	SignalTransaction trans = {
+		.time_begin = time, .time_end = time,
+		.decoder = decoder->id,
+		.address = ~(uint32_t) time,
+		.data = (uint32_t) time
+	};
+	signal_history_transaction_add(history, &trans);
+}
+
+static void stress_decoder_destroy(SignalDecoder *decoder) {
+	free(decoder);
+}
+
+static MunitResult test_concurrent_read(const MunitParameter params[], void* user_data_or_fixture) {
+
+	// odd sample count: consecutive writes to the same slot always store a different value
+	SignalHistory *history = signal_history_create(64, STRESS_SIGNALS, 31, 6125);
+
+	Signal signals[STRESS_SIGNALS];
+	for (int i = 0; i < STRESS_SIGNALS; ++i) {
+		signals[i] = (Signal) {(uint8_t) i, 0, 0};
+	}
+	SignalGroup group = signal_group_create_from_array(STRESS_SIGNALS, signals);
+	uint32_t gi = signal_history_group_create(history, "Test", "Bus", group);
+	signal_group_destroy(group);
+	signal_history_capture_groups_set(history, 1ull << gi);
+
+	SignalDecoder *decoder = (SignalDecoder *) calloc(1, sizeof(SignalDecoder));
+	decoder->process = stress_decoder_process;
+	decoder->destroy = stress_decoder_destroy;
+	decoder->signal_mask[0] = 1;
+	uint32_t di = signal_history_decoder_add(history, "Test", "Counter", decoder);
+	signal_history_capture_decoders_set(history, 1ull << di);
+
+	StressContext ctx = {.history = history};
+	thread_t producer;
+
+	signal_history_process_start(history);
+	thread_create_joinable(&producer, (thread_func_t) stress_producer, &ctx);
+
+	SignalHistoryDiagramData diagram_data = {0};
+	for (int i = 0; i < STRESS_SIGNALS; ++i) {
+		arrpush(diagram_data.signals, signals[i]);
+	}
+	arrpush(diagram_data.groups, gi);
+	SignalTransaction *transactions = NULL;
+
+	size_t samples_checked = 0;
+	size_t transactions_checked = 0;
+
+	// keep querying until the producer has wrapped the sample buffers many times
+	for (int iteration = 0; iteration < 20000 || atomic_load_uint32(&ctx.time) < 100000; ++iteration) {
+		diagram_data.time_end = atomic_load_uint32(&ctx.time);
+		diagram_data.time_begin = MAX(diagram_data.time_end - 100, 0);
+		signal_history_diagram_data(history, &diagram_data);
+
+		for (int si = 0; si < STRESS_SIGNALS; ++si) {
+			int64_t prev_time = diagram_data.time_end;
+			for (size_t s = diagram_data.signal_start_offsets[si]; s < diagram_data.signal_start_offsets[si+1]; ++s) {
+				munit_assert_int64(diagram_data.samples_time[s], <, prev_time);
+				munit_assert_int(diagram_data.samples_value[s], ==, (diagram_data.samples_time[s] >> si) & 1);
+				prev_time = diagram_data.samples_time[s];
+				++samples_checked;
+			}
+		}
+
+		int64_t prev_time = diagram_data.time_end;
+		for (size_t s = diagram_data.group_start_offsets[0]; s < diagram_data.group_start_offsets[1]; ++s) {
+			munit_assert_int64(diagram_data.group_samples_time[s], <, prev_time);
+			munit_assert_uint64(diagram_data.group_samples_value[s], ==, diagram_data.group_samples_time[s] & 0xff);
+			prev_time = diagram_data.group_samples_time[s];
+		}
+
+		signal_history_transactions_range(history, diagram_data.time_begin, diagram_data.time_end, 1ull << di, &transactions);
+		for (size_t t = 0; t < arrlenu(transactions); ++t) {
+			munit_assert_uint32(transactions[t].data, ==, (uint32_t) transactions[t].time_end);
+			munit_assert_uint32(transactions[t].address, ==, ~transactions[t].data);
+			munit_assert_true(t == 0 || transactions[t-1].time_end < transactions[t].time_end);
+			++transactions_checked;
+		}
+	}
+
+	atomic_exchange_uint32(&ctx.stop, 1);
+	int thread_res;
+	thread_join(producer, &thread_res);
+	signal_history_process_stop(history);
+
+	munit_assert_size(samples_checked, >, 0);
+	munit_assert_size(transactions_checked, >, 0);
+
+	arrfree(transactions);
+	signal_history_diagram_release(&diagram_data);
+	signal_history_destroy(history);
+
+    return MUNIT_OK;
+}
+
 MunitTest signal_history_tests[] = {
     { "/create", test_create, signal_history_setup, signal_history_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
     { "/push_history", test_push_history, signal_history_setup, signal_history_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
     { "/push_limit", test_push_limit, signal_history_setup, signal_history_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
     { "/process_incoming", test_process_incoming, signal_history_setup, signal_history_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
     { "/diagram_data", test_diagram_data, signal_history_setup, signal_history_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
+    { "/capture_mask", test_capture_mask, signal_history_setup, signal_history_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
+    { "/group_channel", test_group_channel, signal_history_setup, signal_history_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
+    { "/transactions", test_transactions, signal_history_setup, signal_history_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
+    { "/concurrent_read", test_concurrent_read, NULL, NULL,  MUNIT_TEST_OPTION_NONE, NULL },
     { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
 };
@@ -0,0 +1,167 @@
+// test/test_signal_history_decoders.c - Johan Smet - BSD-3-Clause (see LICENSE)
+
+#include "munit/munit.h"
+
+#include "signal_history.h"
+#include "signal_history_decoders.h"
+#include "signal_line.h"
+
+typedef struct DecoderFixture {
+	SignalHistory *history;
+	uint64_t	   last_value;
+} DecoderFixture;
+
+static void *signal_history_decoders_setup(const MunitParameter params[], void *user_data) {
+	DecoderFixture *fixture = (DecoderFixture *) calloc(1, sizeof(DecoderFixture));
+	fixture->history = signal_history_create(64, 64, 32, 6125);
+	return fixture;
+}
+
+static void signal_history_decoders_teardown(void *fixture) {
+	signal_history_destroy(((DecoderFixture *) fixture)->history);
+	free(fixture);
+}
+
+static void process_timestep(DecoderFixture *fixture, int64_t time, uint64_t value) {
+	uint64_t sample_values[SIGNAL_BLOCKS] = {value};
+	uint64_t sample_changed[SIGNAL_BLOCKS] = {value ^ fixture->last_value};
+	fixture->last_value = value;
+
+	signal_history_add(fixture->history, time, sample_values, sample_changed, true);
+	while (signal_history_process_incoming_single(fixture->history));
+}
+
+static SignalGroup create_group(Signal *signals, uint8_t first, size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		signals[i] = (Signal) {(uint8_t) (first + i), 0, 0};
+	}
+	return signal_group_create_from_array(count, signals);
+}
+
+static MunitResult test_decoder_6502(const MunitParameter params[], void* user_data_or_fixture) {
+	DecoderFixture *fixture = (DecoderFixture *) user_data_or_fixture;
+	SignalHistory *history = fixture->history;
+
+	// clk = 0, rw = 1, sync = 2, address = 8-15, data = 16-23
+	Signal address_signals[8], data_signals[8];
+	SignalGroup sg_address = create_group(address_signals, 8, 8);
+	SignalGroup sg_data = create_group(data_signals, 16, 8);
+
+	uint32_t id = signal_history_decoder_add(history, "CPU", "Bus",
+											 signal_decoder_6502_create((Signal) {0, 0, 0}, (Signal) {1, 0, 0}, (Signal) {2, 0, 0}, sg_address, sg_data));
+	signal_group_destroy(sg_address);
+	signal_group_destroy(sg_data);
+
+	munit_assert_uint32(id, ==, 0);
+	munit_assert_size(signal_history_decoder_count(history), ==, 1);
+	munit_assert_string_equal(signal_history_decoder_names(history)[id], "CPU - Bus");
+
+	signal_history_capture_decoders_set(history, 1ull << id);
+
+	#define CYCLE(addr, data, rw, sync)		(((uint64_t) (data) << 16) | ((uint64_t) (addr) << 8) | ((sync) << 2) | ((rw) << 1))
+
+	process_timestep(fixture, 0, CYCLE(0x00, 0x00, 1, 0) | 1);
+	process_timestep(fixture, 1, CYCLE(0x00, 0x00, 1, 0));				// first negative edge only marks the cycle start
+	process_timestep(fixture, 2, CYCLE(0x12, 0xa9, 1, 1) | 1);
+	process_timestep(fixture, 3, CYCLE(0x12, 0xa9, 1, 1));				// end of opcode fetch cycle
+	process_timestep(fixture, 4, CYCLE(0x13, 0x42, 1, 0) | 1);
+	process_timestep(fixture, 5, CYCLE(0x13, 0x42, 1, 0));				// end of read cycle
+	process_timestep(fixture, 6, CYCLE(0x80, 0x55, 0, 0) | 1);
+	process_timestep(fixture, 7, CYCLE(0x80, 0x55, 0, 0));				// end of write cycle
+
+	#undef CYCLE
+
+	munit_assert_size(history->transaction_rings[id].count, ==, 3);
+
+	SignalTransaction *trans = NULL;
+	signal_history_transactions_range(history, 0, 10, 1, &trans);
+	munit_assert_size(arrlenu(trans), ==, 3);
+
+	munit_assert_uint32(trans[0].type, ==, DECODER_6502_OPCODE_FETCH);
+	munit_assert_int64(trans[0].time_begin, ==, 2);
+	munit_assert_int64(trans[0].time_end, ==, 3);
+	munit_assert_uint32(trans[0].address, ==, 0x12);
+	munit_assert_uint32(trans[0].data, ==, 0xa9);
+
+	munit_assert_uint32(trans[1].type, ==, DECODER_6502_READ);
+	munit_assert_uint32(trans[1].address, ==, 0x13);
+
+	munit_assert_uint32(trans[2].type, ==, DECODER_6502_WRITE);
+	munit_assert_uint32(trans[2].address, ==, 0x80);
+	munit_assert_uint32(trans[2].data, ==, 0x55);
+
+	char text[32];
+	signal_history_transaction_describe(history, &trans[2], text, sizeof(text));
+	munit_assert_string_equal(text, "W 0080:55");
+
+	arrfree(trans);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_decoder_ieee488(const MunitParameter params[], void* user_data_or_fixture) {
+	DecoderFixture *fixture = (DecoderFixture *) user_data_or_fixture;
+	SignalHistory *history = fixture->history;
+
+	// dav_b = 0, atn_b = 1, eoi_b = 2, dio = 8-15 (all active low)
+	Signal dio_signals[8];
+	SignalGroup sg_dio = create_group(dio_signals, 8, 8);
+	uint32_t id = signal_history_decoder_add(history, "PET", "IEEE-488",
+											 signal_decoder_ieee488_create((Signal) {0, 0, 0}, (Signal) {1, 0, 0}, (Signal) {2, 0, 0}, sg_dio));
+	signal_group_destroy(sg_dio);
+
+	signal_history_capture_decoders_set(history, 1ull << id);
+
+	#define BUS(dav, atn, eoi, data)	(((uint64_t) (~(data) & 0xff) << 8) | (!(eoi) << 2) | (!(atn) << 1) | !(dav))
+
+	process_timestep(fixture, 0, BUS(0, 0, 0, 0x00));
+	process_timestep(fixture, 1, BUS(0, 1, 0, 0x28));
+	process_timestep(fixture, 2, BUS(1, 1, 0, 0x28));			// LISTEN 8
+	process_timestep(fixture, 3, BUS(0, 1, 0, 0x28));
+	process_timestep(fixture, 4, BUS(0, 0, 0, 0x41));
+	process_timestep(fixture, 5, BUS(1, 0, 0, 0x41));			// 'A'
+	process_timestep(fixture, 6, BUS(0, 0, 0, 0x41));
+	process_timestep(fixture, 7, BUS(0, 0, 1, 0x42));
+	process_timestep(fixture, 8, BUS(1, 0, 1, 0x42));			// 'B' + EOI
+	process_timestep(fixture, 9, BUS(0, 0, 0, 0x00));
+
+	#undef BUS
+
+	SignalTransaction *trans = NULL;
+	signal_history_transactions_range(history, 0, 10, 1, &trans);
+	munit_assert_size(arrlenu(trans), ==, 3);
+
+	munit_assert_uint32(trans[0].type, ==, DECODER_IEEE488_COMMAND);
+	munit_assert_uint32(trans[0].data, ==, 0x28);
+	munit_assert_int64(trans[0].time_begin, ==, 2);
+	munit_assert_int64(trans[0].time_end, ==, 3);
+	munit_assert_uint32(trans[1].type, ==, DECODER_IEEE488_DATA);
+	munit_assert_uint32(trans[1].data, ==, 0x41);
+	munit_assert_uint32(trans[2].type, ==, DECODER_IEEE488_DATA_EOI);
+	munit_assert_uint32(trans[2].data, ==, 0x42);
+
+	char text[32];
+	signal_history_transaction_describe(history, &trans[0], text, sizeof(text));
+	munit_assert_string_equal(text, "LISTEN 8");
+	signal_history_transaction_describe(history, &trans[2], text, sizeof(text));
+	munit_assert_string_equal(text, "42 'B' EOI");
+
+	// search for the first data byte
+	SignalTransactionQuery query = {
+		.decoder = id,
+		.type_mask = (1u << DECODER_IEEE488_DATA) | (1u << DECODER_IEEE488_DATA_EOI),
+	};
+	SignalTransaction found;
+	munit_assert_true(signal_history_transaction_search(history, &query, 0, true, &found));
+	munit_assert_uint32(found.data, ==, 0x41);
+
+	arrfree(trans);
+
+    return MUNIT_OK;
+}
+
+MunitTest signal_history_decoders_tests[] = {
+    { "/6502", test_decoder_6502, signal_history_decoders_setup, signal_history_decoders_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
+    { "/ieee488", test_decoder_ieee488, signal_history_decoders_setup, signal_history_decoders_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
@@ -0,0 +1,193 @@
+// test/test_signal_trigger.c - Johan Smet - BSD-3-Clause (see LICENSE)
+
+#include "munit/munit.h"
+
+#include "signal_trigger.h"
+#include "signal_history.h"
+#include "signal_line.h"
+
+#include "stb/stb_ds.h"
+
+typedef struct TriggerFixture {
+	SignalHistory *history;
+	SignalTrigger *trigger;
+	uint64_t	   last_value;
+} TriggerFixture;
+
+static void *signal_trigger_setup(const MunitParameter params[], void *user_data) {
+	TriggerFixture *fixture = (TriggerFixture *) calloc(1, sizeof(TriggerFixture));
+	fixture->history = signal_history_create(64, 8, 32, 6125);
+	fixture->trigger = signal_trigger_create();
+	return fixture;
+}
+
+static void signal_trigger_teardown(void *fixture) {
+	signal_trigger_destroy(((TriggerFixture *) fixture)->trigger);
+	signal_history_destroy(((TriggerFixture *) fixture)->history);
+	free(fixture);
+}
+
+static void process_timestep(TriggerFixture *fixture, int64_t time, uint64_t value) {
+	uint64_t sample_values[SIGNAL_BLOCKS] = {value};
+	uint64_t sample_changed[SIGNAL_BLOCKS] = {value ^ fixture->last_value};
+	fixture->last_value = value;
+
+	signal_trigger_process(fixture->trigger, fixture->history, time, sample_values, sample_changed);
+}
+
+static size_t samples_for_signal(SignalHistory *history, size_t signal) {
+	if (history->signal_samples_head[signal] > history->sample_count) {
+		return 0;
+	}
+
+	return ((history->signal_samples_head[signal] + history->sample_count - history->signal_samples_tail[signal]) % history->sample_count) + 1;
+}
+
+static MunitResult test_disabled(const MunitParameter params[], void* user_data_or_fixture) {
+	TriggerFixture *fixture = (TriggerFixture *) user_data_or_fixture;
+
+	munit_assert_int(signal_trigger_state(fixture->trigger), ==, TRIGGER_DISABLED);
+
+	// a disabled trigger forwards every timestep
+	process_timestep(fixture, 0, 0b0000);
+	process_timestep(fixture, 1, 0b0001);
+	process_timestep(fixture, 2, 0b0000);
+
+	munit_assert_true(signal_history_process_incoming_single(fixture->history));
+	munit_assert_true(signal_history_process_incoming_single(fixture->history));
+	munit_assert_true(signal_history_process_incoming_single(fixture->history));
+	munit_assert_false(signal_history_process_incoming_single(fixture->history));
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_edge(const MunitParameter params[], void* user_data_or_fixture) {
+	TriggerFixture *fixture = (TriggerFixture *) user_data_or_fixture;
+	SignalTrigger *trigger = fixture->trigger;
+
+	uint32_t stage = signal_trigger_stage_add(trigger, 1);
+	signal_trigger_stage_edge(trigger, stage, (Signal) {2, 0, 0}, true, false);
+	signal_trigger_set_depth(trigger, 2, 3);
+	signal_trigger_arm(trigger);
+
+	// negative edges and other signals do not fire the trigger
+	process_timestep(fixture, 0, 0b0000);
+	process_timestep(fixture, 1, 0b0001);
+	process_timestep(fixture, 2, 0b0000);
+	process_timestep(fixture, 3, 0b0010);
+	munit_assert_int(signal_trigger_state(trigger), ==, TRIGGER_ARMED);
+	munit_assert_false(signal_history_process_incoming_single(fixture->history));
+
+	// positive edge on signal 2
+	process_timestep(fixture, 4, 0b0110);
+	munit_assert_int(signal_trigger_state(trigger), ==, TRIGGER_CAPTURING);
+	munit_assert_int64(trigger->trigger_time, ==, 4);
+
+	process_timestep(fixture, 5, 0b0100);
+	process_timestep(fixture, 6, 0b0000);
+	process_timestep(fixture, 7, 0b0100);
+	munit_assert_int(signal_trigger_state(trigger), ==, TRIGGER_DONE);
+	process_timestep(fixture, 8, 0b0000);
+
+	// 2 pre-trigger + trigger + 3 post-trigger timesteps
+	for (int i = 0; i < 6; ++i) {
+		munit_assert_true(signal_history_process_incoming_single(fixture->history));
+	}
+	munit_assert_false(signal_history_process_incoming_single(fixture->history));
+
+	// first sample is a full snapshot
+	munit_assert_int64(fixture->history->samples_time[fixture->history->signal_samples_base[7]], ==, 2);
+	munit_assert_size(samples_for_signal(fixture->history, 7), ==, 1);
+	munit_assert_size(samples_for_signal(fixture->history, 2), ==, 4);
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_sequence_counter(const MunitParameter params[], void* user_data_or_fixture) {
+	TriggerFixture *fixture = (TriggerFixture *) user_data_or_fixture;
+	SignalTrigger *trigger = fixture->trigger;
+
+	// stage 0: signal 0 rises twice
+	uint32_t stage = signal_trigger_stage_add(trigger, 2);
+	signal_trigger_stage_edge(trigger, stage, (Signal) {0, 0, 0}, true, false);
+
+	// stage 1: the group of signals 4-7 becomes 0b1010
+	Signal group_signals[4] = {{4, 0, 0}, {5, 0, 0}, {6, 0, 0}, {7, 0, 0}};
+	SignalGroup group = signal_group_create_from_array(4, group_signals);
+	stage = signal_trigger_stage_add(trigger, 1);
+	signal_trigger_stage_group_value(trigger, stage, group, 0b1010);
+	signal_group_destroy(group);
+
+	signal_trigger_set_depth(trigger, 0, 0);
+	signal_trigger_arm(trigger);
+
+	process_timestep(fixture, 0, 0b00000000);
+	process_timestep(fixture, 1, 0b10100000);		// group matches, but stage 0 not done
+	process_timestep(fixture, 2, 0b00000001);
+	munit_assert_uint32(trigger->current_stage, ==, 0);
+	munit_assert_uint32(trigger->current_count, ==, 1);
+	process_timestep(fixture, 3, 0b00000000);
+	process_timestep(fixture, 4, 0b00000001);
+	munit_assert_uint32(trigger->current_stage, ==, 1);
+	process_timestep(fixture, 5, 0b10000001);
+	munit_assert_int(signal_trigger_state(trigger), ==, TRIGGER_ARMED);
+	process_timestep(fixture, 6, 0b10100001);
+	munit_assert_int(signal_trigger_state(trigger), ==, TRIGGER_DONE);
+	munit_assert_int64(trigger->trigger_time, ==, 6);
+
+	munit_assert_true(signal_history_process_incoming_single(fixture->history));
+	munit_assert_false(signal_history_process_incoming_single(fixture->history));
+
+    return MUNIT_OK;
+}
+
+static MunitResult test_request(const MunitParameter params[], void* user_data_or_fixture) {
+	TriggerFixture *fixture = (TriggerFixture *) user_data_or_fixture;
+	SignalTrigger *trigger = fixture->trigger;
+
+	// the configuration is built in a separate trigger and copied on request
+	SignalTrigger *config = signal_trigger_create();
+	uint32_t stage = signal_trigger_stage_add(config, 1);
+	signal_trigger_stage_edge(config, stage, (Signal) {1, 0, 0}, true, false);
+	signal_trigger_set_depth(config, 1, 1);
+
+	signal_trigger_request_arm(trigger, config);
+	signal_trigger_destroy(config);
+
+	// nothing changes until the trigger processes a timestep
+	munit_assert_true(signal_trigger_request_pending(trigger));
+	munit_assert_int(signal_trigger_state(trigger), ==, TRIGGER_DISABLED);
+	munit_assert_size(arrlenu(trigger->stages), ==, 0);
+
+	process_timestep(fixture, 0, 0b0000);
+	munit_assert_false(signal_trigger_request_pending(trigger));
+	munit_assert_int(signal_trigger_state(trigger), ==, TRIGGER_ARMED);
+	munit_assert_size(arrlenu(trigger->stages), ==, 1);
+	munit_assert_size(trigger->pre_trigger_depth, ==, 1);
+
+	process_timestep(fixture, 1, 0b0010);
+	munit_assert_int(signal_trigger_state(trigger), ==, TRIGGER_CAPTURING);
+
+	// disarming is a request too
+	signal_trigger_request_disarm(trigger);
+	munit_assert_int(signal_trigger_state(trigger), ==, TRIGGER_CAPTURING);
+	process_timestep(fixture, 2, 0b0000);
+	munit_assert_false(signal_trigger_request_pending(trigger));
+	munit_assert_int(signal_trigger_state(trigger), ==, TRIGGER_DISABLED);
+
+	// 1 pre-trigger + trigger + the disabled timestep
+	for (int i = 0; i < 3; ++i) {
+		munit_assert_true(signal_history_process_incoming_single(fixture->history));
+	}
+	munit_assert_false(signal_history_process_incoming_single(fixture->history));
+
+    return MUNIT_OK;
+}
+
+MunitTest signal_trigger_tests[] = {
+    { "/disabled", test_disabled, signal_trigger_setup, signal_trigger_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
+    { "/edge", test_edge, signal_trigger_setup, signal_trigger_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
+    { "/sequence_counter", test_sequence_counter, signal_trigger_setup, signal_trigger_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
+    { "/request", test_request, signal_trigger_setup, signal_trigger_teardown,  MUNIT_TEST_OPTION_NONE, NULL },
+    { NULL, NULL, NULL, NULL, MUNIT_TEST_OPTION_NONE, NULL }
+};
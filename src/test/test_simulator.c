@@ -113,6 +113,9 @@ MunitResult test_signal_writers(const MunitParameter params[], void *user_data_o
 
 	munit_assert_int32(c1->id, ==, 0);
 	munit_assert_int32(c2->id, ==, 1);
+	munit_assert_ptr_equal(simulator_chip_by_name(simulator, "C2"), c2);
+	munit_assert_ptr_equal(simulator_chip_by_name(simulator, "C1"), c1);
+	munit_assert_ptr_null(simulator_chip_by_name(simulator, "C3"));
 
 	// no writers
 	signal_pool_cycle(simulator->signal_pool);
@@ -0,0 +1,161 @@
+// coverage_main.cpp - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Coverage tool: merges coverage maps of the 6502 (e.g. written by dromaius_headless coverage_save) and converts
+// them to an lcov tracefile with a line map that gives the source line of each address.
+//
+// Without a line map a summary of the number of covered addresses is printed.
+
+#include <cinttypes>
+#include <cstdio>
+#include <string>
+
+#include <argh/argh.h>
+#include <stb/stb_ds.h>
+
+#include "cpu_6502_coverage.h"
+#include "cpu_6502_profile.h"
+
+namespace {
+
+using argh_list_t = std::initializer_list<const char *const>;
+static constexpr argh_list_t ARG_OUTPUT = {"-o", "--output"};
+static constexpr argh_list_t ARG_LINES = {"-l", "--lines"};
+static constexpr argh_list_t ARG_SYMBOLS = {"-s", "--symbols"};
+static constexpr argh_list_t ARG_LCOV = {"--lcov"};
+static constexpr argh_list_t ARG_TEST_NAME = {"--test-name"};
+static constexpr argh_list_t ARG_HELP = {"-h", "--help"};
+
+void print_help() {
+	auto format_argh_list = [](const argh_list_t &args) -> auto {
+		std::string result;
+		const char *sepa = "";
+
+		for (const auto &a : args) {
+			result.append(sepa);
+			result.append(a);
+			sepa = ", ";
+		}
+
+		return result;
+	};
+
+	printf("Usage:\n\n");
+	printf("dromaius_coverage [options] <coverage map> [<coverage map> ...]\n\n");
+	printf("Options\n");
+	printf(" %-25s write the merged coverage map to a file.\n",
+			format_argh_list(ARG_OUTPUT).c_str());
+	printf(" %-25s line map (\"<address> <file>:<line>\" per line) to convert the coverage to lcov.\n",
+			format_argh_list(ARG_LINES).c_str());
+	printf(" %-25s assembler symbol file with the functions for the lcov tracefile.\n",
+			format_argh_list(ARG_SYMBOLS).c_str());
+	printf(" %-25s file to write the lcov tracefile to (default: stdout).\n",
+			format_argh_list(ARG_LCOV).c_str());
+	printf(" %-25s test name in the lcov tracefile.\n",
+			format_argh_list(ARG_TEST_NAME).c_str());
+	printf(" %-25s display this help message and stop execution.\n",
+			format_argh_list(ARG_HELP).c_str());
+}
+
+void print_summary(const Cpu6502Coverage *coverage) {
+	printf("opcodes:  %6zu addresses\n", cpu_6502_coverage_count(coverage, COVERAGE_6502_OPCODE));
+	printf("operands: %6zu addresses\n", cpu_6502_coverage_count(coverage, COVERAGE_6502_OPERAND));
+	printf("read:     %6zu addresses\n", cpu_6502_coverage_count(coverage, COVERAGE_6502_READ));
+	printf("written:  %6zu addresses\n", cpu_6502_coverage_count(coverage, COVERAGE_6502_WRITE));
+}
+
+bool write_lcov(const Cpu6502Coverage *coverage, const std::string &lines_file, const std::string &symbols_file,
+				const std::string &lcov_file, const std::string &test_name) {
+
+	Cpu6502LineMap *map = cpu_6502_line_map_load(lines_file.c_str());
+	if (!map) {
+		fprintf(stderr, "Unable to load line map (%s)\n", lines_file.c_str());
+		return false;
+	}
+
+	Cpu6502Symbol *symbols = nullptr;
+	if (!symbols_file.empty()) {
+		symbols = cpu_6502_symbols_load(symbols_file.c_str());
+		if (!symbols) {
+			fprintf(stderr, "Unable to load symbols (%s)\n", symbols_file.c_str());
+			cpu_6502_line_map_release(map);
+			return false;
+		}
+	}
+
+	char *lcov = cpu_6502_coverage_lcov(coverage, map, symbols, (test_name.empty()) ? nullptr : test_name.c_str());
+	FILE *fp = (lcov_file.empty()) ? stdout : fopen(lcov_file.c_str(), "w");
+	bool ok = fp != nullptr;
+
+	if (fp) {
+		ok = fwrite(lcov, 1, arrlenu(lcov), fp) == arrlenu(lcov);
+		if (fp != stdout) {
+			fclose(fp);
+		}
+	}
+
+	if (!ok) {
+		fprintf(stderr, "Unable to write lcov tracefile (%s)\n", lcov_file.c_str());
+	}
+
+	arrfree(lcov);
+	cpu_6502_symbols_release(symbols);
+	cpu_6502_line_map_release(map);
+	return ok;
+}
+
+} // unnamed namespace
+
+int main(int argc, char *argv[]) {
+
+	argh::parser cmd_line;
+	cmd_line.add_params(ARG_OUTPUT);
+	cmd_line.add_params(ARG_LINES);
+	cmd_line.add_params(ARG_SYMBOLS);
+	cmd_line.add_params(ARG_LCOV);
+	cmd_line.add_params(ARG_TEST_NAME);
+	cmd_line.add_params(ARG_HELP);
+	cmd_line.parse(argc, argv);
+
+	if (cmd_line[ARG_HELP] || cmd_line.pos_args().size() < 2) {
+		print_help();
+		return (cmd_line[ARG_HELP]) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	std::string output_file, lines_file, symbols_file, lcov_file, test_name;
+	cmd_line(ARG_OUTPUT, "") >> output_file;
+	cmd_line(ARG_LINES, "") >> lines_file;
+	cmd_line(ARG_SYMBOLS, "") >> symbols_file;
+	cmd_line(ARG_LCOV, "") >> lcov_file;
+	cmd_line(ARG_TEST_NAME, "") >> test_name;
+
+	// merge the coverage maps
+	Cpu6502Coverage *coverage = cpu_6502_coverage_create();
+
+	for (size_t i = 1; i < cmd_line.pos_args().size(); ++i) {
+		const auto &input_file = cmd_line.pos_args()[i];
+		Cpu6502Coverage *input = cpu_6502_coverage_load(input_file.c_str());
+		if (!input) {
+			fprintf(stderr, "Unable to load coverage map (%s)\n", input_file.c_str());
+			cpu_6502_coverage_destroy(coverage);
+			return EXIT_FAILURE;
+		}
+		cpu_6502_coverage_merge(coverage, input);
+		cpu_6502_coverage_destroy(input);
+	}
+
+	bool ok = true;
+
+	if (!output_file.empty() && !cpu_6502_coverage_save(coverage, output_file.c_str())) {
+		fprintf(stderr, "Unable to write coverage map (%s)\n", output_file.c_str());
+		ok = false;
+	}
+
+	if (ok && !lines_file.empty()) {
+		ok = write_lcov(coverage, lines_file, symbols_file, lcov_file, test_name);
+	} else if (ok) {
+		print_summary(coverage);
+	}
+
+	cpu_6502_coverage_destroy(coverage);
+	return (ok) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,851 @@
+// headless_main.cpp - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Headless runner: executes a script of timed actions against an emulated device without a GUI.
+// The simulation is not synchronized with real-time and no signal history is kept.
+//
+// Script syntax (one command per line, lines starting with '#' are comments):
+//	run <ms>								run the simulation for <ms> milliseconds of simulated time
+//	type <text>								type text on the keyboard ('\n' = RETURN, '\\' = backslash)
+//	tape <file.tap>							insert a tape and press play
+//	disk <file.d64>							insert a floppy disk in the 2031 drive
+//	prg <file.prg>							load a program into memory (Commodore PET only)
+//	wait_screen <text> [timeout_ms]			run until the text is visible on the screen
+//	wait_pc <address> [timeout_ms]			run until the cpu fetches the instruction at address
+//	dump_screen [file]						write the screen contents as text (default: stdout)
+//	dump_png <file>							write the display buffer as a PNG image (Commodore PET only)
+//	dump_memory <start> <length> [file]		write a hex dump of memory (default: stdout)
+//	profile_start							start (or resume) counting the instructions and cycles executed by the cpu
+//	profile_stop							stop counting
+//	profile_report [file]					write the hot ranges and subroutines of the profile (default: stdout)
+//	coverage_start							start (or resume) flagging the addresses executed, read and written by the cpu
+//	coverage_stop							stop flagging
+//	coverage_clear							forget the coverage collected so far
+//	coverage_save <file>					write the coverage map to a file
+//	coverage_merge <file>					add the coverage to the map in the file (created if it doesn't exist)
+//
+// Addresses and lengths accept the '$' or '0x' prefix for hexadecimal values.
+// Keys, tapes and disks are sent to the simulation as input events: --record saves them to a file and --replay
+// applies a recording (e.g. made in the GUI) at the exact same simulator ticks, the script then decides how long to run.
+// --trace keeps the most recent instructions of the cpu in memory and writes them to a file when the runner stops,
+// use dromaius_trace to disassemble the file. The profile report uses the labels of the --symbols file.
+// Coverage maps of many runs can be merged with coverage_merge, use dromaius_coverage to convert them to lcov.
+// The runner stops with a non-zero exit code when a command fails or a wait times out.
+
+#include <algorithm>
+#include <cctype>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <argh/argh.h>
+#include <stb/stb_ds.h>
+
+#include "context.h"
+#include "cpu_6502.h"
+#include "cpu_6502_coverage.h"
+#include "cpu_6502_profile.h"
+#include "cpu_6502_trace.h"
+#include "dev_commodore_pet.h"
+#include "dev_minimal_6502.h"
+#include "chip_hd44780.h"
+#include "display_rgba.h"
+#include "input_keypad.h"
+#include "perif_datassette_1530.h"
+#include "perif_disk_2031.h"
+#include "simulator.h"
+#include "utils.h"
+
+namespace {
+
+using argh_list_t = std::initializer_list<const char *const>;
+static constexpr argh_list_t ARG_MACHINE = {"-m", "--machine"};
+static constexpr argh_list_t ARG_SCRIPT = {"-s", "--script"};
+static constexpr argh_list_t ARG_ROM = {"-r", "--rom"};
+static constexpr argh_list_t ARG_RECORD = {"--record"};
+static constexpr argh_list_t ARG_REPLAY = {"--replay"};
+static constexpr argh_list_t ARG_TRACE = {"--trace"};
+static constexpr argh_list_t ARG_TRACE_SIZE = {"--trace-size"};
+static constexpr argh_list_t ARG_SYMBOLS = {"--symbols"};
+static constexpr argh_list_t ARG_HELP = {"-h", "--help"};
+
+constexpr int64_t DEFAULT_TIMEOUT_MS = 10000;
+constexpr int64_t DEFAULT_TRACE_SIZE = 1 << 20;		// number of instructions kept in the trace
+constexpr size_t PROFILE_REPORT_COUNT = 20;			// entries per section of the profile report
+constexpr int64_t WAIT_CHECK_INTERVAL_MS = 5;		// simulated time between two checks of a wait condition
+constexpr int KEY_DWELL_MS = 50;					// how long a key is held down
+constexpr int64_t KEY_GAP_MS = 50;					// time between two keystrokes, long enough for the keyboard scan to notice the release
+
+void print_help() {
+	auto format_argh_list = [](const argh_list_t &args) -> auto {
+		std::string result;
+		const char *sepa = "";
+
+		for (const auto &a : args) {
+			result.append(sepa);
+			result.append(a);
+			sepa = ", ";
+		}
+
+		return result;
+	};
+
+	printf("Usage:\n\n");
+	printf("dromaius_headless [options]\n\n");
+	printf("Options\n");
+	printf(" %-25s specify machine to emulate (commodore-pet, commodore-pet-lite, minimal-6502).\n",
+			format_argh_list(ARG_MACHINE).c_str());
+	printf(" %-25s script with the actions to execute.\n",
+			format_argh_list(ARG_SCRIPT).c_str());
+	printf(" %-25s rom image to load (minimal-6502 only).\n",
+			format_argh_list(ARG_ROM).c_str());
+	printf(" %-25s record the input events to a file.\n",
+			format_argh_list(ARG_RECORD).c_str());
+	printf(" %-25s replay the input events of a recording.\n",
+			format_argh_list(ARG_REPLAY).c_str());
+	printf(" %-25s write a trace of the last executed instructions to a file.\n",
+			format_argh_list(ARG_TRACE).c_str());
+	printf(" %-25s number of instructions kept in the trace (default %" PRId64 ").\n",
+			format_argh_list(ARG_TRACE_SIZE).c_str(), DEFAULT_TRACE_SIZE);
+	printf(" %-25s assembler symbol file with the labels for the profile report.\n",
+			format_argh_list(ARG_SYMBOLS).c_str());
+	printf(" %-25s display this help message and stop execution.\n",
+			format_argh_list(ARG_HELP).c_str());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// PNG output (uncompressed deflate blocks, no external dependencies)
+//
+
+class PngWriter {
+public:
+	static bool write(const char *filename, const DisplayRGBA *display) {
+		std::vector<uint8_t> raw;
+		raw.reserve(display->height * (display->width * 4 + 1));
+
+		for (size_t y = 0; y < display->height; ++y) {
+			raw.push_back(0);			// filter type: none
+			auto row = reinterpret_cast<const uint8_t *>(display->frame + (y * display->width));
+			raw.insert(raw.end(), row, row + (display->width * 4));
+		}
+
+		// zlib stream with stored deflate blocks
+		std::vector<uint8_t> zlib = {0x78, 0x01};
+		for (size_t pos = 0; pos < raw.size(); pos += 0xffff) {
+			auto len = static_cast<uint16_t>(std::min<size_t>(raw.size() - pos, 0xffff));
+			zlib.push_back((pos + len >= raw.size()) ? 1 : 0);
+			put_le16(zlib, len);
+			put_le16(zlib, static_cast<uint16_t>(~len));
+			zlib.insert(zlib.end(), raw.begin() + static_cast<ptrdiff_t>(pos), raw.begin() + static_cast<ptrdiff_t>(pos + len));
+		}
+		put_be32(zlib, adler32(raw));
+
+		std::vector<uint8_t> ihdr;
+		put_be32(ihdr, static_cast<uint32_t>(display->width));
+		put_be32(ihdr, static_cast<uint32_t>(display->height));
+		ihdr.insert(ihdr.end(), {8, 6, 0, 0, 0});	// 8-bit RGBA, default compression/filter, no interlace
+
+		std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+		put_chunk(png, "IHDR", ihdr);
+		put_chunk(png, "IDAT", zlib);
+		put_chunk(png, "IEND", {});
+
+		return file_save_binary(filename, reinterpret_cast<int8_t *>(png.data()), png.size());
+	}
+
+private:
+	static void put_le16(std::vector<uint8_t> &out, uint16_t v) {
+		out.push_back(static_cast<uint8_t>(v & 0xff));
+		out.push_back(static_cast<uint8_t>(v >> 8));
+	}
+
+	static void put_be32(std::vector<uint8_t> &out, uint32_t v) {
+		for (int shift = 24; shift >= 0; shift -= 8) {
+			out.push_back(static_cast<uint8_t>((v >> shift) & 0xff));
+		}
+	}
+
+	static uint32_t adler32(const std::vector<uint8_t> &data) {
+		uint32_t a = 1, b = 0;
+		for (auto d : data) {
+			a = (a + d) % 65521;
+			b = (b + a) % 65521;
+		}
+		return (b << 16) | a;
+	}
+
+	static uint32_t crc32(const uint8_t *data, size_t len, uint32_t crc) {
+		for (size_t i = 0; i < len; ++i) {
+			crc ^= data[i];
+			for (int k = 0; k < 8; ++k) {
+				crc = (crc >> 1) ^ (0xedb88320u & (0u - (crc & 1)));
+			}
+		}
+		return crc;
+	}
+
+	static void put_chunk(std::vector<uint8_t> &out, const char *type, const std::vector<uint8_t> &data) {
+		put_be32(out, static_cast<uint32_t>(data.size()));
+		size_t start = out.size();
+		out.insert(out.end(), type, type + 4);
+		out.insert(out.end(), data.begin(), data.end());
+		put_be32(out, crc32(out.data() + start, out.size() - start, 0xffffffffu) ^ 0xffffffffu);
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// device specific operations
+//
+
+class Machine {
+public:
+	virtual ~Machine() = default;
+
+	virtual Device *device() = 0;
+	virtual InputKeypad *keypad() = 0;
+	virtual bool key_for_char(char c, size_t *row, size_t *col) = 0;
+	virtual std::string screen_text() = 0;
+
+	virtual DisplayRGBA *display() {return nullptr;}
+	virtual PerifDatassette *datassette() {return nullptr;}
+	virtual PerifDisk2031 *disk() {return nullptr;}
+	virtual bool load_prg(const char * /*filename*/) {return false;}
+
+	size_t screen_width = 0;
+};
+
+class MachinePet : public Machine {
+public:
+	MachinePet(bool lite) {
+		pet = (lite) ? dev_commodore_pet_lite_create() : dev_commodore_pet_create();
+		screen_width = 40;
+
+		// same layout as the keyboard panel of the GUI: unshifted keys only
+		static const char *labels[80] = {
+			"!", "#", "%", "&", "(", nullptr, nullptr, nullptr,
+			"\"", "$", "'", "\\", ")", nullptr, nullptr, nullptr,
+			"q", "e", "t", "u", "o", nullptr, "7", "9",
+			"w", "r", "y", "i", "p", nullptr, "8", "/",
+			"a", "d", "g", "j", "l", nullptr, "4", "6",
+			"s", "f", "h", "k", ":", nullptr, "5", "*",
+			"z", "c", "b", "m", ";", "\n", "1", "3",
+			"x", "v", "n", ",", "?", nullptr, "2", "+",
+			nullptr, "@", "]", nullptr, ">", nullptr, "0", "-",
+			nullptr, "[", " ", "<", nullptr, nullptr, ".", "="
+		};
+
+		for (uint32_t i = 0; i < 80; ++i) {
+			if (labels[i]) {
+				key_lookup[labels[i][0]] = i;
+			}
+		}
+	}
+
+	~MachinePet() override {
+		dev_commodore_pet_destroy(pet);
+	}
+
+	Device *device() override {return reinterpret_cast<Device *>(pet);}
+	InputKeypad *keypad() override {return pet->keypad;}
+	DisplayRGBA *display() override {return pet->screen;}
+	PerifDatassette *datassette() override {return pet->datassette;}
+	PerifDisk2031 *disk() override {return pet->disk_2031;}
+
+	bool load_prg(const char *filename) override {
+		return dev_commodore_pet_load_prg(pet, filename, true);
+	}
+
+	bool key_for_char(char c, size_t *row, size_t *col) override {
+		auto found = key_lookup.find(static_cast<char>(tolower(c)));
+		if (found == key_lookup.end()) {
+			return false;
+		}
+		*row = found->second / 8;
+		*col = found->second % 8;
+		return true;
+	}
+
+	std::string screen_text() override {
+		uint8_t vram[1000];
+		pet->read_memory(pet, 0x8000, sizeof(vram), vram);
+
+		// convert screen codes to ascii, reverse video is ignored and graphic characters become '.'
+		std::string result;
+		for (auto code : vram) {
+			code &= 0x7f;
+			if (code < 0x20) {
+				result.push_back(static_cast<char>(code + 0x40));
+			} else if (code < 0x40) {
+				result.push_back(static_cast<char>(code));
+			} else {
+				result.push_back('.');
+			}
+		}
+		return result;
+	}
+
+private:
+	DevCommodorePet *pet;
+	std::unordered_map<char, uint32_t> key_lookup;
+};
+
+class MachineMinimal6502 : public Machine {
+public:
+	MachineMinimal6502(const char *rom_file) {
+		minimal = dev_minimal_6502_create(nullptr);
+		if (rom_file) {
+			dev_minimal_6502_rom_from_file(minimal, rom_file);
+			minimal->reset(minimal);
+		}
+	}
+
+	~MachineMinimal6502() override {
+		dev_minimal_6502_destroy(minimal);
+	}
+
+	Device *device() override {return reinterpret_cast<Device *>(minimal);}
+	InputKeypad *keypad() override {return minimal->keypad;}
+
+	bool key_for_char(char c, size_t *row, size_t *col) override {
+		static const char labels[] = "123A456B789C*0#D";
+
+		auto found = strchr(labels, toupper(c));
+		if (c == '\0' || !found) {
+			return false;
+		}
+		*row = static_cast<size_t>(found - labels) / 4;
+		*col = static_cast<size_t>(found - labels) % 4;
+		return true;
+	}
+
+	std::string screen_text() override {
+		// the lines of the lcd start at ddram addresses 0x00 and 0x40
+		auto lcd = minimal->lcd;
+		screen_width = lcd->display_width;
+
+		std::string result;
+		for (size_t line = 0; line < lcd->display_height; ++line) {
+			for (size_t col = 0; col < lcd->display_width; ++col) {
+				auto c = lcd->ddram[(line * 0x40 + col) % DDRAM_SIZE];
+				result.push_back((c >= 0x20 && c < 0x7f) ? static_cast<char>(c) : '.');
+			}
+		}
+		return result;
+	}
+
+private:
+	DevMinimal6502 *minimal;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// script execution
+//
+
+class ScriptRunner {
+public:
+	ScriptRunner(Machine *machine) : machine(machine) {
+		dms = dms_create_context();
+		dms_set_device(dms, machine->device());
+		simulator = machine->device()->simulator;
+	}
+
+	~ScriptRunner() {
+		if (profile) {
+			cpu_6502_set_profile(cpu(), nullptr);
+			cpu_6502_profile_destroy(profile);
+		}
+		if (coverage) {
+			cpu_6502_set_coverage(cpu(), nullptr);
+			cpu_6502_coverage_destroy(coverage);
+		}
+		cpu_6502_symbols_release(symbols);
+		if (trace) {
+			cpu_6502_set_trace(cpu(), nullptr);
+			cpu_6502_trace_destroy(trace);
+		}
+		dms_release_context(dms);
+	}
+
+	bool start_trace(const std::string &filename, int64_t size) {
+		if (filename.empty()) {
+			return true;
+		}
+
+		trace = (size > 0) ? cpu_6502_trace_create(static_cast<uint64_t>(size)) : nullptr;
+		if (!trace) {
+			fprintf(stderr, "Unable to allocate a trace of %" PRId64 " instructions\n", size);
+			return false;
+		}
+
+		trace_file = filename;
+		cpu_6502_set_trace(cpu(), trace);
+		return true;
+	}
+
+	bool load_symbols(const std::string &filename) {
+		if (filename.empty()) {
+			return true;
+		}
+
+		symbols = cpu_6502_symbols_load(filename.c_str());
+		if (!symbols) {
+			fprintf(stderr, "Unable to load symbols (%s)\n", filename.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	bool save_trace() {
+		if (trace && !cpu_6502_trace_save(trace, trace_file.c_str())) {
+			fprintf(stderr, "Unable to write trace (%s)\n", trace_file.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	bool start_input(const std::string &record_file, const std::string &replay_file) {
+		// start recording before the first input event is sent
+		if (!record_file.empty() && !dms_input_record_start(dms, record_file.c_str())) {
+			fprintf(stderr, "Unable to record input (%s)\n", record_file.c_str());
+			return false;
+		}
+
+		dms_input_key_dwell_time(dms, machine->keypad(), KEY_DWELL_MS);
+
+		if (!replay_file.empty() && !dms_input_replay(dms, replay_file.c_str())) {
+			fprintf(stderr, "Unable to replay input (%s)\n", replay_file.c_str());
+			return false;
+		}
+
+		return true;
+	}
+
+	bool execute(std::istream &script) {
+		std::string line;
+
+		while (std::getline(script, line)) {
+			++line_number;
+
+			auto start = line.find_first_not_of(" \t\r");
+			if (start == std::string::npos || line[start] == '#') {
+				continue;
+			}
+			line.erase(line.find_last_not_of(" \t\r") + 1);
+
+			auto cmd_end = line.find_first_of(" \t", start);
+			std::string cmd = line.substr(start, cmd_end - start);
+			std::string args = (cmd_end == std::string::npos) ? "" : line.substr(line.find_first_not_of(" \t", cmd_end));
+
+			if (!execute_command(cmd, args)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+private:
+	bool execute_command(const std::string &cmd, const std::string &args) {
+		auto params = split(args);
+
+		if (cmd == "run" && params.size() == 1) {
+			int64_t ms;
+			return parse_number(params[0], &ms) && run_ms(ms);
+		} else if (cmd == "type" && !args.empty()) {
+			return type_text(unescape(args));
+		} else if (cmd == "tape" && params.size() == 1) {
+			return insert_tape(params[0]);
+		} else if (cmd == "disk" && params.size() == 1) {
+			return insert_disk(params[0]);
+		} else if (cmd == "prg" && params.size() == 1) {
+			return machine->load_prg(params[0].c_str()) || error("unable to load program '%s'", params[0].c_str());
+		} else if (cmd == "wait_screen" && !args.empty()) {
+			return wait_screen(args);
+		} else if (cmd == "wait_pc" && (params.size() == 1 || params.size() == 2)) {
+			return wait_pc(params);
+		} else if (cmd == "dump_screen" && params.size() <= 1) {
+			return dump_screen((params.empty()) ? "" : params[0]);
+		} else if (cmd == "dump_png" && params.size() == 1) {
+			return dump_png(params[0]);
+		} else if (cmd == "dump_memory" && (params.size() == 2 || params.size() == 3)) {
+			return dump_memory(params);
+		} else if (cmd == "profile_start" && params.empty()) {
+			if (!profile) {
+				profile = cpu_6502_profile_create();
+			}
+			cpu_6502_set_profile(cpu(), profile);
+			return true;
+		} else if (cmd == "profile_stop" && params.empty()) {
+			cpu_6502_set_profile(cpu(), nullptr);
+			return true;
+		} else if (cmd == "profile_report" && params.size() <= 1) {
+			return profile_report((params.empty()) ? "" : params[0]);
+		} else if (cmd == "coverage_start" && params.empty()) {
+			if (!coverage) {
+				coverage = cpu_6502_coverage_create();
+			}
+			cpu_6502_set_coverage(cpu(), coverage);
+			return true;
+		} else if (cmd == "coverage_stop" && params.empty()) {
+			cpu_6502_set_coverage(cpu(), nullptr);
+			return true;
+		} else if (cmd == "coverage_clear" && params.empty()) {
+			if (coverage) {
+				cpu_6502_coverage_clear(coverage);
+			}
+			return true;
+		} else if (cmd == "coverage_save" && params.size() == 1) {
+			return coverage_save(params[0], false);
+		} else if (cmd == "coverage_merge" && params.size() == 1) {
+			return coverage_save(params[0], true);
+		}
+
+		return error("invalid command '%s'", cmd.c_str());
+	}
+
+	template <typename... Args>
+	bool error(const char *fmt, Args... args) {
+		fprintf(stderr, "line %zu: ", line_number);
+		fprintf(stderr, fmt, args...);
+		fprintf(stderr, "\n");
+		return false;
+	}
+
+	static std::vector<std::string> split(const std::string &args) {
+		std::vector<std::string> result;
+		size_t pos = 0;
+
+		while ((pos = args.find_first_not_of(" \t", pos)) != std::string::npos) {
+			auto end = args.find_first_of(" \t", pos);
+			result.push_back(args.substr(pos, end - pos));
+			pos = end;
+		}
+
+		return result;
+	}
+
+	static std::string unescape(const std::string &text) {
+		std::string result;
+
+		for (size_t i = 0; i < text.size(); ++i) {
+			if (text[i] == '\\' && i + 1 < text.size()) {
+				++i;
+				result.push_back((text[i] == 'n') ? '\n' : text[i]);
+			} else {
+				result.push_back(text[i]);
+			}
+		}
+
+		return result;
+	}
+
+	bool parse_number(const std::string &text, int64_t *value) {
+		const char *str = text.c_str();
+		int base = 10;
+
+		if (str[0] == '$') {
+			str += 1;
+			base = 16;
+		} else if (str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) {
+			str += 2;
+			base = 16;
+		}
+
+		char *end = nullptr;
+		*value = strtoll(str, &end, base);
+		if (end == str || *end != '\0') {
+			return error("invalid number '%s'", text.c_str());
+		}
+		return true;
+	}
+
+	int64_t ms_to_ticks(int64_t ms) {
+		return simulator_interval_to_tick_count(simulator, MS_TO_PS(ms));
+	}
+
+	bool run_ms(int64_t ms) {
+		dms_run_for_ticks(dms, ms_to_ticks(ms));
+		return true;
+	}
+
+	template <typename Pred>
+	bool run_until(int64_t timeout_ms, Pred pred) {
+		const int64_t tick_end = simulator->current_tick + ms_to_ticks(timeout_ms);
+		const int64_t interval = ms_to_ticks(WAIT_CHECK_INTERVAL_MS);
+
+		while (!pred()) {
+			if (simulator->current_tick >= tick_end) {
+				return false;
+			}
+			dms_run_for_ticks(dms, interval);
+		}
+
+		return true;
+	}
+
+	bool type_text(const std::string &text) {
+		auto keypad = machine->keypad();
+
+		for (auto c : text) {
+			size_t row, col;
+			if (!machine->key_for_char(c, &row, &col)) {
+				return error("no key for character '%c'", c);
+			}
+
+			// the keypad only releases keys when the matrix is being scanned: don't wait forever
+			dms_input_key_pressed(dms, keypad, row, col);
+			run_until(KEY_DWELL_MS * 4, [=]() {return input_keypad_keys_down_count(keypad) == 0;});
+			run_ms(KEY_GAP_MS);
+		}
+
+		return true;
+	}
+
+	bool insert_tape(const std::string &filename) {
+		auto datassette = machine->datassette();
+		if (!datassette) {
+			return error("device has no datassette");
+		}
+
+		int8_t *raw = nullptr;
+		size_t len = file_load_binary(filename.c_str(), &raw);
+		if (len == 0) {
+			return error("unable to load tape '%s'", filename.c_str());
+		}
+		dms_input_tape_load(dms, datassette, raw, len);
+		arrfree(raw);
+
+		dms_input_datassette_key(dms, datassette, DS_KEY_PLAY);
+		return true;
+	}
+
+	bool insert_disk(const std::string &filename) {
+		auto disk = machine->disk();
+		if (!disk) {
+			return error("device has no disk drive");
+		}
+
+		int8_t *raw = nullptr;
+		size_t len = file_load_binary(filename.c_str(), &raw);
+		if (len == 0) {
+			return error("unable to load disk '%s'", filename.c_str());
+		}
+		dms_input_disk_load(dms, disk, raw, len);
+		arrfree(raw);
+		return true;
+	}
+
+	bool wait_screen(const std::string &args) {
+		// an optional timeout follows the text
+		std::string text = args;
+		int64_t timeout_ms = DEFAULT_TIMEOUT_MS;
+
+		auto sepa = args.find_last_of(" \t");
+		if (sepa != std::string::npos && args.find_first_not_of("0123456789", sepa + 1) == std::string::npos) {
+			timeout_ms = std::stoll(args.substr(sepa + 1));
+			text = args.substr(0, args.find_last_not_of(" \t", sepa) + 1);
+		}
+
+		for (auto &c : text) {
+			c = static_cast<char>(toupper(c));
+		}
+
+		if (!run_until(timeout_ms, [&]() {return machine->screen_text().find(text) != std::string::npos;})) {
+			return error("timeout waiting for '%s' on screen", text.c_str());
+		}
+		return true;
+	}
+
+	bool wait_pc(const std::vector<std::string> &params) {
+		int64_t address;
+		int64_t timeout_ms = DEFAULT_TIMEOUT_MS;
+
+		if (!parse_number(params[0], &address) || (params.size() > 1 && !parse_number(params[1], &timeout_ms))) {
+			return false;
+		}
+
+		if (dms_run_until_pc(dms, address, ms_to_ticks(timeout_ms)) != DMS_STOP_REACHED) {
+			return error("timeout waiting for pc $%04llx", static_cast<long long>(address));
+		}
+		return true;
+	}
+
+	bool write_output(const std::string &filename, const std::string &data) {
+		if (filename.empty()) {
+			fwrite(data.data(), 1, data.size(), stdout);
+			return true;
+		}
+
+		std::ofstream out(filename);
+		out << data;
+		return out.good() || error("unable to write '%s'", filename.c_str());
+	}
+
+	bool dump_screen(const std::string &filename) {
+		auto text = machine->screen_text();
+		std::string result;
+
+		for (size_t pos = 0; pos < text.size(); pos += machine->screen_width) {
+			result.append(text, pos, machine->screen_width);
+			result.erase(result.find_last_not_of(' ') + 1);
+			result.push_back('\n');
+		}
+
+		return write_output(filename, result);
+	}
+
+	bool dump_png(const std::string &filename) {
+		auto display = machine->display();
+		if (!display) {
+			return error("device has no pixel display");
+		}
+
+		return PngWriter::write(filename.c_str(), display) || error("unable to write '%s'", filename.c_str());
+	}
+
+	bool dump_memory(const std::vector<std::string> &params) {
+		int64_t start, length;
+		if (!parse_number(params[0], &start) || !parse_number(params[1], &length) || start < 0 || length < 0) {
+			return false;
+		}
+
+		std::vector<uint8_t> data(static_cast<size_t>(length));
+		machine->device()->read_memory(machine->device(), static_cast<size_t>(start), data.size(), data.data());
+
+		std::string result;
+		char buffer[8];
+		for (size_t i = 0; i < data.size(); ++i) {
+			if (i % 16 == 0) {
+				snprintf(buffer, sizeof(buffer), "%04zx:", static_cast<size_t>(start) + i);
+				result.append(buffer);
+			}
+			snprintf(buffer, sizeof(buffer), " %02x", data[i]);
+			result.append(buffer);
+			if (i % 16 == 15 || i + 1 == data.size()) {
+				result.push_back('\n');
+			}
+		}
+
+		return write_output((params.size() > 2) ? params[2] : "", result);
+	}
+
+	bool profile_report(const std::string &filename) {
+		if (!profile) {
+			return error("no profile to report, use profile_start first");
+		}
+
+		char *report = cpu_6502_profile_report(profile, symbols, PROFILE_REPORT_COUNT);
+		bool ok = write_output(filename, std::string(report, arrlenu(report)));
+		arrfree(report);
+		return ok;
+	}
+
+	bool coverage_save(const std::string &filename, bool merge) {
+		if (!coverage) {
+			return error("no coverage to save, use coverage_start first");
+		}
+
+		// merge: combine with the coverage of previous runs, if there are any
+		Cpu6502Coverage *previous = nullptr;
+		if (merge && std::ifstream(filename).good()) {
+			previous = cpu_6502_coverage_load(filename.c_str());
+			if (!previous) {
+				return error("'%s' isn't a coverage map", filename.c_str());
+			}
+			cpu_6502_coverage_merge(previous, coverage);
+		}
+
+		bool ok = cpu_6502_coverage_save((previous) ? previous : coverage, filename.c_str());
+		if (previous) {
+			cpu_6502_coverage_destroy(previous);
+		}
+		return ok || error("unable to write '%s'", filename.c_str());
+	}
+
+	Cpu6502 *cpu() {
+		return reinterpret_cast<Cpu6502 *>(machine->device()->get_cpu(machine->device()));
+	}
+
+private:
+	Machine *		machine;
+	DmsContext *	dms;
+	Simulator *		simulator;
+	size_t			line_number = 0;
+	Cpu6502Trace *	trace = nullptr;
+	std::string		trace_file;
+	Cpu6502Profile *profile = nullptr;
+	Cpu6502Coverage *coverage = nullptr;
+	Cpu6502Symbol *	symbols = nullptr;
+};
+
+} // unnamed namespace
+
+int main(int argc, char *argv[]) {
+
+	argh::parser cmd_line;
+	cmd_line.add_params(ARG_MACHINE);
+	cmd_line.add_params(ARG_SCRIPT);
+	cmd_line.add_params(ARG_ROM);
+	cmd_line.add_params(ARG_RECORD);
+	cmd_line.add_params(ARG_REPLAY);
+	cmd_line.add_params(ARG_TRACE);
+	cmd_line.add_params(ARG_TRACE_SIZE);
+	cmd_line.add_params(ARG_SYMBOLS);
+	cmd_line.add_params(ARG_HELP);
+	cmd_line.parse(argc, argv);
+
+	if (cmd_line[ARG_HELP]) {
+		print_help();
+		return EXIT_SUCCESS;
+	}
+
+	std::string machine_type;
+	std::string script_file;
+	std::string rom_file;
+	std::string record_file;
+	std::string replay_file;
+	std::string trace_file;
+	int64_t trace_size;
+	std::string symbol_file;
+	cmd_line(ARG_MACHINE, "commodore-pet") >> machine_type;
+	cmd_line(ARG_SCRIPT, "") >> script_file;
+	cmd_line(ARG_ROM, "") >> rom_file;
+	cmd_line(ARG_RECORD, "") >> record_file;
+	cmd_line(ARG_REPLAY, "") >> replay_file;
+	cmd_line(ARG_TRACE, "") >> trace_file;
+	cmd_line(ARG_TRACE_SIZE, DEFAULT_TRACE_SIZE) >> trace_size;
+	cmd_line(ARG_SYMBOLS, "") >> symbol_file;
+
+	std::ifstream script(script_file);
+	if (script_file.empty() || !script) {
+		fprintf(stderr, "Unable to open script (%s)\n", script_file.c_str());
+		return EXIT_FAILURE;
+	}
+
+	std::unique_ptr<Machine> machine;
+
+	if (machine_type == "commodore-pet") {
+		machine = std::make_unique<MachinePet>(false);
+	} else if (machine_type == "commodore-pet-lite") {
+		machine = std::make_unique<MachinePet>(true);
+	} else if (machine_type == "minimal-6502") {
+		machine = std::make_unique<MachineMinimal6502>((rom_file.empty()) ? nullptr : rom_file.c_str());
+	} else {
+		fprintf(stderr, "Invalid machine type specified (%s)\n", machine_type.c_str());
+		return EXIT_FAILURE;
+	}
+
+	ScriptRunner runner(machine.get());
+	bool ok = runner.load_symbols(symbol_file) && runner.start_trace(trace_file, trace_size) && runner.start_input(record_file, replay_file) && runner.execute(script);
+
+	// the trace is most useful when something went wrong: always save it
+	ok = runner.save_trace() && ok;
+	return (ok) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -2,13 +2,17 @@
 //
 // Performance analysis test harness
 
+#include <cinttypes>
 #include <cstdio>
 #include <cassert>
 #include <chrono>
 
+#include "cpu_6502.h"
+#include "cpu_6502_trace.h"
 #include "dev_commodore_pet.h"
 #include "context.h"
 #include "signal_history.h"
+#include "simulator.h"
 
 namespace {
 
@@ -31,6 +35,11 @@ int main(int argc, char *argv[]) {
 	// basic (read: stupid) command line argument handling
 	bool arg_lite = false;
 	bool arg_history = false;
+	bool arg_breakpoints = false;
+	bool arg_watchpoints = false;
+	bool arg_trace = false;
+	bool arg_fast_bus = false;
+	bool arg_zero_latency_roms = false;
 
 	for (int i = 1; i < argc; ++i) {
 		if (!strcmp(argv[i], "--lite")) {
@@ -39,6 +48,21 @@ int main(int argc, char *argv[]) {
 		if (!strcmp(argv[i], "--history")) {
 			arg_history = true;
 		}
+		if (!strcmp(argv[i], "--breakpoints")) {
+			arg_breakpoints = true;
+		}
+		if (!strcmp(argv[i], "--watchpoints")) {
+			arg_watchpoints = true;
+		}
+		if (!strcmp(argv[i], "--trace")) {
+			arg_trace = true;
+		}
+		if (!strcmp(argv[i], "--fast-bus")) {
+			arg_fast_bus = true;
+		}
+		if (!strcmp(argv[i], "--zero-latency-roms")) {
+			arg_zero_latency_roms = true;
+		}
 	}
 
     std::printf("--- setting up Dromaius (%s PET)\n", (arg_lite) ? "lite" : "full");
@@ -52,20 +76,64 @@ int main(int argc, char *argv[]) {
 	assert(dms_ctx);
 	dms_set_device(dms_ctx, reinterpret_cast<Device *>(pet_device));
 
+	if (arg_fast_bus) {
+		std::printf("    enabling fast bus mode\n");
+		if (!dev_commodore_pet_fast_bus(pet_device, true)) {
+			std::printf("    (not supported by the full PET)\n");
+		}
+	}
+
+	if (arg_zero_latency_roms) {
+		std::printf("    enabling zero-latency roms\n");
+		dev_commodore_pet_zero_latency_roms(pet_device, true);
+	}
+
 	if (arg_history) {
 		std::printf("    enabling signal history storage\n");
 		signal_history_process_start(pet_device->simulator->signal_history);
 	}
 
+	if (arg_breakpoints) {
+		// breakpoints that are never hit during startup: measures the cost of checking them
+		std::printf("    adding 100 breakpoints\n");
+		for (int64_t addr = 0x7000; addr < 0x7062; ++addr) {
+			dms_toggle_breakpoint(dms_ctx, addr);
+		}
+		dms_breakpoint_signal_set(dms_ctx, pet_device->signals[SIG_P2001N_HIGH], false, true);
+		dms_breakpoint_signal_set(dms_ctx, pet_device->signals[SIG_P2001N_LOW], true, false);
+	}
+
+	if (arg_watchpoints) {
+		// watchpoints that are never hit during startup: measures the cost of snooping the bus
+		std::printf("    adding 100 watchpoints%s\n", (arg_fast_bus) ? " (fast bus mode falls back to bus cycles)" : "");
+		for (int64_t addr = 0x7000; addr < 0x7064; ++addr) {
+			dms_watchpoint_set(dms_ctx, addr, BUS_WATCH_READ | BUS_WATCH_WRITE, 0);
+		}
+	}
+
+	Cpu6502Trace *trace = nullptr;
+	if (arg_trace) {
+		std::printf("    enabling instruction trace\n");
+		trace = cpu_6502_trace_create(1 << 20);
+		cpu_6502_set_trace(pet_device->cpu, trace);
+	}
+
     std::printf("+++ done (%f seconds)\n", chrono_report());
 
     std::printf("--- running Commodore PET until BASIC screen\n");
     chrono_reset();
 
+	// without breakpoints or watchpoints there's nothing to check per step: run in batches of 1ms simulated time
+	bool batched = !arg_breakpoints && !arg_watchpoints;
+	int64_t batch_ticks = simulator_interval_to_tick_count(pet_device->simulator, MS_TO_PS(1));
 	bool ready = false;
 
 	while (!ready) {
-		dms_execute_no_sync(dms_ctx);
+		if (batched) {
+			dms_run_for_ticks(dms_ctx, batch_ticks);
+		} else {
+			dms_execute_no_sync(dms_ctx);
+		}
 
 		// check screen memory
 		uint8_t first_char;
@@ -81,5 +149,10 @@ int main(int argc, char *argv[]) {
 
 	dev_commodore_pet_destroy(pet_device);
 	dms_release_context(dms_ctx);
+
+	if (trace) {
+		std::printf("    %" PRIu64 " instructions traced\n", trace->count);
+		cpu_6502_trace_destroy(trace);
+	}
     return 0;
 }
@@ -0,0 +1,112 @@
+// trace_main.cpp - Johan Smet - BSD-3-Clause (see LICENSE)
+//
+// Trace decoder: renders an instruction trace of the 6502 (e.g. written by dromaius_headless --trace) as disassembly.
+//
+// Each line shows the simulator tick at the start of the instruction, the instruction, the registers before it
+// executed and the effective address for the indexed and indirect addressing modes.
+
+#include <cinttypes>
+#include <cstdio>
+#include <string>
+
+#include <argh/argh.h>
+#include <stb/stb_ds.h>
+
+#include "cpu_6502_trace.h"
+#include "filt_6502_asm.h"
+
+namespace {
+
+using argh_list_t = std::initializer_list<const char *const>;
+static constexpr argh_list_t ARG_INPUT = {"-i", "--input"};
+static constexpr argh_list_t ARG_LAST = {"-n", "--last"};
+static constexpr argh_list_t ARG_HELP = {"-h", "--help"};
+
+void print_help() {
+	auto format_argh_list = [](const argh_list_t &args) -> auto {
+		std::string result;
+		const char *sepa = "";
+
+		for (const auto &a : args) {
+			result.append(sepa);
+			result.append(a);
+			sepa = ", ";
+		}
+
+		return result;
+	};
+
+	printf("Usage:\n\n");
+	printf("dromaius_trace [options]\n\n");
+	printf("Options\n");
+	printf(" %-25s trace file to decode.\n",
+			format_argh_list(ARG_INPUT).c_str());
+	printf(" %-25s only decode the last n instructions.\n",
+			format_argh_list(ARG_LAST).c_str());
+	printf(" %-25s display this help message and stop execution.\n",
+			format_argh_list(ARG_HELP).c_str());
+}
+
+void print_record(const Cpu6502TraceRecord *record, int64_t tick, char **line) {
+	filt_6502_asm_line(record->bytes, sizeof(record->bytes), 0, record->pc, line);
+
+	static const char FLAGS[] = "nv-bdizc";
+	char flags[9] = {0};
+	for (int i = 0; i < 8; ++i) {
+		flags[i] = (record->reg_p & (0x80 >> i)) ? static_cast<char>(FLAGS[i] - 'a' + 'A') : FLAGS[i];
+	}
+	flags[2] = '-';
+
+	printf("%12" PRId64 "  %-20s  A=%.2x X=%.2x Y=%.2x SP=%.2x P=%s",
+			tick, *line, record->reg_a, record->reg_x, record->reg_y, record->reg_sp, flags);
+
+	if (filt_6502_asm_is_indexed_or_indirect(record->bytes[0])) {
+		printf("  [$%.4x]", record->address);
+	}
+
+	printf("\n");
+	stbds_header(*line)->length = 0;
+}
+
+} // unnamed namespace
+
+int main(int argc, char *argv[]) {
+
+	argh::parser cmd_line;
+	cmd_line.add_params(ARG_INPUT);
+	cmd_line.add_params(ARG_LAST);
+	cmd_line.add_params(ARG_HELP);
+	cmd_line.parse(argc, argv);
+
+	if (cmd_line[ARG_HELP]) {
+		print_help();
+		return EXIT_SUCCESS;
+	}
+
+	std::string input_file;
+	uint64_t last;
+	cmd_line(ARG_INPUT, "") >> input_file;
+	cmd_line(ARG_LAST, UINT64_MAX) >> last;
+
+	Cpu6502Trace *trace = (input_file.empty()) ? nullptr : cpu_6502_trace_load(input_file.c_str());
+	if (!trace) {
+		fprintf(stderr, "Unable to load trace (%s)\n", input_file.c_str());
+		return EXIT_FAILURE;
+	}
+
+	uint64_t size = cpu_6502_trace_size(trace);
+	uint64_t first = (last < size) ? size - last : 0;
+
+	int64_t *ticks = cpu_6502_trace_ticks(trace);
+	char *line = nullptr;
+
+	for (uint64_t i = first; i < size; ++i) {
+		print_record(cpu_6502_trace_record(trace, i), ticks[i], &line);
+	}
+
+	arrfree(line);
+	arrfree(ticks);
+	cpu_6502_trace_destroy(trace);
+
+	return EXIT_SUCCESS;
+}
@@ -63,6 +63,50 @@ bool file_save_binary(const char *filename, int8_t *data, size_t size) {
 	return written == size;
 }
 
+void file_write_uint_le(FILE *fp, uint64_t value, size_t size) {
+	assert(fp);
+	assert(size <= 8);
+
+	uint8_t buffer[8];
+	for (size_t i = 0; i < size; ++i) {
+		buffer[i] = (uint8_t) (value >> (i * 8));
+	}
+	dms_fwrite(buffer, 1, size, fp);
+}
+
+bool file_read_uint_le(FILE *fp, uint64_t *value, size_t size) {
+	assert(fp);
+	assert(value);
+	assert(size <= 8);
+
+	uint8_t buffer[8];
+	if (dms_fread(buffer, 1, size, fp) != size) {
+		return false;
+	}
+
+	*value = 0;
+	for (size_t i = 0; i < size; ++i) {
+		*value |= (uint64_t) buffer[i] << (i * 8);
+	}
+	return true;
+}
+
+int64_t file_remaining_size(FILE *fp) {
+	assert(fp);
+
+	int64_t pos = dms_ftell(fp);
+	if (pos < 0 || dms_fseek(fp, 0, SEEK_END) != 0) {
+		return -1;
+	}
+
+	int64_t end = dms_ftell(fp);
+	if (dms_fseek(fp, pos, SEEK_SET) != 0 || end < pos) {
+		return -1;
+	}
+
+	return end - pos;
+}
+
 void dir_list_files(const char *path, const char *ext, const char *prefix, const char ***file_list) {
 
 	cf_dir_t dir;
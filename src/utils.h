@@ -5,6 +5,8 @@
 
 #include "types.h"
 
+#include <stdio.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -13,6 +15,13 @@ size_t file_load_binary_fixed(const char *filename, uint8_t *buffer, size_t max_
 size_t file_load_binary(const char* filename, int8_t** buffer);
 bool file_save_binary(const char *filename, int8_t *data, size_t size);
 
+// little-endian unsigned integers of 'size' bytes (max 8) in binary files
+void file_write_uint_le(FILE *fp, uint64_t value, size_t size);
+bool file_read_uint_le(FILE *fp, uint64_t *value, size_t size);
+
+// file_remaining_size: number of bytes between the current position and the end of the file (-1 on error)
+int64_t file_remaining_size(FILE *fp);
+
 void dir_list_files(const char *path, const char *ext, const char *prefix, const char ***file_list);
 
 char *arr__printf(char *array, const char *fmt, ...);